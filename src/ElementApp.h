@@ -54,6 +54,7 @@ namespace Tags
     const Identifier nodes              = "nodes";
     const Identifier notes              = "notes";
     const Identifier oversamplingFactor = "oversamplingFactor";
+    const Identifier downsamplingFactor = "downsamplingFactor";
     const Identifier persistent         = "persistent";
     const Identifier placeholder        = "placeholder";
     const Identifier port               = "port";
@@ -113,6 +114,17 @@ namespace Tags
     const Identifier workspace          = "workspace";
 
     const Identifier externalSync       = "externalSync";
+
+    const Identifier automation         = "automation";
+    const Identifier lane               = "lane";
+    const Identifier point              = "point";
+    const Identifier beat               = "beat";
+    const Identifier value              = "value";
+
+    const Identifier scene              = "scene";
+    const Identifier scenes             = "scenes";
+    const Identifier glide              = "glide";
+    const Identifier parameters         = "parameters";
 }
 
 struct Alert
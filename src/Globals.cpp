@@ -17,9 +17,11 @@
 */
 
 #include "ElementApp.h"
+#include "DataPath.h"
 #include "engine/InternalFormat.h"
 #include "session/DeviceManager.h"
 #include "session/MediaManager.h"
+#include "session/PeakCache.h"
 #include "session/PluginManager.h"
 #include "session/Presets.h"
 #include "session/Session.h"
@@ -68,6 +70,7 @@ public:
     std::unique_ptr<MappingEngine> mapping;
     std::unique_ptr<PresetCollection> presets;
     std::unique_ptr<MidiEngine>   midi;
+    std::unique_ptr<PeakCache>    peaks;
    
 private:
     friend class Globals;
@@ -82,6 +85,7 @@ private:
         mapping.reset (new MappingEngine());
         midi.reset (new MidiEngine());
         presets.reset (new PresetCollection());
+        peaks.reset (new PeakCache (DataPath::applicationDataDir().getChildFile ("PeakCache")));
     }
     
     void freeAll()
@@ -95,6 +99,7 @@ private:
         devices  = nullptr;
         midi     = nullptr;
         presets  = nullptr;
+        peaks    = nullptr;
     }
 };
 
@@ -144,6 +149,12 @@ MediaManager& Globals::getMediaManager()
 
 AudioEnginePtr Globals::getAudioEngine() const { return impl->engine; }
 
+PeakCache& Globals::getPeakCache()
+{
+    jassert (impl != nullptr && impl->peaks != nullptr);
+    return *impl->peaks;
+}
+
 PluginManager& Globals::getPluginManager()
 {
     jassert (impl->plugins != nullptr);
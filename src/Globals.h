@@ -31,6 +31,7 @@ namespace Element {
 class CommandManager;
 class DeviceManager;
 class MediaManager;
+class PeakCache;
 class PluginManager;
 class PresetCollection;
 class Settings;
@@ -58,6 +59,7 @@ public:
     DeviceManager& getDeviceManager();
     MappingEngine& getMappingEngine();
     MidiEngine& getMidiEngine();
+    PeakCache& getPeakCache();
     PluginManager& getPluginManager();
     PresetCollection& getPresetCollection();
     Settings& getSettings();
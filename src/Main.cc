@@ -72,6 +72,14 @@ public:
             devices.initialiseWithDefaultDevices (DeviceManager::maxAudioChannels,
                                                   DeviceManager::maxAudioChannels);
         }
+
+        const auto backupDevice = settings.getBackupAudioDevice();
+        if (backupDevice.isNotEmpty())
+        {
+            const auto error = devices.setBackupAudioDevice (backupDevice);
+            if (error.isNotEmpty())
+                Logger::writeToLog ("[EL] backup audio device: " + error);
+        }
         
         if (usingThread)
         {
@@ -38,6 +38,11 @@ const char* Settings::lastGraphKey              = "lastGraph";
 const char* Settings::legacyInterfaceKey        = "legacyInterface";
 const char* Settings::workspaceKey              = "workspace";
 const char* Settings::midiEngineKey             = "midiEngine";
+const char* Settings::signalGuardKey            = "signalGuard";
+const char* Settings::sleepIdleNodesKey         = "sleepIdleNodes";
+const char* Settings::localityOrderingKey       = "localityOrdering";
+const char* Settings::pluginUsageKey            = "pluginUsage";
+const char* Settings::backupAudioDeviceKey      = "backupAudioDevice";
 
 enum OptionsMenuItemId
 {
@@ -81,7 +86,153 @@ static bool settingResultIsFor (const int result, const int optionMenuId) {
   const char* Settings::pluginListKey            = "pluginList64";
  #endif
 #endif
-    
+
+//=============================================================================
+class Settings::Writer : public Thread
+{
+public:
+    Writer() : Thread ("Element: Settings Writer")
+    {
+        startThread (3);
+    }
+
+    ~Writer()
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread (5000);
+    }
+
+    /** Replaces any write that hasn't started yet */
+    void write (const File& file, const StringPairArray& values, bool asXml,
+                InterProcessLock* processLock)
+    {
+        {
+            const ScopedLock sl (lock);
+            pending.reset (new Job { file, values, asXml, processLock });
+        }
+        notify();
+    }
+
+    bool isIdle() const
+    {
+        const ScopedLock sl (lock);
+        return pending == nullptr && ! busy;
+    }
+
+    void waitUntilIdle()
+    {
+        while (! isIdle() && isThreadRunning())
+            idle.wait (20);
+    }
+
+    /** Returns true once after a write has failed */
+    bool checkFailed() { return failed.exchange (0) != 0; }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            std::unique_ptr<Job> job;
+            {
+                const ScopedLock sl (lock);
+                job.swap (pending);
+                busy = job != nullptr;
+            }
+
+            if (job == nullptr)
+            {
+                wait (-1);
+                continue;
+            }
+
+            if (! writeFile (*job))
+            {
+                DBG("[EL] could not write settings: " << job->file.getFullPathName());
+                failed.set (1);
+            }
+
+            {
+                const ScopedLock sl (lock);
+                busy = false;
+            }
+            idle.signal();
+        }
+    }
+
+private:
+    struct Job
+    {
+        File file;
+        StringPairArray values;
+        bool asXml;
+        InterProcessLock* processLock;
+    };
+
+    CriticalSection lock;
+    std::unique_ptr<Job> pending;
+    bool busy = false;
+    WaitableEvent idle;
+    Atomic<int> failed { 0 };
+
+    // the same formats PropertiesFile reads back
+    static bool writeFile (const Job& job)
+    {
+        if (job.file == File() || ! job.file.getParentDirectory().createDirectory())
+            return false;
+
+        // as PropertiesFile::save does, so another process never reads a half write
+        std::unique_ptr<InterProcessLock::ScopedLockType> pl;
+        if (job.processLock != nullptr)
+        {
+            pl.reset (new InterProcessLock::ScopedLockType (*job.processLock));
+            if (! pl->isLocked())
+                return false;
+        }
+
+        const auto& keys   = job.values.getAllKeys();
+        const auto& values = job.values.getAllValues();
+
+        if (job.asXml)
+        {
+            XmlElement doc ("PROPERTIES");
+            for (int i = 0; i < keys.size(); ++i)
+            {
+                auto* e = doc.createNewChildElement ("VALUE");
+                e->setAttribute ("name", keys[i]);
+                if (auto child = XmlDocument::parse (values[i]))
+                    e->addChildElement (child.release());
+                else
+                    e->setAttribute ("val", values[i]);
+            }
+
+            return doc.writeToFile (job.file, {});
+        }
+
+        TemporaryFile temp (job.file);
+        {
+            FileOutputStream out (temp.getFile());
+            if (out.failedToOpen())
+                return false;
+
+            out.writeInt ((int) ByteOrder::makeInt ('C', 'P', 'R', 'P'));
+            out.flush();
+
+            GZIPCompressorOutputStream gzip (out, 9);
+            gzip.writeInt (keys.size());
+            for (int i = 0; i < keys.size(); ++i)
+            {
+                gzip.writeString (keys[i]);
+                gzip.writeString (values[i]);
+            }
+            gzip.flush();
+        }
+
+        return temp.overwriteTargetFileWithTemporary();
+    }
+};
+
+//=============================================================================
 Settings::Settings()
 {
     PropertiesFile::Options opts;
@@ -89,6 +240,9 @@ Settings::Settings()
     opts.filenameSuffix      = "conf";
     opts.osxLibrarySubFolder = "Application Support";
     opts.storageFormat       = PropertiesFile::storeAsCompressedBinary;
+    // written by Settings::Writer instead
+    opts.millisecondsBeforeSaving = -1;
+    opts.processLock         = &processLock;
 
    #if JUCE_DEBUG
     opts.applicationName << "Debug";
@@ -102,9 +256,70 @@ Settings::Settings()
    #endif
 
     setStorageParameters (opts);
+    storeAsXml = opts.storageFormat == PropertiesFile::storeAsXML;
+    writer.reset (new Writer());
+    if (auto* props = getUserSettings())
+        props->addChangeListener (this);
+}
+
+Settings::~Settings()
+{
+    if (auto* props = getUserSettings())
+        props->removeChangeListener (this);
+    flush();
+    writer.reset();
+    // the files hold a pointer to the process lock
+    closeFiles();
+}
+
+bool Settings::saveIfNeeded()
+{
+    queueWrite();
+    return true;
+}
+
+void Settings::flush()
+{
+    stopTimer();
+    if (writer->checkFailed())
+        if (auto* props = getProps())
+            props->setNeedsToBeSaved (true);
+    queueWrite();
+    writer->waitUntilIdle();
 }
 
-Settings::~Settings() { }
+void Settings::queueWrite()
+{
+    auto* props = getProps();
+    if (props == nullptr || ! props->needsToBeSaved())
+        return;
+
+    StringPairArray values;
+    {
+        const ScopedLock sl (props->getLock());
+        values = props->getAllProperties();
+    }
+
+    props->setNeedsToBeSaved (false);
+    writer->write (props->getFile(), values, storeAsXml, &processLock);
+    // checks back for a failed write
+    startTimer (retryDelayMs);
+}
+
+void Settings::changeListenerCallback (ChangeBroadcaster*)
+{
+    if (! isTimerRunning() || getTimerInterval() > writeDelayMs)
+        startTimer (writeDelayMs);
+}
+
+void Settings::timerCallback()
+{
+    stopTimer();
+    if (writer->checkFailed())
+        if (auto* props = getProps())
+            props->setNeedsToBeSaved (true);
+    queueWrite();
+}
 
     
 bool Settings::checkForUpdates() const
@@ -281,6 +496,66 @@ void Settings::setHidePluginWindowsWhenFocusLost (const bool hideThem)
         p->setValue (hidePluginWindowsWhenFocusLostKey, hideThem);
 }
 
+bool Settings::useSignalGuard() const
+{
+    if (auto* p = getProps())
+        return p->getBoolValue (signalGuardKey, true);
+    return true;
+}
+
+void Settings::setUseSignalGuard (const bool useGuard)
+{
+    if (useGuard == useSignalGuard())
+        return;
+    if (auto* p = getProps())
+        p->setValue (signalGuardKey, useGuard);
+}
+
+bool Settings::sleepIdleNodes() const
+{
+    if (auto* p = getProps())
+        return p->getBoolValue (sleepIdleNodesKey, true);
+    return true;
+}
+
+void Settings::setSleepIdleNodes (const bool sleepNodes)
+{
+    if (sleepNodes == sleepIdleNodes())
+        return;
+    if (auto* p = getProps())
+        p->setValue (sleepIdleNodesKey, sleepNodes);
+}
+
+bool Settings::localityOrdering() const
+{
+    if (auto* p = getProps())
+        return p->getBoolValue (localityOrderingKey, true);
+    return true;
+}
+
+void Settings::setLocalityOrdering (const bool ordering)
+{
+    if (ordering == localityOrdering())
+        return;
+    if (auto* p = getProps())
+        p->setValue (localityOrderingKey, ordering);
+}
+
+void Settings::setBackupAudioDevice (const String& name)
+{
+    if (getBackupAudioDevice() == name)
+        return;
+    if (auto* p = getProps())
+        p->setValue (backupAudioDeviceKey, name);
+}
+
+String Settings::getBackupAudioDevice() const
+{
+    if (auto* p = getProps())
+        return p->getValue (backupAudioDeviceKey);
+    return String();
+}
+
 bool Settings::useLegacyInterface() const
 {
     if (auto* p = getProps())
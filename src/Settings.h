@@ -24,7 +24,16 @@ namespace Element {
 
 class Globals;
 
-class Settings :  public ApplicationProperties
+/** Application settings.
+
+    Changes are written behind: the properties are copied on the message
+    thread and written to disk on a background thread, replacing the file
+    atomically. A burst of changes results in one write. Reads and writes
+    hold an inter-process lock so the plugin scanner can share the file.
+ */
+class Settings :  public ApplicationProperties,
+                  private ChangeListener,
+                  private Timer
 {
 public:
     Settings();
@@ -47,6 +56,18 @@ public:
     static const char* legacyInterfaceKey;
     static const char* workspaceKey;
     static const char* midiEngineKey;
+    static const char* signalGuardKey;
+    static const char* sleepIdleNodesKey;
+    static const char* localityOrderingKey;
+    static const char* pluginUsageKey;
+    static const char* backupAudioDeviceKey;
+
+    /** Queues the changed settings to be written in the background. Hides
+        ApplicationProperties::saveIfNeeded, which writes on the caller's thread */
+    bool saveIfNeeded();
+
+    /** Writes pending changes and waits until they are on disk */
+    void flush();
 
     std::unique_ptr<XmlElement> getLastGraph() const;
     void setLastGraph (const ValueTree& data);
@@ -97,6 +118,22 @@ public:
     void setHidePluginWindowsWhenFocusLost (const bool);
     bool hidePluginWindowsWhenFocusLost() const;
 
+    /** True if node outputs should be checked for NaN, Inf and denormals */
+    void setUseSignalGuard (const bool);
+    bool useSignalGuard() const;
+
+    /** True if effects may skip rendering while their inputs are silent */
+    void setSleepIdleNodes (const bool);
+    bool sleepIdleNodes() const;
+
+    /** True if graphs order their nodes for cache locality */
+    void setLocalityOrdering (const bool);
+    bool localityOrdering() const;
+
+    /** Name of the output device that mirrors the main output */
+    void setBackupAudioDevice (const String& name);
+    String getBackupAudioDevice() const;
+
     void setUseLegacyInterface (const bool);
     bool useLegacyInterface() const;
 
@@ -105,7 +142,16 @@ public:
     File getWorkspaceFile() const;
 
 private:
+    enum { writeDelayMs = 500, retryDelayMs = 5000 };
+    class Writer;
+    InterProcessLock processLock { "ElementSettings" };
+    std::unique_ptr<Writer> writer;
+    bool storeAsXml = false;
+
     PropertiesFile* getProps() const;
+    void queueWrite();
+    void changeListenerCallback (ChangeBroadcaster*) override;
+    void timerCallback() override;
 };
 
 }
@@ -34,7 +34,10 @@ StringArray getFullVesrionPluginIdentifiers()
         EL_INTERNAL_ID_AUDIO_ROUTER,
         EL_INTERNAL_ID_MEDIA_PLAYER,
         EL_INTERNAL_ID_MIDI_PROGRAM_MAP,
-        EL_INTERNAL_ID_PLACEHOLDER
+        EL_INTERNAL_ID_PLACEHOLDER,
+        EL_INTERNAL_ID_LFO,
+        EL_INTERNAL_ID_ENVELOPE_FOLLOWER,
+        EL_INTERNAL_ID_MIDI_TO_CONTROL
     };
 }
 
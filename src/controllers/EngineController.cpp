@@ -24,6 +24,7 @@
 #include "engine/nodes/MidiDeviceProcessor.h"
 
 #include "engine/nodes/SubGraphProcessor.h"
+#include "engine/SessionReplication.h"
 #include "session/DeviceManager.h"
 #include "session/PluginManager.h"
 #include "session/Node.h"
@@ -51,20 +52,15 @@ struct RootGraphHolder
         model = Node();
     }
     
-    bool attached() const { return node && controller; }
+    bool attached() const { return inEngine && node && controller; }
 
-    /** This will create a root graph processor/controller and load it if not
-        done already. Properties are set from the model, so make sure they are
-        correct before calling this */
-    bool attach (AudioEnginePtr engine)
+    /** Creates the root graph processor and its controller without adding
+        it to the engine, so nodes can be loaded before it renders */
+    bool prepare()
     {
-        jassert (engine);
-        if (! engine)
-            return false;
-        
-        if (attached())
+        if (node && controller)
             return true;
-        
+
         node = GraphNode::createForRoot (new RootGraph ());
         
         if (auto* root = getRootGraph())
@@ -80,10 +76,35 @@ struct RootGraphHolder
             root->setMidiChannels (channels);
             root->setMidiProgram (program);
 
-            if (engine->addGraph (root))
+            controller = new RootGraphManager (*root, plugins);
+            model.setProperty (Tags::object, node.get());
+        }
+
+        return node && controller;
+    }
+
+    /** This will create a root graph processor/controller and load it if not
+        done already. Properties are set from the model, so make sure they are
+        correct before calling this. A graph that was prepared and loaded
+        beforehand is swapped into the engine as is. */
+    bool attach (AudioEnginePtr engine)
+    {
+        jassert (engine);
+        if (! engine)
+            return false;
+        
+        if (attached())
+            return true;
+
+        const bool wasLoaded = controller && controller->isLoaded();
+        if (! prepare())
+            return false;
+
+        if (engine->addGraph (getRootGraph()))
+        {
+            inEngine = true;
+            if (! wasLoaded)
             {
-                controller = new RootGraphManager (*root, plugins);
-                model.setProperty (Tags::object, node.get());
                 controller->setNodeModel (model);
                 resetIONodePorts();
             }
@@ -106,6 +127,7 @@ struct RootGraphHolder
         
         if (wasRemoved)
         {
+            inEngine = false;
             controller = nullptr;
             node = nullptr;
         }
@@ -133,11 +155,13 @@ struct RootGraphHolder
 private:
     friend class EngineController;
     friend class EngineController::RootGraphs;
+    friend class EngineController::GraphDuplicator;
     PluginManager&                      plugins;
     DeviceManager&                      devices;
     ScopedPointer<RootGraphManager>  controller;
     Node                                model;
     GraphNodePtr                        node;
+    bool                                inEngine = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RootGraphHolder);
 };
@@ -301,6 +325,192 @@ private:
     OwnedArray<RootGraphHolder> graphs;
 };
 
+/** Duplicates a root graph without holding up the message thread.
+
+    Plugin states are captured raw on the message thread, then encoded on a
+    background thread. Identical states are only encoded once. The copy is
+    then instantiated a few nodes per timer tick into a graph the engine
+    doesn't know about yet, and swapped in once every node is loaded.
+    Cancelling at any point leaves the session untouched.
+ */
+class EngineController::GraphDuplicator : private Thread,
+                                          private Timer
+{
+public:
+    GraphDuplicator (EngineController& o, const Node& graph)
+        : Thread ("element: duplicate graph"),
+          owner (o)
+    {
+        duplicate = graph.getValueTree().createCopy();
+
+        // the copy still refers to the original objects, states are read from them
+        Node (duplicate, false).savePluginState ([this](ValueTree& data, const Identifier& property, MemoryBlock& state)
+        {
+            auto* const captured = states.add (new CapturedState());
+            captured->data = data;
+            captured->property = property;
+            captured->state.swapWith (state);
+        });
+
+        // dropped here so the originals are never released off this thread
+        Node::sanitizeRuntimeProperties (duplicate);
+
+        started = Time::getMillisecondCounter();
+        startThread (3);
+        startTimer (10);
+    }
+
+    ~GraphDuplicator()
+    {
+        stopTimer();
+        stopThread (5000);
+        progressWindow = nullptr;
+        holder = nullptr;
+    }
+
+private:
+    struct CapturedState
+    {
+        ValueTree data;
+        Identifier property;
+        MemoryBlock state;
+    };
+
+    /** Shows the progress and a button to cancel */
+    struct ProgressWindow : public AlertWindow
+    {
+        ProgressWindow (GraphDuplicator& d)
+            : AlertWindow ("Duplicate Graph", "Loading the copy...", AlertWindow::NoIcon),
+              duplicator (d)
+        {
+            addProgressBarComponent (duplicator.progress);
+            addButton (TRANS("Cancel"), 0, KeyPress (KeyPress::escapeKey));
+        }
+
+        static void closed (int result, ProgressWindow* window)
+        {
+            if (window != nullptr && result == 0)
+                window->duplicator.owner.cancelDuplication();
+        }
+
+        GraphDuplicator& duplicator;
+    };
+
+    EngineController& owner;
+    ValueTree duplicate;
+    OwnedArray<CapturedState> states;
+    std::unique_ptr<RootGraphHolder> holder;
+    std::unique_ptr<ProgressWindow> progressWindow;
+    double progress = 0.0;
+    int numNodes = 0;
+    uint32 started = 0;
+
+    static int64 hashState (const MemoryBlock& block) noexcept
+    {
+        // FNV-1a, a match is confirmed by comparing the blocks
+        uint64 hash = 14695981039346656037ull;
+        const auto* const data = static_cast<const uint8*> (block.getData());
+        for (size_t i = 0; i < block.getSize(); ++i)
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        return (int64) hash;
+    }
+
+    void run() override
+    {
+        HashMap<int64, int> firstWithHash;
+        StringArray encodings;
+
+        for (int i = 0; i < states.size(); ++i)
+        {
+            if (threadShouldExit())
+                return;
+
+            const auto& state = states.getUnchecked(i)->state;
+            const int64 hash = hashState (state);
+            const int match = firstWithHash.contains (hash) ? firstWithHash [hash] : -1;
+
+            if (match >= 0 && states.getUnchecked(match)->state == state)
+            {
+                // instances with the same settings share one string
+                encodings.add (encodings [match]);
+            }
+            else
+            {
+                if (match < 0)
+                    firstWithHash.set (hash, i);
+                encodings.add (state.toBase64Encoding());
+            }
+        }
+
+        // nothing else refers to the copy until this thread has finished
+        for (int i = 0; i < states.size(); ++i)
+        {
+            if (threadShouldExit())
+                return;
+            states.getUnchecked(i)->data.setProperty (states.getUnchecked(i)->property, encodings[i], nullptr);
+        }
+        states.clear();
+
+        // fresh uuids avoid complications with undoable actions
+        Node copy (duplicate, false);
+        copy.forEach ([](const ValueTree& tree)
+        {
+            if (! tree.hasType (Tags::node))
+                return;
+            auto nodeRef = tree;
+            nodeRef.setProperty (Tags::uuid, Uuid().toString(), nullptr);
+        });
+
+        copy.setProperty (Tags::name, copy.getName().replace ("(copy)", "").trim() + String (" (copy)"));
+    }
+
+    void timerCallback() override
+    {
+        if (progressWindow == nullptr && Time::getMillisecondCounter() - started > 300)
+        {
+            progressWindow.reset (new ProgressWindow (*this));
+            progressWindow->enterModalState (true, ModalCallbackFunction::forComponent (
+                ProgressWindow::closed, progressWindow.get()));
+        }
+
+        if (isThreadRunning())
+            return;
+
+        if (holder == nullptr)
+        {
+            holder.reset (new RootGraphHolder (Node (duplicate, false), owner.getWorld()));
+            if (! holder->prepare())
+            {
+                owner.duplicationFinished (nullptr);
+                return;
+            }
+
+            numNodes = holder->model.getNumNodes();
+            holder->controller->beginLoading (holder->model);
+            progress = 0.1;
+            return;
+        }
+
+        // plugins must be created on this thread, so only a slice at a time
+        auto& controller = *holder->controller;
+        const double deadline = Time::getMillisecondCounterHiRes() + 15.0;
+        bool more = true;
+        while (more && Time::getMillisecondCounterHiRes() < deadline)
+            more = controller.loadNextNode();
+
+        progress = 0.1 + 0.9 * (double) controller.getNumNodesLoaded() / (double) jmax (1, numNodes);
+        if (more)
+            return;
+
+        stopTimer();
+        controller.finishLoading();
+        holder->resetIONodePorts();
+        owner.duplicationFinished (holder.release());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphDuplicator)
+};
+
 EngineController::EngineController()
     : AppController::Child()
 {
@@ -309,6 +519,7 @@ EngineController::EngineController()
 
 EngineController::~EngineController()
 {
+    duplicator = nullptr;
     graphs = nullptr;
 }
 
@@ -383,20 +594,39 @@ void EngineController::addGraph (const Node& newGraph)
 
 void EngineController::duplicateGraph (const Node& graph)
 {
-    Node duplicate (graph.getValueTree().createCopy());
-    duplicate.savePluginState(); // need objects present to update processor states
-    Node::sanitizeRuntimeProperties (duplicate.getValueTree());
-    // reset UUIDs to avoid compilcations with undoable actions
-    duplicate.forEach ([](const ValueTree& tree)
+    // one at a time, the progress window is modal anyway
+    if (duplicator != nullptr || ! graph.isGraph())
+        return;
+    duplicator = new GraphDuplicator (*this, graph);
+}
+
+void EngineController::cancelDuplication()
+{
+    duplicator = nullptr;
+}
+
+void EngineController::duplicationFinished (RootGraphHolder* loaded)
+{
+    std::unique_ptr<RootGraphHolder> holder (loaded);
+    auto engine  = getWorld().getAudioEngine();
+    auto session = getWorld().getSession();
+
+    if (holder != nullptr && holder->attach (engine))
     {
-        if (! tree.hasType (Tags::node))
-            return;
-        auto nodeRef = tree;
-        nodeRef.setProperty (Tags::uuid, Uuid().toString(), nullptr);
-    });
+        const Node node (holder->model);
+        graphs->add (holder.release());
+        session->addGraph (node, true);
+        setRootNode (node);
+    }
+    else
+    {
+        AlertWindow::showMessageBoxAsync (AlertWindow::InfoIcon, "Audio Engine",
+                                          "Could not attach new graph to engine.");
+    }
 
-    duplicate.setProperty (Tags::name, duplicate.getName().replace("(copy)","").trim() + String(" (copy)"));
-    addGraph (duplicate);
+    // called from the duplicator's timer, which returns straight away
+    duplicator = nullptr;
+    findSibling<GuiController>()->stabilizeContent();
 }
 
 void EngineController::duplicateGraph()
@@ -652,6 +882,7 @@ void EngineController::deactivate()
         gui->closeAllPluginWindows();
     }
     
+    duplicator = nullptr;
     session->saveGraphState();
     graphs->clear();
     
@@ -662,6 +893,7 @@ void EngineController::deactivate()
 
 void EngineController::clear()
 {
+    duplicator = nullptr;
     graphs->clear();
 }
 
@@ -847,6 +1079,8 @@ Node EngineController::addPlugin (const Node& graph, const PluginDescription& de
 
 void EngineController::sessionReloaded()
 {
+    // a copy of a graph from the old session has nowhere to go
+    duplicator = nullptr;
     graphs->clear();
 
     auto session = getWorld().getSession();
@@ -976,6 +1210,33 @@ void EngineController::changeBusesLayout (const Node& n, const AudioProcessor::B
     }
 }
 
+void EngineController::captureScene (const Node& graph, const String& name)
+{
+    if (! graph.isGraph() || name.isEmpty())
+        return;
+
+    auto scenes = graph.getValueTree().getOrCreateChildWithName (Tags::scenes, nullptr);
+    scenes.removeChild (scenes.getChildWithProperty (Tags::name, name), nullptr);
+    scenes.addChild (CompiledScene::capture (graph, name), -1, nullptr);
+}
+
+bool EngineController::recallScene (const Node& graph, const String& name)
+{
+    GraphNodePtr ptr = graph.getGraphNode();
+    auto* const gp = ptr != nullptr ? dynamic_cast<GraphProcessor*> (ptr->getAudioProcessor()) : nullptr;
+    const auto scene = graph.getScenesValueTree().getChildWithProperty (Tags::name, name);
+    if (gp == nullptr || ! scene.isValid())
+        return false;
+
+    auto compiled = CompiledScene::compile (graph, scene);
+    if (compiled == nullptr || ! gp->getSceneRecall().recall (compiled))
+        return false;
+
+    if (auto* leader = getWorld().getAudioEngine()->getReplicationLeader())
+        leader->sendScene (graph, name);
+    return true;
+}
+
 void EngineController::replace (const Node& node, const PluginDescription& desc)
 {
     const auto graph (node.getParentGraph());
@@ -27,6 +27,7 @@ namespace Element {
 struct ConnectionBuilder;
 class GraphManager;
 class RootGraphManager;
+struct RootGraphHolder;
     
 class EngineController : public AppController::Child,
                          private ChangeListener
@@ -84,8 +85,15 @@ public:
     /** Duplicates the currently active root graph */
     void duplicateGraph();
 
-    /** Ads a specific new graph */
+    /** Duplicates a specific graph. The copy is loaded in the background
+        and added once every node is ready. */
     void duplicateGraph (const Node& graph);
+
+    /** Stops a duplicate that is still loading, nothing is added */
+    void cancelDuplication();
+
+    /** Returns true while a duplicate is loading */
+    bool isDuplicatingGraph() const { return duplicator != nullptr; }
     
     /** Add a connection on the active root graph */
     void addConnection (const uint32, const uint32, const uint32, const uint32);
@@ -120,11 +128,22 @@ public:
     void replace (const Node&, const PluginDescription&);
     
     void changeBusesLayout (const Node& node, const AudioProcessor::BusesLayout& layout);
+
+    /** Captures the state of a graph's nodes as a scene. A scene with the
+        same name is replaced. */
+    void captureScene (const Node& graph, const String& name);
+
+    /** Recalls a scene stored on a graph. It is applied on the graph's audio
+        thread at the start of the next block. */
+    bool recallScene (const Node& graph, const String& name);
     
 private:
     friend struct RootGraphHolder;
     class RootGraphs; friend class RootGraphs;
     ScopedPointer<RootGraphs> graphs;
+    class GraphDuplicator; friend class GraphDuplicator;
+    ScopedPointer<GraphDuplicator> duplicator;
+    void duplicationFinished (RootGraphHolder*);
     
     friend class ChangeBroadcaster;
     void changeListenerCallback (ChangeBroadcaster*) override;
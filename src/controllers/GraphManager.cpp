@@ -470,6 +470,14 @@ void GraphManager::removeConnection (uint32 sourceNode, uint32 sourcePort,
 }
 
 void GraphManager::setNodeModel (const Node& node)
+{
+    beginLoading (node);
+    while (loadNextNode())
+        continue;
+    finishLoading();
+}
+
+void GraphManager::beginLoading (const Node& node)
 {
     loaded = false;
 
@@ -477,30 +485,49 @@ void GraphManager::setNodeModel (const Node& node)
     graph   = node.getValueTree();
     arcs    = node.getArcsValueTree();
     nodes   = node.getNodesValueTree();
-    
-    Array<ValueTree> failed;
-    for (int i = 0; i < nodes.getNumChildren(); ++i)
+    loadIndex = 0;
+    failedNodes.clearQuick();
+
+    // loading can span many message loop turns, the sequence is built once
+    // finishLoading() has added everything
+    processor.setRebuildsSuspended (true);
+}
+
+bool GraphManager::loadNextNode()
+{
+    if (loadIndex >= nodes.getNumChildren())
+        return false;
+
+    Node node (nodes.getChild (loadIndex++), false);
+    const PluginDescription desc (pluginManager.findDescriptionFor (node));
+    if (GraphNodePtr obj = createFilter (&desc, 0.0, 0.0, node.getNodeId()))
     {
-        Node node (nodes.getChild (i), false);
-        const PluginDescription desc (pluginManager.findDescriptionFor (node));
-        if (GraphNodePtr obj = createFilter (&desc, 0.0, 0.0, node.getNodeId()))
-        {
-            setupNode (node.getValueTree(), obj);
-            obj->setEnabled (node.isEnabled());
-            node.setProperty (Tags::enabled, obj->isEnabled());
-        }
-        else if (GraphNodePtr ph = createPlaceholder (node))
-        {
-            DBG("[EL] couldn't create node: " << node.getName() << ". Creating offline placeholder");
-            node.getValueTree().setProperty (Tags::object, ph.get(), nullptr);
-            node.getValueTree().setProperty (Tags::missing, true, nullptr);
-        }
-        else
-        {
-            DBG("[EL] couldn't create node: " << node.getName());
-            failed.add (node.getValueTree());
-        }
+        setupNode (node.getValueTree(), obj);
+        obj->setEnabled (node.isEnabled());
+        node.setProperty (Tags::enabled, obj->isEnabled());
     }
+    else if (GraphNodePtr ph = createPlaceholder (node))
+    {
+        DBG("[EL] couldn't create node: " << node.getName() << ". Creating offline placeholder");
+        node.getValueTree().setProperty (Tags::object, ph.get(), nullptr);
+        node.getValueTree().setProperty (Tags::missing, true, nullptr);
+    }
+    else
+    {
+        DBG("[EL] couldn't create node: " << node.getName());
+        failedNodes.add (node.getValueTree());
+    }
+
+    return loadIndex < nodes.getNumChildren();
+}
+
+void GraphManager::finishLoading()
+{
+    while (loadNextNode())
+        continue;
+
+    Array<ValueTree> failed;
+    failed.swapWith (failedNodes);
 
     for (const auto& n : failed)
     {
@@ -551,6 +578,7 @@ void GraphManager::setNodeModel (const Node& node)
     loaded = true;
     jassert (arcs.getNumChildren() == processor.getNumConnections());
     failed.clearQuick();
+    processor.setRebuildsSuspended (false);
 
     IONodeEnforcer enforceIONodes (*this);
     processorArcsChanged();
@@ -580,6 +608,8 @@ void GraphManager::clear()
         graph.addChild (arcs, -1, nullptr);
     }
     
+    // a load that was cut short mustn't leave the graph without rebuilds
+    processor.setRebuildsSuspended (false);
     processor.clear();
     changed();
 }
@@ -87,6 +87,22 @@ public:
     void clear();
 
     void setNodeModel (const Node& node);
+
+    /** Starts loading a graph model one node at a time. Call loadNextNode()
+        until it returns false then finishLoading(), setNodeModel() does all
+        three at once. The graph's rendering sequence isn't rebuilt until
+        finishLoading(). */
+    void beginLoading (const Node& node);
+
+    /** Instantiates the next node of the model being loaded. Returns false
+        once there are no more to load */
+    bool loadNextNode();
+
+    /** Loads any remaining nodes then the connections */
+    void finishLoading();
+
+    /** Returns how many nodes of the model being loaded have been created */
+    int getNumNodesLoaded() const noexcept { return loadIndex; }
     inline Node getGraphModel() const { return Node (graph, false); }
     
     void savePluginStates();
@@ -105,6 +121,8 @@ private:
     GraphProcessor& processor;
     ValueTree graph, arcs, nodes;
     bool loaded = false;
+    int loadIndex = 0;
+    Array<ValueTree> failedNodes;
     
     uint32 lastUID;
     uint32 getNextUID() noexcept;
@@ -29,6 +29,7 @@
 #include "gui/ContentComponent.h"
 #include "gui/GuiCommon.h"
 #include "gui/MainWindow.h"
+#include "gui/NodeEditorCache.h"
 #include "gui/PluginWindow.h"
 #include "gui/SystemTray.h"
 #include "gui/views/VirtualKeyboardView.h"
@@ -135,6 +136,7 @@ GuiController::GuiController (Globals& w, AppController& a)
         sGlobalLookAndFeel = new GlobalLookAndFeel();
     sGuiControllerInstances.add (this);
     windowManager = new WindowManager (*this);
+    editorCache.reset (new NodeEditorCache());
 }
 
 GuiController::~GuiController()
@@ -215,6 +217,9 @@ void GuiController::deactivate()
         content = nullptr;
     }
 
+    // views hand their editors back as they close
+    editorCache->clear();
+
     Controller::deactivate();
 }
 
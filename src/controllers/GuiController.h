@@ -36,6 +36,7 @@ class EngineControl;
 class Globals;
 class ContentComponent;
 class MainWindow;
+class NodeEditorCache;
 class PluginWindow;
 class SessionDocument;
 
@@ -119,6 +120,9 @@ public:
     /** Get the look and feel used by this instance */
     Element::LookAndFeel& getLookAndFeel();
 
+    /** Hidden editors kept for quick reuse by plugin windows and views */
+    NodeEditorCache& getEditorCache() { return *editorCache; }
+
     #if EL_RUNNING_AS_PLUGIN
     void clearContentComponent();
     #endif
@@ -143,6 +147,7 @@ private:
     ScopedPointer<ContentComponent>  content;
     ScopedPointer<DialogWindow>      about;
     std::unique_ptr<Component>       activation;
+    std::unique_ptr<NodeEditorCache> editorCache;
     Node selectedNode; // TODO: content manager
 
     struct KeyPressManager;
@@ -314,6 +314,16 @@ void MappingController::onControlCaptured()
 
         if (impl->isCaptureComplete())
         {
+            // learning the same control twice shouldn't stack handlers
+            for (const auto& existing : session->findControllerMaps (impl->node))
+            {
+                if (existing.getParameterIndex() == impl->parameter &&
+                    existing.getProperty (Tags::control).toString() == impl->control.getUuidString())
+                {
+                    return;
+                }
+            }
+
             if (mapping.addHandler (impl->control, impl->node, impl->parameter))
             {
                 ValueTree newMap (Tags::map);
@@ -24,6 +24,10 @@
 #include "engine/MidiChannelMap.h"
 #include "engine/MidiEngine.h"
 #include "engine/MidiTranspose.h"
+#include "engine/RealtimeSafety.h"
+#include "engine/RenderArena.h"
+#include "engine/SessionCapture.h"
+#include "engine/SessionReplication.h"
 #include "engine/Transport.h"
 #include "Globals.h"
 #include "Settings.h"
@@ -131,8 +135,42 @@ struct RootGraphRender : public AsyncUpdater
     {
         numInputChans   = numIns;
         numOutputChans  = numOuts;
-        audioTemp.setSize (jmax (numIns, numOuts), numSamples);
-        audioOut.setSize (audioTemp.getNumChannels(), audioTemp.getNumSamples());
+
+        // both buffers share one prefaulted region
+        std::unique_ptr<RenderArena> newArena (new RenderArena());
+        const int numChans = jmax (1, numIns, numOuts);
+        layoutBuffers (*newArena, numChans, numSamples);
+        if (newArena->commit())
+        {
+            layoutBuffers (*newArena, numChans, numSamples);
+            arena.reset (newArena.release());
+            preparedChans   = numChans;
+            preparedSamples = numSamples;
+            audioTemp.setDataToReferTo (tempChans, numChans, numSamples);
+            audioOut.setDataToReferTo (outChans, numChans, numSamples);
+        }
+        else
+        {
+            preparedChans = preparedSamples = 0;
+            audioTemp.setSize (numChans, numSamples);
+            audioOut.setSize (audioTemp.getNumChannels(), audioTemp.getNumSamples());
+        }
+    }
+
+    void layoutBuffers (RenderArena& newArena, const int numChans, const int numSamples)
+    {
+        tempChans = newArena.allocate<float*> (numChans);
+        outChans  = newArena.allocate<float*> (numChans);
+        for (int i = 0; i < numChans; ++i)
+        {
+            auto* const temp = newArena.allocate<float> (numSamples);
+            auto* const out  = newArena.allocate<float> (numSamples);
+            if (tempChans != nullptr)
+            {
+                tempChans[i] = temp;
+                outChans[i]  = out;
+            }
+        }
     }
 
     void releaseBuffers()
@@ -142,6 +180,9 @@ struct RootGraphRender : public AsyncUpdater
         midiTemp.clear();
         audioTemp.setSize (1, 1);
         audioOut.setSize (1, 1);
+        tempChans = outChans = nullptr;
+        preparedChans = preparedSamples = 0;
+        arena = nullptr;
     }
     void dumpGraphs() {
         
@@ -188,10 +229,19 @@ struct RootGraphRender : public AsyncUpdater
 
         if (shouldProcess)
         {
-			audioOut.setSize (buffer.getNumChannels(), buffer.getNumSamples(),
-							  false, false, true);
-			audioTemp.setSize (buffer.getNumChannels(), buffer.getNumSamples(),
-							  false, false, true);
+            if (numChans <= preparedChans && numSamples <= preparedSamples)
+            {
+                audioOut.setDataToReferTo (outChans, numChans, numSamples);
+                audioTemp.setDataToReferTo (tempChans, numChans, numSamples);
+            }
+            else
+            {
+                // bigger than the device said it would be
+                audioOut.setSize (buffer.getNumChannels(), buffer.getNumSamples(),
+                                  false, false, true);
+                audioTemp.setSize (buffer.getNumChannels(), buffer.getNumSamples(),
+                                  false, false, true);
+            }
 
             // clear the mixing area
             for (int i = numChans; --i >= 0;)
@@ -373,6 +423,10 @@ private:
     int numInputChans       = -1;
     int numOutputChans      = -1;
     AudioSampleBuffer   audioOut, audioTemp;
+    std::unique_ptr<RenderArena> arena;
+    float** tempChans = nullptr;
+    float** outChans = nullptr;
+    int preparedChans = 0, preparedSamples = 0;
 
     MidiBuffer midiOut, midiTemp;
 
@@ -406,7 +460,7 @@ class AudioEngine::Private : public AudioIODeviceCallback,
 {
 public:
     Private (AudioEngine& e)
-        : engine (e),sampleRate (0), blockSize (0), isPrepared (false),
+        : engine (e),sampleRate (0), blockSize (0),
           numInputChans (0), numOutputChans (0),
           tempBuffer (1, 1)
     {
@@ -418,6 +472,14 @@ public:
         midiClock.addListener (this);
         graphs.onActiveGraphChanged = std::bind (&AudioEngine::Private::onCurrentGraphChanged, this);
         midiIOMonitor = new MidiIOMonitor();
+       #if EL_RT_CHECKS && JUCE_DEBUG
+        if (SystemStats::getEnvironmentVariable ("EL_RT_CHECKS", "1") != "0")
+            RealtimeSafety::setEnabled (true);
+       #endif
+        captureDirectory = SystemStats::getEnvironmentVariable ("EL_CAPTURE_DIR", String());
+        replicationPort = SystemStats::getEnvironmentVariable ("EL_REPLICATE_PORT", String());
+        replicationAddress = SystemStats::getEnvironmentVariable ("EL_REPLICATE_BIND", "127.0.0.1");
+        followAddress = SystemStats::getEnvironmentVariable ("EL_REPLICATE_LEADER", String());
         startTimerHz (90);
     }
 
@@ -428,9 +490,10 @@ public:
         tempoValue.removeListener (this);
         externalClockValue.removeListener (this);
         
-        if (isPrepared)
+        if (isPrepared.get())
         {
-            jassertfalse;
+            // graphs held in standby are expected here, a running device isn't
+            jassert (! isRunning.get());
             releaseResources();
             isPrepared = false;
         }
@@ -439,6 +502,44 @@ public:
     void timerCallback() override
     {
         midiIOMonitor->notify();
+
+       #if EL_RT_CHECKS && JUCE_DEBUG
+        if (RealtimeSafety::getNumViolations() > 0)
+        {
+            for (const auto& violation : RealtimeSafety::getViolations())
+                DBG("[EL] " << violation.toString());
+            RealtimeSafety::clearViolations();
+        }
+       #endif
+
+        if (captureDirectory.isNotEmpty() && isRunning.get() && File::isAbsolutePath (captureDirectory))
+        {
+            // EL_CAPTURE_DIR records the first run of the device for replay
+            const auto dir = File (captureDirectory).getChildFile (
+                Time::getCurrentTime().formatted ("%Y-%m-%d_%H-%M-%S"));
+            captureDirectory = String();
+            const auto result = engine.startCapture (dir);
+            DBG("[EL] session capture: " << (result.wasOk() ? dir.getFullPathName() : result.getErrorMessage()));
+        }
+
+        if (isRunning.get() && (replicationPort.isNotEmpty() || followAddress.isNotEmpty()))
+        {
+            // EL_REPLICATE_PORT leads and EL_REPLICATE_LEADER follows once the device runs
+            const auto result = replicationPort.isNotEmpty()
+                ? engine.startReplication (replicationPort.getIntValue(), replicationAddress)
+                : engine.followReplication (followAddress.upToLastOccurrenceOf (":", false, false),
+                                            followAddress.fromLastOccurrenceOf (":", false, false).getIntValue());
+            DBG("[EL] replication: " << (result.wasOk() ? String ("started") : result.getErrorMessage()));
+            replicationPort = followAddress = String();
+        }
+
+        if (isPrepared.get() && ! isRunning.get()
+             && Time::getApproximateMillisecondCounter() - stoppedAt.get() >= standbyTimeoutMs)
+        {
+            const ScopedLock sl (lock);
+            if (isPrepared.get() && ! isRunning.get())
+                releaseStandby();
+        }
     }
 
     RootGraph* getCurrentGraph() const { return graphs.getCurrentGraph(); }
@@ -467,6 +568,8 @@ public:
                                 const int numSamples) override
     {
         jassert (sampleRate > 0 && blockSize > 0);
+        // the whole device callback is checked, MIDI output included
+        const RealtimeSafety::ScopedRealtime realtime;
         int totalNumChans = 0;
         ScopedNoDenormals denormals;
         if (numInputChannels > numOutputChannels)
@@ -511,6 +614,15 @@ public:
         const bool wasPlaying = transport.isPlaying();
         AudioSampleBuffer buffer (channels, totalNumChans, numSamples);
         processCurrentGraph (buffer, incomingMidi);
+        ++numBlocksRendered;
+
+        if (standby.get() == 1)
+        {
+            // a hot standby renders everything but is only heard once it takes over
+            for (int i = 0; i < numOutputChannels; ++i)
+                zeromem (outputChannelData[i], sizeof (float) * (size_t) numSamples);
+            incomingMidi.clear();
+        }
 
         {
             ScopedLock lockMidiOut (engine.world.getMidiEngine().getMidiOutputLock());
@@ -551,11 +663,17 @@ public:
     
     void processCurrentGraph (AudioBuffer<float>& buffer, MidiBuffer& midi)
     {
+        // also reached from a plugin host's callback
+        const RealtimeSafety::ScopedRealtime realtime;
         const int numSamples = buffer.getNumSamples();
         messageCollector.removeNextBlockOfMessages (midi, numSamples);
-        
-        const ScopedLock sl (lock);
-        const bool shouldProcess = shouldBeLocked.get() == 0;
+
+        // the message thread only holds this briefly to swap graphs and captures
+        const RealtimeSafety::ScopedAllowedLock sl (lock);
+        if (activeCapture != nullptr)
+            activeCapture->captureBlock (buffer, midi);
+
+        const bool shouldProcess = shouldBeLocked.get() == 0 && preparing.get() == 0;
         const bool wasPlaying = transport.isPlaying();
         transport.preProcess (numSamples);
 
@@ -619,28 +737,65 @@ public:
     void audioAboutToStart (const double newSampleRate, const int newBlockSize,
                             const int numChansIn, const int numChansOut)
     {
-        const ScopedLock sl (lock);
-        
-        sampleRate      = newSampleRate;
-        blockSize       = newBlockSize;
-        numInputChans   = numChansIn;
-        numOutputChans  = numChansOut;
-        
-        midiClock.reset (sampleRate, blockSize);
-        messageCollector.reset (sampleRate);
-        keyboardState.addListener (&messageCollector);
-        channels.calloc ((size_t) jmax (numChansIn, numChansOut) + 2);
-        
-        graphs.prepareBuffers (numInputChans, numOutputChans, blockSize);
+        ReferenceCountedArray<GraphNode> nodesToPrepare;
+        std::unique_ptr<SessionCapture> endedCapture;
 
-        if (isPrepared)
         {
-            isPrepared = false;
-            releaseResources();
+            const ScopedLock sl (lock);
+
+            // a device swap that keeps the same config reuses the graphs as they are
+            const bool canHotSwap = isPrepared.get() && ! isRunning.get()
+                && sampleRate == newSampleRate && blockSize == newBlockSize
+                && numInputChans == numChansIn && numOutputChans == numChansOut;
+
+            if (activeCapture != nullptr && (sampleRate != newSampleRate || numInputChans != numChansIn))
+            {
+                // a capture can't change rate or inputs part way through
+                DBG("[EL] audio device config changed, session capture ended");
+                activeCapture = nullptr;
+                endedCapture.reset (capture.release());
+            }
+            
+            sampleRate      = newSampleRate;
+            blockSize       = newBlockSize;
+            numInputChans   = numChansIn;
+            numOutputChans  = numChansOut;
+            
+            midiClock.reset (sampleRate, blockSize);
+            messageCollector.reset (sampleRate);
+            keyboardState.addListener (&messageCollector);
+            channels.calloc ((size_t) jmax (numChansIn, numChansOut) + 2);
+            
+            graphs.prepareBuffers (numInputChans, numOutputChans, blockSize);
+            isRunning = true;
+
+            if (canHotSwap)
+                return;
+
+            if (isPrepared.get())
+            {
+                isPrepared = false;
+                releaseResources();
+            }
+
+            configureGraphs();
+            nodesToPrepare = getNodesToPrepare();
+            // renders skip the graphs until they are prepared again
+            preparing = 1;
         }
 
+        // flushes what was captured at the old config and closes the files
+        if (endedCapture != nullptr)
+            endedCapture->stop();
+
+        // the expensive part of a re-prepare is usually plugins, they are
+        // prepared concurrently without holding the engine lock
+        prepareNodesInParallel (nodesToPrepare, newSampleRate, newBlockSize);
+
+        const ScopedLock sl (lock);
         prepareToPlay (sampleRate, blockSize);
         isPrepared = true;
+        preparing = 0;
     }
     
     void audioDeviceStopped() override
@@ -652,7 +807,19 @@ public:
     {
         const ScopedLock sl (lock);
         keyboardState.removeListener (&messageCollector);
-        if (isPrepared)
+        isRunning = false;
+
+        // Graphs are kept prepared for a short while so that a device
+        // swap with the same rate and block size can restart without a
+        // rebuild. The timer releases them if nothing restarts.
+        stoppedAt = Time::getApproximateMillisecondCounter();
+        if (! isPrepared.get())
+            releaseStandby();
+    }
+
+    void releaseStandby()
+    {
+        if (isPrepared.get())
             releaseResources();
         isPrepared  = false;
         sampleRate  = 0.0;
@@ -689,7 +856,7 @@ public:
     void addGraph (RootGraph* graph)
     {
         jassert (graph);
-        if (isPrepared)
+        if (isPrepared.get())
             prepareGraph (graph, sampleRate, blockSize);
         ScopedLock sl (lock);
         if (graphs.addGraph (graph))
@@ -707,7 +874,7 @@ public:
         }
         
         graph->renderingSequenceChanged.disconnect_all_slots();
-        if (isPrepared)
+        if (isPrepared.get())
             graph->releaseResources();
     }
     
@@ -739,7 +906,11 @@ public:
         {
             const float tempo = (float) tempoValue.getValue();
             if (sessionWantsExternalClock.get() <= 0 || processMidiClock.get() <= 0)
+            {
                 transport.requestTempo (tempo);
+                if (capture != nullptr)
+                    capture->captureTempo (tempo);
+            }
         }
         else if (externalClockValue.refersToSameSourceAs (value))
         {
@@ -793,7 +964,11 @@ private:
     CriticalSection     lock;
     double sampleRate   = 0.0;
     int blockSize       = 0;
-    bool isPrepared     = false;
+    // read by the timer without the lock
+    Atomic<bool> isPrepared { false };
+    Atomic<bool> isRunning { false };
+    Atomic<uint32> stoppedAt { 0 };
+    static constexpr uint32 standbyTimeoutMs = 2000;
     Atomic<int> currentGraph;
 
     int numInputChans, numOutputChans;
@@ -821,9 +996,20 @@ private:
 
     // GraphRender::locked must match this default value
     Atomic<int> shouldBeLocked { 0 };
+    Atomic<int> preparing { 0 };
 
     MidiIOMonitorPtr midiIOMonitor;
 
+    std::unique_ptr<SessionCapture> capture;
+    SessionCapture* activeCapture = nullptr;
+    String captureDirectory;
+
+    std::unique_ptr<ReplicationLeader> leader;
+    std::unique_ptr<ReplicationFollower> follower;
+    Atomic<int> standby { 0 };
+    Atomic<uint32> numBlocksRendered { 0 };
+    String replicationPort, replicationAddress, followAddress;
+
     void prepareGraph (RootGraph* graph, double sampleRate, int estimatedBlockSize)
     {
         graph->setPlayConfigDetails (numInputChans, numOutputChans,
@@ -832,10 +1018,76 @@ private:
         graph->prepareToPlay (sampleRate, estimatedBlockSize);
     }
     
+    /** Prepares one node's processor on a pool thread. Ports and models are
+        left to the graph which prepares its nodes on the calling thread,
+        subgraphs too because building their rendering sequence takes the
+        message manager lock the caller may be holding */
+    struct PrepareNodeJob : public ThreadPoolJob
+    {
+        PrepareNodeJob (GraphNode* n, double r, int b)
+            : ThreadPoolJob ("prepareNode"), node (n), sampleRate (r), blockSize (b) { }
+
+        JobStatus runJob() override
+        {
+            node->prepareProcessor (sampleRate, blockSize);
+            return jobHasFinished;
+        }
+
+        GraphNodePtr node;
+        const double sampleRate;
+        const int blockSize;
+    };
+
+    std::unique_ptr<ThreadPool> preparePool;
+
+    /** Nodes of every root graph whose processors can be prepared on the pool */
+    ReferenceCountedArray<GraphNode> getNodesToPrepare() const
+    {
+        ReferenceCountedArray<GraphNode> nodes;
+        for (int i = 0; i < graphs.size(); ++i)
+        {
+            auto* graph = graphs.getGraph (i);
+            for (int j = 0; j < graph->getNumNodes(); ++j)
+                if (auto* node = graph->getNode (j))
+                    if (! node->isSubGraph() && node->isEnabled())
+                        nodes.add (node);
+        }
+        return nodes;
+    }
+
+    /** One job per node, so a single large graph is spread over the pool too */
+    void prepareNodesInParallel (const ReferenceCountedArray<GraphNode>& nodes,
+                                 double sampleRate, int estimatedBlockSize)
+    {
+        if (nodes.size() < 2 || SystemStats::getNumCpus() < 2)
+            return;
+
+        if (preparePool == nullptr)
+            preparePool.reset (new ThreadPool (SystemStats::getNumCpus()));
+
+        OwnedArray<PrepareNodeJob> jobs;
+        for (auto* node : nodes)
+            preparePool->addJob (jobs.add (new PrepareNodeJob (node, sampleRate, estimatedBlockSize)), false);
+        for (auto* job : jobs)
+            preparePool->waitForJobToFinish (job, -1);
+    }
+
+    void configureGraphs()
+    {
+        for (int i = 0; i < graphs.size(); ++i)
+        {
+            auto* graph = graphs.getGraph (i);
+            graph->setPlayConfigDetails (numInputChans, numOutputChans, sampleRate, blockSize);
+            graph->setPlayHead (&transport);
+        }
+    }
+
     void prepareToPlay (double sampleRate, int estimatedBlockSize)
     {
         midiClockMaster.setSampleRate (sampleRate);
         midiClockMaster.setTempo (transport.getTempo());
+
+        // nodes already prepared on the pool are skipped here
         for (int i = 0; i < graphs.size(); ++i)
             prepareGraph (graphs.getGraph(i), sampleRate, estimatedBlockSize);
     }
@@ -871,6 +1123,9 @@ void AudioEngine::activate()
 
 void AudioEngine::deactivate()
 {
+    stopCapture();
+    stopReplication();
+    stopFollowing();
    #if ! EL_RUNNING_AS_PLUGIN
     auto& midi (world.getMidiEngine());
     midi.removeMidiInputCallback (String(), &getMidiInputCallback());
@@ -887,6 +1142,15 @@ bool AudioEngine::addGraph (RootGraph* graph)
     return true;
 }
 
+/** Rebuilds a graph and the graphs nested in it on the message thread */
+static void rebuildRenderingSequences (GraphProcessor& graph)
+{
+    graph.triggerAsyncUpdate();
+    for (int i = 0; i < graph.getNumNodes(); ++i)
+        if (auto* const subGraph = graph.getNode(i)->processor<GraphProcessor>())
+            rebuildRenderingSequences (*subGraph);
+}
+
 void AudioEngine::applySettings (Settings& settings)
 {
     const bool useMidiClock = settings.getUserSettings()->getValue("clockSource") == "midiClock";
@@ -895,6 +1159,18 @@ void AudioEngine::applySettings (Settings& settings)
     priv->processMidiClock.set (useMidiClock ? 1 : 0);
     priv->generateMidiClock.set (settings.generateMidiClock() ? 1 : 0);
     priv->sendMidiClockToInput.set (settings.sendMidiClockToInput() ? 1 : 0);
+    GraphNode::setSignalGuardEnabled (settings.useSignalGuard());
+    GraphNode::setSleepingEnabled (settings.sleepIdleNodes());
+
+    const bool localityOrdering = settings.localityOrdering();
+    if (localityOrdering != GraphProcessor::isLocalityOrderingEnabled())
+    {
+        // the order is only worked out when a graph rebuilds
+        GraphProcessor::setLocalityOrderingEnabled (localityOrdering);
+        ScopedLock sl (priv->lock);
+        for (int i = 0; i < priv->graphs.size(); ++i)
+            rebuildRenderingSequences (*priv->graphs.getGraph (i));
+    }
 }
 
 bool AudioEngine::removeGraph (RootGraph* graph)
@@ -958,18 +1234,40 @@ void AudioEngine::setMeter (int beatsPerBar, int beatDivisor)
 {
     auto& transport (priv->transport);
     transport.requestMeter (beatsPerBar, beatDivisor);
+    if (priv->capture != nullptr)
+        priv->capture->captureMeter (beatsPerBar, beatDivisor);
+    if (priv->leader != nullptr)
+        priv->leader->sendMeter (beatsPerBar, beatDivisor);
+}
+
+void AudioEngine::setTempo (const double bpm)
+{
+    auto& transport (priv->transport);
+    transport.requestTempo (bpm);
+    if (priv->capture != nullptr)
+        priv->capture->captureTempo (bpm);
+    if (priv->leader != nullptr)
+        priv->leader->sendTempo (bpm);
 }
 
 void AudioEngine::togglePlayPause()
 {
     auto& transport (priv->transport);
     transport.requestPlayPause();
+    if (priv->capture != nullptr)
+        priv->capture->captureTogglePlayPause();
+    if (priv->leader != nullptr)
+        priv->leader->sendTogglePlayPause();
 }
 
 void AudioEngine::setPlaying (const bool shouldBePlaying)
 {
     auto& transport (priv->transport);
     transport.requestPlayState (shouldBePlaying);
+    if (priv->capture != nullptr)
+        priv->capture->capturePlayState (shouldBePlaying);
+    if (priv->leader != nullptr)
+        priv->leader->sendPlayState (shouldBePlaying);
 }
 
 void AudioEngine::setRecording (const bool shouldBeRecording)
@@ -982,6 +1280,141 @@ void AudioEngine::seekToAudioFrame (const int64 frame)
 {
     auto& transport (priv->transport);
     transport.requestAudioFrame (frame);
+    if (priv->capture != nullptr)
+        priv->capture->captureSeek (frame);
+    if (priv->leader != nullptr)
+        priv->leader->sendSeek (frame);
+}
+
+Result AudioEngine::startCapture (const File& directory)
+{
+    if (priv == nullptr)
+        return Result::fail ("Engine not available");
+    if (priv->capture != nullptr)
+        return Result::fail ("Already capturing");
+
+    ValueTree graphs;
+    if (auto session = world.getSession())
+        graphs = session->getGraphsValueTree();
+
+    std::unique_ptr<SessionCapture> capture (new SessionCapture());
+    double sampleRate = 0.0;
+    int numInputs = 0;
+    {
+        ScopedLock sl (priv->lock);
+        sampleRate = priv->isRunning.get() ? priv->sampleRate : 0.0;
+        numInputs  = priv->numInputChans;
+    }
+
+    const auto result = capture->start (directory, sampleRate, numInputs, graphs);
+    if (result.failed())
+        return result;
+
+    // start from where the live transport is
+    auto& transport (priv->transport);
+    capture->captureTempo (transport.getTempo());
+    capture->captureSeek (transport.getPositionFrames());
+    capture->capturePlayState (transport.isPlaying());
+
+    priv->capture.reset (capture.release());
+    ScopedLock sl (priv->lock);
+    priv->activeCapture = priv->capture.get();
+    return result;
+}
+
+void AudioEngine::stopCapture()
+{
+    if (priv == nullptr || priv->capture == nullptr)
+        return;
+
+    {
+        ScopedLock sl (priv->lock);
+        priv->activeCapture = nullptr;
+    }
+
+    priv->capture->stop();
+    priv->capture.reset();
+}
+
+bool AudioEngine::isCapturing() const
+{
+    return priv != nullptr && priv->capture != nullptr;
+}
+
+Result AudioEngine::startReplication (int port, const String& bindAddress)
+{
+    if (priv == nullptr)
+        return Result::fail ("Engine not available");
+    if (priv->leader != nullptr)
+        return Result::fail ("Already replicating");
+    if (priv->follower != nullptr)
+        return Result::fail ("A follower can't lead");
+
+    auto session = world.getSession();
+    if (session == nullptr)
+        return Result::fail ("There is no session to replicate");
+
+    std::unique_ptr<ReplicationLeader> leader (new ReplicationLeader());
+    leader->attach (*this);
+    const auto result = leader->start (port, session->getValueTree(), bindAddress);
+    if (result.failed())
+        return result;
+
+    leader->setTransportMonitor (getTransportMonitor());
+    priv->leader.reset (leader.release());
+    return result;
+}
+
+void AudioEngine::stopReplication()
+{
+    if (priv != nullptr)
+        priv->leader.reset();
+}
+
+ReplicationLeader* AudioEngine::getReplicationLeader() const
+{
+    return priv != nullptr ? priv->leader.get() : nullptr;
+}
+
+Result AudioEngine::followReplication (const String& host, int port)
+{
+    if (priv == nullptr)
+        return Result::fail ("Engine not available");
+    if (priv->leader != nullptr)
+        return Result::fail ("A leader can't follow");
+
+    stopFollowing();
+    std::unique_ptr<ReplicationFollower> follower (new ReplicationFollower());
+    follower->attach (*this);
+    const auto result = follower->connect (host, port);
+    if (result.wasOk())
+        priv->follower.reset (follower.release());
+    return result;
+}
+
+void AudioEngine::stopFollowing()
+{
+    if (priv == nullptr || priv->follower == nullptr)
+        return;
+
+    priv->follower->disconnect();
+    priv->follower.reset();
+}
+
+void AudioEngine::setStandby (bool standby)
+{
+    if (priv != nullptr)
+        priv->standby.set (standby ? 1 : 0);
+}
+
+bool AudioEngine::isStandby() const
+{
+    return priv != nullptr && priv->standby.get() == 1;
+}
+
+uint32 AudioEngine::getNumBlocksRendered() const
+{
+    return priv != nullptr ? priv->numBlocksRendered.get() : 0;
 }
 
 void AudioEngine::prepareExternalPlayback (const double sampleRate, const int blockSize,
@@ -33,6 +33,7 @@ class Globals;
 class ClipFactory;
 class EngineControl;
 class Settings;
+class ReplicationLeader;
 
 typedef GraphProcessor::AudioGraphIOProcessor IOProcessor;
 
@@ -165,6 +166,7 @@ public:
     void setRecording (const bool shouldBeRecording);
     void seekToAudioFrame (const int64 frame);
     void setMeter (int beatsPerBar, int beatDivisor);
+    void setTempo (const double bpm);
     
     void togglePlayPause();
     
@@ -187,6 +189,64 @@ public:
     Globals& getWorld() const;
     MidiIOMonitorPtr getMidiIOMonitor() const;
 
+    /** Records device input, MIDI, transport requests and edits to the active
+        graph into a directory so the session can be replayed offline. The
+        device must be running.
+
+        Setting EL_CAPTURE_DIR in the environment does this automatically
+        into a time stamped sub directory once the device starts.
+
+        @see SessionCapture, SessionReplay
+     */
+    Result startCapture (const File& directory);
+
+    /** Stops capturing and flushes it to disk */
+    void stopCapture();
+
+    /** Returns true if a capture is being written */
+    bool isCapturing() const;
+
+    /** Streams the session, plugin state and transport to hot standby
+        instances that follow with followReplication().
+
+        Followers connect without authentication, so only the local machine
+        is listened on unless bindAddress names another interface. Setting
+        EL_REPLICATE_PORT in the environment does this automatically once the
+        device starts, EL_REPLICATE_BIND sets the interface.
+
+        @see ReplicationLeader
+     */
+    Result startReplication (int port, const String& bindAddress = "127.0.0.1");
+
+    /** Disconnects followers and stops listening */
+    void stopReplication();
+
+    /** Returns the leader while replicating, nullptr otherwise */
+    ReplicationLeader* getReplicationLeader() const;
+
+    /** Follows another instance as its hot standby. The leader's graphs are
+        loaded here and kept running with the output held silent until the
+        leader goes away.
+
+        Setting EL_REPLICATE_LEADER to host:port in the environment does this
+        automatically once the device starts.
+
+        @see ReplicationFollower
+     */
+    Result followReplication (const String& host, int port);
+
+    /** Stops following and unloads the standby graphs */
+    void stopFollowing();
+
+    /** Keeps graphs running but holds the device output silent */
+    void setStandby (bool standby);
+
+    /** Returns true if the device output is being held silent */
+    bool isStandby() const;
+
+    /** Returns the number of device callbacks rendered, it wraps */
+    uint32 getNumBlocksRendered() const;
+
 private:
     class Private;
     ScopedPointer<Private> priv;
@@ -0,0 +1,182 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/Automation.h"
+
+namespace Element {
+
+int NodeAutomation::Lane::seek (double beat) const noexcept
+{
+    int index = cursor;
+    const bool movedBack = index >= 0 && beats[index] > beat;
+    const bool jumpedAhead = index + 2 < numPoints && beats[index + 2] <= beat;
+
+    if (movedBack || jumpedAhead)
+    {
+        index = (int) (std::upper_bound (beats, beats + numPoints, beat) - beats) - 1;
+    }
+    else if (index + 1 < numPoints && beats[index + 1] <= beat)
+    {
+        ++index;
+    }
+
+    cursor = index;
+    return index;
+}
+
+float NodeAutomation::Lane::getValue (double beat) const noexcept
+{
+    const int index = seek (beat);
+    if (index < 0)
+        return values[0];
+    if (index + 1 >= numPoints)
+        return values[numPoints - 1];
+
+    // seek guarantees beats[index] <= beat < beats[index + 1]
+    const double alpha = (beat - beats[index]) / (beats[index + 1] - beats[index]);
+    return values[index] + (float) alpha * (values[index + 1] - values[index]);
+}
+
+bool NodeAutomation::Lane::isFlat (double start, double end) const noexcept
+{
+    const int index = seek (start);
+    if (index + 1 >= numPoints)
+        return true;
+    if (beats[index + 1] < end)
+        return false;
+    return index < 0 || values[index] == values[index + 1];
+}
+
+NodeAutomation::Ptr NodeAutomation::compile (const ValueTree& automation)
+{
+    struct Point { double beat; float value; };
+    struct PointSorter
+    {
+        static int compareElements (const Point& a, const Point& b) noexcept
+        {
+            return a.beat < b.beat ? -1 : (b.beat < a.beat ? 1 : 0);
+        }
+    } sorter;
+
+    OwnedArray<Array<Point>> points;
+    Array<int> parameters;
+    int totalPoints = 0;
+
+    for (int i = 0; i < automation.getNumChildren(); ++i)
+    {
+        const auto lane (automation.getChild (i));
+        const int parameter = lane.getProperty (Tags::parameter, -1);
+        if (! lane.hasType (Tags::lane) || parameter < 0 || parameters.contains (parameter))
+            continue;
+
+        auto* lanePoints = new Array<Point>();
+        for (int j = 0; j < lane.getNumChildren(); ++j)
+        {
+            const auto point (lane.getChild (j));
+            if (! point.hasType (Tags::point))
+                continue;
+            lanePoints->add ({ (double) point.getProperty (Tags::beat, 0.0),
+                               jlimit (0.f, 1.f, (float) point.getProperty (Tags::value, 0.f)) });
+        }
+
+        if (lanePoints->isEmpty())
+        {
+            delete lanePoints;
+            continue;
+        }
+
+        // stable, so points drawn on the same beat keep their order
+        lanePoints->sort (sorter, true);
+        points.add (lanePoints);
+        parameters.add (parameter);
+        totalPoints += lanePoints->size();
+    }
+
+    if (points.isEmpty())
+        return nullptr;
+
+    Ptr compiled (new NodeAutomation());
+    compiled->beats.malloc ((size_t) totalPoints);
+    compiled->values.malloc ((size_t) totalPoints);
+
+    int offset = 0;
+    for (int i = 0; i < points.size(); ++i)
+    {
+        Lane lane;
+        lane.parameter = parameters.getUnchecked (i);
+        lane.beats     = compiled->beats + offset;
+        lane.values    = compiled->values + offset;
+        lane.numPoints = points.getUnchecked(i)->size();
+
+        for (const auto& point : *points.getUnchecked (i))
+        {
+            compiled->beats[offset]  = point.beat;
+            compiled->values[offset] = point.value;
+            ++offset;
+        }
+
+        compiled->lanes.add (lane);
+    }
+
+    return compiled;
+}
+
+bool NodeAutomation::movesWithin (double start, double end) const noexcept
+{
+    for (const auto& lane : lanes)
+        if (! lane.isFlat (start, end))
+            return true;
+    return false;
+}
+
+void NodeAutomation::apply (AudioProcessor& processor, double beat) noexcept
+{
+    const auto& params = processor.getParameters();
+    for (auto& lane : lanes)
+    {
+        const float value = lane.getValue (beat);
+        if (value == lane.lastValue)
+            continue;
+
+        lane.lastValue = value;
+        if (auto* const param = params[lane.parameter])
+        {
+            if (param->getValue() != value)
+            {
+                param->setValue (value);
+                lane.changed = true;
+            }
+        }
+    }
+}
+
+void NodeAutomation::notify (AudioProcessor& processor)
+{
+    const auto& params = processor.getParameters();
+    for (auto& lane : lanes)
+    {
+        if (! lane.changed)
+            continue;
+        lane.changed = false;
+        if (auto* const param = params[lane.parameter])
+            param->sendValueChangedMessageToListeners (lane.lastValue);
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "ElementApp.h"
+
+namespace Element {
+
+/** Parameter automation of a node, compiled for the audio thread.
+
+    The model keeps lanes as breakpoint envelopes in the node's automation
+    tree, one lane per parameter. compile() flattens them into sorted arrays
+    of beats and normalized values which the render op reads while the
+    transport plays. Lanes are linearly interpolated between points and hold
+    their first and last value outside of them.
+ */
+class NodeAutomation : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<NodeAutomation>;
+
+    /** Most samples rendered between parameter writes while a lane moves */
+    enum { subBlockSize = 32 };
+
+    struct Lane
+    {
+        int parameter = -1;
+        const double* beats = nullptr;
+        const float* values = nullptr;
+        int numPoints = 0;
+
+        /** Returns the lane's value at a beat */
+        float getValue (double beat) const noexcept;
+
+        /** Returns true if the value doesn't change from start to end */
+        bool isFlat (double start, double end) const noexcept;
+
+    private:
+        friend class NodeAutomation;
+        mutable int cursor = -1;
+        mutable float lastValue = -1.f;
+        mutable bool changed = false;
+
+        /** Index of the last point at or before beat, -1 if there is none.
+            Playback moves forward in small steps, so the last position is
+            tried before searching. */
+        int seek (double beat) const noexcept;
+    };
+
+    /** Compiles the lanes in an automation tree. Returns nullptr if there are
+        no lanes with points. Call on the message thread. */
+    static Ptr compile (const ValueTree& automation);
+
+    int getNumLanes() const noexcept { return lanes.size(); }
+    const Lane& getLane (int index) const noexcept { return lanes.getReference (index); }
+
+    /** Returns true if any lane changes from start to end */
+    bool movesWithin (double start, double end) const noexcept;
+
+    /** Writes every lane's value at a beat to the processor. Parameters are
+        only written when their lane has moved since the last write, listeners
+        are told once per block in notify() */
+    void apply (AudioProcessor& processor, double beat) noexcept;
+
+    /** Tells listeners of each parameter written since the last call */
+    void notify (AudioProcessor& processor);
+
+private:
+    NodeAutomation() = default;
+    Array<Lane> lanes;
+    HeapBlock<double> beats;
+    HeapBlock<float> values;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NodeAutomation)
+};
+
+}
@@ -0,0 +1,180 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "engine/Downsampler.h"
+
+namespace Element {
+
+void Downsampler::prepare (int newNumChannels, int newFactor, int newMaxBlockSize)
+{
+    numChannels  = jmax (1, newNumChannels);
+    factor       = jmax (1, newFactor);
+    maxBlockSize = jmax (1, newMaxBlockSize);
+
+    // 16 taps per phase keeps the stop band near -60 dB at a modest cost
+    tapsPerPhase = 16;
+    numTaps      = tapsPerPhase * factor;
+    taps.allocate ((size_t) numTaps, true);
+
+    // Blackman windowed sinc, cut off a little below the inner Nyquist
+    const double cutoff = 0.45 / (double) factor;
+    const double centre = 0.5 * (double) (numTaps - 1);
+    double sum = 0.0;
+    for (int i = 0; i < numTaps; ++i)
+    {
+        const double x = (double) i - centre;
+        const double sinc = x == 0.0 ? 2.0 * cutoff
+                                     : std::sin (MathConstants<double>::twoPi * cutoff * x) / (MathConstants<double>::pi * x);
+        const double w = 0.42 - 0.5 * std::cos (MathConstants<double>::twoPi * i / (numTaps - 1))
+                              + 0.08 * std::cos (2.0 * MathConstants<double>::twoPi * i / (numTaps - 1));
+        taps[i] = (float) (sinc * w);
+        sum += sinc * w;
+    }
+    for (int i = 0; i < numTaps; ++i)
+        taps[i] = (float) (taps[i] / sum);
+
+    input.setSize (numChannels, numTaps - 1 + maxBlockSize);
+    inner.setSize (numChannels, tapsPerPhase - 1 + getMaxInnerSamples());
+    innerChannels.allocate ((size_t) numChannels, true);
+    for (int ch = 0; ch < numChannels; ++ch)
+        innerChannels[ch] = inner.getWritePointer (ch, tapsPerPhase - 1);
+    branch.allocate ((size_t) (tapsPerPhase - 1 + getMaxInnerSamples()), true);
+    branchOut.allocate ((size_t) getMaxInnerSamples(), true);
+    fifo.setSize (numChannels, maxBlockSize + 2 * factor);
+    reset();
+}
+
+void Downsampler::reset()
+{
+    input.clear();
+    inner.clear();
+    fifo.clear();
+    phase = 0;
+    fifoRead = 0;
+    fifoReady = factor - 1;
+}
+
+/*  Both filters are split into factor branches of tapsPerPhase taps,
+    branch r holding taps r, r + factor, r + 2 * factor...
+
+    Decimating, inner sample m is the sum over branches of branch r
+    convolved with every factor'th input ending r samples before the input
+    that completes m. Interpolating, output p of inner sample m is branch p
+    convolved with the inner samples ending at m. Either way each tap of a
+    branch scales one contiguous run, so it is one addWithMultiply. */
+
+int Downsampler::decimate (const AudioSampleBuffer& outer, int numSamples) noexcept
+{
+    jassert (numSamples <= maxBlockSize);
+    numSamples = jmin (numSamples, maxBlockSize);
+    const int numChans = jmin (numChannels, outer.getNumChannels());
+    const int numHistory = numTaps - 1;
+
+    // the first input of the block to complete an inner sample
+    const int first = factor - 1 - phase;
+    const int numInner = numSamples > first ? (numSamples - first - 1) / factor + 1 : 0;
+    phase = (phase + numSamples) % factor;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* const in = input.getWritePointer (ch);
+        if (ch < numChans)
+            FloatVectorOperations::copy (in + numHistory, outer.getReadPointer (ch), numSamples);
+        else
+            FloatVectorOperations::clear (in + numHistory, numSamples);
+
+        float* const out = innerChannels[ch];
+        FloatVectorOperations::clear (out, numInner);
+
+        if (numInner > 0)
+        {
+            const int length = tapsPerPhase - 1 + numInner;
+            for (int r = 0; r < factor; ++r)
+            {
+                // every factor'th input, back far enough for the oldest tap
+                const float* src = in + first - r - (tapsPerPhase - 1) * factor + numHistory;
+                for (int t = 0; t < length; ++t, src += factor)
+                    branch[t] = *src;
+
+                for (int q = 0; q < tapsPerPhase; ++q)
+                    FloatVectorOperations::addWithMultiply (out, branch + (tapsPerPhase - 1 - q),
+                                                            taps[q * factor + r], numInner);
+            }
+        }
+
+        // keep the newest inputs for the next block
+        std::memmove (in, in + numSamples, sizeof (float) * (size_t) numHistory);
+    }
+
+    return numInner;
+}
+
+void Downsampler::interpolate (AudioSampleBuffer& outer, int numSamples, int numInner) noexcept
+{
+    const int numChans = jmin (numChannels, outer.getNumChannels());
+    const int capacity = fifo.getNumSamples();
+    const int numHistory = tapsPerPhase - 1;
+    jassert (fifoReady + numInner * factor <= capacity);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* const recent = inner.getWritePointer (ch);
+        float* const dest = fifo.getWritePointer (ch);
+
+        for (int p = 0; p < factor && numInner > 0; ++p)
+        {
+            FloatVectorOperations::clear (branchOut, numInner);
+            for (int j = 0; j < tapsPerPhase; ++j)
+                FloatVectorOperations::addWithMultiply (branchOut, recent + numHistory - j,
+                                                        taps[p + j * factor] * (float) factor, numInner);
+
+            int write = (fifoRead + fifoReady + p) % capacity;
+            for (int m = 0; m < numInner; ++m)
+            {
+                dest[write] = branchOut[m];
+                write += factor;
+                if (write >= capacity)
+                    write -= capacity;
+            }
+        }
+
+        // keep the newest inner samples for the next block
+        std::memmove (recent, recent + numInner, sizeof (float) * (size_t) numHistory);
+    }
+
+    fifoReady += numInner * factor;
+
+    jassert (fifoReady >= numSamples);
+    const int available = jmin (numSamples, fifoReady);
+    for (int ch = 0; ch < numChans; ++ch)
+    {
+        const int first = jmin (available, capacity - fifoRead);
+        outer.copyFrom (ch, 0, fifo, ch, fifoRead, first);
+        if (available > first)
+            outer.copyFrom (ch, first, fifo, ch, 0, available - first);
+        if (available < numSamples)
+            outer.clear (ch, available, numSamples - available);
+    }
+
+    fifoRead = (fifoRead + available) % capacity;
+    fifoReady -= available;
+}
+
+}
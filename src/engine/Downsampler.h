@@ -0,0 +1,96 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#pragma once
+
+#include "ElementApp.h"
+
+namespace Element {
+
+/** Runs a node at its parent's rate divided by a whole factor.
+
+    Input is low-passed and decimated as it streams in, so blocks of any
+    length work, the filter phase carries over from one block to the next.
+    The node renders however many inner samples the block completed, which
+    is one more or less than blockSize / factor when the block isn't a
+    multiple of the factor. Its output is interpolated back into a short
+    FIFO, primed with factor - 1 samples so there is always a full block to
+    hand back.
+
+    Both stages use the same linear phase windowed sinc, so the latency is
+    fixed and reported at the parent's rate. The filters run a block at a
+    time, split into one short convolution per polyphase branch so the
+    multiply-adds are vector operations over contiguous samples.
+ */
+class Downsampler
+{
+public:
+    Downsampler() = default;
+
+    /** Allocates everything. Call before rendering, not on the audio thread. */
+    void prepare (int numChannels, int factor, int maxBlockSize);
+
+    /** Clears the filter history and primes the FIFO again */
+    void reset();
+
+    /** Returns the number of channels prepared */
+    int getNumChannels() const noexcept         { return numChannels; }
+
+    /** Returns the most inner samples one block can produce */
+    int getMaxInnerSamples() const noexcept     { return maxBlockSize / factor + 1; }
+
+    /** Returns the delay added at the parent's rate. Each filter delays by
+        half its length, the primed FIFO makes up for the decimator's phase. */
+    int getLatencySamples() const noexcept      { return numTaps - 1; }
+
+    /** Filters and decimates a block. Returns the number of inner samples now
+        in getInnerChannels() for the node to render in place. */
+    int decimate (const AudioSampleBuffer& outer, int numSamples) noexcept;
+
+    /** Channels the node renders at the inner rate */
+    float** getInnerChannels() noexcept         { return innerChannels.get(); }
+
+    /** Interpolates the rendered inner samples and writes a full block back */
+    void interpolate (AudioSampleBuffer& outer, int numSamples, int numInner) noexcept;
+
+private:
+    int numChannels = 0, factor = 1, maxBlockSize = 0;
+    int numTaps = 1, tapsPerPhase = 1;
+    HeapBlock<float> taps;
+
+    // numTaps - 1 samples of input history followed by the block
+    AudioSampleBuffer input;
+    int phase = 0;
+
+    // tapsPerPhase - 1 inner samples of history followed by the ones the
+    // node renders in place
+    AudioSampleBuffer inner;
+    HeapBlock<float*> innerChannels;
+
+    // one polyphase branch gathered to be contiguous, and its output
+    HeapBlock<float> branch, branchOut;
+
+    AudioSampleBuffer fifo;
+    int fifoRead = 0, fifoReady = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (Downsampler)
+};
+
+}
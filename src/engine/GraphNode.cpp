@@ -34,12 +34,16 @@
 
 namespace Element {
 
+static Atomic<int> sSignalGuardEnabled { 1 };
+static Atomic<int> sSleepingEnabled { 1 };
+
 GraphNode::GraphNode (const uint32 nodeId_) noexcept
     : nodeId (nodeId_),
       metadata (Tags::node),
       isPrepared (false),
       enablement (*this),
-      midiProgramLoader (*this)
+      midiProgramLoader (*this),
+      faultReporter (*this)
 {
     parent = nullptr;
     gain.set(1.0f); lastGain.set (1.0f);
@@ -51,6 +55,7 @@ GraphNode::GraphNode (const uint32 nodeId_) noexcept
 GraphNode::~GraphNode()
 {
     enablement.cancelPendingUpdate();
+    faultReporter.cancelPendingUpdate();
     parent = nullptr;
 }
 
@@ -287,10 +292,9 @@ void GraphNode::prepare (const double sampleRate, const int blockSize,
         isPrepared = true;
         setParentGraph (parentGraph); //<< ensures io nodes get setup
 
-        initOversampling (jmax (getNumPorts (PortType::Audio, true), getNumPorts (PortType::Audio, false)), blockSize);
-
-        const int osFactor = getOversamplingFactor();
-        prepareToRender (sampleRate * osFactor, blockSize * osFactor);
+        // the processor may have been prepared ahead on another thread
+        if (! processorPrepared.compareAndSetBool (0, 1))
+            prepareRender (sampleRate, blockSize);
 
         // TODO: move model code out of engine code
         // VERIFY: this portion is actually needed. This was here to ensure
@@ -320,14 +324,42 @@ void GraphNode::prepare (const double sampleRate, const int blockSize,
     }
 }
 
+void GraphNode::prepareProcessor (const double sampleRate, const int blockSize)
+{
+    if (isPrepared || isAudioIONode() || isMidiIONode() || processorPrepared.get() == 1)
+        return;
+
+    prepareRender (sampleRate, blockSize);
+    processorPrepared.set (1);
+}
+
+void GraphNode::prepareRender (const double sampleRate, const int blockSize)
+{
+    const int numAudioChannels = jmax (getNumPorts (PortType::Audio, true), getNumPorts (PortType::Audio, false));
+    const int dsFactor = getDownsamplingFactor();
+    if (dsFactor > 1)
+    {
+        initDownsampling (numAudioChannels, blockSize);
+        prepareToRender (sampleRate / dsFactor, downsampler->getMaxInnerSamples());
+    }
+    else
+    {
+        const int osFactor = getOversamplingFactor();
+        prepareToRender (sampleRate * osFactor, blockSize * osFactor);
+    }
+}
+
 void GraphNode::unprepare()
 {
+    if (processorPrepared.compareAndSetBool (0, 1) && ! isPrepared)
+        releaseResources();
+
     if (isPrepared)
     {
         isPrepared = false;
         inRMS.clear (true);
         outRMS.clear (true);
-        resetOversampling();
+        downsampler.reset();
         releaseResources();
     }
 }
@@ -661,47 +693,147 @@ void GraphNode::setMuted (bool muted)
         muteChanged (this);
 }
 
-void GraphNode::initOversampling (int numChannels, int blockSize)
+//=============================================================================
+
+void GraphNode::setSignalGuardEnabled (bool enabled)
+{
+    sSignalGuardEnabled.set (enabled ? 1 : 0);
+}
+
+bool GraphNode::isSignalGuardEnabled()
+{
+    return sSignalGuardEnabled.get() == 1;
+}
+
+void GraphNode::setSleepingEnabled (bool enabled)
 {
-    osProcessors.clear();
-    numChannels = jmax (1, numChannels); // avoid assertion on nodes that don't have audio
-    for (int pow = 1; pow <= maxOsPow; ++pow)
-        osProcessors.add (new dsp::Oversampling<float> (numChannels, pow, dsp::Oversampling<float>::FilterType::filterHalfBandPolyphaseIIR));
+    sSleepingEnabled.set (enabled ? 1 : 0);
+}
 
-    prepareOversampling (blockSize);
+bool GraphNode::isSleepingEnabled()
+{
+    return sSleepingEnabled.get() == 1;
 }
 
-void GraphNode::prepareOversampling (int blockSize)
+void GraphNode::signalFault (FaultType type) noexcept
 {
-    for (auto* osProcessor : osProcessors)
-        osProcessor->initProcessing (blockSize);
+    if (type == NonFiniteFault)
+    {
+        if (faulted.get() == 1)
+            return;
+        faulted.set (1);
+    }
+    else if (type == DenormalFault)
+    {
+        // only report a denormal storm once until the node is reset
+        if (! denormalsReported.compareAndSetBool (1, 0))
+            return;
+    }
+    else
+    {
+        return;
+    }
+
+    pendingFault.set (static_cast<int> (type));
+    faultReporter.triggerAsyncUpdate();
 }
 
-void GraphNode::resetOversampling()
+void GraphNode::clearFault()
 {
-    for (auto* osProcessor : osProcessors)
-        osProcessor->reset();
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+    const bool wasFaulted = isFaulted();
+    denormalsReported.set (0);
+    if (! wasFaulted)
+        return;
+
+    // the render op skips faulted nodes, so it is safe to reset here
+    if (auto* const proc = getAudioProcessor())
+        proc->reset();
+
+    faulted.set (0);
+    Logger::writeToLog (String ("[EL] fault cleared: ") + getName());
+    faultChanged (this);
 }
 
-dsp::Oversampling<float>* GraphNode::getOversamplingProcessor()
+void GraphNode::FaultReporter::handleAsyncUpdate()
 {
-    return osProcessors[osPow-1];
+    const int type = node.pendingFault.exchange (0);
+    String nodeName = node.getName();
+    if (auto* const proc = node.getAudioProcessor())
+        if (nodeName.isEmpty())
+            nodeName = proc->getName();
+
+    if (type == NonFiniteFault)
+        Logger::writeToLog (String ("[EL] node produced NaN or Inf and was silenced: ") + nodeName);
+    else if (type == DenormalFault)
+        Logger::writeToLog (String ("[EL] node is producing denormals: ") + nodeName);
+
+    node.faultChanged (&node);
 }
 
 void GraphNode::setOversamplingFactor (int osFactor)
 {
-    osPow = (int) log2f ((float) osFactor);
-    if (auto* osProc = getOversamplingProcessor())
-        osLatency = osProc->getLatencyInSamples();
+    osPow = jlimit (0, maxOsPow, (int) log2f ((float) jmax (1, osFactor)));
+    if (osPow > 0)
+        dsPow = 0;
+    if (dsPow == 0)
+        osLatency = 0.f;
 }
 
-int GraphNode::getOversamplingFactor()
+void GraphNode::setDownsamplingFactor (int dsFactor)
 {
-    if (osPow > 0)
-        if (auto* osProc = getOversamplingProcessor())
-            return osProc->getOversamplingFactor();
+    // only subgraphs have a boundary to resample at
+    const int newPow = isSubGraph() ? jlimit (0, maxDsPow, (int) log2f ((float) jmax (1, dsFactor))) : 0;
+    if (newPow == dsPow)
+        return;
+
+    dsPow = newPow;
+    if (dsPow > 0)
+        osPow = 0;
+    if (osPow == 0)
+        osLatency = 0.f;
+}
 
-    return 1;
+int GraphNode::getDownsamplingFactor() const
+{
+    return 1 << dsPow;
+}
+
+void GraphNode::setAutomation (NodeAutomation::Ptr newAutomation)
+{
+    NodeAutomation::Ptr oldAutomation;
+    {
+        ScopedLock sl (automationLock);
+        oldAutomation = automation;
+        automation = newAutomation;
+    }
+
+    // the render op may still hold lanes it took before the swap. Only this
+    // array references retired lanes once it has let go, and it can't take
+    // them again, so those are safe to release here
+    for (int i = retiredAutomation.size(); --i >= 0;)
+        if (retiredAutomation.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+            retiredAutomation.remove (i);
+    if (oldAutomation != nullptr)
+        retiredAutomation.add (oldAutomation);
+}
+
+bool GraphNode::hasAutomation() const
+{
+    ScopedLock sl (automationLock);
+    return automation != nullptr;
+}
+
+void GraphNode::initDownsampling (int numChannels, int blockSize)
+{
+    downsampler.reset (new Downsampler());
+    downsampler->prepare (jmax (1, numChannels), getDownsamplingFactor(), blockSize);
+    osLatency = (float) downsampler->getLatencySamples();
+}
+
+int GraphNode::getOversamplingFactor() const
+{
+    return 1 << osPow;
 }
 
 }
@@ -20,6 +20,8 @@
 #pragma once
 
 #include "ElementApp.h"
+#include "engine/Automation.h"
+#include "engine/Downsampler.h"
 
 namespace Element {
 
@@ -72,6 +74,10 @@ public:
     virtual void releaseResources() = 0;
 
     virtual bool wantsMidiPipe() const { return false; }
+
+    /** Renders a node that wants a MIDI pipe. The last channels of the
+        buffer are the control outputs, in port order, after the audio.
+        Control signals are normalized from 0 to 1 at the audio rate. */
     virtual void render (AudioSampleBuffer&, MidiPipe&) { }
     virtual void renderBypassed (AudioSampleBuffer&, MidiPipe&);
     
@@ -148,8 +154,9 @@ public:
     /** Suspend processing */
     void suspendProcessing (const bool);
 
-    /** Get latency audio samples */
-    int getLatencySamples() const { return latencySamples + roundFloatToInt (osLatency); }
+    /** Get latency audio samples at the parent graph's rate. Oversampling
+        filter latency is not included, the graph reports it once per scope. */
+    int getLatencySamples() const { return roundToInt ((double) latencySamples * (double) getDownsamplingFactor() / (double) getOversamplingFactor()) + roundFloatToInt (osLatency); }
 
     /** Set latency samples */
     void setLatencySamples (int latency) { if (latencySamples != latency) latencySamples = latency; }
@@ -316,6 +323,45 @@ public:
     void setMuteInput (bool shouldMuteInput) { muteInput.set (shouldMuteInput ? 1 : 0); }
     bool isMutingInputs() const { return muteInput.get() == 1; }
 
+    /** Control inputs are applied once per block unless this is set, then a
+        signal moving inside the block renders the node in short sub-blocks */
+    void setSubBlockControls (bool subBlocks) { subBlockControls.set (subBlocks ? 1 : 0); }
+    bool wantsSubBlockControls() const { return subBlockControls.get() == 1; }
+
+    //=========================================================================
+    /** Reasons a node's output was flagged by the signal guard */
+    enum FaultType
+    {
+        NoFault         = 0,
+        NonFiniteFault,     /**< Output contained NaN or Inf, node was silenced */
+        DenormalFault       /**< Output was mostly denormals, samples were flushed */
+    };
+
+    /** Enable or disable scanning every node's output for NaN, Inf and
+        denormals. This is a global setting shared by all graphs. */
+    static void setSignalGuardEnabled (bool enabled);
+
+    /** Returns true if node outputs are being checked */
+    static bool isSignalGuardEnabled();
+
+    /** Enable or disable letting effects skip rendering while their inputs
+        are silent and their tails have faded. This is a global setting
+        shared by all graphs. */
+    static void setSleepingEnabled (bool enabled);
+
+    /** Returns true if idle effects may sleep */
+    static bool isSleepingEnabled();
+
+    /** Returns true if this node skipped rendering its last block */
+    bool isSleeping() const { return sleeping.get() == 1; }
+
+    /** Returns true if this node was silenced because it produced NaN or Inf */
+    bool isFaulted() const { return faulted.get() == 1; }
+
+    /** Resets the processor and lets this node render again after a fault.
+        Call this on the message thread. */
+    void clearFault();
+
     //=========================================================================
     virtual void getState (MemoryBlock&) = 0;
     virtual void setState (const void*, int sizeInBytes) = 0;
@@ -330,9 +376,43 @@ public:
     Signal<void(GraphNode*)> muteChanged;
     Signal<void()> willBeRemoved;
 
+    /** Triggered on the message thread when the signal guard flags this node
+        or when a fault is cleared */
+    Signal<void(GraphNode*)> faultChanged;
+
 
+    /** Renders the node at its parent's rate times osFactor (1, 2, 4 or 8).
+
+        Nodes with the same factor that feed straight into each other share
+        one oversampling scope in the parent graph. Audio is upsampled once
+        where the chain starts and downsampled once where it ends, and the
+        filter latency is reported to delay compensation once. Takes effect
+        the next time the graph is prepared. */
     void setOversamplingFactor (int osFactor);
-    int getOversamplingFactor();
+    int getOversamplingFactor() const;
+
+    /** Runs a subgraph at its parent's rate divided by dsFactor (1, 2 or 4).
+        Audio is decimated and interpolated with FIR filters at the boundary,
+        blocks that aren't a multiple of the factor are carried over in a
+        short FIFO. The filter latency is reported to delay compensation.
+        Changing this resets oversampling, and vice versa. Takes effect the
+        next time the node is prepared. */
+    void setDownsamplingFactor (int dsFactor);
+    int getDownsamplingFactor() const;
+
+    /** Prepares only the processor to render, the expensive part of preparing
+        a plugin. Nothing in the model is touched so this may run on another
+        thread ahead of the graph preparing the node, which then skips it.
+        Does nothing for IO nodes and nodes that are already prepared. */
+    void prepareProcessor (double sampleRate, int blockSize);
+
+    /** Replaces the automation lanes rendered with this node, nullptr removes
+        them. Call on the message thread. Old lanes are kept until the render
+        op lets go of them and released by a later call or with the node. */
+    void setAutomation (NodeAutomation::Ptr newAutomation);
+
+    /** Returns true if this node has automation lanes */
+    bool hasAutomation() const;
 
 protected:
     GraphNode (uint32 nodeId) noexcept;
@@ -354,13 +434,16 @@ private:
     friend class GraphManager;
     friend class EngineController;
     friend class Node;
+    friend class CompiledScene;
     
     GraphProcessor* parent = nullptr;
     bool isPrepared = false;
+    Atomic<int> processorPrepared { 0 };
     Atomic<int> enabled { 1 };
     Atomic<int> bypassed { 0 };
     Atomic<int> mute { 0 };
     Atomic<int> muteInput { 0 };
+    Atomic<int> subBlockControls { 0 };
 
     int latencySamples = 0;
     String name;
@@ -395,6 +478,22 @@ private:
         GraphNode& node;    
     } midiProgramLoader;
 
+    Atomic<int> faulted { 0 };
+    Atomic<int> sleeping { 0 };
+    Atomic<int> pendingFault { 0 };
+    Atomic<int> denormalsReported { 0 };
+
+    struct FaultReporter : public AsyncUpdater
+    {
+        FaultReporter (GraphNode& n) : node (n) { }
+        ~FaultReporter() { cancelPendingUpdate(); }
+        void handleAsyncUpdate() override;
+        GraphNode& node;
+    } faultReporter;
+
+    /** Called by the render op on the audio thread */
+    void signalFault (FaultType type) noexcept;
+
     struct MidiProgram
     {
         int program;
@@ -406,18 +505,23 @@ private:
 
     void setParentGraph (GraphProcessor*);
     void prepare (double sampleRate, int blockSize, GraphProcessor*, bool willBeEnabled = false);
+    void prepareRender (double sampleRate, int blockSize);
     void unprepare();
     void resetPorts();
-    void initOversampling (int numChannels, int blockSize);
-    void prepareOversampling (int blockSize);
-    void resetOversampling();
-    dsp::Oversampling<float>* getOversamplingProcessor();
 
     int osPow = 0;
     float osLatency = 0.0f;
-    OwnedArray<dsp::Oversampling<float>> osProcessors;
     const int maxOsPow = 3;
 
+    int dsPow = 0;
+    std::unique_ptr<Downsampler> downsampler;
+    const int maxDsPow = 2;
+    void initDownsampling (int numChannels, int blockSize);
+
+    CriticalSection automationLock;
+    NodeAutomation::Ptr automation;
+    ReferenceCountedArray<NodeAutomation> retiredAutomation;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphNode)
 };
 
@@ -22,12 +22,15 @@
 #include "engine/GraphProcessor.h"
 #include "engine/MidiPipe.h"
 #include "engine/MidiTranspose.h"
+#include "engine/RenderArena.h"
+#include "engine/SignalGuard.h"
 #include "engine/nodes/SubGraphProcessor.h"
 #include "session/Node.h"
 
 namespace Element {
 
 const int GraphProcessor::midiChannelIndex = 0x1000;
+static Atomic<int> sLocalityOrdering { 1 };
 
 namespace GraphRender
 {
@@ -38,9 +41,16 @@ public:
     Task() { }
     virtual ~Task()  { }
 
+    /** Runs the task. silentChannels holds a flag per shared audio buffer
+        which is true while the buffer is known to be all zeros, tasks
+        writing audio keep the flags of their buffers up to date. */
     virtual void perform (AudioSampleBuffer& sharedBufferChans,
                           const OwnedArray <MidiBuffer>& sharedMidiBuffers,
-                          const int numSamples) = 0;
+                          const int numSamples, bool* silentChannels) = 0;
+
+    /** Takes the memory the task renders with from the graph's arena. Called
+        once to measure and again after the arena is committed. */
+    virtual void allocate (RenderArena&) { }
 
     JUCE_LEAK_DETECTOR (Task);
 };
@@ -52,9 +62,11 @@ public:
         : channelNum (channelNum_)
     { }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples, bool* silentChannels)
     {
-        sharedBufferChans.clear (channelNum, 0, numSamples);
+        if (! silentChannels[channelNum])
+            sharedBufferChans.clear (channelNum, 0, numSamples);
+        silentChannels[channelNum] = true;
     }
 
 private:
@@ -72,9 +84,11 @@ public:
           dstChannelNum (dstChannelNum_)
     { }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples, bool* silentChannels)
     {
-        sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
+        if (! (silentChannels[srcChannelNum] && silentChannels[dstChannelNum]))
+            sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
+        silentChannels[dstChannelNum] = silentChannels[srcChannelNum];
     }
 
 private:
@@ -92,9 +106,12 @@ public:
           dstChannelNum (dstChannelNum_)
     { }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples, bool* silentChannels)
     {
+        if (silentChannels[srcChannelNum])
+            return;
         sharedBufferChans.addFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
+        silentChannels[dstChannelNum] = false;
     }
 
 private:
@@ -111,7 +128,7 @@ public:
         : bufferNum (bufferNum_)
     {}
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
+    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int, bool*)
     {
         sharedMidiBuffers.getUnchecked (bufferNum)->clear();
     }
@@ -131,7 +148,7 @@ public:
           dstBufferNum (dstBufferNum_)
     { }
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
+    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int, bool*)
     {
         *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
     }
@@ -151,7 +168,7 @@ public:
           dstBufferNum (dstBufferNum_)
     { }
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples, bool*)
     {
         sharedMidiBuffers.getUnchecked (dstBufferNum)
             ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
@@ -170,12 +187,19 @@ public:
         : channel (channel_),
           bufferSize (numSamplesDelay_ + 1),
           readIndex (0), writeIndex (numSamplesDelay_)
+    { }
+
+    void allocate (RenderArena& arena) override
     {
-        buffer.calloc ((size_t) bufferSize);
+        buffer = arena.allocate<float> (bufferSize);
     }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples, bool* silentChannels)
     {
+        // once the line holds nothing but silence there is nothing to move
+        if (silentChannels[channel] && silentSamples >= bufferSize)
+            return;
+
         float* data = sharedBufferChans.getWritePointer (channel, 0);
 
         for (int i = numSamples; --i >= 0;)
@@ -186,17 +210,44 @@ public:
             if (++readIndex  >= bufferSize) readIndex = 0;
             if (++writeIndex >= bufferSize) writeIndex = 0;
         }
+
+        silentSamples = silentChannels[channel] ? silentSamples + numSamples : 0;
+        silentChannels[channel] = false;
     }
 
 private:
-    HeapBlock<float> buffer;
+    float* buffer = nullptr;
     const int channel, bufferSize;
     int readIndex, writeIndex;
+    int silentSamples = 0;
 
     JUCE_DECLARE_NON_COPYABLE (DelayChannelOp)
 };
 
 
+/** Oversampling shared by a chain of ProcessBufferOps. The first op in the
+    chain upsamples its buffers into the scope, the ops after it render in
+    place on the oversampled block and the last one downsamples back. */
+class OversamplingScope : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<OversamplingScope>;
+
+    OversamplingScope (const int numChannels, const int factor_, const int blockSize)
+        : factor (factor_),
+          oversampling ((size_t) jmax (1, numChannels), (size_t) roundToInt (log2 ((double) factor_)),
+                        dsp::Oversampling<float>::FilterType::filterHalfBandPolyphaseIIR)
+    {
+        oversampling.initProcessing ((size_t) jmax (1, blockSize));
+    }
+
+    const int factor;
+    dsp::Oversampling<float> oversampling;
+    dsp::AudioBlock<float> block;
+
+    JUCE_DECLARE_NON_COPYABLE (OversamplingScope)
+};
+
 class ProcessBufferOp : public Task
 {
 public:
@@ -214,29 +265,187 @@ public:
           numAudioOuts (node_->getNumPorts (PortType::Audio, false)),
           midiBufferToUse (midiBufferToUse_)
     {
-        channels.calloc ((size_t) totalChans);
-
         while (audioChannelsToUse.size() < totalChans)
             audioChannelsToUse.add (0);
 
         if (chans[PortType::Midi].size() > 0)
             midiBufferToUse = chans[PortType::Midi].getFirst();
 
+        BigInteger allInputs;
+        allInputs.setRange (0, numAudioIns, true);
+        setConnectedInputs (allInputs);
+
         lastMute = node->isMuted();
+        {
+            const ScopedLock spl (node->getPropertyLock());
+            midiChans = node->getMidiChannels();
+        }
+        mightSleep = numAudioIns > 0 && processor != nullptr && ! node->wantsMidiPipe()
+            && ! node->isAudioIONode() && ! node->isMidiIONode()
+            && node->processor<GraphProcessor>() == nullptr;
+        scaledMidi.ensureSize (2048);
+        subBlockMidi.ensureSize (2048);
+        automatedMidi.ensureSize (2048);
+    }
+
+    /** A connected control input and the shared buffer its signal is in */
+    struct ControlInput
+    {
+        int parameter = -1;
+        int buffer = 0;
+        float lastValue = -1.f;
+        bool changed = false;
+    };
+
+    /** Binds control inputs to the processor's parameters and, for nodes that
+        render themselves, control outputs to the channels after the audio. */
+    void setControlPorts (const Array<ControlInput>& inputs, const Array<int>& outputs)
+    {
+        controlInputs = inputs;
+        controlOutputs = outputs;
     }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    /** Sets which audio inputs have a connection. The others read a cleared or
+        shared empty buffer, so gain and metering skip them. Sidechain buses
+        are only channels after the main ones, connected ones point straight
+        at their source's buffer like any other input. */
+    void setConnectedInputs (const BigInteger& connected)
     {
+        connectedInputs = connected;
+        inputRuns.clearQuick();
+        for (int ch = 0; ch < numAudioIns; ++ch)
+        {
+            if (! connected[ch])
+                continue;
+            if (inputRuns.size() > 0 && inputRuns.getLast().getEnd() == ch)
+                inputRuns.getReference (inputRuns.size() - 1).setEnd (ch + 1);
+            else
+                inputRuns.add ({ ch, ch + 1 });
+        }
+    }
+
+    void allocate (RenderArena& arena) override
+    {
+        channels     = arena.allocate<float*> (totalChans + controlOutputs.size());
+        rateChannels = arena.allocate<float*> (totalChans);
+        controlData  = arena.allocate<const float*> (controlInputs.size());
+    }
+
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples, bool* silentChannels)
+    {
+        silent = silentChannels;
         for (int i = totalChans; --i >= 0;) {
             channels[i] = sharedBufferChans.getWritePointer (audioChannelsToUse.getUnchecked (i), 0);
         }
 
+        // sources that don't render this block leave their outputs at zero
+        for (int i = controlOutputs.size(); --i >= 0;)
+        {
+            channels[totalChans + i] = sharedBufferChans.getWritePointer (controlOutputs.getUnchecked (i), 0);
+            FloatVectorOperations::clear (channels[totalChans + i], numSamples);
+            silent[controlOutputs.getUnchecked (i)] = false;
+        }
+
+        for (int i = controlInputs.size(); --i >= 0;)
+            controlData[i] = sharedBufferChans.getReadPointer (controlInputs.getReference(i).buffer, 0);
+
         AudioSampleBuffer buffer (channels, totalChans, numSamples);
-        
+
+        if (scope == nullptr)
+        {
+            process (buffer, sharedMidiBuffers, 1);
+            return;
+        }
+
+        dsp::AudioBlock<float> block (buffer);
+        if (scopeEntry)
+            scope->block = scope->oversampling.processSamplesUp (block);
+
+        for (int ch = 0; ch < totalChans; ++ch)
+            rateChannels[ch] = scope->block.getChannelPointer ((size_t) ch);
+
+        AudioSampleBuffer osBuffer (rateChannels, totalChans, (int) scope->block.getNumSamples());
+        process (osBuffer, sharedMidiBuffers, scope->factor);
+
+        if (scopeExit)
+            scope->oversampling.processSamplesDown (block);
+    }
+
+    /** Puts this op at the start of an oversampling scope */
+    void beginScope (OversamplingScope* newScope)
+    {
+        scope = newScope;
+        scopeEntry = scopeExit = true;
+    }
+
+    /** Continues this op's scope with the next op, which then ends it */
+    void continueScope (ProcessBufferOp& next)
+    {
+        jassert (scope != nullptr && scopeExit);
+        next.scope = scope;
+        next.scopeEntry = false;
+        next.scopeExit = true;
+        scopeExit = false;
+    }
+
+    OversamplingScope* getScope() const noexcept            { return scope.get(); }
+    int getTotalChannels() const noexcept                   { return totalChans; }
+    const Array<int>& getAudioChannels() const noexcept     { return audioChannelsToUse; }
+
+    const GraphNodePtr node;
+    AudioProcessor* const processor;
+
+private:
+    Array <int> audioChannelsToUse;
+    Array <int> midiChannelsToUse;
+    float** channels = nullptr;
+    Array<ControlInput> controlInputs;
+    Array<int> controlOutputs;
+    const float** controlData = nullptr;
+    int totalChans, numAudioIns, numAudioOuts;
+    BigInteger connectedInputs;
+    Array<Range<int>> inputRuns;
+    int midiBufferToUse;
+    bool lastMute = false;
+    bool wasFaulted = false;
+    bool* silent = nullptr;
+    bool mightSleep = false;
+    bool outputQuiet = false;
+    int silentSamples = 0;
+    float** rateChannels = nullptr;
+    MidiBuffer scaledMidi;
+    MidiTranspose transpose;
+    MidiChannels midiChans;
+    OversamplingScope::Ptr scope;
+    bool scopeEntry = false, scopeExit = false;
+
+    /** Renders the node. rateFactor is how many times the parent's rate the
+        buffer is at, MIDI always arrives with times at the parent's rate. */
+    void process (AudioSampleBuffer& buffer, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int rateFactor)
+    {
+        const int numSamples = buffer.getNumSamples();
+
         if (! node->isEnabled())
         {
             for (int ch = numAudioIns; ch < numAudioOuts; ++ch)
+            {
                 buffer.clear (ch, 0, buffer.getNumSamples());
+                setSilent (ch, true);
+            }
+            return;
+        }
+
+        if (node->isFaulted())
+        {
+            // silenced by the signal guard: don't let it render until cleared
+            for (int ch = 0; ch < numAudioOuts; ++ch)
+            {
+                buffer.clear (ch, 0, numSamples);
+                node->setOutputRMS (ch, 0.f);
+                setSilent (ch, true);
+            }
+            sharedMidiBuffers.getUnchecked (midiBufferToUse)->clear();
+            wasFaulted = true;
             return;
         }
 
@@ -248,39 +457,47 @@ public:
             if (lastMute != muted)
             {
                 // just became muted
-                buffer.applyGainRamp (0, numSamples, node->getLastInputGain(), 0.0);
+                applyInputGain (buffer, numSamples, node->getLastInputGain(), 0.f);
             }
             else
             {
                 // normal mute processing
-                buffer.applyGain (0, numSamples, 0.0);
+                applyInputGain (buffer, numSamples, 0.f, 0.f);
             }
         }
         else if (!muted && muteInput && muted != lastMute)
         {
             // just became unmuted
-            buffer.applyGainRamp (0, numSamples, 0.0, node->getInputGain());
+            applyInputGain (buffer, numSamples, 0.f, node->getInputGain());
         }
-        else if (node->getInputGain() != node->getLastInputGain())
-        {
-            buffer.applyGainRamp (0, numSamples, node->getLastInputGain(), node->getInputGain());
-        } 
-        else 
+        else
         {
-            buffer.applyGain (0, numSamples, node->getInputGain());
+            applyInputGain (buffer, numSamples, node->getLastInputGain(), node->getInputGain());
         }
 
+        // inputs known to be silent aren't measured
+        bool inputsSilent = true;
         for (int i = numAudioIns; --i >= 0;)
-            node->setInputRMS (i, buffer.getRMSLevel (i, 0, numSamples));
+        {
+            const float rms = (isSilent (i) || ! connectedInputs[i]) ? 0.f : buffer.getRMSLevel (i, 0, numSamples);
+            node->setInputRMS (i, rms);
+            inputsSilent = inputsSilent && rms == 0.f;
+        }
 
        #ifndef EL_FREE
         // Begin MIDI filters
         {
             jassert (tempMidi.getNumEvents() == 0);
-            ScopedLock spl (node->getPropertyLock());
+            // only the channels need the lock, the UI holds it to change
+            // them so keep the last ones rather than wait
+            {
+                const ScopedTryLock spl (node->getPropertyLock());
+                if (spl.isLocked())
+                    midiChans = node->getMidiChannels();
+            }
+
             transpose.setNoteOffset (node->getTransposeOffset());
             const auto keyRange (node->getKeyRange());
-            const auto midiChans (node->getMidiChannels());
             const auto useMidiProgram (node->areMidiProgramsEnabled());
  
             if (keyRange.getLength() > 0 || !midiChans.isOmni() || useMidiProgram)
@@ -315,20 +532,35 @@ public:
             }
             else
             {
-                transpose.process (*sharedMidiBuffers.getUnchecked (midiBufferToUse), numSamples);
+                transpose.process (*sharedMidiBuffers.getUnchecked (midiBufferToUse), numSamples / rateFactor);
             }
         }
         tempMidi.clear();
         // End MIDI filters
        #endif
+
+        if (shouldSleep (inputsSilent, sharedMidiBuffers.getUnchecked (midiBufferToUse)->isEmpty(), numSamples / rateFactor))
+        {
+            for (int ch = 0; ch < numAudioOuts; ++ch)
+            {
+                buffer.clear (ch, 0, numSamples);
+                node->setOutputRMS (ch, 0.f);
+                setSilent (ch, true);
+            }
+
+            node->updateGain();
+            lastMute = muted;
+            return;
+        }
         
         if (node->wantsMidiPipe())
         {
             MidiPipe midiPipe (sharedMidiBuffers, midiChannelsToUse);
+            AudioSampleBuffer renderBuffer (channels, totalChans + controlOutputs.size(), numSamples);
             if (! node->isSuspended())
-                node->render (buffer, midiPipe);
+                node->render (renderBuffer, midiPipe);
             else
-                node->renderBypassed (buffer, midiPipe);
+                node->renderBypassed (renderBuffer, midiPipe);
         }
         else
         {
@@ -344,28 +576,70 @@ public:
                 }
             };
 
-            if (node->getOversamplingFactor() > 1)
+            auto& midi = *sharedMidiBuffers.getUnchecked (midiBufferToUse);
+            const int dsFactor = node->getDownsamplingFactor();
+
+            // the message thread only holds this to swap lanes, skip a block
+            // of automation rather than wait for it. The lanes are held by
+            // reference so the lock isn't kept while the plugin renders, the
+            // node retires old lanes so the last reference isn't dropped here
+            NodeAutomation::Ptr automation;
             {
-                auto osProcessor = node->getOversamplingProcessor();
+                const ScopedTryLock sal (node->automationLock);
+                if (sal.isLocked())
+                    automation = node->automation;
+            }
+            double beat = 0.0, beatsPerSample = 0.0;
+            const bool automating = automation != nullptr && getTransportBeat (beat, beatsPerSample);
+            const bool subdivide = rateFactor == 1 && dsFactor == 1
+                && ((automating && automation->movesWithin (beat, beat + beatsPerSample * numSamples))
+                    || (node->wantsSubBlockControls() && controlsMoveWithin (numSamples)));
 
-                dsp::AudioBlock<float> block (buffer);
-                dsp::AudioBlock<float> osBlock = osProcessor->processSamplesUp (block);
+            if (! subdivide)
+            {
+                if (automating)
+                    automation->apply (*processor, beat);
+                applyControls (0);
+            }
 
-                std::unique_ptr<float*> ptrArray;
-                ptrArray.reset (new float* [buffer.getNumChannels()]);
-                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-                    ptrArray.get()[ch] = osBlock.getChannelPointer (ch);
+            if (subdivide)
+            {
+                processSubBlocks (buffer, midi, automating ? automation.get() : nullptr,
+                                  beat, beatsPerSample, processor->isSuspended());
+            }
+            else if (rateFactor > 1)
+            {
+                // events keep their position in time inside the longer block
+                scaleMidiTimes (midi, rateFactor, 1, numSamples);
+                pluginProcessBlock (buffer, processor->isSuspended());
+                scaleMidiTimes (midi, 1, rateFactor, numSamples / rateFactor);
+            }
+            else if (dsFactor > 1 && node->downsampler != nullptr)
+            {
+                // the downsampler carries whatever doesn't fill an inner
+                // sample over to the next block, so odd host blocks still
+                // come back whole
+                auto& ds = *node->downsampler;
+                const int innerSamples = ds.decimate (buffer, numSamples);
 
-                AudioBuffer<float> osBuffer (ptrArray.get(), buffer.getNumChannels(), static_cast<int> (osBlock.getNumSamples()));
-                pluginProcessBlock (osBuffer, processor->isSuspended());
+                if (innerSamples > 0)
+                {
+                    scaleMidiTimes (midi, 1, dsFactor, innerSamples);
+                    AudioBuffer<float> dsBuffer (ds.getInnerChannels(), jmin (totalChans, ds.getNumChannels()), innerSamples);
+                    pluginProcessBlock (dsBuffer, processor->isSuspended());
+                    scaleMidiTimes (midi, dsFactor, 1, numSamples);
+                }
 
-                osProcessor->processSamplesDown (block);
+                ds.interpolate (buffer, numSamples, innerSamples);
             }
             else
             {
                 pluginProcessBlock (buffer, processor->isSuspended());
             }
-            
+
+            if (automating)
+                automation->notify (*processor);
+            notifyControls();
         }
         
         if (muted && !muteInput)
@@ -373,47 +647,258 @@ public:
             if (lastMute != muted)
             {
                 // just became muted
-                buffer.applyGainRamp (0, numSamples, node->getLastGain(), 0.0);
+                applyOutputGain (buffer, numSamples, node->getLastGain(), 0.f);
             }
             else
             {
                 // normal mute processing
-                buffer.applyGain (0, numSamples, 0.0);
+                applyOutputGain (buffer, numSamples, 0.f, 0.f);
             }
         }
         else if (!muted && !muteInput && muted != lastMute)
         {
             // just became unmuted
-            buffer.applyGainRamp (0, numSamples, 0.0, node->getGain());
+            applyOutputGain (buffer, numSamples, 0.f, node->getGain());
         }
-        else if (node->getGain() != node->getLastGain())
-        {
-            buffer.applyGainRamp (0, numSamples, node->getLastGain(), node->getGain());
-        }
-        else 
+        else
         {
-            buffer.applyGain (0, numSamples, node->getGain());
+            applyOutputGain (buffer, numSamples, node->getLastGain(), node->getGain());
         }
 
         node->updateGain();
         lastMute = muted;
 
-        for (int i = 0; i < numAudioOuts; ++i)
-            node->setOutputRMS (i, buffer.getRMSLevel (i, 0, numSamples));
+        if (wasFaulted)
+        {
+            // fault was cleared, fade back in
+            for (int i = 0; i < numAudioOuts; ++i)
+                buffer.applyGainRamp (i, 0, numSamples, 0.f, 1.f);
+            wasFaulted = false;
+        }
+
+        float outputLevel = 0.f;
+
+        if (GraphNode::isSignalGuardEnabled())
+        {
+            bool nonFinite = false;
+            int denormals = 0;
+
+            for (int i = 0; i < numAudioOuts; ++i)
+            {
+                const auto result = SignalGuard::scan (buffer.getWritePointer (i), numSamples);
+                nonFinite = nonFinite || result.nonFinite;
+                denormals += result.denormals;
+                node->setOutputRMS (i, result.rms);
+                setSilent (i, result.rms == 0.f);
+                outputLevel = jmax (outputLevel, result.rms);
+            }
+
+            if (nonFinite)
+            {
+                // NaN can't be ramped out, the whole block has to go
+                for (int i = 0; i < numAudioOuts; ++i)
+                {
+                    buffer.clear (i, 0, numSamples);
+                    node->setOutputRMS (i, 0.f);
+                    setSilent (i, true);
+                }
+                outputLevel = 0.f;
+
+                node->signalFault (GraphNode::NonFiniteFault);
+            }
+            else if (SignalGuard::isDenormalStorm (denormals, numSamples * jmax (1, numAudioOuts)))
+            {
+                node->signalFault (GraphNode::DenormalFault);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numAudioOuts; ++i)
+            {
+                const float rms = buffer.getRMSLevel (i, 0, numSamples);
+                node->setOutputRMS (i, rms);
+                setSilent (i, rms == 0.f);
+                outputLevel = jmax (outputLevel, rms);
+            }
+        }
+
+        outputQuiet = outputLevel <= quietLevel;
     }
 
-    const GraphNodePtr node;
-    AudioProcessor* const processor;
+    /** Ramps the gain of the connected inputs, one run of adjacent channels
+        at a time. Applying a constant gain of one is free. */
+    void applyInputGain (AudioSampleBuffer& buffer, const int numSamples, const float startGain, const float endGain) noexcept
+    {
+        for (const auto& run : inputRuns)
+        {
+            AudioSampleBuffer channelRun (buffer.getArrayOfWritePointers() + run.getStart(),
+                                          run.getLength(), numSamples);
+            channelRun.applyGainRamp (0, numSamples, startGain, endGain);
+        }
+    }
 
-private:
-    Array <int> audioChannelsToUse;
-    Array <int> midiChannelsToUse;
-    HeapBlock <float*> channels;
-    int totalChans, numAudioIns, numAudioOuts;
-    int midiBufferToUse;
-    bool lastMute = false;
-    MidiTranspose transpose;
+    /** Ramps the gain of the outputs, the channels after them only pad the
+        buffer for inputs and aren't read again */
+    void applyOutputGain (AudioSampleBuffer& buffer, const int numSamples, const float startGain, const float endGain) noexcept
+    {
+        for (int ch = jmin (numAudioOuts, buffer.getNumChannels()); --ch >= 0;)
+            buffer.applyGainRamp (ch, 0, numSamples, startGain, endGain);
+    }
+
+    /** Below about -100 dB a tail is over */
+    static constexpr float quietLevel = 1.0e-5f;
+
+    /** True if the shared buffer behind a channel is known to be silent.
+        Oversampled ops work on the scope's buffers so nothing is known. */
+    bool isSilent (const int channel) const noexcept
+    {
+        return scope == nullptr && silent[audioChannelsToUse.getUnchecked (channel)];
+    }
+
+    void setSilent (const int channel, const bool isNowSilent) noexcept
+    {
+        silent[audioChannelsToUse.getUnchecked (channel)] = scope == nullptr && isNowSilent;
+    }
+
+    /** True if an effect can skip rendering. That is once its inputs and MIDI
+        have been empty for longer than its tail and latency and its output
+        has faded out. Parameters changed while asleep are picked up when it
+        wakes, but automation and control inputs keep it awake. */
+    bool shouldSleep (const bool inputsSilent, const bool midiEmpty, const int numSamples)
+    {
+        bool idle = inputsSilent && midiEmpty && mightSleep && scope == nullptr
+            && controlInputs.isEmpty() && GraphNode::isSleepingEnabled();
+        if (idle)
+        {
+            // stays awake while the lanes are being swapped
+            const ScopedTryLock sal (node->automationLock);
+            idle = sal.isLocked() && node->automation == nullptr;
+        }
+
+        silentSamples = idle ? silentSamples + numSamples : 0;
+
+        const bool asleep = idle && outputQuiet && silentSamples > getTailSamples();
+        node->sleeping.set (asleep ? 1 : 0);
+        return asleep;
+    }
+
+    int getTailSamples() const
+    {
+        const double tail = processor->getTailLengthSeconds();
+        // infinite tails, like a looper's, never sleep
+        if (! (tail >= 0.0 && tail < 60.0))
+            return std::numeric_limits<int>::max();
+        return roundToInt (tail * processor->getSampleRate() * node->getDownsamplingFactor())
+            + processor->getLatencySamples();
+    }
+
+    /** Gets the transport position in beats if it is playing */
+    bool getTransportBeat (double& beat, double& beatsPerSample)
+    {
+        auto* const playhead = processor->getPlayHead();
+        const double sampleRate = processor->getSampleRate();
+        AudioPlayHead::CurrentPositionInfo pos;
+        if (playhead == nullptr || sampleRate <= 0.0 || ! playhead->getCurrentPosition (pos) || ! pos.isPlaying)
+            return false;
+
+        beat = pos.ppqPosition;
+        beatsPerSample = pos.bpm / (60.0 * sampleRate);
+        return true;
+    }
+
+    /** True if a connected control signal changes during the block */
+    bool controlsMoveWithin (const int numSamples) const noexcept
+    {
+        for (int i = controlInputs.size(); --i >= 0;)
+        {
+            const auto range = FloatVectorOperations::findMinAndMax (controlData[i], numSamples);
+            if (range.getLength() > 0.f)
+                return true;
+        }
+
+        return false;
+    }
+
+    /** Writes control signals to their parameters as they are at a sample.
+        Listeners are told once per block in notifyControls() */
+    void applyControls (const int sample) noexcept
+    {
+        const auto& params = processor->getParameters();
+        for (int i = 0; i < controlInputs.size(); ++i)
+        {
+            auto& input = controlInputs.getReference (i);
+            const float value = jlimit (0.f, 1.f, controlData[i][sample]);
+            if (value == input.lastValue)
+                continue;
+
+            input.lastValue = value;
+            if (auto* const param = params[input.parameter])
+            {
+                param->setValue (value);
+                input.changed = true;
+            }
+        }
+    }
+
+    void notifyControls()
+    {
+        const auto& params = processor->getParameters();
+        for (auto& input : controlInputs)
+        {
+            if (! input.changed)
+                continue;
+            input.changed = false;
+            if (auto* const param = params[input.parameter])
+                param->sendValueChangedMessageToListeners (input.lastValue);
+        }
+    }
+
+    /** Renders the plugin in short sub-blocks so parameters follow automation
+        and control signals that move inside the block. Events are moved into
+        each sub-block and the plugin's output events back to the block's timeline. */
+    void processSubBlocks (AudioSampleBuffer& buffer, MidiBuffer& midi, NodeAutomation* automation,
+                           const double beat, const double beatsPerSample, const bool suspended)
+    {
+        const int numSamples = buffer.getNumSamples();
+        automatedMidi.clear();
+
+        for (int start = 0; start < numSamples; start += NodeAutomation::subBlockSize)
+        {
+            const int length = jmin ((int) NodeAutomation::subBlockSize, numSamples - start);
+            if (automation != nullptr)
+                automation->apply (*processor, beat + beatsPerSample * start);
+            applyControls (start);
+
+            subBlockMidi.clear();
+            subBlockMidi.addEvents (midi, start, length, -start);
+            AudioSampleBuffer subBlock (buffer.getArrayOfWritePointers(), totalChans, start, length);
+
+            if (! suspended)
+                processor->processBlock (subBlock, subBlockMidi);
+            else
+                processor->processBlockBypassed (subBlock, subBlockMidi);
+
+            automatedMidi.addEvents (subBlockMidi, 0, -1, start);
+        }
+
+        midi.swapWith (automatedMidi);
+    }
+
+    /** Moves event times when a node renders at a different rate than its parent */
+    void scaleMidiTimes (MidiBuffer& midi, const int multiplier, const int divisor, const int numSamples)
+    {
+        if (midi.isEmpty())
+            return;
+
+        scaledMidi.clear();
+        MidiBuffer::Iterator iter (midi);
+        int frame = 0; MidiMessage msg;
+        while (iter.getNextEvent (msg, frame))
+            scaledMidi.addEvent (msg, jlimit (0, jmax (0, numSamples - 1), frame * multiplier / divisor));
+        midi.swapWith (scaledMidi);
+    }
     MidiBuffer tempMidi;
+    MidiBuffer subBlockMidi, automatedMidi;
     JUCE_DECLARE_NON_COPYABLE (ProcessBufferOp)
 };
 
@@ -512,12 +997,21 @@ private:
         }
         
         Array <int> channelsToUse [PortType::Unknown];
+        BigInteger connectedInputs;
+        Array<ProcessBufferOp::ControlInput> controlInputs;
+        Array<int> controlOutputs;
         int maxLatency = getInputLatency (node->nodeId);
 
         const uint32 numPorts (node->getNumPorts());
         for (uint32 port = 0; port < numPorts; ++port)
         {
             const PortType portType (node->getPortType (port));
+            if (portType == PortType::Control)
+            {
+                createControlBuffer (*node, port, renderingOps, controlInputs, controlOutputs);
+                continue;
+            }
+
             if (portType != PortType::Audio && portType != PortType::Midi)
                 continue;
 
@@ -562,6 +1056,9 @@ private:
                 }
             }
 
+            if (portType == PortType::Audio && sourceNodes.size() > 0)
+                connectedInputs.setBit (inputChan);
+
             int bufIndex = -1;
             if (sourceNodes.size() == 0)
             {
@@ -747,15 +1244,130 @@ private:
             }
         } /* foreach port */
 
-        setNodeDelay (node->nodeId, maxLatency + node->getLatencySamples());
+        int totalChans = jmax (node->getNumPorts (PortType::Audio, true),
+                               node->getNumPorts (PortType::Audio, false));
+        auto* const op = new ProcessBufferOp (node, channelsToUse [PortType::Audio],
+                                              totalChans, 0, channelsToUse);
+        op->setConnectedInputs (connectedInputs);
+        if (controlInputs.size() > 0 || controlOutputs.size() > 0)
+            op->setControlPorts (controlInputs, controlOutputs);
+
+        // the filters delay the signal once per scope, not once per node
+        int scopeLatency = 0;
+        if (wantsOversampling (*node))
+        {
+            if (canContinueScope (*op, renderingOps))
+            {
+                lastScopedOp->continueScope (*op);
+            }
+            else
+            {
+                auto* const scope = new OversamplingScope (op->getTotalChannels(), node->getOversamplingFactor(),
+                                                           graph.getBlockSize());
+                op->beginScope (scope);
+                scopeLatency = roundFloatToInt (scope->oversampling.getLatencyInSamples());
+            }
+        }
+
+        setNodeDelay (node->nodeId, maxLatency + node->getLatencySamples() + scopeLatency);
         
         if (node->isAudioIONode() && node->getNumPorts (PortType::Audio, false) == 0)
             totalLatency = maxLatency;
 
-        int totalChans = jmax (node->getNumPorts (PortType::Audio, true),
-                               node->getNumPorts (PortType::Audio, false));
-        renderingOps.add (new ProcessBufferOp (node, channelsToUse [PortType::Audio],
-                                               totalChans, 0, channelsToUse));
+        renderingOps.add (op);
+        lastScopedOp = op->getScope() != nullptr ? op : nullptr;
+        lastScopedOpIndex = renderingOps.size() - 1;
+    }
+
+    /** Control signals share the audio buffers. Only connected inputs get
+        one, so a plugin's parameters cost nothing until something drives them.
+        Inputs are read only, sources keep their buffers until the last reader. */
+    void createControlBuffer (GraphNode& node, const uint32 port, Array<void*>& renderingOps,
+                              Array<ProcessBufferOp::ControlInput>& controlInputs,
+                              Array<int>& controlOutputs)
+    {
+        if (node.isPortOutput (port))
+        {
+            // only nodes rendering themselves can write control signals
+            if (! node.wantsMidiPipe())
+                return;
+
+            const int bufIndex = getFreeBuffer (PortType::Audio);
+            markBufferAsContaining (bufIndex, PortType::Audio, node.nodeId, port);
+            controlOutputs.add (bufIndex);
+            return;
+        }
+
+        // control inputs drive the parameters of audio processors
+        if (node.wantsMidiPipe() || node.getAudioProcessor() == nullptr)
+            return;
+
+        Array<int> sourceBuffers;
+        for (int i = graph.getNumConnections(); --i >= 0;)
+        {
+            const auto* const c = graph.getConnection (i);
+            if (c->destNode != node.nodeId || c->destPort != port)
+                continue;
+
+            // a feedback loop or a source that doesn't write its output
+            const int bufIndex = getBufferContaining (PortType::Audio, c->sourceNode, c->sourcePort);
+            if (bufIndex >= 0)
+                sourceBuffers.add (bufIndex);
+        }
+
+        if (sourceBuffers.isEmpty())
+            return;
+
+        ProcessBufferOp::ControlInput input;
+        input.parameter = node.getChannelPort (port);
+        input.buffer = sourceBuffers.getFirst();
+
+        if (sourceBuffers.size() > 1)
+        {
+            // several sources are summed
+            input.buffer = getFreeBuffer (PortType::Audio);
+            markBufferAsContaining (input.buffer, PortType::Audio, anonymousNodeID, 0);
+            renderingOps.add (new CopyChannelOp (sourceBuffers.getFirst(), input.buffer));
+            for (int i = 1; i < sourceBuffers.size(); ++i)
+                renderingOps.add (new AddChannelOp (sourceBuffers.getUnchecked (i), input.buffer));
+        }
+
+        controlInputs.add (input);
+    }
+
+    //==============================================================================
+    ProcessBufferOp* lastScopedOp = nullptr;
+    int lastScopedOpIndex = -1;
+
+    static bool wantsOversampling (GraphNode& node)
+    {
+        return node.getOversamplingFactor() > 1 && node.getDownsamplingFactor() == 1
+            && ! node.wantsMidiPipe() && ! node.isAudioIONode() && ! node.isMidiIONode()
+            && node.getAudioPluginInstance() != nullptr;
+    }
+
+    /** True if the op can render inside the scope of the op just before it.
+        That is when both run at the same factor on the same buffers and
+        nothing in between touches audio, so the downsample and upsample
+        between them would only add filtering. */
+    bool canContinueScope (ProcessBufferOp& op, const Array<void*>& renderingOps) const
+    {
+        if (lastScopedOp == nullptr
+            || lastScopedOp->getScope()->factor != op.node->getOversamplingFactor()
+            || lastScopedOp->getTotalChannels() != op.getTotalChannels()
+            || lastScopedOp->getAudioChannels() != op.getAudioChannels())
+            return false;
+
+        for (int i = lastScopedOpIndex + 1; i < renderingOps.size(); ++i)
+        {
+            auto* const task = static_cast<Task*> (renderingOps.getUnchecked (i));
+            if (dynamic_cast<ClearMidiBufferOp*> (task) == nullptr
+                && dynamic_cast<CopyMidiBufferOp*> (task) == nullptr
+                && dynamic_cast<AddMidiBufferOp*> (task) == nullptr)
+                return false;
+        }
+
+        return true;
     }
 
     int getFreeBuffer (PortType type)
@@ -873,6 +1485,8 @@ GraphProcessor::GraphProcessor()
 
 GraphProcessor::~GraphProcessor()
 {
+    // scenes hold references to nodes
+    sceneRecall.clear();
     renderingSequenceChanged.disconnect_all_slots();
     clearRenderingSequence();
     clear();
@@ -888,7 +1502,7 @@ void GraphProcessor::clear()
     nodes.clear();
     connections.clear();
     //triggerAsyncUpdate();
-    handleAsyncUpdate();
+    buildRenderingSequence();
 }
 
 GraphNode* GraphProcessor::getNodeForId (const uint32 nodeId) const
@@ -1013,7 +1627,7 @@ bool GraphProcessor::removeNode (const uint32 nodeId)
          
             // triggerAsyncUpdate();
             // do this syncronoously so it wont try processing with a null graph
-            handleAsyncUpdate();
+            buildRenderingSequence();
             n->setParentGraph (nullptr);
 
             if (auto* sub = dynamic_cast<SubGraphProcessor*> (n->getAudioProcessor()))
@@ -1234,6 +1848,22 @@ void GraphProcessor::setVelocityCurveMode (const VelocityCurve::Mode mode) noexc
     velocityCurve.setMode (mode);
 }
 
+void GraphProcessor::layoutRenderMemory (RenderArena& arena, const Array<void*>& ops, const int numBuffers,
+                                         float**& channels, bool*& silent)
+{
+    channels = arena.allocate<float*> (numBuffers);
+    for (int i = 0; i < numBuffers; ++i)
+    {
+        auto* const data = arena.allocate<float> (renderBufferSize);
+        if (channels != nullptr)
+            channels[i] = data;
+    }
+
+    silent = arena.allocate<bool> (numBuffers);
+    for (auto* const op : ops)
+        static_cast<GraphRender::Task*> (op)->allocate (arena);
+}
+
 static void deleteRenderOpArray (Array<void*>& ops)
 {
     for (int i = ops.size(); --i >= 0;)
@@ -1283,24 +1913,11 @@ void GraphProcessor::buildRenderingSequence()
         //XXX:
         MessageManagerLock mml;
 
-        Array<void*> orderedNodes;
-
-        {
-            const LookupTable table (connections);
-
-            for (int i = 0; i < nodes.size(); ++i)
-            {
-                GraphNode* const node = nodes.getUnchecked(i);
-                node->prepare (getSampleRate(), getBlockSize(), this);
-
-                int j = 0;
-                for (; j < orderedNodes.size(); ++j)
-                    if (table.isAnInputTo (node->nodeId, ((GraphNode*) orderedNodes.getUnchecked(j))->nodeId))
-                      break;
+        for (auto* const node : nodes)
+            node->prepare (getSampleRate(), getBlockSize(), this);
 
-                orderedNodes.insert (j, node);
-            }
-        }
+        Array<void*> orderedNodes;
+        createOrderedNodeList (orderedNodes);
 
         GraphRender::ProcessorGraphBuilder calculator (*this, orderedNodes, newRenderingOps);
 
@@ -1308,46 +1925,196 @@ void GraphProcessor::buildRenderingSequence()
         numMidiBuffersNeeded      = calculator.buffersNeeded (PortType::Midi);
     }
 
+    // measure, then lay out for real in the committed region
+    std::unique_ptr<RenderArena> newArena (new RenderArena());
+    float** newChannels = nullptr;
+    bool* newSilentBuffers = nullptr;
+    layoutRenderMemory (*newArena, newRenderingOps, numRenderingBuffersNeeded, newChannels, newSilentBuffers);
+    if (! newArena->commit())
+    {
+        jassertfalse;
+        deleteRenderOpArray (newRenderingOps);
+        return;
+    }
+    layoutRenderMemory (*newArena, newRenderingOps, numRenderingBuffersNeeded, newChannels, newSilentBuffers);
+
     {
         // swap over to the new rendering sequence..
         const ScopedLock sl (getCallbackLock());
 
-        renderingBuffers.setSize (numRenderingBuffersNeeded, 4096);
-        renderingBuffers.clear();
+        // the arena is already zeroed
+        renderingBuffers.setDataToReferTo (newChannels, numRenderingBuffersNeeded, renderBufferSize);
+        silentBuffers = newSilentBuffers;
+        std::swap (renderArena, newArena);
 
         for (int i = midiBuffers.size(); --i >= 0;)
             midiBuffers.getUnchecked(i)->clear();
 
         while (midiBuffers.size() < numMidiBuffersNeeded)
-            midiBuffers.add (new MidiBuffer());
+            midiBuffers.add (new MidiBuffer())->ensureSize (2048);
 
         renderingOps.swapWith (newRenderingOps);
     }
 
-    // delete the old ones..
+    // delete the old ones before the memory they render with
     deleteRenderOpArray (newRenderingOps);
+    newArena = nullptr;
 
     renderingSequenceChanged();
 }
 
-void GraphProcessor::getOrderedNodes (ReferenceCountedArray<GraphNode>& orderedNodes)
+void GraphProcessor::createOrderedNodeList (Array<void*>& orderedNodes) const
 {
-    const LookupTable table (connections);
-    for (int i = 0; i < nodes.size(); ++i)
     {
-        GraphNode* const node = nodes.getUnchecked(i);
-        
-        int j = 0;
-        for (; j < orderedNodes.size(); ++j)
-            if (table.isAnInputTo (node->nodeId, ((GraphNode*) orderedNodes.getUnchecked(j))->nodeId))
-                break;
-        
-        orderedNodes.insert (j, node);
+        const LookupTable table (connections);
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            GraphNode* const node = nodes.getUnchecked(i);
+
+            int j = 0;
+            for (; j < orderedNodes.size(); ++j)
+                if (table.isAnInputTo (node->nodeId, ((GraphNode*) orderedNodes.getUnchecked(j))->nodeId))
+                    break;
+
+            orderedNodes.insert (j, node);
+        }
     }
+
+    if (isLocalityOrderingEnabled())
+        orderForLocality (orderedNodes);
+}
+
+void GraphProcessor::orderForLocality (Array<void*>& orderedNodes) const
+{
+    const int numNodes = orderedNodes.size();
+    if (numNodes < 3)
+        return;
+
+    HashMap<uint32, int> indexes;
+    for (int i = 0; i < numNodes; ++i)
+        indexes.set (((GraphNode*) orderedNodes.getUnchecked(i))->nodeId, i);
+
+    // direct producer/consumer links between nodes, one per pair
+    Array<Array<int>> sources, consumers;
+    sources.resize (numNodes);
+    consumers.resize (numNodes);
+    for (const auto* const c : connections)
+    {
+        if (c->sourceNode == c->destNode || ! indexes.contains (c->sourceNode) || ! indexes.contains (c->destNode))
+            continue;
+        const int source = indexes [c->sourceNode];
+        const int dest = indexes [c->destNode];
+        if (sources.getReference(dest).addIfNotAlreadyThere (source))
+            consumers.getReference(source).add (dest);
+    }
+
+    // bytes a node touches per block, estimated from its ports
+    const int64 blockBytes = (int64) jmax (1, getBlockSize()) * (int64) sizeof (float);
+    Array<int64> workingSets;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        const auto* const node = (GraphNode*) orderedNodes.getUnchecked (i);
+        const int numChannels = node->getNumPorts (PortType::Audio, true) + node->getNumPorts (PortType::Audio, false)
+                              + node->getNumPorts (PortType::Control, true) + node->getNumPorts (PortType::Control, false);
+        const int numMidi = node->getNumPorts (PortType::Midi, true) + node->getNumPorts (PortType::Midi, false);
+        workingSets.add (jmax ((int64) 256, numChannels * blockBytes + numMidi * 1024));
+    }
+
+    // list scheduling: of the nodes whose inputs have all run, take the one whose
+    // oldest input was written the fewest bytes ago. Nodes without inputs wait
+    // until nothing else is ready, so they run right before their consumers.
+    Array<int> waitingOn, ready, order;
+    Array<int64> writtenAt;
+    waitingOn.resize (numNodes);
+    writtenAt.insertMultiple (0, -1, numNodes);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        waitingOn.set (i, sources.getReference(i).size());
+        if (waitingOn[i] == 0)
+            ready.add (i);
+    }
+
+    int64 bytesTouched = 0;
+    while (ready.size() > 0)
+    {
+        int best = 0;
+        int64 bestDistance = std::numeric_limits<int64>::max();
+        for (int r = 0; r < ready.size(); ++r)
+        {
+            const int candidate = ready.getUnchecked (r);
+            int64 distance = std::numeric_limits<int64>::max();
+            if (sources.getReference(candidate).size() > 0)
+            {
+                distance = 0;
+                for (const int source : sources.getReference (candidate))
+                    distance = jmax (distance, bytesTouched - writtenAt.getUnchecked (source));
+            }
+
+            // ties keep the dependency order
+            if (distance < bestDistance || (distance == bestDistance && candidate < ready.getUnchecked (best)))
+            {
+                best = r;
+                bestDistance = distance;
+            }
+        }
+
+        const int next = ready.removeAndReturn (best);
+        order.add (next);
+        bytesTouched += workingSets.getUnchecked (next);
+        writtenAt.set (next, bytesTouched);
+
+        for (const int consumer : consumers.getReference (next))
+        {
+            waitingOn.set (consumer, waitingOn[consumer] - 1);
+            if (waitingOn[consumer] == 0)
+                ready.add (consumer);
+        }
+    }
+
+    // a feedback loop leaves nodes unscheduled, keep the dependency order then
+    if (order.size() != numNodes)
+        return;
+
+    Array<void*> reordered;
+    reordered.ensureStorageAllocated (numNodes);
+    for (const int index : order)
+        reordered.add (orderedNodes.getUnchecked (index));
+    orderedNodes.swapWith (reordered);
+}
+
+void GraphProcessor::getOrderedNodes (ReferenceCountedArray<GraphNode>& orderedNodes)
+{
+    Array<void*> ordered;
+    createOrderedNodeList (ordered);
+    for (auto* const node : ordered)
+        orderedNodes.add ((GraphNode*) node);
+}
+
+void GraphProcessor::setLocalityOrderingEnabled (bool enabled)
+{
+    sLocalityOrdering.set (enabled ? 1 : 0);
+}
+
+bool GraphProcessor::isLocalityOrderingEnabled()
+{
+    return sLocalityOrdering.get() == 1;
+}
+
+void GraphProcessor::setRebuildsSuspended (bool suspended)
+{
+    if (rebuildsSuspended == suspended)
+        return;
+
+    rebuildsSuspended = suspended;
+    cancelPendingUpdate();
+    if (! rebuildsSuspended)
+        buildRenderingSequence();
 }
 
 void GraphProcessor::handleAsyncUpdate()
 {
+    if (rebuildsSuspended)
+        return;
     buildRenderingSequence();
 }
 
@@ -1357,6 +2124,9 @@ void GraphProcessor::prepareToPlay (double sampleRate, int estimatedSamplesPerBl
     currentAudioOutputBuffer.setSize (jmax (1, getTotalNumOutputChannels()), estimatedSamplesPerBlock);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
+    // so the render thread doesn't grow them
+    currentMidiOutputBuffer.ensureSize (2048);
+    filteredMidi.ensureSize (2048);
     clearRenderingSequence();
 
     if (getSampleRate() != sampleRate || getBlockSize() != estimatedSamplesPerBlock)
@@ -1398,9 +2168,11 @@ void GraphProcessor::reset()
 void GraphProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
 {
     const int32 numSamples = buffer.getNumSamples();
+    sceneRecall.process (numSamples, getSampleRate());
 
     currentAudioInputBuffer = &buffer;
-    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
+    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples,
+                                      false, false, true);
     currentAudioOutputBuffer.clear();
     
     if (midiChannels.isOmni() && velocityCurve.getMode() == VelocityCurve::Linear)
@@ -1434,10 +2206,15 @@ void GraphProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMe
     
     currentMidiOutputBuffer.clear();
 
+    // the first buffer is the read only silence
+    for (int i = renderingBuffers.getNumChannels(); --i > 0;)
+        silentBuffers[i] = false;
+    silentBuffers[0] = true;
+
     for (int i = 0; i < renderingOps.size(); ++i)
     {
         GraphRender::Task* const op = static_cast<GraphRender::Task*> (renderingOps.getUnchecked (i));
-        op->perform (renderingBuffers, midiBuffers, numSamples);
+        op->perform (renderingBuffers, midiBuffers, numSamples, silentBuffers);
     }
 
     for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -21,11 +21,14 @@
 
 #include "ElementApp.h"
 #include "engine/GraphNode.h"
+#include "engine/SceneRecall.h"
 #include "engine/VelocityCurve.h"
 #include "Signals.h"
 
 namespace Element {
 
+class RenderArena;
+
 /**
     A type of AudioProcessor which plays back a graph of other AudioProcessors.
 
@@ -74,6 +77,11 @@ public:
     */
     void clear();
 
+    /** Holds off rebuilding the rendering sequence after each node or
+        connection is added, for loading many at once. Turning it back off
+        rebuilds once. Removing nodes still rebuilds right away. */
+    void setRebuildsSuspended (bool suspended);
+
     /** Returns the number of nodes in the graph. */
     int getNumNodes() const                                         { return nodes.size(); }
 
@@ -110,8 +118,17 @@ public:
     */
     bool removeNode (uint32 nodeId);
 
-    /** Builds an array of ordered nodes */
+    /** Builds an array of nodes in the order they are rendered */
     void getOrderedNodes (ReferenceCountedArray<GraphNode>& res);
+
+    /** Enable or disable reordering nodes so consumers run soon after their
+        producers, while the buffers they share are still in cache. Takes effect
+        the next time a graph rebuilds. This is a global setting shared by all
+        graphs. */
+    static void setLocalityOrderingEnabled (bool enabled);
+
+    /** Returns true if nodes are ordered for cache locality */
+    static bool isLocalityOrderingEnabled();
     
     /** Returns the number of connections in the graph. */
     int getNumConnections() const                                       { return connections.size(); }
@@ -187,6 +204,9 @@ public:
     /** Set the MIDI curve of this graph */
     void setVelocityCurveMode (const VelocityCurve::Mode) noexcept;
 
+    /** Returns the scenes recalled on this graph's audio thread */
+    SceneRecall& getSceneRecall() noexcept { return sceneRecall; }
+
     /** A special number that represents the midi channel of a node.
 
         This is used as a channel index value if you want to refer to the midi input
@@ -342,6 +362,13 @@ private:
     
     uint32 lastNodeId;
     AudioSampleBuffer renderingBuffers;
+    /** Samples in each shared render buffer */
+    enum { renderBufferSize = 4096 };
+
+    // render time memory of the current sequence, swapped with it
+    std::unique_ptr<RenderArena> renderArena;
+    bool noBuffersSilent [1] = { true };
+    bool* silentBuffers = noBuffersSilent;
     OwnedArray <MidiBuffer> midiBuffers;
     Array<void*> renderingOps;
 
@@ -356,10 +383,16 @@ private:
     kv::MidiChannels midiChannels;
     VelocityCurve velocityCurve;
     MidiBuffer filteredMidi;
+    SceneRecall sceneRecall;
+    bool rebuildsSuspended = false;
     
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
+    void createOrderedNodeList (Array<void*>& orderedNodes) const;
+    void orderForLocality (Array<void*>& orderedNodes) const;
+    static void layoutRenderMemory (RenderArena&, const Array<void*>& ops, int numBuffers,
+                                    float**& channels, bool*& silent);
     bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphProcessor)
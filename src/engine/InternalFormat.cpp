@@ -29,7 +29,10 @@
 #include "engine/nodes/MidiChannelMapProcessor.h"
 #include "engine/nodes/MidiChannelSplitterNode.h"
 #include "engine/nodes/MidiDeviceProcessor.h"
+#include "engine/nodes/EnvelopeFollowerNode.h"
+#include "engine/nodes/LfoNode.h"
 #include "engine/nodes/MidiMonitorNode.h"
+#include "engine/nodes/MidiToControlNode.h"
 #include "engine/nodes/PlaceholderProcessor.h"
 #include "engine/nodes/ReverbProcessor.h"
 #include "engine/nodes/SubGraphProcessor.h"
@@ -326,6 +329,21 @@ void ElementAudioPluginFormat::findAllTypesForFile (OwnedArray <PluginDescriptio
         auto* const desc = ds.add (new PluginDescription());
         MidiMonitorNode().fillInPluginDescription (*desc);
     }
+    else if (fileOrId == EL_INTERNAL_ID_LFO)
+    {
+        auto* const desc = ds.add (new PluginDescription());
+        LfoNode().getPluginDescription (*desc);
+    }
+    else if (fileOrId == EL_INTERNAL_ID_ENVELOPE_FOLLOWER)
+    {
+        auto* const desc = ds.add (new PluginDescription());
+        EnvelopeFollowerNode().getPluginDescription (*desc);
+    }
+    else if (fileOrId == EL_INTERNAL_ID_MIDI_TO_CONTROL)
+    {
+        auto* const desc = ds.add (new PluginDescription());
+        MidiToControlNode().getPluginDescription (*desc);
+    }
    #endif
 }
 
@@ -356,6 +374,9 @@ StringArray ElementAudioPluginFormat::searchPathsForPlugins (const FileSearchPat
     results.add (EL_INTERNAL_ID_AUDIO_ROUTER);
     results.add (EL_INTERNAL_ID_MIDI_PROGRAM_MAP);
     results.add (EL_INTERNAL_ID_MIDI_MONITOR);
+    results.add (EL_INTERNAL_ID_LFO);
+    results.add (EL_INTERNAL_ID_ENVELOPE_FOLLOWER);
+    results.add (EL_INTERNAL_ID_MIDI_TO_CONTROL);
     results.add (EL_INTERNAL_ID_PLACEHOLDER);
    #endif // product enablements
     return results;
@@ -0,0 +1,265 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/RealtimeSafety.h"
+
+#if EL_RT_CHECKS && JUCE_LINUX
+ #define EL_RT_INTERPOSE 1
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <time.h>
+ #include <unistd.h>
+ // initial-exec keeps TLS access from calling back into malloc
+ #define EL_RT_THREAD_LOCAL __thread __attribute__((tls_model ("initial-exec")))
+#else
+ #define EL_RT_INTERPOSE 0
+ #define EL_RT_THREAD_LOCAL thread_local
+#endif
+
+namespace Element {
+namespace RealtimeSafetyDetail {
+
+static EL_RT_THREAD_LOCAL int realtimeDepth = 0;
+static EL_RT_THREAD_LOCAL int suspendDepth  = 0;
+static std::atomic<bool> enabled { false };
+static std::atomic<int> numViolations { 0 };
+
+#if EL_RT_INTERPOSE
+
+/* Violations are written into static storage so recording one never
+   allocates. Symbols are resolved later, off the realtime thread. */
+struct Record
+{
+    const char* function;
+    void* frames [32];
+    int numFrames;
+    char threadName [32];
+    std::atomic<bool> ready;
+};
+
+static const int maxRecords = 256;
+static Record records [maxRecords];
+static std::atomic<int> numRecords { 0 };
+
+static void record (const char* function) noexcept
+{
+    ++suspendDepth;
+    numViolations.fetch_add (1, std::memory_order_relaxed);
+
+    const int slot = numRecords.fetch_add (1, std::memory_order_acq_rel);
+    if (slot < maxRecords)
+    {
+        auto& r = records [slot];
+        r.function  = function;
+        r.numFrames = backtrace (r.frames, numElementsInArray (r.frames));
+        r.threadName[0] = 0;
+        pthread_getname_np (pthread_self(), r.threadName, sizeof (r.threadName));
+        r.ready.store (true, std::memory_order_release);
+    }
+
+    --suspendDepth;
+}
+
+static inline void check (const char* function) noexcept
+{
+    if (realtimeDepth > 0 && suspendDepth == 0 && enabled.load (std::memory_order_relaxed))
+        record (function);
+}
+
+template<typename Fn>
+static Fn resolveNext (std::atomic<void*>& cache, const char* name, const char* version = nullptr) noexcept
+{
+    // resolved without a function-local static, whose guard may lock
+    void* fn = cache.load (std::memory_order_acquire);
+    if (fn == nullptr)
+    {
+        if (version != nullptr)
+            fn = dlvsym (RTLD_NEXT, name, version);
+        if (fn == nullptr)
+            fn = dlsym (RTLD_NEXT, name);
+        cache.store (fn, std::memory_order_release);
+    }
+    return reinterpret_cast<Fn> (fn);
+}
+
+#endif
+
+}
+
+//==============================================================================
+String RealtimeSafety::Violation::toString() const
+{
+    String text;
+    text << function << " called on realtime thread";
+    if (threadName.isNotEmpty())
+        text << " '" << threadName << "'";
+    for (const auto& frame : stack)
+        text << newLine << "    " << frame;
+    return text;
+}
+
+RealtimeSafety::ScopedRealtime::ScopedRealtime() noexcept      { ++RealtimeSafetyDetail::realtimeDepth; }
+RealtimeSafety::ScopedRealtime::~ScopedRealtime() noexcept     { --RealtimeSafetyDetail::realtimeDepth; }
+RealtimeSafety::ScopedNonRealtime::ScopedNonRealtime() noexcept    { ++RealtimeSafetyDetail::suspendDepth; }
+RealtimeSafety::ScopedNonRealtime::~ScopedNonRealtime() noexcept   { --RealtimeSafetyDetail::suspendDepth; }
+
+bool RealtimeSafety::isAvailable() noexcept { return EL_RT_INTERPOSE != 0; }
+
+void RealtimeSafety::setEnabled (bool shouldBeEnabled) noexcept
+{
+    RealtimeSafetyDetail::enabled.store (shouldBeEnabled && isAvailable());
+}
+
+bool RealtimeSafety::isEnabled() noexcept               { return RealtimeSafetyDetail::enabled.load(); }
+bool RealtimeSafety::isRealtimeThread() noexcept        { return RealtimeSafetyDetail::realtimeDepth > 0; }
+int RealtimeSafety::getNumViolations() noexcept         { return RealtimeSafetyDetail::numViolations.load(); }
+
+Array<RealtimeSafety::Violation> RealtimeSafety::getViolations()
+{
+    Array<Violation> violations;
+   #if EL_RT_INTERPOSE
+    using namespace RealtimeSafetyDetail;
+    const ScopedNonRealtime nonRealtime;
+    const int count = jmin (maxRecords, numRecords.load (std::memory_order_acquire));
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& r = records [i];
+        if (! r.ready.load (std::memory_order_acquire))
+            continue;
+
+        Violation violation;
+        violation.function   = r.function;
+        violation.threadName = String::fromUTF8 (r.threadName);
+        if (char** symbols = backtrace_symbols (r.frames, r.numFrames))
+        {
+            // skip record() and check()
+            for (int f = 2; f < r.numFrames; ++f)
+                violation.stack.add (String::fromUTF8 (symbols [f]));
+            ::free (symbols);
+        }
+
+        violations.add (violation);
+    }
+   #endif
+    return violations;
+}
+
+void RealtimeSafety::clearViolations()
+{
+   #if EL_RT_INTERPOSE
+    using namespace RealtimeSafetyDetail;
+    const int count = jmin (maxRecords, numRecords.load());
+    for (int i = 0; i < count; ++i)
+        records[i].ready.store (false);
+    numRecords.store (0);
+   #endif
+    RealtimeSafetyDetail::numViolations.store (0);
+}
+
+}
+
+//==============================================================================
+#if EL_RT_INTERPOSE
+
+using Element::RealtimeSafetyDetail::check;
+using Element::RealtimeSafetyDetail::resolveNext;
+
+extern "C" {
+
+void* __libc_malloc (size_t);
+void* __libc_calloc (size_t, size_t);
+void* __libc_realloc (void*, size_t);
+void  __libc_free (void*);
+
+void* malloc (size_t size) __THROW
+{
+    check ("malloc");
+    return __libc_malloc (size);
+}
+
+void* calloc (size_t num, size_t size) __THROW
+{
+    check ("calloc");
+    return __libc_calloc (num, size);
+}
+
+void* realloc (void* ptr, size_t size) __THROW
+{
+    check ("realloc");
+    return __libc_realloc (ptr, size);
+}
+
+void free (void* ptr) __THROW
+{
+    if (ptr != nullptr)
+        check ("free");
+    __libc_free (ptr);
+}
+
+static std::atomic<void*> nextMutexLock { nullptr };
+int pthread_mutex_lock (pthread_mutex_t* mutex) __THROWNL
+{
+    check ("pthread_mutex_lock");
+    return resolveNext<int (*)(pthread_mutex_t*)> (nextMutexLock, "pthread_mutex_lock") (mutex);
+}
+
+// plain dlsym can hand back the pre 2.3.2 condition variable ABI on x86
+static const char* const condVersion = "GLIBC_2.3.2";
+
+static std::atomic<void*> nextCondWait { nullptr };
+int pthread_cond_wait (pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    check ("pthread_cond_wait");
+    return resolveNext<int (*)(pthread_cond_t*, pthread_mutex_t*)> (nextCondWait, "pthread_cond_wait", condVersion) (cond, mutex);
+}
+
+static std::atomic<void*> nextCondTimedWait { nullptr };
+int pthread_cond_timedwait (pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time)
+{
+    check ("pthread_cond_timedwait");
+    return resolveNext<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> (
+        nextCondTimedWait, "pthread_cond_timedwait", condVersion) (cond, mutex, time);
+}
+
+static std::atomic<void*> nextSemWait { nullptr };
+int sem_wait (sem_t* sem)
+{
+    check ("sem_wait");
+    return resolveNext<int (*)(sem_t*)> (nextSemWait, "sem_wait") (sem);
+}
+
+static std::atomic<void*> nextNanosleep { nullptr };
+int nanosleep (const struct timespec* req, struct timespec* rem)
+{
+    check ("nanosleep");
+    return resolveNext<int (*)(const struct timespec*, struct timespec*)> (nextNanosleep, "nanosleep") (req, rem);
+}
+
+static std::atomic<void*> nextUsleep { nullptr };
+int usleep (__useconds_t usec)
+{
+    check ("usleep");
+    return resolveNext<int (*)(__useconds_t)> (nextUsleep, "usleep") (usec);
+}
+
+}
+
+#endif
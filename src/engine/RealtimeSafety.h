@@ -0,0 +1,116 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#ifndef EL_RT_CHECKS
+ #define EL_RT_CHECKS 0
+#endif
+
+namespace Element {
+
+/** Catches calls that aren't realtime safe on threads marked as realtime.
+
+    When built with EL_RT_CHECKS on Linux, malloc, calloc, realloc, free,
+    pthread_mutex_lock, pthread_cond_wait, sem_wait and the sleep calls are
+    interposed. If one of them is called on a thread inside a ScopedRealtime
+    while checking is enabled, the call and a stack trace are recorded.
+
+    In other builds everything here compiles to no-ops and isAvailable()
+    returns false.
+ */
+struct RealtimeSafety
+{
+    struct Violation
+    {
+        String function;
+        String threadName;
+        StringArray stack;
+
+        String toString() const;
+    };
+
+    /** Marks the calling thread as realtime for the lifetime of this object.
+        Nesting is allowed. */
+    class ScopedRealtime
+    {
+    public:
+        ScopedRealtime() noexcept;
+        ~ScopedRealtime() noexcept;
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtime)
+    };
+
+    /** Lets the calling realtime thread make unsafe calls without them being
+        recorded, e.g. for deliberate logging. */
+    class ScopedNonRealtime
+    {
+    public:
+        ScopedNonRealtime() noexcept;
+        ~ScopedNonRealtime() noexcept;
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ScopedNonRealtime)
+    };
+
+    /** Holds a lock a realtime thread is allowed to wait for, because the
+        other threads only ever hold it briefly. Taking it isn't recorded,
+        everything done while holding it is. */
+    class ScopedAllowedLock
+    {
+    public:
+        explicit ScopedAllowedLock (const CriticalSection& l) noexcept
+            : lock (l)
+        {
+            const ScopedNonRealtime nonRealtime;
+            lock.enter();
+        }
+
+        ~ScopedAllowedLock() noexcept { lock.exit(); }
+
+    private:
+        const CriticalSection& lock;
+        JUCE_DECLARE_NON_COPYABLE (ScopedAllowedLock)
+    };
+
+    /** Returns true if the detector was built in */
+    static bool isAvailable() noexcept;
+
+    /** Turns recording on or off for all threads */
+    static void setEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if recording is on */
+    static bool isEnabled() noexcept;
+
+    /** Returns true if the calling thread is marked realtime */
+    static bool isRealtimeThread() noexcept;
+
+    /** Returns the number of violations since the last clear */
+    static int getNumViolations() noexcept;
+
+    /** Returns the recorded violations, oldest first. At most a few hundred
+        are kept. */
+    static Array<Violation> getViolations();
+
+    /** Forget recorded violations */
+    static void clearViolations();
+};
+
+}
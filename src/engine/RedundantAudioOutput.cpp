@@ -0,0 +1,491 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/RedundantAudioOutput.h"
+
+namespace Element {
+
+static void clearChannels (float** channels, int numChannels, int startSample, int numSamples)
+{
+    for (int i = 0; i < numChannels; ++i)
+        if (channels[i] != nullptr)
+            zeromem (channels[i] + startSample, sizeof (float) * (size_t) numSamples);
+}
+
+// MARK: Backup
+
+class RedundantAudioOutput::Backup : public AudioIODeviceCallback
+{
+public:
+    Backup (RedundantAudioOutput& o) : owner (o) { }
+
+    void audioDeviceAboutToStart (AudioIODevice* device) override
+    {
+        numChannels          = jmax (1, device->getActiveOutputChannels().countNumberOfSetBits());
+        blockSize            = device->getCurrentBufferSizeSamples();
+        sampleRate           = device->getCurrentSampleRate();
+        configure();
+        underruns.set (0);
+        overruns.set (0);
+        running.set (1);
+    }
+
+    void audioDeviceStopped() override
+    {
+        running.set (0);
+        latency.set (0);
+        drift.set (0.f);
+
+        // with neither device left the engine stops, a running primary
+        // takes back over straight away
+        if (owner.primaryRunning.get() == 0)
+            owner.stopEngine();
+        else
+            owner.failedOver.set (0);
+    }
+
+    void audioDeviceIOCallback (const float**, int, float** outputs, int numOutputs, int numSamples) override
+    {
+        const SpinLock::ScopedTryLockType cl (configLock);
+        if (! cl.isLocked() || compatible.get() == 0)
+        {
+            clearChannels (outputs, numOutputs, 0, numSamples);
+            return;
+        }
+
+        checkPrimary();
+
+        if (owner.failedOver.get() != 0)
+            renderEngine (outputs, numOutputs, numSamples);
+        else
+            pull (outputs, numOutputs, numSamples);
+    }
+
+    /** Sizes everything for this device and the primary's current rate and
+        block size. The primary calls this each time it starts. */
+    void configure()
+    {
+        if (sampleRate <= 0.0)
+            return;
+
+        // the callback only tries this lock, and the primary pushes while
+        // holding the render lock
+        const SpinLock::ScopedLockType cl (configLock);
+        const SpinLock::ScopedLockType sl (owner.renderLock);
+
+        const double ratio   = getNominalRatio();
+        const int primaryBlock = jmax (1, owner.primaryBlockSize.get());
+        const int capacity   = jmax (8192, nextPowerOfTwo (8 * jmax ((int) std::ceil (blockSize * ratio), primaryBlock)));
+
+        // a rate this far off can't be bridged by resampling block by block
+        compatible.set (ratio >= 1.0 / maxRatio && ratio <= maxRatio ? 1 : 0);
+        if (compatible.get() == 0)
+            DBG("[EL] backup audio device can't follow the primary's sample rate");
+
+        fifo.setTotalSize (capacity);
+        fifo.reset();
+        fifoBuffer.setSize (numChannels, capacity);
+        staging.setSize (numChannels, capacity);
+        renderBuffer.setSize (numChannels, primaryBlock);
+        interpolators.clearQuick (true);
+        for (int i = 0; i < numChannels; ++i)
+            interpolators.add (new LagrangeInterpolator());
+
+        resetControl();
+        resetRequested.set (0);
+    }
+
+    /** Returns true if this can render the engine if the primary goes away */
+    bool canTakeOver() const { return running.get() != 0 && compatible.get() != 0; }
+
+    /** Called by the primary with the render lock held */
+    void push (float** outputs, int numOutputs, int numSamples)
+    {
+        if (running.get() == 0)
+            return;
+
+        if (fifo.getFreeSpace() < numSamples)
+        {
+            // the backup fell behind, start again from fresh audio
+            overruns.set (overruns.get() + 1);
+            resetRequested.set (1);
+            return;
+        }
+
+        write (outputs, numOutputs, numSamples);
+    }
+
+    /** The primary calls this when it takes back over so stale audio is dropped */
+    void requestReset() { resetRequested.set (1); }
+
+    RedundantAudioOutput& owner;
+    Atomic<int> running { 0 };
+    Atomic<int> compatible { 1 };
+    Atomic<int> underruns { 0 };
+    Atomic<int> overruns { 0 };
+    Atomic<int> latency { 0 };
+    Atomic<float> drift { 0.f };
+
+private:
+    SpinLock configLock;
+    AbstractFifo fifo { 1 };
+    AudioSampleBuffer fifoBuffer, staging, renderBuffer;
+    OwnedArray<LagrangeInterpolator> interpolators;
+    Atomic<int> resetRequested { 0 };
+    double sampleRate   = 0.0;
+    int blockSize       = 0;
+    int numChannels     = 1;
+    bool priming        = true;
+    double correction   = 0.0;
+    double integral     = 0.0;
+    double level        = -1.0;
+
+    // PI gains on the relative fill error, and the level filter's coefficient
+    static constexpr double proportionalGain = 0.0005;
+    static constexpr double integralGain     = 0.00001;
+    static constexpr double levelSmoothing   = 0.05;
+    static constexpr double maxCorrection    = 0.005;
+
+    /** Largest ratio between the two devices' sample rates */
+    static constexpr double maxRatio         = 4.0;
+
+    void resetControl()
+    {
+        priming     = true;
+        correction  = 0.0;
+        integral    = 0.0;
+        level       = -1.0;
+    }
+
+    double getNominalRatio() const
+    {
+        const double primaryRate = owner.primarySampleRate.get();
+        return (primaryRate > 0.0 && sampleRate > 0.0) ? primaryRate / sampleRate : 1.0;
+    }
+
+    void checkPrimary()
+    {
+        if (owner.failedOver.get() != 0 || owner.primaryRunning.get() == 0)
+            return;
+
+        if (owner.primaryError.get() != 0
+            || Time::getMillisecondCounter() - owner.lastPrimaryTime.get() > owner.getStallMs())
+        {
+            owner.failedOver.set (1);
+        }
+    }
+
+    void write (float* const* channels, int numInputs, int numSamples)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+        for (int c = 0; c < fifoBuffer.getNumChannels(); ++c)
+        {
+            if (c < numInputs && channels[c] != nullptr)
+            {
+                fifoBuffer.copyFrom (c, start1, channels[c], size1);
+                if (size2 > 0)
+                    fifoBuffer.copyFrom (c, start2, channels[c] + size1, size2);
+            }
+            else
+            {
+                fifoBuffer.clear (c, start1, size1);
+                if (size2 > 0)
+                    fifoBuffer.clear (c, start2, size2);
+            }
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    /** Resamples numSamples out of the fifo. Returns false and leaves the
+        outputs alone if it doesn't hold enough */
+    bool read (float** outputs, int numOutputs, int numSamples, double ratio)
+    {
+        const int needed = (int) std::ceil (numSamples * ratio) + 4;
+        if (fifo.getNumReady() < needed || needed > staging.getNumSamples())
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (needed, start1, size1, start2, size2);
+
+        const int numChans = jmin (numOutputs, fifoBuffer.getNumChannels());
+        int used = 0;
+        for (int c = 0; c < numChans; ++c)
+        {
+            staging.copyFrom (c, 0, fifoBuffer, c, start1, size1);
+            if (size2 > 0)
+                staging.copyFrom (c, size1, fifoBuffer, c, start2, size2);
+            if (outputs[c] != nullptr)
+                used = interpolators.getUnchecked(c)->process (ratio, staging.getReadPointer (c), outputs[c], numSamples);
+        }
+
+        fifo.finishedRead (jlimit (0, size1 + size2, used));
+
+        if (numChans < numOutputs)
+            clearChannels (outputs + numChans, numOutputs - numChans, 0, numSamples);
+        return true;
+    }
+
+    void renderEngine (float** outputs, int numOutputs, int numSamples)
+    {
+        const SpinLock::ScopedTryLockType sl (owner.renderLock);
+        auto* const engine = owner.engine;
+        if (! sl.isLocked() || engine == nullptr || ! owner.engineStarted)
+        {
+            clearChannels (outputs, numOutputs, 0, numSamples);
+            return;
+        }
+
+        // the engine keeps the primary's rate and block size, so its blocks
+        // go through the fifo and are resampled to this device like the
+        // primary's were. Audio the primary left queued plays out first.
+        const int numChans = jmin (renderBuffer.getNumChannels(), jmax (1, owner.primaryNumOutputs.get()));
+        const int chunk    = renderBuffer.getNumSamples();
+        const double ratio = getNominalRatio();
+        const int needed   = (int) std::ceil (numSamples * ratio) + 4;
+
+        while (fifo.getNumReady() < needed && fifo.getFreeSpace() >= chunk)
+        {
+            engine->audioDeviceIOCallback (nullptr, 0, renderBuffer.getArrayOfWritePointers(), numChans, chunk);
+            write (renderBuffer.getArrayOfWritePointers(), numChans, chunk);
+        }
+
+        latency.set (fifo.getNumReady());
+        drift.set (0.f);
+        if (! read (outputs, numOutputs, numSamples, ratio))
+            clearChannels (outputs, numOutputs, 0, numSamples);
+    }
+
+    void pull (float** outputs, int numOutputs, int numSamples)
+    {
+        if (resetRequested.compareAndSetBool (0, 1))
+        {
+            fifo.finishedRead (fifo.getNumReady());
+            for (auto* interpolator : interpolators)
+                interpolator->reset();
+            resetControl();
+        }
+
+        const int ready = fifo.getNumReady();
+        latency.set (ready);
+
+        if (owner.primaryRunning.get() == 0)
+        {
+            clearChannels (outputs, numOutputs, 0, numSamples);
+            return;
+        }
+
+        // keep about one block of each device queued, enough to ride out
+        // scheduling jitter between the two callbacks
+        const int target = jmax (1, owner.primaryBlockSize.get() + blockSize);
+        if (priming)
+        {
+            if (ready < target)
+            {
+                clearChannels (outputs, numOutputs, 0, numSamples);
+                return;
+            }
+
+            priming = false;
+        }
+
+        // steer the consumption rate so the fifo level settles on target. The
+        // level jumps by whole blocks as the devices take turns, so the
+        // controller sees it low-passed. The proportional term damps the loop
+        // and the integral one takes out the steady clock offset.
+        level = level < 0.0 ? (double) ready : level + levelSmoothing * ((double) ready - level);
+        const double error = (level - (double) target) / (double) target;
+        integral   = jlimit (-maxCorrection, maxCorrection, integral + integralGain * error);
+        correction = jlimit (-maxCorrection, maxCorrection, integral + proportionalGain * error);
+        drift.set ((float) (correction * 1000000.0));
+
+        if (! read (outputs, numOutputs, numSamples, getNominalRatio() * (1.0 + correction)))
+        {
+            underruns.set (underruns.get() + 1);
+            resetControl();
+            clearChannels (outputs, numOutputs, 0, numSamples);
+        }
+    }
+};
+
+// MARK: Primary
+
+class RedundantAudioOutput::Primary : public AudioIODeviceCallback
+{
+public:
+    Primary (RedundantAudioOutput& o) : owner (o) { }
+
+    void audioDeviceAboutToStart (AudioIODevice* device) override
+    {
+        owner.primarySampleRate.set (device->getCurrentSampleRate());
+        owner.primaryBlockSize.set (device->getCurrentBufferSizeSamples());
+        owner.primaryNumOutputs.set (device->getActiveOutputChannels().countNumberOfSetBits());
+        steadyBlocks = 0;
+
+        // the rate or block size may have changed under a running backup
+        owner.backup->configure();
+
+        // restarting the engine holds the render lock, so the backup can't be
+        // rendering it meanwhile. It stays failed over until then.
+        owner.startEngine (device);
+
+        // a freshly started primary always takes back over from the backup
+        owner.primaryError.set (0);
+        owner.lastPrimaryTime.set (Time::getMillisecondCounter());
+        owner.failedOver.set (0);
+        owner.primaryRunning.set (1);
+    }
+
+    void audioDeviceStopped() override
+    {
+        // an unplugged or closed primary leaves the engine running on the
+        // backup. It only stops when nothing is left to render it
+        owner.primaryRunning.set (0);
+        if (owner.backup->canTakeOver())
+            owner.failedOver.set (1);
+        else
+            owner.stopEngine();
+    }
+
+    void audioDeviceError (const String& message) override
+    {
+        DBG("[EL] primary audio device error: " << message);
+        owner.primaryError.set (1);
+    }
+
+    void audioDeviceIOCallback (const float** inputs, int numInputs,
+                                float** outputs, int numOutputs, int numSamples) override
+    {
+        const uint32 now = Time::getMillisecondCounter();
+        const bool steady = now - owner.lastPrimaryTime.get() <= owner.getStallMs();
+        owner.lastPrimaryTime.set (now);
+
+        if (owner.failedOver.get() != 0)
+        {
+            // a stall the device recovered from on its own: take back over
+            // once callbacks have been on time for a while. Errors stay
+            // latched until the device restarts.
+            steadyBlocks = steady ? steadyBlocks + 1 : 0;
+            if (owner.primaryError.get() != 0 || steadyBlocks < recoverBlocks)
+            {
+                clearChannels (outputs, numOutputs, 0, numSamples);
+                return;
+            }
+
+            steadyBlocks = 0;
+            owner.backup->requestReset();
+            owner.failedOver.set (0);
+            owner.recoveries.set (owner.recoveries.get() + 1);
+        }
+
+        const SpinLock::ScopedTryLockType sl (owner.renderLock);
+        if (! sl.isLocked() || owner.failedOver.get() != 0 || owner.engine == nullptr)
+        {
+            clearChannels (outputs, numOutputs, 0, numSamples);
+            return;
+        }
+
+        owner.engine->audioDeviceIOCallback (inputs, numInputs, outputs, numOutputs, numSamples);
+        owner.backup->push (outputs, numOutputs, numSamples);
+    }
+
+private:
+    RedundantAudioOutput& owner;
+    int steadyBlocks = 0;
+
+    /** Number of on time callbacks before the primary takes back over */
+    static constexpr int recoverBlocks = 256;
+};
+
+// MARK: Redundant Output
+
+RedundantAudioOutput::RedundantAudioOutput()
+{
+    primary.reset (new Primary (*this));
+    backup.reset (new Backup (*this));
+}
+
+RedundantAudioOutput::~RedundantAudioOutput()
+{
+    jassert (! engineStarted);
+    backup.reset();
+    primary.reset();
+}
+
+void RedundantAudioOutput::setEngineCallback (AudioIODeviceCallback* callback)
+{
+    const ScopedLock sl (startStopLock);
+    if (engine == callback)
+        return;
+
+    stopEngine();
+    const SpinLock::ScopedLockType rl (renderLock);
+    engine = callback;
+}
+
+AudioIODeviceCallback& RedundantAudioOutput::getPrimaryCallback()  { return *primary; }
+AudioIODeviceCallback& RedundantAudioOutput::getBackupCallback()   { return *backup; }
+
+RedundantAudioOutput::Status RedundantAudioOutput::getStatus() const
+{
+    Status status;
+    status.backupRunning    = backup->running.get() != 0;
+    status.backupCompatible = backup->compatible.get() != 0;
+    status.failedOver       = failedOver.get() != 0;
+    status.primaryError     = primaryError.get() != 0;
+    status.recoveries       = recoveries.get();
+    status.underruns        = backup->underruns.get();
+    status.overruns         = backup->overruns.get();
+    status.latencySamples   = backup->latency.get();
+    status.driftPPM         = backup->drift.get();
+    return status;
+}
+
+uint32 RedundantAudioOutput::getStallMs() const
+{
+    const double primaryRate = primarySampleRate.get();
+    const int primaryBlock   = primaryBlockSize.get();
+    return primaryRate > 0.0 ? (uint32) jmax (50.0, 4000.0 * primaryBlock / primaryRate) : 50;
+}
+
+void RedundantAudioOutput::startEngine (AudioIODevice* device)
+{
+    const ScopedLock sl (startStopLock);
+    if (engine == nullptr)
+        return;
+
+    // both devices only try the render lock, so while the engine is being
+    // prepared they output silence instead of rendering it
+    const SpinLock::ScopedLockType rl (renderLock);
+    engine->audioDeviceAboutToStart (device);
+    engineStarted = true;
+}
+
+void RedundantAudioOutput::stopEngine()
+{
+    const ScopedLock sl (startStopLock);
+    if (engine == nullptr || ! engineStarted)
+        return;
+    const SpinLock::ScopedLockType rl (renderLock);
+    engineStarted = false;
+    engine->audioDeviceStopped();
+}
+
+}
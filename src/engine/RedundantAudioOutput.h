@@ -0,0 +1,108 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace Element {
+
+/** Drives a primary and a backup audio device from a single engine callback.
+
+    The primary device renders the engine exactly as before and then copies
+    its output into a FIFO. The backup device drains that FIFO through a
+    resampler whose ratio is nudged to keep the FIFO at a target level, which
+    absorbs clock drift between the two interfaces. The primary path gains no
+    latency. The backup is sized again each time the primary starts, so it
+    follows changes to the primary's rate and block size. A backup whose
+    rate is more than four times off the primary's outputs silence and
+    can't take over, Status::backupCompatible reports that.
+
+    If the primary stops calling back, reports an error or is stopped while
+    the backup runs, the backup takes over. It renders the engine itself at
+    the primary's rate and block size and resamples the result. After a
+    stall the primary takes back over once its callbacks have been on time
+    for a few seconds. After an error or a stop it only does so when the
+    device is restarted, Status::primaryError reports errors.
+ */
+class RedundantAudioOutput
+{
+public:
+    struct Status
+    {
+        bool backupRunning     = false;
+        bool backupCompatible  = true;
+        bool failedOver        = false;
+        bool primaryError      = false;
+        int recoveries         = 0;
+        int underruns          = 0;
+        int overruns           = 0;
+        int latencySamples     = 0;
+        float driftPPM         = 0.f;
+    };
+
+    RedundantAudioOutput();
+    ~RedundantAudioOutput();
+
+    /** Sets the engine callback. Only call this while the primary callback
+        is not registered with a device. */
+    void setEngineCallback (AudioIODeviceCallback* callback);
+
+    /** Register this with the primary device (the AudioDeviceManager) */
+    AudioIODeviceCallback& getPrimaryCallback();
+
+    /** Start the backup device with this */
+    AudioIODeviceCallback& getBackupCallback();
+
+    /** Returns current monitoring values */
+    Status getStatus() const;
+
+    /** Returns true if the backup is rendering the engine */
+    bool isFailedOver() const { return failedOver.get() != 0; }
+
+private:
+    class Primary;
+    class Backup;
+    std::unique_ptr<Primary> primary;
+    std::unique_ptr<Backup> backup;
+
+    AudioIODeviceCallback* engine = nullptr;
+    bool engineStarted = false;
+    CriticalSection startStopLock;
+    SpinLock renderLock;
+
+    Atomic<int> primaryRunning { 0 };
+    Atomic<int> primaryError { 0 };
+    Atomic<int> failedOver { 0 };
+    Atomic<int> recoveries { 0 };
+    Atomic<uint32> lastPrimaryTime { 0 };
+    Atomic<int> primaryBlockSize { 0 };
+    Atomic<int> primaryNumOutputs { 0 };
+    Atomic<double> primarySampleRate { 0.0 };
+
+    /** Time without a primary callback that counts as a stall */
+    uint32 getStallMs() const;
+
+    void startEngine (AudioIODevice*);
+    void stopEngine();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RedundantAudioOutput)
+};
+
+}
@@ -0,0 +1,142 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/RenderArena.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/mman.h>
+#endif
+
+namespace Element {
+
+static size_t alignUp (size_t size, size_t boundary) noexcept
+{
+    return (size + boundary - 1) & ~(boundary - 1);
+}
+
+RenderArena::RenderArena() { }
+
+RenderArena::~RenderArena()
+{
+    release();
+}
+
+void* RenderArena::allocateBytes (size_t numBytes) noexcept
+{
+    const size_t offset = used;
+    used += alignUp (jmax ((size_t) 1, numBytes), (size_t) alignment);
+
+    if (region == nullptr)
+        return nullptr;
+
+    // the second pass has to ask for the same sizes as the first
+    jassert (used <= capacity);
+    return used <= capacity ? region + offset : nullptr;
+}
+
+bool RenderArena::commit()
+{
+    jassert (region == nullptr);
+    const size_t size = alignUp (jmax (used, (size_t) alignment), (size_t) 4096);
+
+   #if JUCE_LINUX
+    // explicit huge pages only exist if the system reserved some, otherwise
+    // ask for transparent ones
+    const size_t hugePageSize = 2 * 1024 * 1024;
+    if (size >= hugePageSize)
+    {
+        const size_t hugeSize = alignUp (size, hugePageSize);
+        void* const ptr = mmap (nullptr, hugeSize, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED)
+        {
+            region = static_cast<char*> (ptr);
+            mappedBytes = hugeSize;
+            hugePages = true;
+        }
+    }
+   #endif
+
+   #if JUCE_LINUX || JUCE_MAC
+    if (region == nullptr)
+    {
+        void* const ptr = mmap (nullptr, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED)
+        {
+            region = static_cast<char*> (ptr);
+            mappedBytes = size;
+           #if JUCE_LINUX && defined (MADV_HUGEPAGE)
+            hugePages = madvise (ptr, size, MADV_HUGEPAGE) == 0;
+           #endif
+        }
+    }
+    mapped = region != nullptr;
+   #endif
+
+    if (region == nullptr)
+    {
+        region = static_cast<char*> (std::malloc (size + alignment));
+        if (region == nullptr)
+            return false;
+        mappedBytes = size + alignment;
+    }
+
+    capacity = size;
+
+    // faults every page in now instead of on first touch in the callback
+    char* const start = mapped ? region : region + (alignment - ((size_t) region & (alignment - 1)));
+    std::memset (start, 0, capacity);
+
+   #if JUCE_LINUX || JUCE_MAC
+    // fails quietly when over the memlock limit
+    locked = mapped && mlock (region, mappedBytes) == 0;
+   #endif
+
+    if (! mapped)
+    {
+        // keep the malloc'd pointer to free it, hand out the aligned part
+        allocation = region;
+        region = start;
+    }
+
+    used = 0;
+    return true;
+}
+
+void RenderArena::release()
+{
+   #if JUCE_LINUX || JUCE_MAC
+    if (mapped && region != nullptr)
+    {
+        if (locked)
+            munlock (region, mappedBytes);
+        munmap (region, mappedBytes);
+    }
+   #endif
+
+    if (! mapped)
+        std::free (allocation);
+
+    region = allocation = nullptr;
+    capacity = mappedBytes = used = 0;
+    mapped = hugePages = locked = false;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "ElementApp.h"
+
+namespace Element {
+
+/** One region of memory for everything a compiled graph touches while
+    rendering.
+
+    Memory is laid out in two passes. The first pass makes every allocation
+    to measure the size and gets nullptrs back, commit() then maps the region
+    and the second pass makes the same allocations again for real. Each
+    allocation starts on its own cache line so no two owners share one.
+
+    The region is backed by huge pages where the system has them, zeroed to
+    fault in every page up front and locked in memory when allowed. Nothing
+    is freed until the arena is deleted.
+ */
+class RenderArena
+{
+public:
+    enum { alignment = 64 };
+
+    RenderArena();
+    ~RenderArena();
+
+    /** Allocates the region measured so far and rewinds for the second
+        pass. Returns false if it couldn't be allocated. */
+    bool commit();
+
+    /** Returns true once commit() has succeeded */
+    bool isCommitted() const noexcept       { return region != nullptr; }
+
+    /** Allocates zeroed, cache line aligned memory. Returns nullptr while
+        measuring. */
+    void* allocateBytes (size_t numBytes) noexcept;
+
+    template<typename Type>
+    Type* allocate (int count) noexcept
+    {
+        return static_cast<Type*> (allocateBytes (sizeof (Type) * (size_t) jmax (0, count)));
+    }
+
+    /** Bytes allocated so far in the current pass */
+    size_t getUsedBytes() const noexcept    { return used; }
+
+    /** Returns true if the region is on huge pages */
+    bool isUsingHugePages() const noexcept  { return hugePages; }
+
+    /** Returns true if the region is locked in physical memory */
+    bool isLocked() const noexcept          { return locked; }
+
+private:
+    char* region = nullptr;
+    char* allocation = nullptr;
+    size_t capacity = 0;
+    size_t mappedBytes = 0;
+    size_t used = 0;
+    bool mapped = false;
+    bool hugePages = false;
+    bool locked = false;
+
+    void release();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderArena)
+};
+
+}
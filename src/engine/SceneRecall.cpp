@@ -0,0 +1,432 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/nodes/AudioRouterNode.h"
+#include "engine/SceneRecall.h"
+#include "session/Node.h"
+
+namespace Element {
+
+struct CompiledScene::Router
+{
+    Router (AudioRouterNode& r, const MatrixState& m)
+        : object (&r), router (r), matrix (m), toggles (m) { }
+
+    GraphNodePtr object;
+    AudioRouterNode& router;
+    MatrixState matrix;
+    ToggleGrid toggles;
+    bool pending = false;
+};
+
+CompiledScene::~CompiledScene() { }
+
+ValueTree CompiledScene::capture (const Node& graph, const String& name)
+{
+    ValueTree scene (Tags::scene);
+    scene.setProperty (Tags::name, name, nullptr);
+
+    for (int i = 0; i < graph.getNumNodes(); ++i)
+    {
+        const Node model (graph.getNode (i));
+        GraphNodePtr object = model.getGraphNode();
+        if (object == nullptr || model.isIONode())
+            continue;
+
+        ValueTree node (Tags::node);
+        node.setProperty (Tags::uuid, model.getUuidString(), nullptr)
+            .setProperty (Tags::enabled, object->isEnabled(), nullptr)
+            .setProperty (Tags::mute, object->isMuted(), nullptr);
+
+        if (auto* const proc = object->getAudioProcessor())
+        {
+            const auto& params = proc->getParameters();
+            if (params.size() > 0)
+            {
+                MemoryOutputStream values;
+                for (auto* const param : params)
+                    values.writeFloat (param->getValue());
+                node.setProperty (Tags::parameters, values.getMemoryBlock().toBase64Encoding(), nullptr);
+            }
+        }
+
+        if (dynamic_cast<AudioRouterNode*> (object.get()) != nullptr)
+        {
+            MemoryBlock state;
+            object->getState (state);
+            node.setProperty (Tags::state, state.toBase64Encoding(), nullptr);
+        }
+
+        scene.addChild (node, -1, nullptr);
+    }
+
+    return scene;
+}
+
+CompiledScene::Ptr CompiledScene::compile (const Node& graph, const ValueTree& data)
+{
+    if (graph.getGraphNode() == nullptr || ! data.hasType (Tags::scene))
+        return nullptr;
+
+    Ptr scene (new CompiledScene());
+    scene->name = data.getProperty (Tags::name).toString();
+    const double glide = jmax (0.0, (double) data.getProperty (Tags::glide, 0.0));
+
+    for (int i = 0; i < data.getNumChildren(); ++i)
+    {
+        const auto child (data.getChild (i));
+        if (! child.hasType (Tags::node))
+            continue;
+
+        const Node model (graph.getNodeByUuid (Uuid (child.getProperty (Tags::uuid).toString()), false));
+        GraphNodePtr object = model.getGraphNode();
+        if (object == nullptr)
+            continue;
+
+        NodeTarget target;
+        target.object  = object;
+        target.model   = model.getValueTree();
+        target.enabled = (bool) child.getProperty (Tags::enabled, true);
+        target.muted   = (bool) child.getProperty (Tags::mute, false);
+        scene->nodes.add (target);
+
+        if (auto* const proc = object->getAudioProcessor())
+        {
+            MemoryBlock values;
+            values.fromBase64Encoding (child.getProperty (Tags::parameters).toString());
+            MemoryInputStream stream (values, false);
+
+            const auto& params = proc->getParameters();
+            const int first = scene->parameters.size();
+            for (int p = 0; p < params.size() && stream.getNumBytesRemaining() >= (int64) sizeof (float); ++p)
+            {
+                Parameter parameter;
+                parameter.param         = params.getUnchecked (p);
+                parameter.target        = jlimit (0.f, 1.f, stream.readFloat());
+                parameter.glideSeconds  = glide;
+                scene->parameters.add (parameter);
+            }
+
+            const int numParams = scene->parameters.size() - first;
+            for (int g = 0; g < child.getNumChildren(); ++g)
+            {
+                const auto paramGlide (child.getChild (g));
+                const int index = paramGlide.getProperty (Tags::parameter, -1);
+                if (paramGlide.hasType (Tags::glide) && isPositiveAndBelow (index, numParams))
+                    scene->parameters.getReference (first + index).glideSeconds =
+                        jmax (0.0, (double) paramGlide.getProperty (Tags::value, glide));
+            }
+        }
+
+        if (auto* const router = dynamic_cast<AudioRouterNode*> (object.get()))
+        {
+            MemoryBlock state;
+            state.fromBase64Encoding (child.getProperty (Tags::state).toString());
+            const auto tree = ValueTree::readFromData (state.getData(), state.getSize());
+            if (! tree.isValid())
+                continue;
+
+            MatrixState matrix;
+            matrix.restoreFromValueTree (tree);
+            const auto current (router->getMatrixState());
+            if (matrix.getNumRows() == current.getNumRows() && matrix.getNumColumns() == current.getNumColumns())
+                scene->routers.add (new Router (*router, matrix));
+        }
+    }
+
+    return scene;
+}
+
+void CompiledScene::prepareNodes()
+{
+    for (auto& target : nodes)
+    {
+        if (target.enabled && ! target.object->isEnabled())
+        {
+            // stays silent until the scene is applied and the mute ramps in
+            target.object->mute.set (1);
+            target.object->setEnabled (true);
+        }
+    }
+}
+
+void CompiledScene::abandon (const CompiledScene* newer)
+{
+    for (auto& target : nodes)
+    {
+        // on while its model is off means a scene that never applied turned it on
+        auto* const object = target.object.get();
+        if (! object->isEnabled() || (bool) target.model.getProperty (Tags::enabled, true))
+            continue;
+        if (newer != nullptr && newer->targets (object))
+            continue;
+
+        object->setEnabled (false);
+        object->mute.set ((bool) target.model.getProperty (Tags::mute, false) ? 1 : 0);
+    }
+}
+
+bool CompiledScene::targets (const GraphNode* object) const noexcept
+{
+    for (const auto& target : nodes)
+        if (target.object.get() == object)
+            return true;
+    return false;
+}
+
+void CompiledScene::begin (double sampleRate) noexcept
+{
+    // nodes being turned off are faded out here and disabled in finish()
+    for (auto& target : nodes)
+        target.object->mute.set ((target.muted || ! target.enabled) ? 1 : 0);
+
+    routersPending = routers.size() > 0;
+    for (auto* const router : routers)
+        router->pending = true;
+
+    bool allSettled = true;
+    for (auto& parameter : parameters)
+    {
+        parameter.start = parameter.param->getValue();
+        parameter.position = 0;
+        parameter.glideSamples = jmax (0, roundToInt (parameter.glideSeconds * sampleRate));
+
+        if (parameter.start == parameter.target)
+        {
+            parameter.position = parameter.glideSamples;
+        }
+        else if (parameter.glideSamples == 0)
+        {
+            parameter.param->setValue (parameter.target);
+        }
+        else
+        {
+            allSettled = false;
+        }
+    }
+
+    settled.set (allSettled ? 1 : 0);
+}
+
+void CompiledScene::advance (int numSamples) noexcept
+{
+    if (routersPending)
+    {
+        // a router busy with the UI gets its patches on the next block
+        routersPending = false;
+        for (auto* const router : routers)
+        {
+            if (router->pending)
+                router->pending = ! router->router.trySetToggles (router->toggles);
+            routersPending = routersPending || router->pending;
+        }
+    }
+
+    if (settled.get() == 1)
+        return;
+
+    bool allSettled = true;
+    for (auto& parameter : parameters)
+    {
+        if (parameter.position >= parameter.glideSamples)
+            continue;
+
+        parameter.position = jmin (parameter.glideSamples, parameter.position + numSamples);
+        const float alpha = (float) parameter.position / (float) parameter.glideSamples;
+        parameter.param->setValue (parameter.start + alpha * (parameter.target - parameter.start));
+        allSettled = allSettled && parameter.position >= parameter.glideSamples;
+    }
+
+    settled.set (allSettled ? 1 : 0);
+}
+
+void CompiledScene::finish()
+{
+    for (auto& target : nodes)
+    {
+        auto* const object = target.object.get();
+        if (! target.enabled && object->isEnabled())
+            object->setEnabled (false);
+        object->mute.set (target.muted ? 1 : 0);
+
+        const bool wasMuted = (bool) target.model.getProperty (Tags::mute, false);
+        target.model.setProperty (Tags::enabled, object->isEnabled(), nullptr)
+                    .setProperty (Tags::mute, target.muted, nullptr);
+        if (wasMuted != target.muted)
+            object->muteChanged (object);
+    }
+
+    // keeps the matrix the UI shows in sync, the toggles already match
+    for (auto* const router : routers)
+        router->router.setMatrixState (router->matrix);
+
+    notifyParameters();
+}
+
+void CompiledScene::notifyParameters()
+{
+    for (auto& parameter : parameters)
+    {
+        const float value = parameter.param->getValue();
+        if (value == parameter.notified)
+            continue;
+        parameter.notified = value;
+        parameter.param->sendValueChangedMessageToListeners (value);
+    }
+}
+
+//=============================================================================
+
+SceneRecall::SceneRecall() { }
+
+SceneRecall::~SceneRecall()
+{
+    clear();
+}
+
+bool SceneRecall::recall (CompiledScene::Ptr scene)
+{
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+    collect();
+
+    if (scene == nullptr || requestFifo.getFreeSpace() <= 0)
+        return false;
+
+    scene->prepareNodes();
+    latest = scene;
+
+    // the queue holds its own reference until the scene comes back
+    scene->incReferenceCount();
+    push (requestFifo, requests, { scene.get(), false });
+    ++outstanding;
+    startTimer (25);
+    return true;
+}
+
+void SceneRecall::process (int numSamples, double sampleRate) noexcept
+{
+    // reported a block late so fades have finished before finish() runs
+    if (reportPending)
+    {
+        push (returnFifo, returns, { active, true });
+        reportPending = false;
+    }
+
+    // only the newest request is applied, older ones go back untouched
+    CompiledScene* next = nullptr;
+    Entry entry;
+    while (pop (requestFifo, requests, entry))
+    {
+        if (next != nullptr)
+            push (returnFifo, returns, { next, false });
+        next = entry.scene;
+    }
+
+    if (next != nullptr)
+    {
+        active = next;
+        active->begin (sampleRate);
+        reportPending = true;
+    }
+
+    if (active != nullptr)
+        active->advance (numSamples);
+}
+
+void SceneRecall::clear()
+{
+    stopTimer();
+    collect();
+
+    Entry entry;
+    while (pop (requestFifo, requests, entry))
+    {
+        entry.scene->abandon (nullptr);
+        entry.scene->decReferenceCount();
+    }
+
+    if (reportPending && active != nullptr)
+        active->decReferenceCount();
+
+    active = nullptr;
+    reportPending = false;
+    applied = nullptr;
+    latest = nullptr;
+    outstanding = 0;
+}
+
+void SceneRecall::push (AbstractFifo& fifo, Entry* entries, const Entry& entry) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (1, start1, size1, start2, size2);
+    jassert (size1 + size2 == 1);
+    if (size1 > 0)
+        entries[start1] = entry;
+    else if (size2 > 0)
+        entries[start2] = entry;
+    fifo.finishedWrite (size1 + size2);
+}
+
+bool SceneRecall::pop (AbstractFifo& fifo, Entry* entries, Entry& entry) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (1, start1, size1, start2, size2);
+    if (size1 > 0)
+        entry = entries[start1];
+    else if (size2 > 0)
+        entry = entries[start2];
+    fifo.finishedRead (size1 + size2);
+    return size1 + size2 > 0;
+}
+
+void SceneRecall::collect()
+{
+    Entry entry;
+    while (pop (returnFifo, returns, entry))
+    {
+        --outstanding;
+        CompiledScene::Ptr scene (entry.scene);
+        entry.scene->decReferenceCount();
+
+        if (entry.applied)
+        {
+            applied = scene;
+            scene->finish();
+        }
+        else
+        {
+            scene->abandon (latest.get());
+        }
+    }
+}
+
+void SceneRecall::timerCallback()
+{
+    collect();
+
+    // checked before notifying so the last step of a glide is reported
+    const bool settled = applied == nullptr || applied->isSettled();
+    if (applied != nullptr)
+        applied->notifyParameters();
+
+    if (outstanding <= 0 && settled)
+        stopTimer();
+}
+
+}
@@ -0,0 +1,184 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "ElementApp.h"
+#include "engine/GraphNode.h"
+
+namespace Element {
+
+class Node;
+
+/** A scene resolved against the nodes of a running graph.
+
+    Scenes are stored on a graph's model as a list of nodes by uuid, each
+    with its enablement, mute, parameter values and, for audio routers, the
+    patch matrix. Parameter values are kept as one base64 block of floats per
+    node. A scene can glide its parameters, the scene's glide property is the
+    time in seconds and glide children override it per parameter.
+
+    compile() looks everything up ahead of time so the audio thread only
+    has to walk flat arrays when the scene is recalled.
+ */
+class CompiledScene : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<CompiledScene>;
+
+    ~CompiledScene();
+
+    /** Captures the current state of a graph's nodes as a scene */
+    static ValueTree capture (const Node& graph, const String& name);
+
+    /** Resolves a scene against a running graph. Returns nullptr if the graph
+        isn't running. Call on the message thread. */
+    static Ptr compile (const Node& graph, const ValueTree& scene);
+
+    /** Returns the scene's name */
+    const String& getName() const noexcept { return name; }
+
+    int getNumNodes() const noexcept        { return nodes.size(); }
+    int getNumParameters() const noexcept   { return parameters.size(); }
+
+    /** Returns true once every parameter has reached its target */
+    bool isSettled() const noexcept         { return settled.get() == 1; }
+
+private:
+    friend class SceneRecall;
+    CompiledScene() = default;
+
+    struct NodeTarget
+    {
+        GraphNodePtr object;
+        ValueTree model;
+        bool enabled = true;
+        bool muted = false;
+    };
+
+    struct Parameter
+    {
+        AudioProcessorParameter* param = nullptr;
+        float target = 0.f;
+        float start = 0.f;
+        double glideSeconds = 0.0;
+        int glideSamples = 0;
+        int position = 0;
+        float notified = -1.f;
+    };
+
+    struct Router;
+
+    String name;
+    Array<NodeTarget> nodes;
+    Array<Parameter> parameters;
+    OwnedArray<Router> routers;
+    Atomic<int> settled { 1 };
+    bool routersPending = false;
+
+    /** Prepares nodes the scene turns on, they stay muted until the scene
+        is applied. Message thread. */
+    void prepareNodes();
+
+    /** Turns off again the nodes prepareNodes() turned on, for a scene that
+        was dropped for a newer one. Nodes the newer scene sets are left to
+        it. Message thread. */
+    void abandon (const CompiledScene* newer);
+
+    /** Returns true if the scene sets this node */
+    bool targets (const GraphNode* object) const noexcept;
+
+    /** Applies mutes and patches and starts the parameter glides. Parameters
+        are set without telling listeners. Audio thread. */
+    void begin (double sampleRate) noexcept;
+
+    /** Moves glides and retries busy routers. Audio thread. */
+    void advance (int numSamples) noexcept;
+
+    /** Disables nodes the scene turned off and updates the models once the
+        audio thread has faded them out. Message thread. */
+    void finish();
+
+    /** Tells listeners about parameters that moved since the last call.
+        Message thread. */
+    void notifyParameters();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompiledScene)
+};
+
+/** Recalls scenes on a graph's audio thread.
+
+    Scenes are handed over through a lock free queue and applied at the top
+    of the next block, so a whole scene changes at once. Mutes use the nodes'
+    gain ramps and router patches their crossfades. Scenes come back through
+    a second queue and are only released on the message thread. Parameter
+    listeners are told from a timer while the applied scene glides.
+ */
+class SceneRecall : private Timer
+{
+public:
+    SceneRecall();
+    ~SceneRecall();
+
+    /** Switches to a scene at the start of the next block. Returns false if
+        too many recalls are already waiting. Message thread. */
+    bool recall (CompiledScene::Ptr scene);
+
+    /** Returns the last scene the audio thread applied */
+    CompiledScene::Ptr getAppliedScene() const { return applied; }
+
+    /** Applies waiting scenes and moves glides. Call at the top of each block. */
+    void process (int numSamples, double sampleRate) noexcept;
+
+    /** Releases every scene. The audio thread must not be processing. */
+    void clear();
+
+private:
+    enum { queueSize = 16 };
+
+    struct Entry
+    {
+        CompiledScene* scene = nullptr;
+        bool applied = false;
+    };
+
+    AbstractFifo requestFifo { queueSize };
+    Entry requests [queueSize];
+    // room for every request plus the one being applied
+    AbstractFifo returnFifo { queueSize * 2 + 1 };
+    Entry returns [queueSize * 2 + 1];
+
+    // audio thread
+    CompiledScene* active = nullptr;
+    bool reportPending = false;
+
+    // message thread
+    CompiledScene::Ptr applied;
+    CompiledScene::Ptr latest;
+    int outstanding = 0;
+
+    void push (AbstractFifo&, Entry*, const Entry&) noexcept;
+    bool pop (AbstractFifo&, Entry*, Entry&) noexcept;
+    void collect();
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SceneRecall)
+};
+
+}
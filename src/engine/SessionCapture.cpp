@@ -0,0 +1,380 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/SessionCapture.h"
+#include "session/Node.h"
+
+namespace Element {
+
+const int SessionCapture::magic                     = (int) ByteOrder::littleEndianInt ("ELCP");
+const int SessionCapture::version                   = 2;
+const int SessionCapture::maxEventSize              = 1 << 16;
+const char* const SessionCapture::inputFileName     = "input.wav";
+const char* const SessionCapture::eventsFileName    = "events.dat";
+
+SessionCapture::SessionCapture() { }
+
+SessionCapture::~SessionCapture()
+{
+    stop();
+}
+
+Result SessionCapture::start (const File& dir, double sampleRate, int numInputChannels, const ValueTree& sessionGraphs)
+{
+    if (capturing)
+        return Result::fail ("Already capturing");
+    if (sampleRate <= 0.0)
+        return Result::fail ("The engine isn't running");
+    if (dir.getChildFile (eventsFileName).existsAsFile())
+        return Result::fail ("Directory already has a capture in it");
+    if (! dir.createDirectory())
+        return Result::fail ("Could not create " + dir.getFullPathName());
+
+    directory = dir;
+    numInputs = jmax (0, numInputChannels);
+
+    events.reset (directory.getChildFile (eventsFileName).createOutputStream());
+    if (events == nullptr)
+        return Result::fail ("Could not write the event log");
+
+    events->writeInt (magic);
+    events->writeInt (version);
+    events->writeDouble (sampleRate);
+    events->writeInt (numInputs);
+
+    if (numInputs > 0)
+    {
+        WavAudioFormat wav;
+        auto* stream = directory.getChildFile (inputFileName).createOutputStream();
+        if (auto* writer = wav.createWriterFor (stream, sampleRate, (unsigned int) numInputs, 32, {}, 0))
+        {
+            inputWriter.reset (new AudioFormatWriter::ThreadedWriter (
+                writer, thread, roundToInt (sampleRate * 4.0)));
+        }
+        else
+        {
+            deleteAndZero (stream);
+            events.reset();
+            return Result::fail ("Could not write the input file");
+        }
+    }
+
+    records.calloc ((size_t) fifo.getTotalSize());
+    sysexData.calloc ((size_t) sysexFifo.getTotalSize());
+    inputChannels.calloc ((size_t) jmax (1, numInputs));
+    silence.setSize (1, 8192);
+    silence.clear();
+    fifo.reset();
+    sysexFifo.reset();
+    framesCaptured.store (0);
+    framesWritten = 0;
+    numDropped.store (0);
+
+    graphs = sessionGraphs;
+    graphs.addListener (this);
+    snapshotGraph();
+
+    thread.addTimeSliceClient (this);
+    thread.startThread();
+    capturing = true;
+    return Result::ok();
+}
+
+void SessionCapture::stop()
+{
+    if (! capturing)
+        return;
+
+    capturing = false;
+    graphs.removeListener (this);
+    graphs = ValueTree();
+    cancelPendingUpdate();
+
+    thread.removeTimeSliceClient (this);
+    inputWriter.reset();
+    thread.stopThread (1000);
+
+    {
+        const ScopedLock sl (writeLock);
+        drain();
+        writePending (true);
+        events->flush();
+        events.reset();
+    }
+
+    if (numDropped.load() > 0)
+        DBG("[EL] session capture dropped " << numDropped.load() << " events/blocks");
+}
+
+//==============================================================================
+void SessionCapture::captureBlock (const AudioSampleBuffer& input, const MidiBuffer& midi) noexcept
+{
+    const int numSamples = input.getNumSamples();
+
+    if (inputWriter != nullptr)
+    {
+        const bool canPad = numSamples <= silence.getNumSamples();
+        for (int c = 0; c < numInputs; ++c)
+            inputChannels[c] = c < input.getNumChannels() ? input.getReadPointer (c)
+                                                          : (canPad ? silence.getReadPointer (0) : nullptr);
+
+        if ((input.getNumChannels() < numInputs && ! canPad) || ! inputWriter->write (inputChannels, numSamples))
+            numDropped.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    int numEvents = midi.getNumEvents();
+    if (fifo.getFreeSpace() < 1 + numEvents)
+    {
+        numDropped.fetch_add (numEvents, std::memory_order_relaxed);
+        numEvents = 0;
+    }
+
+    if (fifo.getFreeSpace() < 1)
+    {
+        // losing a whole block throws timing off for the rest of the capture
+        numDropped.fetch_add (1, std::memory_order_relaxed);
+        framesCaptured.fetch_add (numSamples, std::memory_order_release);
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (1 + numEvents, start1, size1, start2, size2);
+    auto at = [&](int i) -> Record& { return records [i < size1 ? start1 + i : start2 + i - size1]; };
+
+    auto& block = at (0);
+    block.type      = blockEvent;
+    block.position  = numSamples;
+
+    int written = 0;
+    if (numEvents > 0)
+    {
+        MidiBuffer::Iterator iter (midi);
+        const uint8* data; int numBytes, position;
+        while (written < numEvents && iter.getNextEvent (data, numBytes, position))
+        {
+            if (numBytes > (int) sizeof (Record::data))
+            {
+                // the bytes are made readable before the record that refers to them
+                if (numBytes > sysexFifo.getFreeSpace())
+                {
+                    numDropped.fetch_add (1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                int s1, n1, s2, n2;
+                sysexFifo.prepareToWrite (numBytes, s1, n1, s2, n2);
+                memcpy (sysexData + s1, data, (size_t) n1);
+                if (n2 > 0)
+                    memcpy (sysexData + s2, data + n1, (size_t) n2);
+                sysexFifo.finishedWrite (n1 + n2);
+            }
+            else
+            {
+                memcpy (at (1 + written).data, data, (size_t) numBytes);
+            }
+
+            auto& record = at (1 + written);
+            record.type     = 0;
+            record.position = position;
+            record.size     = numBytes;
+            ++written;
+        }
+    }
+
+    block.size = written;
+    fifo.finishedWrite (1 + written);
+    framesCaptured.fetch_add (numSamples, std::memory_order_release);
+}
+
+//==============================================================================
+void SessionCapture::capturePlayState (bool playing)
+{
+    MemoryOutputStream out;
+    out.writeBool (playing);
+    addPending (playEvent, out.getMemoryBlock());
+}
+
+void SessionCapture::captureTogglePlayPause()
+{
+    addPending (togglePlayEvent, {});
+}
+
+void SessionCapture::captureSeek (int64 frame)
+{
+    MemoryOutputStream out;
+    out.writeInt64 (frame);
+    addPending (seekEvent, out.getMemoryBlock());
+}
+
+void SessionCapture::captureTempo (double bpm)
+{
+    MemoryOutputStream out;
+    out.writeDouble (bpm);
+    addPending (tempoEvent, out.getMemoryBlock());
+}
+
+void SessionCapture::captureMeter (int beatsPerBar, int beatDivisor)
+{
+    MemoryOutputStream out;
+    out.writeCompressedInt (beatsPerBar);
+    out.writeCompressedInt (beatDivisor);
+    addPending (meterEvent, out.getMemoryBlock());
+}
+
+void SessionCapture::addPending (EventType type, const MemoryBlock& payload)
+{
+    if (! capturing && type != graphEvent)
+        return;
+
+    Pending event;
+    event.frame = framesCaptured.load (std::memory_order_acquire);
+    MemoryOutputStream out (event.data, false);
+    out.writeByte ((char) type);
+    out.write (payload.getData(), payload.getSize());
+    out.flush();
+
+    const ScopedLock sl (pendingLock);
+    pending.add (event);
+}
+
+void SessionCapture::writePending (bool writeAll)
+{
+    const ScopedLock sl (pendingLock);
+    int numWritten = 0;
+    for (const auto& event : pending)
+    {
+        if (! writeAll && event.frame > framesWritten)
+            break;
+        events->write (event.data.getData(), event.data.getSize());
+        ++numWritten;
+    }
+
+    pending.removeRange (0, numWritten);
+}
+
+int SessionCapture::drain()
+{
+    const int numReady = fifo.getNumReady();
+    if (numReady <= 0)
+        return 0;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numReady, start1, size1, start2, size2);
+    auto at = [&](int i) -> const Record& { return records [i < size1 ? start1 + i : start2 + i - size1]; };
+
+    int consumed = 0;
+    while (consumed < numReady)
+    {
+        const auto& block = at (consumed);
+        jassert (block.type == blockEvent);
+
+        writePending (false);
+        events->writeByte ((char) blockEvent);
+        events->writeCompressedInt (block.position);
+        events->writeCompressedInt (block.size);
+        for (int i = 0; i < block.size; ++i)
+        {
+            const auto& midi = at (consumed + 1 + i);
+            events->writeCompressedInt (midi.position);
+            events->writeCompressedInt (midi.size);
+
+            if (midi.size <= (int) sizeof (Record::data))
+            {
+                events->write (midi.data, (size_t) midi.size);
+                continue;
+            }
+
+            int s1, n1, s2, n2;
+            sysexFifo.prepareToRead (midi.size, s1, n1, s2, n2);
+            jassert (n1 + n2 == midi.size);
+            events->write (sysexData + s1, (size_t) n1);
+            if (n2 > 0)
+                events->write (sysexData + s2, (size_t) n2);
+            sysexFifo.finishedRead (n1 + n2);
+        }
+
+        framesWritten += block.position;
+        consumed += 1 + block.size;
+    }
+
+    fifo.finishedRead (consumed);
+    return consumed;
+}
+
+int SessionCapture::useTimeSlice()
+{
+    const ScopedLock sl (writeLock);
+    return drain() > 0 ? 5 : 20;
+}
+
+//==============================================================================
+void SessionCapture::snapshotGraph()
+{
+    const ValueTree graph = graphs.getChild ((int) graphs.getProperty (Tags::active, 0));
+    if (! graph.isValid())
+        return;
+
+    // plugin state isn't in the model until it is asked for
+    Node (graph, false).forEach ([](const ValueTree& tree) {
+        if (tree.hasType (Tags::node))
+            Node (tree, false).savePluginState();
+    });
+
+    ValueTree copy = graph.createCopy();
+    Node::sanitizeProperties (copy, true);
+
+    MemoryBlock data;
+    {
+        MemoryOutputStream tree (data, false);
+        copy.writeToStream (tree);
+    }
+
+    MemoryOutputStream out;
+    out.writeCompressedInt ((int) data.getSize());
+    out << data;
+    addPending (graphEvent, out.getMemoryBlock());
+}
+
+void SessionCapture::handleAsyncUpdate()
+{
+    if (capturing)
+        snapshotGraph();
+}
+
+void SessionCapture::valueTreePropertyChanged (ValueTree& tree, const Identifier& property)
+{
+    if (tree == graphs)
+    {
+        if (property == Tags::active)
+            triggerAsyncUpdate();
+        return;
+    }
+
+    // state is written back by the snapshot itself, the rest is view only
+    static const Array<Identifier> ignored ({
+        Tags::state, Tags::programState, Tags::object,
+        Tags::relativeX, Tags::relativeY, Tags::windowX, Tags::windowY,
+        Tags::windowVisible, Tags::windowOnTop, Tags::collapsed
+    });
+
+    if (! ignored.contains (property))
+        triggerAsyncUpdate();
+}
+
+}
@@ -0,0 +1,159 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace Element {
+
+/** Records what the engine is fed during a live session so it can be
+    replayed offline with SessionReplay.
+
+    A capture is a directory holding the device input as a float wav file and
+    an event log. The log has every callback's block size with the MIDI the
+    graph received in it, plus transport requests and snapshots of the active
+    graph, stamped with the frame they were made at.
+
+    captureBlock() is called on the audio thread and only copies into
+    preallocated fifos, sysex goes through a byte fifo of its own. Everything
+    else is written out on a background thread.
+ */
+class SessionCapture : private TimeSliceClient,
+                       private ValueTree::Listener,
+                       private AsyncUpdater
+{
+public:
+    enum EventType
+    {
+        blockEvent = 1,
+        playEvent,
+        togglePlayEvent,
+        seekEvent,
+        tempoEvent,
+        meterEvent,
+        graphEvent
+    };
+
+    static const int magic;
+    static const int version;
+    /** The largest MIDI event a capture keeps, anything bigger is dropped */
+    static const int maxEventSize;
+    static const char* const inputFileName;
+    static const char* const eventsFileName;
+
+    SessionCapture();
+    ~SessionCapture();
+
+    /** Starts writing a capture into an empty or new directory
+
+        @param directory    Where to write
+        @param sampleRate   The running sample rate
+        @param numInputs    Number of device inputs to record
+        @param graphs       The session's graphs. The active one is snapshot now
+                            and again each time it is edited.
+     */
+    Result start (const File& directory, double sampleRate, int numInputs, const ValueTree& graphs);
+
+    /** Stops and flushes everything to disk */
+    void stop();
+
+    /** Returns true between start() and stop() */
+    bool isCapturing() const { return capturing; }
+
+    /** Returns the directory being written */
+    const File& getDirectory() const { return directory; }
+
+    /** Records one callback's input and MIDI. Audio thread only.
+        The first numInputs channels of the buffer are taken as device input. */
+    void captureBlock (const AudioSampleBuffer& input, const MidiBuffer& midi) noexcept;
+
+    /** Transport requests made on the message thread */
+    void capturePlayState (bool playing);
+    void captureTogglePlayPause();
+    void captureSeek (int64 frame);
+    void captureTempo (double bpm);
+    void captureMeter (int beatsPerBar, int beatDivisor);
+
+    /** Returns the number of frames recorded so far */
+    int64 getNumFramesCaptured() const { return framesCaptured.load(); }
+
+    /** Returns the number of MIDI events and input blocks that didn't fit in
+        the fifos. A capture with drops will not replay exactly. */
+    int getNumDropped() const { return numDropped.load(); }
+
+private:
+    /** Events that fit in data are kept inline, longer ones (sysex) have
+        their bytes in the sysex fifo in the order they were recorded. */
+    struct Record
+    {
+        int32 type;
+        int32 position;
+        int32 size;
+        uint8 data [16];
+    };
+
+    struct Pending
+    {
+        int64 frame;
+        MemoryBlock data;
+    };
+
+    File directory;
+    ValueTree graphs;
+    bool capturing = false;
+    int numInputs = 0;
+
+    TimeSliceThread thread { "Session Capture" };
+    std::unique_ptr<AudioFormatWriter::ThreadedWriter> inputWriter;
+    std::unique_ptr<FileOutputStream> events;
+
+    AbstractFifo fifo { 1 << 14 };
+    HeapBlock<Record> records;
+    AbstractFifo sysexFifo { 1 << 16 };
+    HeapBlock<uint8> sysexData;
+    HeapBlock<const float*> inputChannels;
+    AudioSampleBuffer silence;
+    std::atomic<int64> framesCaptured { 0 };
+    std::atomic<int> numDropped { 0 };
+
+    CriticalSection pendingLock;
+    Array<Pending> pending;
+    CriticalSection writeLock;
+    int64 framesWritten = 0;
+
+    void addPending (EventType type, const MemoryBlock& payload);
+    void writePending (bool writeAll);
+    int drain();
+    void snapshotGraph();
+
+    int useTimeSlice() override;
+    void handleAsyncUpdate() override;
+
+    friend class ValueTree;
+    void valueTreePropertyChanged (ValueTree&, const Identifier&) override;
+    void valueTreeChildAdded (ValueTree&, ValueTree&) override { triggerAsyncUpdate(); }
+    void valueTreeChildRemoved (ValueTree&, ValueTree&, int) override { triggerAsyncUpdate(); }
+    void valueTreeChildOrderChanged (ValueTree&, int, int) override { }
+    void valueTreeParentChanged (ValueTree&) override { }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionCapture)
+};
+
+}
@@ -0,0 +1,408 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "controllers/GraphManager.h"
+#include "engine/AudioEngine.h"
+#include "engine/SessionCapture.h"
+#include "engine/SessionReplay.h"
+#include "session/PluginManager.h"
+#include "Globals.h"
+
+namespace Element {
+
+static const Identifier replayReportType    = "replayReport";
+static const Identifier sampleRateProp      = "sampleRate";
+static const Identifier numFramesProp       = "numFrames";
+static const Identifier numBlocksProp       = "numBlocks";
+static const Identifier numMidiEventsProp   = "numMidiEvents";
+static const Identifier numTransportProp    = "numTransportEvents";
+static const Identifier numGraphEditsProp   = "numGraphEdits";
+static const Identifier numOverBudgetProp   = "numOverBudget";
+static const Identifier outputHashProp      = "outputHash";
+static const Identifier sectionHashesProp   = "sectionHashes";
+static const Identifier callbackTimesProp   = "callbackTimes";
+
+static inline uint64 hashSamples (uint64 hash, const float* data, int numSamples) noexcept
+{
+    // FNV-1a over the sample bits, exact rather than tolerant on purpose
+    for (int i = 0; i < numSamples; ++i)
+    {
+        uint32 bits;
+        memcpy (&bits, data + i, sizeof (bits));
+        hash = (hash ^ bits) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static const uint64 hashSeed = 14695981039346656037ull;
+
+//==============================================================================
+double SessionReplay::Report::getCallbackPercentile (double percentile) const
+{
+    if (callbackTimes.isEmpty())
+        return 0.0;
+    Array<double> sorted (callbackTimes);
+    sorted.sort();
+    const int index = jlimit (0, sorted.size() - 1,
+        roundToInt (percentile / 100.0 * (double) (sorted.size() - 1)));
+    return sorted.getUnchecked (index);
+}
+
+double SessionReplay::Report::getMeanCallbackTime() const
+{
+    if (callbackTimes.isEmpty())
+        return 0.0;
+    double total = 0.0;
+    for (const auto time : callbackTimes)
+        total += time;
+    return total / (double) callbackTimes.size();
+}
+
+int SessionReplay::Report::findFirstDifference (const Report& other) const
+{
+    const int numSections = jmin (sectionHashes.size(), other.sectionHashes.size());
+    for (int i = 0; i < numSections; ++i)
+        if (sectionHashes.getUnchecked (i) != other.sectionHashes.getUnchecked (i))
+            return i;
+    if (sectionHashes.size() != other.sectionHashes.size())
+        return numSections;
+    return outputHash == other.outputHash ? -1 : numSections;
+}
+
+String SessionReplay::Report::toString() const
+{
+    String text;
+    text << "blocks: " << numBlocks << ", frames: " << numFrames;
+    if (sampleRate > 0.0)
+        text << " (" << String ((double) numFrames / sampleRate, 2) << "s)";
+    text << newLine
+         << "midi events: " << numMidiEvents << ", transport events: " << numTransportEvents
+         << ", graph edits: " << numGraphEdits << newLine
+         << "callback us: mean " << String (getMeanCallbackTime(), 1)
+         << ", p50 " << String (getCallbackPercentile (50.0), 1)
+         << ", p95 " << String (getCallbackPercentile (95.0), 1)
+         << ", p99 " << String (getCallbackPercentile (99.0), 1)
+         << ", max " << String (getCallbackPercentile (100.0), 1) << newLine
+         << "over budget: " << numOverBudget << newLine
+         << "output hash: " << String::toHexString ((int64) outputHash);
+    return text;
+}
+
+ValueTree SessionReplay::Report::toValueTree() const
+{
+    ValueTree data (replayReportType);
+    data.setProperty (sampleRateProp,       sampleRate, nullptr)
+        .setProperty (numFramesProp,        numFrames, nullptr)
+        .setProperty (numBlocksProp,        numBlocks, nullptr)
+        .setProperty (numMidiEventsProp,    numMidiEvents, nullptr)
+        .setProperty (numTransportProp,     numTransportEvents, nullptr)
+        .setProperty (numGraphEditsProp,    numGraphEdits, nullptr)
+        .setProperty (numOverBudgetProp,    numOverBudget, nullptr)
+        .setProperty (outputHashProp,       String::toHexString ((int64) outputHash), nullptr);
+
+    MemoryOutputStream hashes;
+    for (const auto hash : sectionHashes)
+        hashes.writeInt64 (hash);
+    data.setProperty (sectionHashesProp, hashes.getMemoryBlock(), nullptr);
+
+    MemoryOutputStream times;
+    for (const auto time : callbackTimes)
+        times.writeFloat ((float) time);
+    data.setProperty (callbackTimesProp, times.getMemoryBlock(), nullptr);
+    return data;
+}
+
+SessionReplay::Report SessionReplay::Report::fromValueTree (const ValueTree& data)
+{
+    Report report;
+    if (! data.hasType (replayReportType))
+        return report;
+
+    report.sampleRate           = (double) data.getProperty (sampleRateProp, 0.0);
+    report.numFrames            = (int64) data.getProperty (numFramesProp, 0);
+    report.numBlocks            = (int) data.getProperty (numBlocksProp, 0);
+    report.numMidiEvents        = (int) data.getProperty (numMidiEventsProp, 0);
+    report.numTransportEvents   = (int) data.getProperty (numTransportProp, 0);
+    report.numGraphEdits        = (int) data.getProperty (numGraphEditsProp, 0);
+    report.numOverBudget        = (int) data.getProperty (numOverBudgetProp, 0);
+    report.outputHash           = (uint64) data.getProperty (outputHashProp).toString().getHexValue64();
+
+    auto readBlock = [&data](const Identifier& property) -> MemoryBlock {
+        const var& value = data.getProperty (property);
+        if (auto* block = value.getBinaryData())
+            return *block;
+        MemoryBlock block;
+        block.fromBase64Encoding (value.toString());
+        return block;
+    };
+
+    {
+        const MemoryBlock block (readBlock (sectionHashesProp));
+        MemoryInputStream hashes (block, false);
+        while (! hashes.isExhausted())
+            report.sectionHashes.add (hashes.readInt64());
+    }
+
+    {
+        const MemoryBlock block (readBlock (callbackTimesProp));
+        MemoryInputStream times (block, false);
+        while (! times.isExhausted())
+            report.callbackTimes.add ((double) times.readFloat());
+    }
+
+    return report;
+}
+
+//==============================================================================
+SessionReplay::SessionReplay() { }
+SessionReplay::~SessionReplay() { }
+
+Result SessionReplay::open (const File& dir)
+{
+    directory = dir;
+    sampleRate = 0.0;
+    numInputs = maxBlockSize = 0;
+    return scan();
+}
+
+Result SessionReplay::scan()
+{
+    FileInputStream events (directory.getChildFile (SessionCapture::eventsFileName));
+    if (! events.openedOk())
+        return Result::fail ("No capture in " + directory.getFullPathName());
+    if (events.readInt() != SessionCapture::magic)
+        return Result::fail ("Not a session capture");
+    if (events.readInt() > SessionCapture::version)
+        return Result::fail ("Capture was made by a newer version");
+
+    sampleRate  = events.readDouble();
+    numInputs   = events.readInt();
+    eventsStart = events.getPosition();
+
+    // block sizes are needed up front to prepare the engine
+    while (! events.isExhausted())
+    {
+        switch ((int) events.readByte())
+        {
+            case SessionCapture::blockEvent:
+            {
+                maxBlockSize = jmax (maxBlockSize, events.readCompressedInt());
+                const int numEvents = events.readCompressedInt();
+                for (int i = 0; i < numEvents; ++i)
+                {
+                    events.readCompressedInt();
+                    events.skipNextBytes (events.readCompressedInt());
+                }
+            } break;
+
+            case SessionCapture::playEvent:         events.skipNextBytes (1); break;
+            case SessionCapture::togglePlayEvent:   break;
+            case SessionCapture::seekEvent:         events.skipNextBytes (8); break;
+            case SessionCapture::tempoEvent:        events.skipNextBytes (8); break;
+            case SessionCapture::meterEvent:        events.readCompressedInt(); events.readCompressedInt(); break;
+            case SessionCapture::graphEvent:        events.skipNextBytes (events.readCompressedInt()); break;
+            default:
+                return Result::fail ("Capture event log is corrupt");
+        }
+    }
+
+    if (sampleRate <= 0.0 || maxBlockSize <= 0)
+        return Result::fail ("Capture is empty");
+    return Result::ok();
+}
+
+Result SessionReplay::run (AudioEngine& engine, Report& report, const Options& options)
+{
+    if (sampleRate <= 0.0 || maxBlockSize <= 0)
+        return Result::fail ("No capture open");
+
+    FileInputStream events (directory.getChildFile (SessionCapture::eventsFileName));
+    if (! events.openedOk())
+        return Result::fail ("Could not read the event log");
+    events.setPosition (eventsStart);
+
+    std::unique_ptr<AudioFormatReader> input;
+    if (numInputs > 0)
+    {
+        WavAudioFormat wav;
+        input.reset (wav.createReaderFor (directory.getChildFile (SessionCapture::inputFileName).createInputStream(), true));
+        if (input == nullptr)
+            return Result::fail ("Could not read the input file");
+    }
+
+    const int numOutputs = jmax (1, options.numOutputs);
+    report = Report();
+    report.sampleRate = sampleRate;
+
+    engine.prepareExternalPlayback (sampleRate, maxBlockSize, numInputs, numOutputs);
+
+    GraphNodePtr holder = GraphNode::createForRoot (new RootGraph());
+    auto* root = dynamic_cast<RootGraph*> (holder->getAudioProcessor());
+    root->setLocked (false);
+    root->setPlayConfigDetails (numInputs, numOutputs, sampleRate, maxBlockSize);
+    root->setRenderMode (RootGraph::SingleGraph);
+    engine.addGraph (root);
+    for (int i = 0; auto* graph = engine.getGraph (i); ++i)
+        if (graph == root)
+            engine.setActiveGraph (i);
+
+    std::unique_ptr<RootGraphManager> manager (new RootGraphManager (*root,
+        engine.getWorld().getPluginManager()));
+    ValueTree model;
+
+    // replays always start stopped at zero
+    engine.setPlaying (false);
+    engine.seekToAudioFrame (0);
+    engine.setTempo (120.0);
+
+    AudioSampleBuffer buffer (jmax (numInputs, numOutputs), maxBlockSize);
+    MidiBuffer midi;
+    MemoryBlock eventData;
+    midi.ensureSize (4096);
+    report.callbackTimes.ensureStorageAllocated (jmax (0, options.maxBlocks));
+
+    const int64 framesPerSection = jmax ((int64) 1, (int64) (options.hashSeconds * sampleRate));
+    uint64 sectionHash = hashSeed;
+    report.outputHash = hashSeed;
+    int64 sectionEnd = framesPerSection;
+    bool sectionHasOutput = false;
+    Result result (Result::ok());
+
+    while (! events.isExhausted() && result.wasOk())
+    {
+        if (options.maxBlocks > 0 && report.numBlocks >= options.maxBlocks)
+            break;
+
+        switch ((int) events.readByte())
+        {
+            case SessionCapture::blockEvent:
+            {
+                const int numSamples = events.readCompressedInt();
+                const int numEvents  = events.readCompressedInt();
+                midi.clear();
+                for (int i = 0; i < numEvents; ++i)
+                {
+                    const int position = events.readCompressedInt();
+                    const int size = events.readCompressedInt();
+                    if (! isPositiveAndNotGreaterThan (size, SessionCapture::maxEventSize))
+                    {
+                        result = Result::fail ("Capture event log is corrupt");
+                        break;
+                    }
+                    eventData.ensureSize ((size_t) size);
+                    events.read (eventData.getData(), size);
+                    midi.addEvent (eventData.getData(), size, position);
+                }
+
+                if (result.failed())
+                    break;
+
+                buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+                buffer.clear();
+                if (input != nullptr)
+                    input->read (&buffer, 0, numSamples, report.numFrames, true, true);
+
+                const int64 started = Time::getHighResolutionTicks();
+                engine.processExternalBuffers (buffer, midi);
+                const double micros = Time::highResolutionTicksToSeconds (
+                    Time::getHighResolutionTicks() - started) * 1000000.0;
+
+                report.callbackTimes.add (micros);
+                if (micros > (double) numSamples / sampleRate * 1000000.0)
+                    ++report.numOverBudget;
+
+                for (int c = 0; c < numOutputs; ++c)
+                {
+                    report.outputHash = hashSamples (report.outputHash, buffer.getReadPointer (c), numSamples);
+                    sectionHash = hashSamples (sectionHash, buffer.getReadPointer (c), numSamples);
+                }
+
+                ++report.numBlocks;
+                report.numMidiEvents += numEvents;
+                report.numFrames += numSamples;
+                sectionHasOutput = true;
+                if (report.numFrames >= sectionEnd)
+                {
+                    report.sectionHashes.add ((int64) sectionHash);
+                    sectionHash = hashSeed;
+                    sectionEnd += framesPerSection;
+                    sectionHasOutput = false;
+                }
+            } break;
+
+            case SessionCapture::playEvent:
+                engine.setPlaying (events.readBool());
+                ++report.numTransportEvents;
+                break;
+            case SessionCapture::togglePlayEvent:
+                engine.togglePlayPause();
+                ++report.numTransportEvents;
+                break;
+            case SessionCapture::seekEvent:
+                engine.seekToAudioFrame (events.readInt64());
+                ++report.numTransportEvents;
+                break;
+            case SessionCapture::tempoEvent:
+                engine.setTempo (events.readDouble());
+                ++report.numTransportEvents;
+                break;
+            case SessionCapture::meterEvent:
+            {
+                const int beatsPerBar = events.readCompressedInt();
+                engine.setMeter (beatsPerBar, events.readCompressedInt());
+                ++report.numTransportEvents;
+            } break;
+
+            case SessionCapture::graphEvent:
+            {
+                MemoryBlock data;
+                events.readIntoMemoryBlock (data, (ssize_t) events.readCompressedInt());
+                model = ValueTree::readFromData (data.getData(), data.getSize());
+                if (! model.isValid())
+                {
+                    result = Result::fail ("Could not read a graph snapshot");
+                    break;
+                }
+
+                model.setProperty (Tags::object, holder.get(), nullptr);
+                manager->setNodeModel (Node (model, false));
+                root->handleUpdateNowIfNeeded();
+                ++report.numGraphEdits;
+            } break;
+
+            default:
+                result = Result::fail ("Capture event log is corrupt");
+                break;
+        }
+    }
+
+    if (sectionHasOutput)
+        report.sectionHashes.add ((int64) sectionHash);
+
+    engine.removeGraph (root);
+    manager->clear();
+    manager.reset();
+    if (model.isValid())
+        Node::sanitizeRuntimeProperties (model, true);
+    holder = nullptr;
+    engine.releaseExternalResources();
+    return result;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace Element {
+
+class AudioEngine;
+
+/** Plays a SessionCapture back through an AudioEngine offline.
+
+    Callbacks are rendered with the same block sizes, input and MIDI as the
+    live session. Transport requests and graph snapshots are applied between
+    the same blocks they were captured at, so two replays of the same capture
+    against the same build produce the same output.
+
+    Graph snapshots are loaded whole, which resets plugin state at each edit.
+    The live session does not, so compare replays with replays rather than
+    with what was heard live.
+ */
+class SessionReplay
+{
+public:
+    struct Options
+    {
+        /** Output channels to render */
+        int numOutputs = 2;
+
+        /** Length of each section hashed separately, so a change can be
+            located in time */
+        double hashSeconds = 1.0;
+
+        /** Stop after this many blocks, zero plays everything */
+        int maxBlocks = 0;
+    };
+
+    struct Report
+    {
+        double sampleRate = 0.0;
+        int64 numFrames = 0;
+        int numBlocks = 0;
+        int numMidiEvents = 0;
+        int numTransportEvents = 0;
+        int numGraphEdits = 0;
+
+        /** Time spent in each callback, in microseconds */
+        Array<double> callbackTimes;
+        /** Number of callbacks that took longer than their block lasts */
+        int numOverBudget = 0;
+
+        /** Hash of all output */
+        uint64 outputHash = 0;
+        /** Hash of each Options::hashSeconds of output */
+        Array<int64> sectionHashes;
+
+        /** Returns the given percentile (0 to 100) of callback times */
+        double getCallbackPercentile (double percentile) const;
+        double getMeanCallbackTime() const;
+
+        /** Returns the index of the first section whose output differs from
+            another report, or -1 if the output is identical */
+        int findFirstDifference (const Report& other) const;
+
+        String toString() const;
+        ValueTree toValueTree() const;
+        static Report fromValueTree (const ValueTree& data);
+    };
+
+    SessionReplay();
+    ~SessionReplay();
+
+    /** Opens a capture directory */
+    Result open (const File& directory);
+
+    /** Returns the sample rate the capture was made at */
+    double getSampleRate() const { return sampleRate; }
+
+    /** Returns the number of device inputs in the capture */
+    int getNumInputs() const { return numInputs; }
+
+    /** Replays the capture from the start. The engine should not be attached
+        to a device or hold other graphs while this runs. */
+    Result run (AudioEngine& engine, Report& report, const Options& options = Options());
+
+private:
+    File directory;
+    double sampleRate = 0.0;
+    int numInputs = 0;
+    int maxBlockSize = 0;
+    int64 eventsStart = 0;
+
+    Result scan();
+};
+
+}
@@ -0,0 +1,1351 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "controllers/GraphManager.h"
+#include "engine/AudioEngine.h"
+#include "engine/SessionReplication.h"
+#include "session/Node.h"
+#include "Globals.h"
+
+namespace Element {
+
+const uint32 Replication::magic     = ByteOrder::littleEndianInt ("ELRP");
+const int Replication::version      = 2;
+
+static void writePath (OutputStream& out, const Array<int>& path)
+{
+    out.writeCompressedInt (path.size());
+    for (const auto index : path)
+        out.writeCompressedInt (index);
+}
+
+static bool readPath (InputStream& in, Array<int>& path)
+{
+    const int size = in.readCompressedInt();
+    if (size < 0 || size > 256)
+        return false;
+    path.clearQuick();
+    for (int i = 0; i < size; ++i)
+        path.add (in.readCompressedInt());
+    return ! in.isExhausted();
+}
+
+static void writeTree (OutputStream& out, const ValueTree& tree)
+{
+    MemoryOutputStream data;
+    tree.writeToStream (data);
+    out.writeCompressedInt ((int) data.getDataSize());
+    out.write (data.getData(), data.getDataSize());
+}
+
+static ValueTree readTree (InputStream& in)
+{
+    const int size = in.readCompressedInt();
+    if (size <= 0 || size > in.getNumBytesRemaining())
+        return ValueTree();
+    MemoryBlock data;
+    in.readIntoMemoryBlock (data, (ssize_t) size);
+    return ValueTree::readFromData (data.getData(), data.getSize());
+}
+
+/** Records the plugin state each node in tree was saved with */
+static void seedStates (const ValueTree& tree, HashMap<String, MemoryBlock>& states)
+{
+    if (tree.hasType (Tags::node) && tree.hasProperty (Tags::state))
+    {
+        MemoryBlock state;
+        state.fromBase64Encoding (tree.getProperty (Tags::state).toString());
+        states.set (tree.getProperty (Tags::uuid).toString(), state);
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        seedStates (tree.getChild (i), states);
+}
+
+/** Sets the state property of each node in tree to what states holds for it */
+static void writeStates (ValueTree tree, const HashMap<String, MemoryBlock>& states)
+{
+    if (tree.hasType (Tags::node))
+    {
+        const auto uuid = tree.getProperty (Tags::uuid).toString();
+        if (states.contains (uuid))
+            tree.setProperty (Tags::state, states[uuid].toBase64Encoding(), nullptr);
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        writeStates (tree.getChild (i), states);
+}
+
+bool Replication::writeStateDiff (const MemoryBlock& previous, const MemoryBlock& current, OutputStream& out)
+{
+    const int size = (int) current.getSize();
+    const int previousSize = (int) previous.getSize();
+    const auto* const was = static_cast<const uint8*> (previous.getData());
+    const auto* const now = static_cast<const uint8*> (current.getData());
+
+    Array<int> changed;
+    for (int offset = 0; offset < size; offset += stateChunkSize)
+    {
+        const int length = jmin ((int) stateChunkSize, size - offset);
+        if (offset + length > previousSize || memcmp (was + offset, now + offset, (size_t) length) != 0)
+            changed.add (offset / stateChunkSize);
+    }
+
+    if (changed.isEmpty() && size == previousSize)
+        return false;
+
+    out.writeCompressedInt (size);
+    out.writeCompressedInt (changed.size());
+    for (const auto chunk : changed)
+    {
+        const int offset = chunk * stateChunkSize;
+        out.writeCompressedInt (chunk);
+        out.write (now + offset, (size_t) jmin ((int) stateChunkSize, size - offset));
+    }
+
+    return true;
+}
+
+bool Replication::applyStateDiff (MemoryBlock& state, InputStream& in)
+{
+    const int size = in.readCompressedInt();
+    const int numChunks = in.readCompressedInt();
+    if (size < 0 || numChunks < 0 || numChunks > size / stateChunkSize + 1)
+        return false;
+
+    state.setSize ((size_t) size, true);
+    auto* const data = static_cast<uint8*> (state.getData());
+    for (int i = 0; i < numChunks; ++i)
+    {
+        const int offset = in.readCompressedInt() * stateChunkSize;
+        if (! isPositiveAndBelow (offset, size))
+            return false;
+        const int length = jmin ((int) stateChunkSize, size - offset);
+        if (in.read (data + offset, length) != length)
+            return false;
+    }
+
+    return true;
+}
+
+bool Replication::getPath (const ValueTree& root, ValueTree tree, Array<int>& path)
+{
+    path.clearQuick();
+    while (tree.isValid() && tree != root)
+    {
+        const auto parent (tree.getParent());
+        if (! parent.isValid())
+            return false;
+        path.insert (0, parent.indexOf (tree));
+        tree = parent;
+    }
+
+    return tree.isValid();
+}
+
+ValueTree Replication::findTree (const ValueTree& root, const Array<int>& path)
+{
+    ValueTree tree (root);
+    for (const auto index : path)
+    {
+        if (! isPositiveAndBelow (index, tree.getNumChildren()))
+            return ValueTree();
+        tree = tree.getChild (index);
+    }
+    return tree;
+}
+
+MemoryBlock Replication::encodeSignal (RecordType type)
+{
+    MemoryOutputStream out;
+    out.writeByte (0);
+    out.writeCompressedInt (1);
+    out.writeByte ((char) type);
+    return out.getMemoryBlock();
+}
+
+int Replication::getSignal (const MemoryBlock& batch)
+{
+    if (batch.getSize() > 8)
+        return 0;
+
+    for (const auto type : { heartbeatRecord, fenceRecord, fenceAckRecord })
+        if (batch == encodeSignal (type))
+            return type;
+
+    return 0;
+}
+
+//=============================================================================
+class ReplicationLeader::Link : public InterprocessConnection
+{
+public:
+    Link (ReplicationLeader& l)
+        : InterprocessConnection (false, Replication::magic),
+          leader (l) { }
+
+    ~Link()
+    {
+        disconnect();
+    }
+
+    // called on the connection's thread, the snapshot is sent from the message thread
+    void connectionMade() override
+    {
+        snapshotDue.set (1);
+        leader.triggerAsyncUpdate();
+    }
+
+    void connectionLost() override      { lost.set (1); }
+
+    void messageReceived (const MemoryBlock& message) override
+    {
+        if (Replication::getSignal (message) == Replication::fenceRecord)
+            leader.fence (*this);
+    }
+
+    /** Sends from any thread, one message at a time */
+    bool send (const MemoryBlock& batch)
+    {
+        const ScopedLock sl (sendLock);
+        return sendMessage (batch);
+    }
+
+    bool isLive() const { return ready.get() == 1 && lost.get() == 0; }
+
+    ReplicationLeader& leader;
+    CriticalSection sendLock;
+    Atomic<int> snapshotDue { 0 };
+    Atomic<int> ready { 0 };
+    Atomic<int> lost { 0 };
+};
+
+//=============================================================================
+class ReplicationLeader::Heartbeat : public Thread
+{
+public:
+    Heartbeat (ReplicationLeader& l)
+        : Thread ("el.replication.heartbeat"),
+          leader (l) { }
+
+    ~Heartbeat()
+    {
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+        uint32 lastRendered = 0;
+        while (! threadShouldExit())
+        {
+            wait (batchInterval);
+            if (threadShouldExit() || leader.isFenced())
+                continue;
+
+            if (leader.engine != nullptr)
+            {
+                // a stalled audio callback goes quiet here, whatever the
+                // message thread is doing
+                const auto rendered = leader.engine->getNumBlocksRendered();
+                if (rendered == lastRendered)
+                    continue;
+                lastRendered = rendered;
+            }
+
+            leader.sendHeartbeat();
+        }
+    }
+
+private:
+    ReplicationLeader& leader;
+};
+
+//=============================================================================
+/** Notes when a node's processor reports a parameter or state change, so
+    its state is only read back when it may differ */
+class ReplicationLeader::StateWatch : private AudioProcessorListener
+{
+public:
+    StateWatch (const String& nodeUuid, GraphNode* node)
+        : uuid (nodeUuid), object (node)
+    {
+        if (auto* const proc = object->getAudioProcessor())
+            proc->addListener (this);
+    }
+
+    ~StateWatch()
+    {
+        if (auto* const proc = object->getAudioProcessor())
+            proc->removeListener (this);
+    }
+
+    /** Returns true if the processor changed since this was last called */
+    bool takeChanged() { return changed.compareAndSetBool (0, 1); }
+
+    const String uuid;
+    const GraphNodePtr object;
+    bool seen = false;
+
+private:
+    Atomic<int> changed { 1 };
+
+    // parameter changes can come from any thread, the audio thread included
+    void audioProcessorParameterChanged (AudioProcessor*, int, float) override { changed.set (1); }
+    void audioProcessorChanged (AudioProcessor*) override { changed.set (1); }
+};
+
+//=============================================================================
+ReplicationLeader::ReplicationLeader() { }
+
+ReplicationLeader::~ReplicationLeader()
+{
+    stop();
+}
+
+void ReplicationLeader::attach (AudioEngine& e)
+{
+    jassert (! isRunning());
+    engine = &e;
+}
+
+Result ReplicationLeader::start (int port, const ValueTree& data, const String& bindAddress)
+{
+    if (isRunning())
+        return Result::fail ("Already replicating");
+    if (! data.isValid())
+        return Result::fail ("There is no session to replicate");
+    if (! beginWaitingForSocket (port, bindAddress))
+        return Result::fail ("Could not listen on " + (bindAddress.isNotEmpty() ? bindAddress : String ("port")) + ":" + String (port));
+
+    session = data;
+    session.addListener (this);
+    fencedOff.set (0);
+    fenceAnnounced = false;
+    startTimer (batchInterval);
+    heartbeat.reset (new Heartbeat (*this));
+    heartbeat->startThread();
+    return Result::ok();
+}
+
+void ReplicationLeader::stop()
+{
+    stopTimer();
+    heartbeat.reset();
+    InterprocessConnectionServer::stop();
+
+    {
+        const ScopedLock sl (linksLock);
+        links.clear();
+    }
+
+    cancelPendingUpdate();
+    watches.clear();
+    session.removeListener (this);
+    session = ValueTree();
+    pending.clearQuick();
+    firstCoalescable = 0;
+    states.clear();
+}
+
+int ReplicationLeader::getNumFollowers() const
+{
+    const ScopedLock sl (linksLock);
+    int numFollowers = 0;
+    for (auto* const link : links)
+        if (link->isLive())
+            ++numFollowers;
+    return numFollowers;
+}
+
+bool ReplicationLeader::hasFollowers() const
+{
+    return getNumFollowers() > 0;
+}
+
+InterprocessConnection* ReplicationLeader::createConnectionObject()
+{
+    // server thread, the snapshot is sent once the connection reaches the message thread
+    auto* const link = new Link (*this);
+    const ScopedLock sl (linksLock);
+    return links.add (link);
+}
+
+void ReplicationLeader::removeLostLinks()
+{
+    const ScopedLock sl (linksLock);
+    for (int i = links.size(); --i >= 0;)
+        if (links.getUnchecked(i)->lost.get() == 1)
+            links.remove (i);
+}
+
+void ReplicationLeader::sendDueSnapshots()
+{
+    // links are only removed on this thread, so these stay valid
+    Array<Link*> due;
+    {
+        const ScopedLock sl (linksLock);
+        for (auto* const link : links)
+            if (link->snapshotDue.compareAndSetBool (0, 1))
+                due.add (link);
+    }
+
+    for (auto* const link : due)
+        sendSnapshot (*link);
+}
+
+void ReplicationLeader::fence (Link& link)
+{
+    // connection thread. A follower is going live, this side stops being
+    // heard before it says so
+    if (engine != nullptr)
+        engine->setStandby (true);
+    fencedOff.set (1);
+    link.send (Replication::encodeSignal (Replication::fenceAckRecord));
+    triggerAsyncUpdate();
+}
+
+void ReplicationLeader::handleAsyncUpdate()
+{
+    sendDueSnapshots();
+
+    if (fencedOff.get() == 1 && ! fenceAnnounced)
+    {
+        fenceAnnounced = true;
+        fenced();
+    }
+}
+
+//=============================================================================
+void ReplicationLeader::sendPlayState (bool playing)
+{
+    MemoryOutputStream out;
+    out.writeBool (playing);
+    add (Replication::playRecord, out.getMemoryBlock());
+}
+
+void ReplicationLeader::sendTogglePlayPause()
+{
+    add (Replication::togglePlayRecord, {});
+}
+
+void ReplicationLeader::sendSeek (int64 frame)
+{
+    MemoryOutputStream out;
+    out.writeInt64 (frame);
+    add (Replication::seekRecord, out.getMemoryBlock());
+}
+
+void ReplicationLeader::sendTempo (double bpm)
+{
+    MemoryOutputStream out;
+    out.writeDouble (bpm);
+    add (Replication::tempoRecord, out.getMemoryBlock());
+}
+
+void ReplicationLeader::sendMeter (int beatsPerBar, int beatDivisor)
+{
+    MemoryOutputStream out;
+    out.writeCompressedInt (beatsPerBar);
+    out.writeCompressedInt (beatDivisor);
+    add (Replication::meterRecord, out.getMemoryBlock());
+}
+
+void ReplicationLeader::sendScene (const Node& graph, const String& name)
+{
+    MemoryOutputStream out;
+    out.writeString (graph.getUuidString());
+    out.writeString (name);
+    add (Replication::sceneRecord, out.getMemoryBlock());
+}
+
+void ReplicationLeader::add (Replication::RecordType type, const MemoryBlock& data)
+{
+    if (! hasFollowers())
+        return;
+
+    Pending record;
+    record.type = type;
+    MemoryOutputStream out (record.data, false);
+    out.writeByte ((char) type);
+    out << data;
+    out.flush();
+    pending.add (record);
+}
+
+void ReplicationLeader::addStructural (Replication::RecordType type, const Array<int>& path, const MemoryBlock& data)
+{
+    Pending record;
+    record.type = type;
+    MemoryOutputStream out (record.data, false);
+    out.writeByte ((char) type);
+    writePath (out, path);
+    out << data;
+    out.flush();
+    pending.add (record);
+
+    // paths recorded before this may not point at the same trees anymore
+    firstCoalescable = pending.size();
+}
+
+//=============================================================================
+void ReplicationLeader::flush()
+{
+    if (stateInterval > 0)
+        checkStates (true);
+    sendPending();
+}
+
+ReplicationLeader::StateWatch* ReplicationLeader::getWatch (const String& uuid, GraphNode* object)
+{
+    for (auto* const watch : watches)
+        if (watch->uuid == uuid && watch->object == object)
+            return watch;
+    return watches.add (new StateWatch (uuid, object));
+}
+
+void ReplicationLeader::checkStates (bool allNodes)
+{
+    for (auto* const watch : watches)
+        watch->seen = false;
+
+    const auto graphs = session.getChildWithName (Tags::graphs);
+    for (int i = 0; i < graphs.getNumChildren(); ++i)
+    {
+        Node (graphs.getChild (i), false).forEach ([this, allNodes](const ValueTree& tree) {
+            if (! tree.hasType (Tags::node))
+                return;
+
+            const Node node (tree, false);
+            GraphNodePtr object = node.getGraphNode();
+            auto* const proc = object != nullptr && object->isPrepared ? object->getAudioProcessor() : nullptr;
+            const auto uuid = node.getUuidString();
+            if (proc == nullptr || object->isSubGraph() || uuid.isEmpty())
+                return;
+
+            // asking a plugin for its state can be slow, only ask the ones
+            // that reported a change unless every node is due
+            auto* const watch = getWatch (uuid, object.get());
+            watch->seen = true;
+            if (! watch->takeChanged() && ! allNodes)
+                return;
+
+            MemoryBlock state;
+            proc->getStateInformation (state);
+
+            MemoryOutputStream out;
+            out.writeString (uuid);
+            // kept current without followers too, snapshots are written from it
+            if (Replication::writeStateDiff (states[uuid], state, out))
+            {
+                add (Replication::stateRecord, out.getMemoryBlock());
+                states.set (uuid, state);
+            }
+        });
+    }
+
+    // nodes that went away are let go here
+    for (int i = watches.size(); --i >= 0;)
+        if (! watches.getUnchecked(i)->seen)
+            watches.remove (i);
+}
+
+void ReplicationLeader::sendSnapshot (Link& link)
+{
+    if (! isRunning() || link.lost.get() == 1)
+        return;
+
+    if (stateInterval > 0)
+    {
+        checkStates (true);
+    }
+    else
+    {
+        // plugin state isn't in the model until it is asked for
+        const auto graphs = session.getChildWithName (Tags::graphs);
+        for (int i = 0; i < graphs.getNumChildren(); ++i)
+            Node (graphs.getChild (i), false).forEach ([](const ValueTree& tree) {
+                if (tree.hasType (Tags::node))
+                    Node (tree, false).savePluginState();
+            });
+    }
+
+    // followers already in sync get what's pending first, the snapshot has it
+    sendPending();
+
+    ValueTree copy = session.createCopy();
+    Node::sanitizeProperties (copy, true);
+    if (stateInterval > 0)
+        writeStates (copy, states);
+
+    MemoryOutputStream out;
+    out.writeByte ((char) Replication::snapshotRecord);
+    out.writeCompressedInt (Replication::version);
+    writeTree (out, copy);
+
+    Array<MemoryBlock> records;
+    records.add (out.getMemoryBlock());
+    const auto batch = encodeBatch (records);
+    if (link.send (batch))
+    {
+        link.ready.set (1);
+        numBytesSent += (int64) batch.getSize();
+    }
+}
+
+void ReplicationLeader::sendPending()
+{
+    if (pending.isEmpty())
+        return;
+
+    Array<MemoryBlock> records;
+    records.ensureStorageAllocated (pending.size());
+    for (const auto& record : pending)
+        records.add (record.data);
+    pending.clearQuick();
+    firstCoalescable = 0;
+
+    send (encodeBatch (records));
+}
+
+void ReplicationLeader::send (const MemoryBlock& batch)
+{
+    const ScopedLock sl (linksLock);
+    for (auto* const link : links)
+        if (link->isLive() && link->send (batch))
+            numBytesSent += (int64) batch.getSize();
+    ++numBatchesSent;
+}
+
+MemoryBlock ReplicationLeader::encodeBatch (const Array<MemoryBlock>& records)
+{
+    MemoryOutputStream body;
+    body.writeCompressedInt (records.size());
+    for (const auto& record : records)
+        body << record;
+
+    MemoryOutputStream out;
+    if (body.getDataSize() > (size_t) Replication::compressAbove)
+    {
+        MemoryOutputStream zipped;
+        {
+            GZIPCompressorOutputStream gzip (zipped);
+            gzip.write (body.getData(), body.getDataSize());
+        }
+
+        if (zipped.getDataSize() < body.getDataSize())
+        {
+            out.writeByte ((char) Replication::compressedFlag);
+            out.write (zipped.getData(), zipped.getDataSize());
+            return out.getMemoryBlock();
+        }
+    }
+
+    out.writeByte (0);
+    out.write (body.getData(), body.getDataSize());
+    return out.getMemoryBlock();
+}
+
+void ReplicationLeader::timerCallback()
+{
+    removeLostLinks();
+    if (! hasFollowers())
+    {
+        pending.clearQuick();
+        firstCoalescable = 0;
+        watches.clear();
+        return;
+    }
+
+    const uint32 now = Time::getMillisecondCounter();
+    if (stateInterval > 0 && now - lastStateCheck >= (uint32) stateInterval)
+    {
+        // plugins that never report their changes are still caught, later
+        const bool allNodes = now - lastFullStateCheck >= (uint32) fullStateInterval;
+        if (allNodes)
+            lastFullStateCheck = now;
+        lastStateCheck = now;
+        checkStates (allNodes);
+    }
+
+    if (transport != nullptr && transport->playing.get() && now - lastPosition >= (uint32) positionInterval)
+    {
+        lastPosition = now;
+        MemoryOutputStream out;
+        out.writeBool (true);
+        out.writeInt64 (transport->positionFrames.get());
+        add (Replication::positionRecord, out.getMemoryBlock());
+    }
+
+    sendPending();
+}
+
+void ReplicationLeader::sendHeartbeat()
+{
+    const auto batch = Replication::encodeSignal (Replication::heartbeatRecord);
+    const ScopedLock sl (linksLock);
+    for (auto* const link : links)
+        if (link->isLive() && link->send (batch))
+            numBytesSent += (int64) batch.getSize();
+}
+
+//=============================================================================
+void ReplicationLeader::valueTreePropertyChanged (ValueTree& tree, const Identifier& property)
+{
+    // state goes out as diffs, the rest is runtime only
+    static const Array<Identifier> ignored ({
+        Tags::object, Tags::state, Tags::programState,
+        Tags::offline, Tags::placeholder, Tags::missing
+    });
+
+    if (ignored.contains (property) || ! hasFollowers())
+        return;
+
+    Array<int> path;
+    if (! Replication::getPath (session, tree, path))
+        return;
+
+    const bool removed = ! tree.hasProperty (property);
+    const var value (tree.getProperty (property));
+    if (value.isObject() || value.isMethod())
+        return;
+
+    // a newer value for the same property replaces the one waiting
+    for (int i = pending.size(); --i >= firstCoalescable;)
+    {
+        const auto& record = pending.getReference (i);
+        if ((record.type == Replication::propertyRecord || record.type == Replication::propertyRemovedRecord)
+                && record.property == property && record.path == path)
+        {
+            pending.remove (i);
+            break;
+        }
+    }
+
+    Pending record;
+    record.type     = removed ? Replication::propertyRemovedRecord : Replication::propertyRecord;
+    record.path     = path;
+    record.property = property;
+    MemoryOutputStream out (record.data, false);
+    out.writeByte ((char) record.type);
+    writePath (out, path);
+    out.writeString (property.toString());
+    if (! removed)
+        value.writeToStream (out);
+    out.flush();
+    pending.add (record);
+}
+
+void ReplicationLeader::valueTreeChildAdded (ValueTree& parent, ValueTree& child)
+{
+    Array<int> path;
+    if (! hasFollowers() || ! Replication::getPath (session, parent, path))
+        return;
+
+    ValueTree copy = child.createCopy();
+    Node::sanitizeProperties (copy, true);
+    seedStates (copy, states);
+
+    MemoryOutputStream out;
+    out.writeCompressedInt (parent.indexOf (child));
+    writeTree (out, copy);
+    addStructural (Replication::childAddedRecord, path, out.getMemoryBlock());
+}
+
+void ReplicationLeader::valueTreeChildRemoved (ValueTree& parent, ValueTree&, int index)
+{
+    Array<int> path;
+    if (! hasFollowers() || ! Replication::getPath (session, parent, path))
+        return;
+
+    MemoryOutputStream out;
+    out.writeCompressedInt (index);
+    addStructural (Replication::childRemovedRecord, path, out.getMemoryBlock());
+}
+
+void ReplicationLeader::valueTreeChildOrderChanged (ValueTree& parent, int oldIndex, int newIndex)
+{
+    Array<int> path;
+    if (! hasFollowers() || ! Replication::getPath (session, parent, path))
+        return;
+
+    MemoryOutputStream out;
+    out.writeCompressedInt (oldIndex);
+    out.writeCompressedInt (newIndex);
+    addStructural (Replication::childMovedRecord, path, out.getMemoryBlock());
+}
+
+//=============================================================================
+struct ReplicationFollower::Standby
+{
+    GraphNodePtr holder;
+    std::unique_ptr<RootGraphManager> manager;
+    ValueTree model;
+
+    RootGraph* getRootGraph() const
+    {
+        return holder != nullptr ? dynamic_cast<RootGraph*> (holder->getAudioProcessor()) : nullptr;
+    }
+};
+
+ReplicationFollower::ReplicationFollower()
+    : InterprocessConnection (false, Replication::magic),
+      Thread ("el.replication.watchdog") { }
+
+ReplicationFollower::~ReplicationFollower()
+{
+    leaving.set (1);
+    stopThread (1000);
+    InterprocessConnection::disconnect();
+    cancelPendingUpdate();
+    unloadGraphs();
+}
+
+void ReplicationFollower::attach (AudioEngine& e)
+{
+    jassert (! isConnected());
+    engine = &e;
+}
+
+Result ReplicationFollower::connect (const String& host, int port, int timeoutMillis)
+{
+    if (isConnected())
+        return Result::fail ("Already following a leader");
+
+    stopThread (1000);
+    leaving.set (0);
+    following.set (0);
+    takenOver.set (0);
+    fencing.set (0);
+    announced = false;
+    if (! connectToSocket (host, port, timeoutMillis))
+        return Result::fail ("Could not connect to " + host + ":" + String (port));
+
+    if (engine != nullptr)
+        engine->setStandby (true);
+    lastReceived.set (Time::getMillisecondCounter());
+    startThread();
+    return Result::ok();
+}
+
+void ReplicationFollower::disconnect()
+{
+    leaving.set (1);
+    stopThread (1000);
+    InterprocessConnection::disconnect();
+    cancelPendingUpdate();
+    {
+        const ScopedLock sl (inboxLock);
+        inbox.clearQuick();
+    }
+    following.set (0);
+    unloadGraphs();
+    if (engine != nullptr)
+        engine->setStandby (false);
+}
+
+bool ReplicationFollower::claimTakeover()
+{
+    if (following.get() == 0 || leaving.get() == 1)
+        return false;
+    if (! takenOver.compareAndSetBool (1, 0))
+        return false;
+
+    // the standby graphs are already running, this lets them be heard
+    if (engine != nullptr)
+        engine->setStandby (false);
+    return true;
+}
+
+void ReplicationFollower::connectionLost()
+{
+    // connection thread, a closed connection needs no fence
+    if (claimTakeover())
+        triggerAsyncUpdate();
+    following.set (0);
+}
+
+void ReplicationFollower::run()
+{
+    uint32 fencedAt = 0;
+    while (! threadShouldExit())
+    {
+        const int timeout = leaderTimeout.get();
+        wait (timeout > 0 ? jlimit (5, 50, timeout / 4) : 50);
+        if (timeout <= 0 || following.get() == 0)
+            continue;
+
+        const uint32 now = Time::getMillisecondCounter();
+        if (fencing.get() == 0)
+        {
+            if (now - lastReceived.get() <= (uint32) timeout)
+                continue;
+
+            // the leader's audio went quiet. It is asked to go silent first,
+            // the acknowledgement arrives in messageReceived
+            fencedAt = now;
+            fencing.set (1);
+            sendMessage (Replication::encodeSignal (Replication::fenceRecord));
+        }
+        else if (now - fencedAt > (uint32) timeout && claimTakeover())
+        {
+            // no answer either, the leader or the network is gone
+            triggerAsyncUpdate();
+            return;
+        }
+    }
+}
+
+void ReplicationFollower::handleAsyncUpdate()
+{
+    Array<MemoryBlock> batches;
+    {
+        const ScopedLock sl (inboxLock);
+        batches.swapWith (inbox);
+    }
+
+    for (const auto& batch : batches)
+    {
+        if (takenOver.get() == 1 || leaving.get() == 1)
+            break;
+
+        MemoryInputStream in (batch, false);
+        if (! applyBatch (in))
+            DBG("[EL] replication batch " << numBatchesReceived << " could not be applied");
+        ++numBatchesReceived;
+    }
+
+    if (takenOver.get() == 0 || announced)
+        return;
+
+    // the leader may still be alive but stuck, stop listening to it. The
+    // graphs stay loaded, they are the ones being heard now
+    announced = true;
+    leaving.set (1);
+    InterprocessConnection::disconnect();
+    following.set (0);
+    takeover();
+}
+
+void ReplicationFollower::messageReceived (const MemoryBlock& message)
+{
+    // connection thread. Liveness is decided here, the rest waits for the
+    // message thread
+    if (takenOver.get() == 1)
+        return;
+
+    switch (Replication::getSignal (message))
+    {
+        case Replication::heartbeatRecord:
+            lastReceived.set (Time::getMillisecondCounter());
+            return;
+
+        case Replication::fenceAckRecord:
+            // the leader holds its output silent now, this side can be heard
+            if (fencing.get() == 1 && claimTakeover())
+                triggerAsyncUpdate();
+            return;
+
+        case Replication::fenceRecord:
+            return;
+
+        default:
+            break;
+    }
+
+    {
+        const ScopedLock sl (inboxLock);
+        inbox.add (message);
+    }
+
+    triggerAsyncUpdate();
+}
+
+bool ReplicationFollower::applyBatch (InputStream& in)
+{
+    const int flags = (int) (uint8) in.readByte();
+    MemoryBlock data;
+    if ((flags & Replication::compressedFlag) != 0)
+    {
+        GZIPDecompressorInputStream gzip (in);
+        gzip.readIntoMemoryBlock (data);
+    }
+    else
+    {
+        in.readIntoMemoryBlock (data);
+    }
+
+    MemoryInputStream records (data, false);
+    const int numRecords = records.readCompressedInt();
+    BigInteger dirtyGraphs;
+    bool rebuildAll = false;
+    bool ok = true;
+
+    for (int i = 0; i < numRecords && ok; ++i)
+        ok = applyRecord (records, dirtyGraphs, rebuildAll);
+
+    if (engine != nullptr && following.get() == 1)
+    {
+        if (rebuildAll)
+        {
+            loadGraphs();
+        }
+        else
+        {
+            for (int i = dirtyGraphs.findNextSetBit (0); i >= 0; i = dirtyGraphs.findNextSetBit (i + 1))
+                reloadGraph (i);
+        }
+    }
+
+    return ok;
+}
+
+bool ReplicationFollower::applyRecord (InputStream& in, BigInteger& dirtyGraphs, bool& rebuildAll)
+{
+    Array<int> path;
+    const int type = (int) in.readByte();
+
+    switch (type)
+    {
+        case Replication::snapshotRecord:
+        {
+            if (in.readCompressedInt() != Replication::version)
+                return false;
+            const auto data = readTree (in);
+            if (! data.isValid())
+                return false;
+            applySnapshot (data);
+        } break;
+
+        case Replication::propertyRecord:
+        case Replication::propertyRemovedRecord:
+        {
+            if (! readPath (in, path))
+                return false;
+            const Identifier property (in.readString());
+            ValueTree tree (Replication::findTree (session, path));
+            if (type == Replication::propertyRecord)
+            {
+                const var value (var::readFromStream (in));
+                if (! tree.isValid())
+                    return false;
+                tree.setProperty (property, value, nullptr);
+            }
+            else
+            {
+                if (! tree.isValid())
+                    return false;
+                tree.removeProperty (property, nullptr);
+            }
+            applyNodeProperty (tree, property);
+        } break;
+
+        case Replication::childAddedRecord:
+        {
+            if (! readPath (in, path))
+                return false;
+            const int index = in.readCompressedInt();
+            const auto child = readTree (in);
+            ValueTree parent (Replication::findTree (session, path));
+            if (! child.isValid() || ! parent.isValid())
+                return false;
+            parent.addChild (child, index, nullptr);
+            seedStates (child, states);
+            markStructural (path, dirtyGraphs, rebuildAll);
+        } break;
+
+        case Replication::childRemovedRecord:
+        {
+            if (! readPath (in, path))
+                return false;
+            const int index = in.readCompressedInt();
+            ValueTree parent (Replication::findTree (session, path));
+            if (! isPositiveAndBelow (index, parent.getNumChildren()))
+                return false;
+            parent.removeChild (index, nullptr);
+            markStructural (path, dirtyGraphs, rebuildAll);
+        } break;
+
+        case Replication::childMovedRecord:
+        {
+            if (! readPath (in, path))
+                return false;
+            const int oldIndex = in.readCompressedInt();
+            const int newIndex = in.readCompressedInt();
+            ValueTree parent (Replication::findTree (session, path));
+            if (! isPositiveAndBelow (oldIndex, parent.getNumChildren()))
+                return false;
+            parent.moveChild (oldIndex, newIndex, nullptr);
+            markStructural (path, dirtyGraphs, rebuildAll);
+        } break;
+
+        case Replication::stateRecord:
+        {
+            const auto uuid = in.readString();
+            applyState (uuid, in);
+        } break;
+
+        case Replication::playRecord:
+            transportState.playing = in.readBool();
+            if (engine != nullptr)
+                engine->setPlaying (transportState.playing);
+            break;
+
+        case Replication::togglePlayRecord:
+            transportState.playing = ! transportState.playing;
+            if (engine != nullptr)
+                engine->togglePlayPause();
+            break;
+
+        case Replication::seekRecord:
+            transportState.frame = in.readInt64();
+            if (engine != nullptr)
+                engine->seekToAudioFrame (transportState.frame);
+            break;
+
+        case Replication::tempoRecord:
+            transportState.tempo = in.readDouble();
+            if (engine != nullptr)
+                engine->setTempo (transportState.tempo);
+            break;
+
+        case Replication::meterRecord:
+            transportState.beatsPerBar = in.readCompressedInt();
+            transportState.beatDivisor = in.readCompressedInt();
+            if (engine != nullptr)
+                engine->setMeter (transportState.beatsPerBar, transportState.beatDivisor);
+            break;
+
+        case Replication::sceneRecord:
+        {
+            const auto graph = in.readString();
+            transportState.scene = in.readString();
+            applyScene (graph, transportState.scene);
+        } break;
+
+        case Replication::positionRecord:
+        {
+            const bool playing = in.readBool();
+            applyPosition (playing, in.readInt64());
+        } break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+void ReplicationFollower::markStructural (const Array<int>& path, BigInteger& dirtyGraphs, bool& rebuildAll) const
+{
+    const auto graphs = session.getChild (path.isEmpty() ? -1 : path.getFirst());
+    if (! graphs.hasType (Tags::graphs))
+        return;
+
+    if (path.size() == 1)
+    {
+        rebuildAll = true;
+        return;
+    }
+
+    // scenes and other graph level data don't change what runs
+    if (path.size() > 2)
+    {
+        const auto section = graphs.getChild (path[1]).getChild (path[2]);
+        if (! section.hasType (Tags::nodes) && ! section.hasType (Tags::arcs))
+            return;
+    }
+
+    dirtyGraphs.setBit (path[1]);
+}
+
+void ReplicationFollower::applySnapshot (const ValueTree& data)
+{
+    session = data;
+    states.clear();
+    seedStates (session, states);
+    if (engine != nullptr)
+        loadGraphs();
+
+    // loading graphs can take a while, the leader's silence during it
+    // doesn't count against the timeout
+    lastReceived.set (Time::getMillisecondCounter());
+    following.set (1);
+
+    snapshotApplied();
+}
+
+void ReplicationFollower::applyNodeProperty (const ValueTree& tree, const Identifier& property)
+{
+    if (engine == nullptr)
+        return;
+
+    if (tree.hasType (Tags::graphs) && property == Tags::active)
+    {
+        if (auto* standby = graphs [(int) tree.getProperty (Tags::active, 0)])
+            if (auto* root = standby->getRootGraph())
+                engine->setActiveGraph (root->getEngineIndex());
+        return;
+    }
+
+    if (! tree.hasType (Tags::node))
+        return;
+
+    Node node (findNode (tree.getProperty (Tags::uuid).toString()));
+    GraphNodePtr object = node.getGraphNode();
+    if (object == nullptr)
+        return;
+
+    // keep the loaded copy in step so it reads the same as the leader's
+    node.getValueTree().setProperty (property, tree.getProperty (property), nullptr);
+    if (property == Tags::enabled)
+        object->setEnabled ((bool) tree.getProperty (property, true));
+    else if (property == Tags::mute)
+        object->setMuted ((bool) tree.getProperty (property, false));
+    else if (property == Tags::bypass)
+        object->suspendProcessing ((bool) tree.getProperty (property, false));
+}
+
+void ReplicationFollower::applyState (const String& uuid, InputStream& in)
+{
+    MemoryBlock state (states[uuid]);
+    if (! Replication::applyStateDiff (state, in))
+        return;
+
+    states.set (uuid, state);
+    GraphNodePtr object = findNode (uuid).getGraphNode();
+    if (auto* const proc = object != nullptr ? object->getAudioProcessor() : nullptr)
+        proc->setStateInformation (state.getData(), (int) state.getSize());
+}
+
+void ReplicationFollower::applyScene (const String& graphUuid, const String& name)
+{
+    for (auto* const standby : graphs)
+    {
+        const Node graph (standby->model, false);
+        if (graph.getUuidString() != graphUuid)
+            continue;
+
+        // scenes captured since the graph loaded are only in the session copy
+        const Node current (session.getChildWithName (Tags::graphs).getChild (graphs.indexOf (standby)), false);
+        const auto scene = current.getScenesValueTree().getChildWithProperty (Tags::name, name);
+        auto* const root = standby->getRootGraph();
+        if (root != nullptr && scene.isValid())
+            if (auto compiled = CompiledScene::compile (graph, scene))
+                root->getSceneRecall().recall (compiled);
+        break;
+    }
+}
+
+void ReplicationFollower::applyPosition (bool playing, int64 frame)
+{
+    transportState.playing = playing;
+    transportState.frame = frame;
+
+    auto monitor = engine != nullptr ? engine->getTransportMonitor() : nullptr;
+    if (monitor == nullptr)
+        return;
+
+    if (monitor->playing.get() != playing)
+        engine->setPlaying (playing);
+    if (std::abs (monitor->positionFrames.get() - frame) > (int64) syncTolerance)
+        engine->seekToAudioFrame (frame);
+}
+
+Node ReplicationFollower::findNode (const String& uuid) const
+{
+    const Uuid id (uuid);
+    for (auto* const standby : graphs)
+    {
+        const Node node (Node (standby->model, false).getNodeByUuid (id));
+        if (node.isValid())
+            return node;
+    }
+    return Node();
+}
+
+//=============================================================================
+void ReplicationFollower::loadGraphs()
+{
+    unloadGraphs();
+    const auto data = session.getChildWithName (Tags::graphs);
+    for (int i = 0; i < data.getNumChildren(); ++i)
+    {
+        graphs.add (new Standby());
+        reloadGraph (i);
+    }
+
+    applyNodeProperty (data, Tags::active);
+}
+
+void ReplicationFollower::reloadGraph (int index)
+{
+    auto* const standby = graphs [index];
+    const auto data = session.getChildWithName (Tags::graphs).getChild (index);
+    if (engine == nullptr || standby == nullptr || ! data.isValid())
+        return;
+
+    auto& world = engine->getWorld();
+    if (standby->holder == nullptr)
+    {
+        standby->holder = GraphNode::createForRoot (new RootGraph());
+        auto* const root = standby->getRootGraph();
+        root->setLocked (false);
+        root->setPlayConfigFor (world.getDeviceManager());
+        engine->addGraph (root);
+        standby->manager.reset (new RootGraphManager (*root, world.getPluginManager()));
+    }
+
+    const Node graph (data, false);
+    auto* const root = standby->getRootGraph();
+    const auto mode = graph.getProperty (Tags::renderMode, "single").toString().trim().toLowerCase();
+    root->setRenderMode (mode == "single" ? RootGraph::SingleGraph : RootGraph::Parallel);
+    root->setMidiChannels (graph.getMidiChannels());
+    root->setMidiProgram ((int) graph.getProperty ("midiProgram", -1));
+
+    // the newest state of each plugin is in the diffs, not the model
+    ValueTree model = data.createCopy();
+    writeStates (model, states);
+    model.setProperty (Tags::object, standby->holder.get(), nullptr);
+    standby->manager->setNodeModel (Node (model, false));
+
+    if (standby->model.isValid())
+        Node::sanitizeRuntimeProperties (standby->model, true);
+    standby->model = model;
+}
+
+void ReplicationFollower::unloadGraphs()
+{
+    for (auto* const standby : graphs)
+    {
+        if (auto* const root = standby->getRootGraph())
+            if (engine != nullptr)
+                engine->removeGraph (root);
+        if (standby->manager != nullptr)
+            standby->manager->clear();
+        standby->manager.reset();
+        if (standby->model.isValid())
+            Node::sanitizeRuntimeProperties (standby->model, true);
+        standby->holder = nullptr;
+    }
+
+    graphs.clear();
+}
+
+}
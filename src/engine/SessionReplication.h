@@ -0,0 +1,373 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#pragma once
+
+#include "ElementApp.h"
+#include "engine/Transport.h"
+#include "Signals.h"
+
+namespace Element {
+
+class AudioEngine;
+class GraphNode;
+class Node;
+
+/** The wire format shared by ReplicationLeader and ReplicationFollower.
+
+    A leader sends batches, each one a single InterprocessConnection message.
+    A batch starts with a flags byte and a count, then that many records, each
+    a type byte followed by its payload. Trees are addressed by their child
+    index path from the session root, values use var's binary form and numbers
+    are written compressed. Batches over a few hundred bytes are gzipped.
+
+    Plugin state travels as diffs against the last state sent for the same
+    node, split into fixed size chunks so only the chunks that changed go
+    over the wire.
+
+    Heartbeats, fences and fence acknowledgements travel as batches of
+    their own, so they can be picked out without decoding. The leader sends
+    a heartbeat each batch interval its audio callback has made progress,
+    so followers can tell a quiet leader from a stalled one. A follower that
+    stops hearing them sends a fence, and the leader answers it by holding
+    its output silent and acknowledging.
+ */
+struct Replication
+{
+    enum RecordType
+    {
+        snapshotRecord = 1,
+        propertyRecord,
+        propertyRemovedRecord,
+        childAddedRecord,
+        childRemovedRecord,
+        childMovedRecord,
+        stateRecord,
+        playRecord,
+        togglePlayRecord,
+        seekRecord,
+        tempoRecord,
+        meterRecord,
+        sceneRecord,
+        positionRecord,
+        heartbeatRecord,
+        fenceRecord,
+        fenceAckRecord
+    };
+
+    enum
+    {
+        compressedFlag  = 1 << 0,
+        compressAbove   = 384,
+        stateChunkSize  = 64
+    };
+
+    static const uint32 magic;
+    static const int version;
+
+    /** Writes the chunks of current that differ from previous. Returns false
+        if nothing changed and nothing was written. */
+    static bool writeStateDiff (const MemoryBlock& previous, const MemoryBlock& current, OutputStream& out);
+
+    /** Patches a state with a diff written by writeStateDiff */
+    static bool applyStateDiff (MemoryBlock& state, InputStream& in);
+
+    /** Fills path with the child indexes leading from root to tree. Returns
+        false if tree is not inside root. */
+    static bool getPath (const ValueTree& root, ValueTree tree, Array<int>& path);
+
+    /** Returns the tree at a path, invalid if the path doesn't exist */
+    static ValueTree findTree (const ValueTree& root, const Array<int>& path);
+
+    /** Returns a batch holding a single record without a payload */
+    static MemoryBlock encodeSignal (RecordType type);
+
+    /** Returns the record type if batch was made by encodeSignal, zero for
+        anything else */
+    static int getSignal (const MemoryBlock& batch);
+};
+
+//=============================================================================
+/** Streams a session to hot standby followers over TCP.
+
+    Followers get a full snapshot when they connect. After that model edits,
+    plugin state diffs, transport requests and scene recalls are collected
+    and sent in batches on a timer. Property changes to the same tree in one
+    batch are coalesced, so dragging a slider sends its latest value only.
+    Plugin state is only read back from nodes whose processor reported a
+    change, with a slower sweep of every node for plugins that don't.
+
+    Batches are sent from the message thread. Heartbeats come from a thread
+    of their own and follow the attached engine's audio callback, fences
+    from followers are answered on the connection's thread, so neither
+    waits on the message thread.
+ */
+class ReplicationLeader : private InterprocessConnectionServer,
+                          private ValueTree::Listener,
+                          private Timer,
+                          private AsyncUpdater
+{
+public:
+    ReplicationLeader();
+    ~ReplicationLeader();
+
+    /** Sends heartbeats only while this engine renders, and holds its output
+        silent if a follower fences this leader off. Call before start(). */
+    void attach (AudioEngine& engine);
+
+    /** Starts listening for followers
+
+        @param port         TCP port to listen on
+        @param session      The session's data. Nodes with running objects
+                            have their plugin state diffed and sent.
+        @param bindAddress  The interface to listen on, followers connect
+                            without authentication so this defaults to the
+                            local machine only. Empty listens on every
+                            interface.
+     */
+    Result start (int port, const ValueTree& session, const String& bindAddress = "127.0.0.1");
+
+    /** Disconnects every follower and stops listening */
+    void stop();
+
+    /** Returns true between start() and stop() */
+    bool isRunning() const { return session.isValid(); }
+
+    /** Returns the number of connected followers */
+    int getNumFollowers() const;
+
+    /** Lets the leader send its transport position so followers stay locked
+        to it while playing */
+    void setTransportMonitor (Transport::MonitorPtr monitor) { transport = monitor; }
+
+    /** Sets how often plugin state is checked for changes, zero turns
+        state diffs off */
+    void setStateInterval (int milliseconds) { stateInterval = jmax (0, milliseconds); }
+
+    /** Transport requests and scene recalls made on the leader */
+    void sendPlayState (bool playing);
+    void sendTogglePlayPause();
+    void sendSeek (int64 frame);
+    void sendTempo (double bpm);
+    void sendMeter (int beatsPerBar, int beatDivisor);
+    void sendScene (const Node& graph, const String& name);
+
+    /** Checks plugin state and sends everything pending now */
+    void flush();
+
+    /** Returns bytes put on the wire so far, after compression */
+    int64 getNumBytesSent() const { return numBytesSent.get(); }
+
+    /** Returns the number of batches sent to each follower, not counting
+        heartbeats */
+    int getNumBatchesSent() const { return numBatchesSent; }
+
+    /** Returns true once a follower has fenced this leader off */
+    bool isFenced() const { return fencedOff.get() == 1; }
+
+    /** Emitted on the message thread when a follower fenced this leader
+        off. The attached engine's output is already silent by then. */
+    Signal<void()> fenced;
+
+private:
+    enum
+    {
+        batchInterval           = 20,
+        positionInterval        = 250,
+        defaultStateInterval    = 250,
+        fullStateInterval       = 5000
+    };
+
+    class Link;
+    class Heartbeat;
+    class StateWatch;
+    struct Pending
+    {
+        Replication::RecordType type;
+        Array<int> path;
+        Identifier property;
+        MemoryBlock data;
+    };
+
+    ValueTree session;
+    AudioEngine* engine = nullptr;
+    Transport::MonitorPtr transport;
+    CriticalSection linksLock;
+    OwnedArray<Link> links;
+    std::unique_ptr<Heartbeat> heartbeat;
+    OwnedArray<StateWatch> watches;
+    Atomic<int> fencedOff { 0 };
+    bool fenceAnnounced = false;
+
+    Array<Pending> pending;
+    int firstCoalescable = 0;
+    HashMap<String, MemoryBlock> states;
+    int stateInterval = defaultStateInterval;
+    uint32 lastStateCheck = 0;
+    uint32 lastFullStateCheck = 0;
+    uint32 lastPosition = 0;
+    Atomic<int64> numBytesSent { 0 };
+    int numBatchesSent = 0;
+
+    void add (Replication::RecordType type, const MemoryBlock& data);
+    void addStructural (Replication::RecordType type, const Array<int>& path, const MemoryBlock& data);
+    void checkStates (bool allNodes);
+    StateWatch* getWatch (const String& uuid, GraphNode* object);
+    void sendSnapshot (Link&);
+    void sendDueSnapshots();
+    void send (const MemoryBlock& batch);
+    void sendPending();
+    void sendHeartbeat();
+    bool hasFollowers() const;
+    void removeLostLinks();
+    void fence (Link&);
+    static MemoryBlock encodeBatch (const Array<MemoryBlock>& records);
+
+    InterprocessConnection* createConnectionObject() override;
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+
+    friend class ValueTree;
+    void valueTreePropertyChanged (ValueTree&, const Identifier&) override;
+    void valueTreeChildAdded (ValueTree&, ValueTree&) override;
+    void valueTreeChildRemoved (ValueTree&, ValueTree&, int) override;
+    void valueTreeChildOrderChanged (ValueTree&, int, int) override;
+    void valueTreeParentChanged (ValueTree&) override { }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReplicationLeader)
+};
+
+//=============================================================================
+/** Follows a ReplicationLeader and keeps a copy of its session.
+
+    With an engine attached the follower also loads every graph of the
+    session into it, prepared and running but with the device output held
+    silent. Edits are applied as they arrive, node structure changes reload
+    the affected graph. If the leader goes away the engine's output is let
+    through on the next buffer and takeover is emitted.
+
+    The leader counts as gone when its connection closes. If its heartbeats
+    stop for the leader timeout it is fenced: the follower asks it to go
+    silent and goes live once it acknowledges, or once another timeout
+    passes without an answer. Messages arrive on the connection's thread,
+    heartbeats and fences are handled there and everything else is applied
+    on the message thread, so a busy message thread on either side doesn't
+    look like a lost leader. Takeover is emitted on the message thread.
+ */
+class ReplicationFollower : private InterprocessConnection,
+                            private Thread,
+                            private AsyncUpdater
+{
+public:
+    /** The last transport state received */
+    struct TransportState
+    {
+        bool playing = false;
+        int64 frame = 0;
+        double tempo = 120.0;
+        int beatsPerBar = 4;
+        int beatDivisor = 2;
+        String scene;
+    };
+
+    ReplicationFollower();
+    ~ReplicationFollower();
+
+    /** Runs standby graphs on this engine. Call before connecting. */
+    void attach (AudioEngine& engine);
+
+    /** Connects to a leader */
+    Result connect (const String& host, int port, int timeoutMillis = 3000);
+
+    /** Disconnects without taking over */
+    void disconnect();
+
+    /** Returns true once the first snapshot has arrived */
+    bool isFollowing() const { return following.get() == 1; }
+
+    /** Returns true if the leader went away and this follower took over */
+    bool hasTakenOver() const { return takenOver.get() == 1; }
+
+    /** Returns the copy of the leader's session */
+    const ValueTree& getSession() const { return session; }
+
+    const TransportState& getTransportState() const { return transportState; }
+
+    int getNumBatchesReceived() const { return numBatchesReceived; }
+
+    /** Frames the transport may drift from the leader before it is moved */
+    void setSyncTolerance (int frames) { syncTolerance = jmax (0, frames); }
+
+    /** Takes over when nothing arrives from the leader for this long, zero
+        only takes over when the connection closes */
+    void setLeaderTimeout (int milliseconds) { leaderTimeout.set (jmax (0, milliseconds)); }
+    int getLeaderTimeout() const { return leaderTimeout.get(); }
+
+    /** Emitted after each snapshot is applied */
+    Signal<void()> snapshotApplied;
+
+    /** Emitted when the leader was lost and this follower's output went live */
+    Signal<void()> takeover;
+
+private:
+    enum { defaultLeaderTimeout = 500 };
+
+    struct Standby;
+    AudioEngine* engine = nullptr;
+    ValueTree session;
+    OwnedArray<Standby> graphs;
+    HashMap<String, MemoryBlock> states;
+    TransportState transportState;
+    Atomic<int> following { 0 };
+    Atomic<int> takenOver { 0 };
+    Atomic<int> leaving { 0 };
+    Atomic<int> leaderTimeout { defaultLeaderTimeout };
+    Atomic<uint32> lastReceived { 0 };
+    Atomic<int> fencing { 0 };
+    CriticalSection inboxLock;
+    Array<MemoryBlock> inbox;
+    bool announced = false;
+    int syncTolerance = 2048;
+    int numBatchesReceived = 0;
+
+    bool applyBatch (InputStream&);
+    bool applyRecord (InputStream&, BigInteger& dirtyGraphs, bool& rebuildAll);
+    bool claimTakeover();
+    void applySnapshot (const ValueTree& data);
+    void applyNodeProperty (const ValueTree& tree, const Identifier& property);
+    void applyState (const String& uuid, InputStream&);
+    void applyScene (const String& graphUuid, const String& name);
+    void applyPosition (bool playing, int64 frame);
+    void loadGraphs();
+    void reloadGraph (int index);
+    void unloadGraphs();
+    void markStructural (const Array<int>& path, BigInteger& dirtyGraphs, bool& rebuildAll) const;
+    Node findNode (const String& uuid) const;
+
+    void connectionMade() override { }
+    void connectionLost() override;
+    void messageReceived (const MemoryBlock&) override;
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReplicationFollower)
+};
+
+}
@@ -0,0 +1,104 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+#include <cstring>
+
+namespace Element {
+
+/** Scans rendered audio for values that would poison the rest of a graph.
+
+    The scan is fused with RMS metering so a node's output is only walked
+    once per block. Each sample is classified by its exponent bits: all ones
+    is NaN or Inf, all zeros with a mantissa is a denormal, which is counted
+    and flushed to zero in the same pass. Working on the bits means large
+    finite values aren't mistaken for Inf and DAZ doesn't hide denormals.
+
+    The engine renders with FTZ and DAZ set (ScopedNoDenormals), so plugins
+    rarely produce denormals there and DenormalFault is mostly seen when
+    Element is hosted by something that doesn't set them.
+ */
+struct SignalGuard
+{
+    struct Result
+    {
+        float rms       = 0.f;
+        int denormals   = 0;
+        bool nonFinite  = false;
+    };
+
+    /** Scan and meter a single channel. Denormals are flushed in place. */
+    static Result scan (float* data, const int numSamples) noexcept
+    {
+        Result result;
+        if (numSamples <= 0)
+            return result;
+
+        // four independent accumulators keep the loop friendly to the
+        // auto-vectorizer without relying on fast-math reassociation. The
+        // sum is kept in double so loud but finite output still meters
+        double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+        int tiny[4]   = { 0, 0, 0, 0 };
+        int bad[4]    = { 0, 0, 0, 0 };
+        const int numQuads = numSamples / 4;
+
+        for (int i = 0; i < numQuads; ++i)
+        {
+            float* const q = data + (i * 4);
+            for (int j = 0; j < 4; ++j)
+                check (q[j], sum[j], tiny[j], bad[j]);
+        }
+
+        for (int i = numQuads * 4; i < numSamples; ++i)
+            check (data[i], sum[0], tiny[0], bad[0]);
+
+        result.nonFinite = (bad[0] | bad[1] | bad[2] | bad[3]) != 0;
+        result.denormals = tiny[0] + tiny[1] + tiny[2] + tiny[3];
+        const double total = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+        result.rms = result.nonFinite ? 0.f
+            : static_cast<float> (std::sqrt (total / static_cast<double> (numSamples)));
+        return result;
+    }
+
+    /** Returns true if this many denormals in a block should be reported.
+        A handful is harmless; a block that is mostly denormal is a plugin
+        decaying into the slow path.
+     */
+    static bool isDenormalStorm (const int denormals, const int numSamples) noexcept
+    {
+        return numSamples > 0 && denormals * 2 >= numSamples;
+    }
+
+private:
+    static void check (float& sample, double& sum, int& tiny, int& bad) noexcept
+    {
+        uint32 bits;
+        std::memcpy (&bits, &sample, sizeof (bits));
+        const uint32 exponent = bits & 0x7f800000u;
+        const bool isDenormal = exponent == 0 && (bits & 0x007fffffu) != 0;
+        bad  |= exponent == 0x7f800000u ? 1 : 0;
+        tiny += isDenormal ? 1 : 0;
+        sample = isDenormal ? 0.f : sample;
+        sum += static_cast<double> (sample) * static_cast<double> (sample);
+    }
+};
+
+}
@@ -20,6 +20,7 @@
 #include "engine/nodes/AudioFilePlayerNode.h"
 #include "gui/LookAndFeel.h"
 #include "gui/ViewHelpers.h"
+#include "gui/widgets/PeakOverview.h"
 
 // nav panel needs these headers included
 #include "controllers/EngineController.h"
@@ -61,6 +62,8 @@ public:
         addAndMakeVisible (startStopContinueToggle);
         startStopContinueToggle.setButtonText ("Respond to MIDI start/stop/continue");
 
+        addAndMakeVisible (overview);
+
         addAndMakeVisible (position);
         position.setSliderStyle (Slider::LinearBar);
         position.setRange (0.0, 1.0, 0.001);
@@ -74,7 +77,7 @@ public:
         stabilizeComponents();
         bindHandlers();
 
-        setSize (360, 144);
+        setSize (360, 196);
         startTimer (1001);
     }
 
@@ -97,16 +100,23 @@ public:
 
         loopButton.setToggleState (processor.isLooping(), dontSendNotification);
 
+        if (overview.getPeakCache() == nullptr)
+            if (auto* const globals = ViewHelpers::getGlobals (this))
+                overview.setPeakCache (&globals->getPeakCache());
+        overview.setFile (processor.getAudioFile());
+
         if (! draggingPos)
         {
             if (processor.getPlayer().getLengthInSeconds() > 0.0)
             {
+                overview.setPosition (processor.getPlayer().getCurrentPosition() / processor.getPlayer().getLengthInSeconds());
                 position.setValue (
                     processor.getPlayer().getCurrentPosition() / processor.getPlayer().getLengthInSeconds(),
                     dontSendNotification);
             }
             else
             {
+                overview.setPosition (-1.0);
                 position.setValue (position.getMinimum(), dontSendNotification);
             }
         }
@@ -135,6 +145,8 @@ public:
         r.removeFromTop (4);
         volume.setBounds (r.removeFromTop (18));
         r.removeFromTop (4);
+        overview.setBounds (r.removeFromTop (48));
+        r.removeFromTop (4);
         position.setBounds (r.removeFromTop (18));
         r.removeFromTop (4);
         startStopContinueToggle.setBounds (r.removeFromTop (18));
@@ -195,6 +207,7 @@ public:
 private:
     AudioFilePlayerNode& processor;
     std::unique_ptr<FilenameComponent> chooser;
+    PeakOverview overview;
     Slider position;
     Slider volume;
     TextButton playButton;
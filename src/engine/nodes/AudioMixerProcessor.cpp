@@ -77,6 +77,10 @@ public:
         monitors.clearQuick();
         for (int i = 0; i < owner.getNumTracks(); ++i)
             monitors.add (owner.getMonitor (i));
+        for (int i = 0; i < owner.getNumGroups(); ++i)
+            monitors.add (owner.getGroupMonitor (i));
+        for (int i = 0; i < owner.getNumVcas(); ++i)
+            monitors.add (owner.getVcaMonitor (i));
         channels.updateContent();
 
         masterMonitor = owner.getMonitor();
@@ -95,7 +99,7 @@ private:
     public:
         ChannelStrip (AudioMixerEditor& ed, AudioMixerProcessor::Monitor* mon)
             : editor (ed), monitor (mon),
-              meter (mon->getNumChannels())
+              meter (jmax (1, mon->getNumChannels()))
         {
             addAndMakeVisible (fader);
             fader.setSliderStyle (Slider::LinearBarVertical);
@@ -105,13 +109,20 @@ private:
             fader.setSkewFactor (2);
             fader.addListener (this);
             
-            addAndMakeVisible (meter);
+            addChildComponent (meter);
+
+            addChildComponent (pan);
+            pan.setSliderStyle (Slider::LinearBar);
+            pan.setTextBoxStyle (Slider::NoTextBox, true, 1, 1);
+            pan.setRange (-1.0, 1.0, 0.01);
+            pan.setDoubleClickReturnValue (true, 0.0);
+            pan.addListener (this);
 
             addAndMakeVisible (name); 
             name.setFont (name.getFont().withHeight (14));
             name.setJustificationType (Justification::centred);
-            setTrackName (monitor->getTrackId() >= 0 ? "Track " + String(monitor->getTrackId() + 1)
-                                                     : "Master");
+            name.addMouseListener (this, false);
+            updateType();
 
             addAndMakeVisible (mute);
             mute.setColour (TextButton::buttonOnColourId, Colors::toggleRed);
@@ -139,6 +150,9 @@ private:
             if (ptr == monitor)
                 return;
             monitor = ptr;
+            updateType();
+            stabilizeContent();
+            resized();
         }
 
         void paint (Graphics& g) override
@@ -150,6 +164,8 @@ private:
         {
             auto r = getLocalBounds();
             name.setBounds (r.removeFromTop (18));
+            if (pan.isVisible())
+                pan.setBounds (r.removeFromTop (12).reduced (2, 1));
             
             volume.setBounds (r.removeFromBottom (18));
             auto r2 = r.removeFromBottom (18);
@@ -174,6 +190,16 @@ private:
                 monitor->requestVolume (s->getValue());
                 updateLabels();
             }
+            else if (s == &pan)
+            {
+                monitor->requestPan ((float) s->getValue());
+            }
+        }
+
+        void mouseDown (const MouseEvent& ev) override
+        {
+            if (ev.eventComponent == &name && monitor->getType() == AudioMixerProcessor::Monitor::TrackStrip)
+                editor.showRoutingMenu (monitor->getTrackId());
         }
 
         int getNumChannels() const { return (nullptr != monitor) ? monitor->getNumChannels()
@@ -185,6 +211,7 @@ private:
         AudioMixerEditor& editor;
         AudioMixerProcessor::MonitorPtr monitor;
         Slider fader;
+        Slider pan;
         DigitalMeter meter;
         TextButton mute;
         Label name;
@@ -197,8 +224,22 @@ private:
             volume.setText (voltxt, dontSendNotification);
         }
 
+        void updateType()
+        {
+            using Monitor = AudioMixerProcessor::Monitor;
+            setTrackName (monitor->getName());
+            meter.setVisible (monitor->getType() != Monitor::VcaStrip);
+            pan.setVisible (monitor->getType() == Monitor::TrackStrip ||
+                            monitor->getType() == Monitor::GroupStrip);
+            name.setTooltip (monitor->getType() == Monitor::TrackStrip
+                ? "Click to route this track to a group or VCA" : String());
+        }
+
         void stabilizeContent()
         {
+            if (pan.isVisible() && ! pan.isMouseButtonDown() && pan.getValue() != (double) monitor->getPan())
+                pan.setValue ((double) monitor->getPan(), dontSendNotification);
+
             const double dB = (double) Decibels::gainToDecibels (monitor->getGain(), (float) EL_FADER_MIN_DB);
             if (fader.getValue() != dB)
             {
@@ -211,6 +252,8 @@ private:
 
         void processMeter()
         {
+            if (! meter.isVisible())
+                return;
             for (int i = 0; i < monitor->getNumChannels(); ++i)
                 meter.setValue (i, monitor->getLevel (i));
             meter.repaint();
@@ -342,6 +385,46 @@ private:
     friend class ChannelList;
     friend class ChannelStrip;
 
+    void showRoutingMenu (const int track)
+    {
+        enum { newGroup = 1, newVca, toMaster, noVca, groupBase = 100, vcaBase = 200 };
+        const int group = owner.getTrackGroup (track);
+        const int vca = owner.getTrackVca (track);
+
+        PopupMenu output, vcaMenu, menu;
+        output.addItem (toMaster, "Master", true, group < 0);
+        for (int i = 0; i < owner.getNumGroups(); ++i)
+            output.addItem (groupBase + i, owner.getGroupMonitor(i)->getName(), true, group == i);
+        output.addSeparator();
+        output.addItem (newGroup, "New Group", owner.getNumGroups() < AudioMixerProcessor::maxGroups);
+
+        vcaMenu.addItem (noVca, "None", true, vca < 0);
+        for (int i = 0; i < owner.getNumVcas(); ++i)
+            vcaMenu.addItem (vcaBase + i, owner.getVcaMonitor(i)->getName(), true, vca == i);
+        vcaMenu.addSeparator();
+        vcaMenu.addItem (newVca, "New VCA", owner.getNumVcas() < AudioMixerProcessor::maxVcas);
+
+        menu.addSubMenu ("Output", output);
+        menu.addSubMenu ("VCA", vcaMenu);
+
+        const int result = menu.show();
+        if (result == toMaster)
+            owner.setTrackGroup (track, -1);
+        else if (result == noVca)
+            owner.setTrackVca (track, -1);
+        else if (result == newGroup)
+            owner.setTrackGroup (track, owner.addGroup());
+        else if (result == newVca)
+            owner.setTrackVca (track, owner.addVca());
+        else if (result >= vcaBase)
+            owner.setTrackVca (track, result - vcaBase);
+        else if (result >= groupBase)
+            owner.setTrackGroup (track, result - groupBase);
+
+        if (result == newGroup || result == newVca)
+            rebuildTracks();
+    }
+
     ChannelList channels;
     Array<ChannelStrip*> strips;
     MonitorList monitors;
@@ -359,11 +442,125 @@ private:
     }
 };
 
+//=============================================================================
+struct AudioMixerProcessor::Mix
+{
+    struct Channel
+    {
+        int busIdx;
+        int numInputs;
+        int group;
+        int vca;
+        Monitor* monitor;
+    };
+
+    Array<Channel> channels;
+    Array<Monitor*> groups;
+    Array<Monitor*> vcas;
+    HeapBlock<float> vcaGains;
+    // keeps every strip alive while the audio thread uses the mix
+    ReferenceCountedArray<Monitor> monitors;
+};
+
+namespace MixerHelpers {
+
+/** Adds a gain ramped copy of src to dst and returns the sum of squares of
+    what was added. Four lanes of independent sums keep the loop free of
+    dependencies so it vectorizes without fast math. */
+static float mixChannel (const float* src, float* dst, const int numSamples,
+                         const float startGain, const float endGain) noexcept
+{
+    if (startGain == 0.f && endGain == 0.f)
+        return 0.f;
+
+    const float step = (endGain - startGain) / (float) numSamples;
+    float sum0 = 0.f, sum1 = 0.f, sum2 = 0.f, sum3 = 0.f;
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const float gain = startGain + step * (float) i;
+        const float y0 = src[i]     * gain;
+        const float y1 = src[i + 1] * (gain + step);
+        const float y2 = src[i + 2] * (gain + step * 2.f);
+        const float y3 = src[i + 3] * (gain + step * 3.f);
+        dst[i]     += y0;
+        dst[i + 1] += y1;
+        dst[i + 2] += y2;
+        dst[i + 3] += y3;
+        sum0 += y0 * y0;
+        sum1 += y1 * y1;
+        sum2 += y2 * y2;
+        sum3 += y3 * y3;
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        const float y = src[i] * (startGain + step * (float) i);
+        dst[i] += y;
+        sum0 += y * y;
+    }
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/** Picks up a strip's requests and returns the gains of its left and right
+    outputs. Audio thread. */
+static void updateStrip (const AudioMixerProcessor::Monitor& monitor, const float scale,
+                         const int numInputs, float& left, float& right,
+                         bool& muted, float& gain, float& pan) noexcept
+{
+    muted = monitor.isMuteRequested();
+    gain  = monitor.getRequestedGain();
+    pan   = monitor.getRequestedPan();
+
+    const float level = muted ? 0.f : gain * scale;
+    if (numInputs == 1)
+    {
+        const float angle = (pan + 1.f) * MathConstants<float>::pi * 0.25f;
+        left  = level * std::cos (angle);
+        right = level * std::sin (angle);
+    }
+    else
+    {
+        left  = level * jmin (1.f, 1.f - pan);
+        right = level * jmin (1.f, 1.f + pan);
+    }
+}
+
+/** Mixes a strip's inputs into a stereo destination and meters it */
+static void mixStrip (Array<Atomic<float>>& rms, float* lastGains, const float* const* inputs, const int numInputs,
+                      float* const* dest, const int numSamples,
+                      const float left, const float right) noexcept
+{
+    const float norm = 1.f / (float) numSamples;
+    if (numInputs == 1)
+    {
+        const float sumL = mixChannel (inputs[0], dest[0], numSamples, lastGains[0], left);
+        const float sumR = mixChannel (inputs[0], dest[1], numSamples, lastGains[1], right);
+        rms.getReference(0).set (std::sqrt (jmax (sumL, sumR) * norm));
+    }
+    else if (numInputs >= 2)
+    {
+        rms.getReference(0).set (std::sqrt (mixChannel (inputs[0], dest[0], numSamples, lastGains[0], left) * norm));
+        rms.getReference(1).set (std::sqrt (mixChannel (inputs[1], dest[1], numSamples, lastGains[1], right) * norm));
+    }
+
+    lastGains[0] = left;
+    lastGains[1] = right;
+}
+
+}
+
 AudioMixerProcessor::~AudioMixerProcessor()
 {
+    stopTimer();
+    masterMute->removeListener (this);
+    masterVolume->removeListener (this);
+
     Array<Track*> oldTracks;
     {
-        ScopedLock sl (getCallbackLock());
+        ScopedLock sl (lock);
         masterMute = nullptr;
         masterVolume = nullptr;
         tracks.swapWith (oldTracks);
@@ -371,18 +568,35 @@ AudioMixerProcessor::~AudioMixerProcessor()
 
     for (auto* t : oldTracks)
         delete t;
+
+    releaseRetired();
+    delete pendingMix.exchange (nullptr);
+    delete activeMix;
+    activeMix = nullptr;
 }
 
 AudioMixerProcessor::MonitorPtr AudioMixerProcessor::getMonitor (const int track) const
 {
     if (track < 0)
         return masterMonitor;
-    ScopedLock sl (getCallbackLock());
+    ScopedLock sl (lock);
     if (! isPositiveAndBelow (track, tracks.size()))
         return nullptr;
     return tracks.getUnchecked(track)->monitor;
 }
 
+AudioMixerProcessor::MonitorPtr AudioMixerProcessor::getGroupMonitor (const int group) const
+{
+    ScopedLock sl (lock);
+    return groups [group];
+}
+
+AudioMixerProcessor::MonitorPtr AudioMixerProcessor::getVcaMonitor (const int vca) const
+{
+    ScopedLock sl (lock);
+    return vcas [vca];
+}
+
 void AudioMixerProcessor::addMonoTrack()
 {
     auto* track = new Track();
@@ -390,9 +604,6 @@ void AudioMixerProcessor::addMonoTrack()
     track->busIdx = -1;
     track->numInputs = 1;
     track->numOutputs = 2;
-    track->lastGain = 1.0;
-    track->gain = 1.0;
-    track->mute = false;
     deleteAndZero (track); // mono not yet supported
 }
 
@@ -414,12 +625,9 @@ void AudioMixerProcessor::addStereoTrack()
         track->busIdx       = input->getBusIndex();
         track->numInputs    = input->getNumberOfChannels();
         track->numOutputs   = input->getNumberOfChannels();
-        track->lastGain     = 1.0;
-        track->gain         = 1.0;
-        track->mute         = false;
         track->monitor      = new Monitor (track->index, track->numOutputs);
 
-        ScopedLock sl (getCallbackLock());
+        ScopedLock sl (lock);
         tracks.add (track);
         numTracks = tracks.size();
     }
@@ -429,6 +637,75 @@ void AudioMixerProcessor::addStereoTrack()
     }
 }
 
+int AudioMixerProcessor::addGroup()
+{
+    int index = -1;
+    {
+        ScopedLock sl (lock);
+        if (groups.size() >= maxGroups)
+            return -1;
+        index = groups.size();
+        groups.add (new Monitor (Monitor::GroupStrip, index, 2));
+    }
+
+    publish();
+    return index;
+}
+
+int AudioMixerProcessor::addVca()
+{
+    int index = -1;
+    {
+        ScopedLock sl (lock);
+        if (vcas.size() >= maxVcas)
+            return -1;
+        index = vcas.size();
+        vcas.add (new Monitor (Monitor::VcaStrip, index, 0));
+    }
+
+    publish();
+    return index;
+}
+
+void AudioMixerProcessor::publish()
+{
+    std::unique_ptr<Mix> mix (new Mix());
+    {
+        ScopedLock sl (lock);
+        for (auto* const track : tracks)
+        {
+            mix->channels.add ({ track->busIdx, track->numInputs,
+                                 isPositiveAndBelow (track->group, groups.size()) ? track->group : -1,
+                                 isPositiveAndBelow (track->vca, vcas.size()) ? track->vca : -1,
+                                 track->monitor.get() });
+            mix->monitors.add (track->monitor);
+        }
+
+        for (auto* const group : groups)
+        {
+            mix->groups.add (group);
+            mix->monitors.add (group);
+        }
+
+        for (auto* const vca : vcas)
+        {
+            mix->vcas.add (vca);
+            mix->monitors.add (vca);
+        }
+    }
+
+    mix->vcaGains.calloc ((size_t) jmax (1, mix->vcas.size()));
+
+    releaseRetired();
+    // a mix the audio thread never picked up can go straight away
+    delete pendingMix.exchange (mix.release());
+}
+
+void AudioMixerProcessor::releaseRetired()
+{
+    delete retiredMix.exchange (nullptr);
+}
+
 AudioProcessorEditor* AudioMixerProcessor::createEditor()
 {
     auto* ed = new AudioMixerEditor (*this);
@@ -442,81 +719,134 @@ void AudioMixerProcessor::prepareToPlay (const double sampleRate, const int buff
     jassert (tracks.size() == getBusCount (true));
     jassert (1 == getBusCount (false));
     tempBuffer.setSize (getMainBusNumOutputChannels(), bufferSize, false, true, true);
+    groupBuffer.setSize (maxGroups * 2, bufferSize, false, true, true);
+    releaseRetired();
 }
 
 void AudioMixerProcessor::processBlock (AudioSampleBuffer& audio, MidiBuffer& midi)
 {
+    using namespace MixerHelpers;
     midi.clear();
 
-    ScopedLock sl (getCallbackLock());
+    // the old mix goes back only once the message thread released the last one
+    if (retiredMix.get() == nullptr)
+    {
+        if (auto* const next = pendingMix.exchange (nullptr))
+        {
+            retiredMix.set (activeMix);
+            activeMix = next;
+        }
+    }
 
-    if (tracks.size() <= 0)
+    auto* const mix = activeMix;
+    const int numSamples = jmin (audio.getNumSamples(), tempBuffer.getNumSamples());
+    if (mix == nullptr || mix->channels.size() <= 0 || numSamples <= 0 || tempBuffer.getNumChannels() < 2)
     {
         audio.clear();
         return;
     }
 
-    auto output (getBusBuffer<float> (audio, false, 0));
-    const int numSamples = audio.getNumSamples();
     tempBuffer.clear (0, numSamples);
+    const int numGroups = jmin (mix->groups.size(), groupBuffer.getNumChannels() / 2);
+    for (int c = 0; c < numGroups * 2; ++c)
+        groupBuffer.clear (c, 0, numSamples);
 
-    for (int i = 0; i < tracks.size(); ++i)
+    for (int v = 0; v < mix->vcas.size(); ++v)
     {
-        auto* const track = tracks.getUnchecked (i);
-        auto input (getBusBuffer<float> (audio, true, track->busIdx));
-        auto& rms = track->monitor->rms;
+        auto* const vca = mix->vcas.getUnchecked (v);
+        const bool muted = vca->isMuteRequested();
+        const float gain = vca->getRequestedGain();
+        vca->muted.set (muted ? 1 : 0);
+        vca->gain.set (gain);
+        mix->vcaGains[v] = muted ? 0.f : gain;
+    }
 
-        if (track->mute)
-        {
-            for (int c = 0; c < track->numInputs; ++c)
-                rms.getReference(c).set (0.0);
-        }
-        else
+    const int numBuses = getBusCount (true);
+    for (const auto& channel : mix->channels)
+    {
+        auto& monitor = *channel.monitor;
+        if (! isPositiveAndBelow (channel.busIdx, numBuses))
+            continue;
+
+        auto input (getBusBuffer<float> (audio, true, channel.busIdx));
+        const int numInputs = jmin (channel.numInputs, input.getNumChannels(), 2);
+        float* dest[2] = { tempBuffer.getWritePointer (0), tempBuffer.getWritePointer (1) };
+        if (isPositiveAndBelow (channel.group, numGroups))
         {
-            for (int c = 0; c < track->numInputs; ++c)
-            {
-                rms.getReference(c).set (track->gain * input.getRMSLevel (c, 0, numSamples));
-                tempBuffer.addFromWithRamp (c, 0, input.getReadPointer(c), numSamples,
-                                            track->lastGain, track->gain);
-            }
+            dest[0] = groupBuffer.getWritePointer (channel.group * 2);
+            dest[1] = groupBuffer.getWritePointer (channel.group * 2 + 1);
         }
 
-        track->lastGain = track->gain;
+        float left, right, gain, pan;
+        bool muted;
+        updateStrip (monitor, channel.vca >= 0 ? mix->vcaGains[channel.vca] : 1.f,
+                     numInputs, left, right, muted, gain, pan);
+        mixStrip (monitor.rms, monitor.lastGains, input.getArrayOfReadPointers(),
+                  numInputs, dest, numSamples, left, right);
 
-        if (track->gain != track->monitor->nextGain.get())
-            track->gain = track->monitor->nextGain.get();
-        track->monitor->gain.set (track->gain);
-
-        if (static_cast<int> (track->mute) != track->monitor->nextMute.get())
-            track->mute = track->monitor->nextMute.get() > 0;
-        track->monitor->muted.set (track->mute ? 1 : 0);
+        monitor.gain.set (gain);
+        monitor.muted.set (muted ? 1 : 0);
+        monitor.pan.set (pan);
     }
 
-    output.clear (0, numSamples);
-    const float gain = Decibels::decibelsToGain ((float)*masterVolume, (float) EL_FADER_MIN_DB);
-    if (! *masterMute)
-        for (int c = 0; c < output.getNumChannels(); ++c)
-            output.copyFromWithRamp (c, 0, tempBuffer.getReadPointer(c), numSamples,
-                                     lastGain, gain);
+    for (int g = 0; g < numGroups; ++g)
+    {
+        auto& monitor = *mix->groups.getUnchecked (g);
+        const float* inputs[2] = { groupBuffer.getReadPointer (g * 2), groupBuffer.getReadPointer (g * 2 + 1) };
+        float* dest[2] = { tempBuffer.getWritePointer (0), tempBuffer.getWritePointer (1) };
+
+        float left, right, gain, pan;
+        bool muted;
+        updateStrip (monitor, 1.f, 2, left, right, muted, gain, pan);
+        mixStrip (monitor.rms, monitor.lastGains, inputs, 2, dest, numSamples, left, right);
+
+        monitor.gain.set (gain);
+        monitor.muted.set (muted ? 1 : 0);
+        monitor.pan.set (pan);
+    }
 
-    if (gain != masterMonitor->nextGain.get())
-        *masterVolume = Decibels::gainToDecibels (masterMonitor->nextGain.get(), (float) EL_FADER_MIN_DB);
-    if (static_cast<int> (*masterMute) != masterMonitor->nextMute.get())
-        *masterMute = masterMonitor->nextMute.get() <= 0 ? false : true;
+    auto output (getBusBuffer<float> (audio, false, 0));
+    output.clear();
+    // the parameters are kept in step on the message thread
+    const float gain = masterMonitor->getRequestedGain();
+    const bool muted = masterMonitor->isMuteRequested();
+    const float target = muted ? 0.f : gain;
+    const float norm = 1.f / (float) numSamples;
+    for (int c = 0; c < jmin (2, output.getNumChannels()); ++c)
+    {
+        const float sum = mixChannel (tempBuffer.getReadPointer (c), output.getWritePointer (c),
+                                      numSamples, lastGain, target);
+        masterMonitor->rms.getReference(c).set (std::sqrt (sum * norm));
+    }
 
-    masterMonitor->muted.set (*masterMute);
+    masterMonitor->muted.set (muted ? 1 : 0);
     masterMonitor->gain.set (gain);
+    lastGain = target;
+}
 
-    for (int i = 0; i < 2; ++i)
-        masterMonitor->rms.getReference(i).set (
-            output.getRMSLevel (i, 0, numSamples));
+void AudioMixerProcessor::parameterValueChanged (int index, float)
+{
+    auto* const param = getParameters()[index];
+    if (param == masterVolume)
+        masterMonitor->requestGain (Decibels::decibelsToGain ((float) *masterVolume, (float) EL_FADER_MIN_DB));
+    else if (param == masterMute)
+        masterMonitor->requestMute (*masterMute);
+}
 
-    lastGain = gain;
+void AudioMixerProcessor::timerCallback()
+{
+    const float volume = Decibels::gainToDecibels (masterMonitor->getRequestedGain(), (float) EL_FADER_MIN_DB);
+    if (std::abs (volume - (float) *masterVolume) > 0.001f)
+        *masterVolume = volume;
+    if (masterMonitor->isMuteRequested() != (bool) *masterMute)
+        *masterMute = masterMonitor->isMuteRequested();
 }
 
 void AudioMixerProcessor::releaseResources()
 {
     tempBuffer.setSize (1, 1, false, false, false);
+    groupBuffer.setSize (1, 1, false, false, false);
+    releaseRetired();
 }
 
 bool AudioMixerProcessor::canApplyBusCountChange (bool isInput, bool isAdding,
@@ -543,64 +873,127 @@ bool AudioMixerProcessor::canApplyBusCountChange (bool isInput, bool isAdding,
 
 void AudioMixerProcessor::setTrackGain (const int track, const float gain)
 {
-    if (! isPositiveAndBelow (track, numTracks))
-        return;
-    ScopedLock sl (getCallbackLock());
-    tracks.getUnchecked(track)->gain = gain;
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        monitor->requestGain (gain);
 }
 
-void AudioMixerProcessor::setTrackMuted (const int track, const bool mute) {
-    if (! isPositiveAndBelow (track, numTracks))
-        return;
-    ScopedLock sl (getCallbackLock());
-    tracks.getUnchecked(track)->mute = mute;
+void AudioMixerProcessor::setTrackMuted (const int track, const bool mute)
+{
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        monitor->requestMute (mute);
 }
 
 bool AudioMixerProcessor::isTrackMuted (const int track) const
 {
-    if (! isPositiveAndBelow (track, numTracks))
-        return false;
-    ScopedLock sl (getCallbackLock());
-    return tracks.getUnchecked(track)->mute;
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        return monitor->isMuteRequested();
+    return false;
 }
 
 float AudioMixerProcessor::getTrackGain (const int track) const
 {
-    if (! isPositiveAndBelow (track, numTracks))
-        return 1.f;
-    ScopedLock sl (getCallbackLock());
-    return tracks.getUnchecked(track)->gain;
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        return monitor->getRequestedGain();
+    return 1.f;
 }
 
-void AudioMixerProcessor::getStateInformation (juce::MemoryBlock& block)
+void AudioMixerProcessor::setTrackPan (const int track, const float pan)
+{
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        monitor->requestPan (pan);
+}
+
+float AudioMixerProcessor::getTrackPan (const int track) const
+{
+    if (auto monitor = isPositiveAndBelow (track, numTracks) ? getMonitor (track) : nullptr)
+        return monitor->getRequestedPan();
+    return 0.f;
+}
+
+void AudioMixerProcessor::setTrackGroup (const int track, const int group)
+{
+    {
+        ScopedLock sl (lock);
+        if (! isPositiveAndBelow (track, tracks.size()))
+            return;
+        const int newGroup = isPositiveAndBelow (group, groups.size()) ? group : -1;
+        if (tracks.getUnchecked(track)->group == newGroup)
+            return;
+        tracks.getUnchecked(track)->group = newGroup;
+    }
+
+    publish();
+}
+
+int AudioMixerProcessor::getTrackGroup (const int track) const
+{
+    ScopedLock sl (lock);
+    return isPositiveAndBelow (track, tracks.size()) ? tracks.getUnchecked(track)->group : -1;
+}
+
+void AudioMixerProcessor::setTrackVca (const int track, const int vca)
 {
-    OwnedArray<Track> t;
-    while (t.size() < numTracks)
-        t.add (new Track());
-    float volume = 0.0f;
-    bool mute = false;
     {
-        ScopedLock sl (getCallbackLock());
-        for (int i = 0; i < numTracks; ++i)
-            t.getUnchecked(i)->update (tracks.getUnchecked (i));
-        volume = *masterVolume;
-        mute = *masterMute;
+        ScopedLock sl (lock);
+        if (! isPositiveAndBelow (track, tracks.size()))
+            return;
+        const int newVca = isPositiveAndBelow (vca, vcas.size()) ? vca : -1;
+        if (tracks.getUnchecked(track)->vca == newVca)
+            return;
+        tracks.getUnchecked(track)->vca = newVca;
     }
 
+    publish();
+}
+
+int AudioMixerProcessor::getTrackVca (const int track) const
+{
+    ScopedLock sl (lock);
+    return isPositiveAndBelow (track, tracks.size()) ? tracks.getUnchecked(track)->vca : -1;
+}
+
+static ValueTree createStripState (const Identifier& type, const AudioMixerProcessor::Monitor& monitor)
+{
+    ValueTree strip (type);
+    strip.setProperty ("index", monitor.getTrackId(), 0)
+         .setProperty ("gain",  monitor.getRequestedGain(), 0)
+         .setProperty ("mute",  monitor.isMuteRequested(), 0);
+    return strip;
+}
+
+static void restoreStripState (const ValueTree& strip, AudioMixerProcessor::Monitor& monitor)
+{
+    monitor.requestGain ((float) strip.getProperty ("gain", 1.f));
+    monitor.requestMute ((bool) strip.getProperty ("mute", false));
+    monitor.requestPan ((float) strip.getProperty ("pan", 0.f));
+}
+
+void AudioMixerProcessor::getStateInformation (juce::MemoryBlock& block)
+{
     ValueTree state ("audiomixer");
-    state.setProperty (Tags::volume, volume, 0)
-         .setProperty ("mute", mute, 0);
-    for (int i = 0; i < numTracks; ++i)
+
     {
-        ValueTree trk ("track");
-        auto* const track = t.getUnchecked (i);
-        trk.setProperty ("index",       track->index, 0)
-           .setProperty ("busIdx",      track->busIdx, 0)
-           .setProperty ("numInputs",   track->numInputs, 0)
-           .setProperty ("numOutputs",  track->numOutputs, 0)
-           .setProperty ("gain",        track->gain, 0)
-           .setProperty ("mute",        track->mute, 0);
-        state.addChild (trk, -1, 0);
+        ScopedLock sl (lock);
+        state.setProperty (Tags::volume, Decibels::gainToDecibels (masterMonitor->getRequestedGain(), (float) EL_FADER_MIN_DB), 0)
+             .setProperty ("mute", masterMonitor->isMuteRequested(), 0);
+
+        for (auto* const track : tracks)
+        {
+            auto trk = createStripState ("track", *track->monitor);
+            trk.setProperty ("busIdx",      track->busIdx, 0)
+               .setProperty ("numInputs",   track->numInputs, 0)
+               .setProperty ("numOutputs",  track->numOutputs, 0)
+               .setProperty ("pan",         track->monitor->getRequestedPan(), 0)
+               .setProperty ("group",       track->group, 0)
+               .setProperty ("vca",         track->vca, 0);
+            state.addChild (trk, -1, 0);
+        }
+
+        for (auto* const group : groups)
+            state.addChild (createStripState ("group", *group)
+                .setProperty ("pan", group->getRequestedPan(), 0), -1, 0);
+        for (auto* const vca : vcas)
+            state.addChild (createStripState ("vca", *vca), -1, 0);
     }
 
     if (auto xml = state.createXml())
@@ -621,29 +1014,49 @@ void AudioMixerProcessor::setStateInformation (const void* data, int size)
         return;
 
     Array<Track*> newTracks;
+    ReferenceCountedArray<Monitor> newGroups, newVcas;
     for (int i = 0; i < state.getNumChildren(); ++i)
     {
-        const ValueTree trk (state.getChild (i));
-        auto* const track   = new Track();
-        track->index        = trk.getProperty ("index", i);
-        track->busIdx       = trk.getProperty ("busIdx", i);
-        track->numInputs    = trk.getProperty ("numInputs", 2);
-        track->numOutputs   = trk.getProperty ("numOutputs", 2);
-        track->gain         = trk.getProperty ("gain", 1.f);
-        track->lastGain     = track->gain;
-        track->mute         = (bool) trk.getProperty ("mute", false);
-
-        track->monitor = new Monitor (track->index, track->numInputs);
-        track->monitor->gain.set (track->gain);
-        track->monitor->nextGain.set (track->gain);
-        track->monitor->muted.set (track->mute ? 1 : 0);
-        track->monitor->nextMute.set (track->mute ? 1 : 0);
-        
-        newTracks.add (track);
+        const ValueTree child (state.getChild (i));
+        if (child.hasType ("group") && newGroups.size() < maxGroups)
+        {
+            auto* const group = newGroups.add (new Monitor (Monitor::GroupStrip, newGroups.size(), 2));
+            restoreStripState (child, *group);
+        }
+        else if (child.hasType ("vca") && newVcas.size() < maxVcas)
+        {
+            auto* const vca = newVcas.add (new Monitor (Monitor::VcaStrip, newVcas.size(), 0));
+            restoreStripState (child, *vca);
+        }
+        else if (newTracks.size() < maxTracks)
+        {
+            const int index     = newTracks.size();
+            auto* const track   = new Track();
+            track->index        = child.getProperty ("index", index);
+            track->busIdx       = child.getProperty ("busIdx", index);
+            track->numInputs    = child.getProperty ("numInputs", 2);
+            track->numOutputs   = child.getProperty ("numOutputs", 2);
+            track->group        = child.getProperty ("group", -1);
+            track->vca          = child.getProperty ("vca", -1);
+            track->monitor      = new Monitor (track->index, track->numInputs);
+            restoreStripState (child, *track->monitor);
+            newTracks.add (track);
+        }
     }
 
+    for (auto* const track : newTracks)
     {
-        ScopedLock sl (getCallbackLock());
+        // applied right away so the first block doesn't ramp from unity
+        auto& monitor = *track->monitor;
+        monitor.gain.set (monitor.nextGain.get());
+        monitor.muted.set (monitor.nextMute.get());
+        monitor.pan.set (monitor.nextPan.get());
+        const float gain = monitor.isMuteRequested() ? 0.f : monitor.getRequestedGain();
+        monitor.lastGains[0] = monitor.lastGains[1] = gain;
+    }
+
+    {
+        ScopedLock sl (lock);
         *masterVolume = (float) state.getProperty (Tags::volume, 0.0);
         *masterMute = (bool) state.getProperty ("mute", false);
         masterMonitor->nextGain.set (Decibels::decibelsToGain ((float)*masterVolume, (float)EL_FADER_MIN_DB));
@@ -651,9 +1064,13 @@ void AudioMixerProcessor::setStateInformation (const void* data, int size)
         masterMonitor->nextMute.set (*masterMute ? 1 : 0);
         masterMonitor->muted.set (masterMonitor->nextMute.get());
         tracks.swapWith (newTracks);
+        groups.swapWith (newGroups);
+        vcas.swapWith (newVcas);
         numTracks = tracks.size();
     }
 
+    publish();
+
     for (auto* dt : newTracks)
         delete dt;
     newTracks.clear();
@@ -23,17 +23,43 @@
 
 namespace Element {
 
-class AudioMixerProcessor : public BaseProcessor
+/** A mixer for up to maxTracks stereo inputs.
+
+    Tracks sum into the master or into one of up to maxGroups stereo
+    subgroups, which sum into the master. A VCA scales the gain of every
+    track assigned to it without carrying audio.
+
+    The audio thread never locks. Faders, pans and mutes are read from each
+    strip's Monitor once per block. Routing changes build a new Mix on the
+    message thread which the audio thread swaps in at the top of a block.
+    Each routed channel is mixed in one pass that ramps its gain, applies the
+    pan, adds it to the destination and measures the level.
+ */
+class AudioMixerProcessor : public BaseProcessor,
+                            private AudioProcessorParameter::Listener,
+                            private Timer
 {
     AudioParameterBool* masterMute;
     AudioParameterFloat* masterVolume;
 
 public:
+    enum
+    {
+        maxTracks   = 128,
+        maxGroups   = 16,
+        maxVcas     = 16
+    };
+
     class Monitor : public ReferenceCountedObject
     {
     public:
+        enum Type { TrackStrip = 0, GroupStrip, VcaStrip, MasterStrip };
+
         explicit Monitor (const int track, const int totalChannels = 2)
-            : trackId (track), numChannels (totalChannels)
+            : Monitor (track >= 0 ? TrackStrip : MasterStrip, track, totalChannels) { }
+
+        Monitor (const Type t, const int index, const int totalChannels)
+            : type (t), trackId (index), numChannels (totalChannels)
         {
             reset();
         }
@@ -43,11 +69,31 @@ public:
             rms.clear();
         }
 
+        inline Type getType()           const { return type; }
         inline float getGain()          const { return gain.get(); }
+        inline float getPan()           const { return pan.get(); }
         inline int getNumChannels()     const { return numChannels; }
         inline int getTrackId()         const { return trackId; }
         inline bool isMuted()           const { return muted.get() > 0; }
 
+        /** Returns the last requested gain, which the audio thread may not
+            have picked up yet */
+        inline float getRequestedGain() const { return nextGain.get(); }
+        inline bool isMuteRequested()   const { return nextMute.get() > 0; }
+        inline float getRequestedPan()  const { return nextPan.get(); }
+
+        String getName() const
+        {
+            switch (type)
+            {
+                case TrackStrip:  return "Track " + String (trackId + 1);
+                case GroupStrip:  return "Group " + String (trackId + 1);
+                case VcaStrip:    return "VCA " + String (trackId + 1);
+                case MasterStrip: break;
+            }
+            return "Master";
+        }
+
         inline float getLevel (const int channel)
         {
             if (isPositiveAndBelow (channel, rms.size()))
@@ -70,8 +116,16 @@ public:
             requestGain (Decibels::decibelsToGain (dB, -120.f));
         }
 
+        /** Requests a pan between -1 (left) and 1 (right). Stereo strips
+            balance, mono strips pan at equal power */
+        inline void requestPan (const float newPan)
+        {
+            nextPan.set (jlimit (-1.f, 1.f, newPan));
+        }
+
     private:
         friend class AudioMixerProcessor;
+        const Type type;
         const int trackId;
         const int numChannels;
         Array<Atomic<float> > rms;
@@ -79,6 +133,11 @@ public:
         Atomic<int> nextMute;
         Atomic<float> gain;
         Atomic<float> nextGain;
+        Atomic<float> pan;
+        Atomic<float> nextPan;
+
+        // audio thread
+        float lastGains [2] = { 1.f, 1.f };
 
         void reset()
         {
@@ -86,6 +145,9 @@ public:
             nextMute = 0;
             gain = 1.f;
             nextGain = 1.f;
+            pan = 0.f;
+            nextPan = 0.f;
+            lastGains[0] = lastGains[1] = 1.f;
             if (rms.size() > 0)
                 rms.clearQuick();
             while (rms.size() < numChannels)
@@ -101,22 +163,9 @@ public:
         int busIdx      = -1;
         int numInputs   = 0;
         int numOutputs  = 0;
-        float lastGain  = 1.0;
-        float gain      = 1.0;
-        bool mute       = false;
+        int group       = -1;
+        int vca         = -1;
         MonitorPtr      monitor;
-
-        inline void update (const Track* const track)
-        {
-            this->index         = track->index;
-            this->busIdx        = track->busIdx;
-            this->numInputs     = track->numInputs;
-            this->numOutputs    = track->numOutputs;
-            this->gain          = track->gain;
-            this->lastGain      = track->gain;
-            this->mute          = track->mute;
-            this->monitor       = track->monitor;
-        }
     };
 
     explicit AudioMixerProcessor (int numTracks = 4,
@@ -125,13 +174,18 @@ public:
         : BaseProcessor (BusesProperties()
             .withOutput ("Master",  AudioChannelSet::stereo(), false))
     {
-        tracks.ensureStorageAllocated (16);
+        numTracks = jmin ((int) maxTracks, numTracks);
+        tracks.ensureStorageAllocated (jmax (16, numTracks));
         while (--numTracks >= 0)
             addStereoTrack();
         setRateAndBufferSizeDetails (sampleRate, bufferSize);
         addParameter (masterMute = new AudioParameterBool ("masterMute", "Master Mute", false));
         addParameter (masterVolume  = new AudioParameterFloat ("masterVolume",  "Master Volume", -120.0f, 12.0f, 0.f));
         masterMonitor = new Monitor (-1, 2);
+        masterMute->addListener (this);
+        masterVolume->addListener (this);
+        publish();
+        startTimerHz (15);
     }
 
     ~AudioMixerProcessor();
@@ -142,7 +196,7 @@ public:
     {
         desc.name = getName();
         desc.fileOrIdentifier   = "element.audioMixer";
-        desc.descriptiveName    = "Simple 4 track mixer";
+        desc.descriptiveName    = "Mixer with subgroups and VCAs";
         desc.category           = "Mixer";
         desc.numInputChannels   = getTotalNumInputChannels();
         desc.numOutputChannels  = getTotalNumOutputChannels();
@@ -153,14 +207,34 @@ public:
         desc.version            = "1.0.0";
     }
 
-    int getNumTracks() const { ScopedLock sl (getCallbackLock()); return tracks.size(); }
-    
+    int getNumTracks() const { ScopedLock sl (lock); return tracks.size(); }
+    int getNumGroups() const { ScopedLock sl (lock); return groups.size(); }
+    int getNumVcas()   const { ScopedLock sl (lock); return vcas.size(); }
+
     MonitorPtr getMonitor (const int track = -1) const;
-    
+    MonitorPtr getGroupMonitor (const int group) const;
+    MonitorPtr getVcaMonitor (const int vca) const;
+
     void setTrackGain  (const int track, const float gain);
     void setTrackMuted (const int track, const bool mute);
     bool isTrackMuted  (const int track) const;
     float getTrackGain (const int track) const;
+    void setTrackPan   (const int track, const float pan);
+    float getTrackPan  (const int track) const;
+
+    /** Adds a subgroup and returns its index, or -1 if there are maxGroups */
+    int addGroup();
+
+    /** Adds a VCA and returns its index, or -1 if there are maxVcas */
+    int addVca();
+
+    /** Routes a track to a subgroup, or to the master if group is negative */
+    void setTrackGroup (const int track, const int group);
+    int getTrackGroup  (const int track) const;
+
+    /** Puts a track under a VCA, or under none if vca is negative */
+    void setTrackVca   (const int track, const int vca);
+    int getTrackVca    (const int track) const;
 
     inline bool acceptsMidi()  const override { return false; }
     inline bool producesMidi() const override { return false; }
@@ -183,7 +257,7 @@ public:
         return true;
     }
 
-    bool canAddBus (bool) const override { return true; }
+    bool canAddBus (bool isInput) const override { return ! isInput || getBusCount (true) < maxTracks; }
     bool canRemoveBus (bool) const override { return true; }
     bool canApplyBusCountChange (bool isInput, bool isAdding,
                                  AudioProcessor::BusProperties& outProperties) override;
@@ -200,13 +274,40 @@ public:
     void setStateInformation (const void*, int) override;
 
 private:
+    struct Mix;
+
+    // message thread
+    CriticalSection lock;
     MonitorPtr masterMonitor;
     Array<Track*> tracks;
+    ReferenceCountedArray<Monitor> groups;
+    ReferenceCountedArray<Monitor> vcas;
     int numTracks = 0;
+
+    // handed to the audio thread, and back once replaced
+    Atomic<Mix*> pendingMix { nullptr };
+    Atomic<Mix*> retiredMix { nullptr };
+
+    // audio thread
+    Mix* activeMix = nullptr;
     AudioSampleBuffer tempBuffer;
+    AudioSampleBuffer groupBuffer;
     float lastGain = 0.f;
+
     void addMonoTrack();
     void addStereoTrack();
+
+    /** Builds a Mix from the tracks, groups and VCAs and hands it to the
+        audio thread. Message thread. */
+    void publish();
+    void releaseRetired();
+
+    /** Host and editor changes to the master parameters go to the monitor */
+    void parameterValueChanged (int, float) override;
+    void parameterGestureChanged (int, bool) override { }
+
+    /** Publishes the master monitor's gain and mute to the parameters */
+    void timerCallback() override;
 };
 
 }
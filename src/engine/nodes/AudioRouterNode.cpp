@@ -107,6 +107,18 @@ void AudioRouterNode::setMatrixState (const MatrixState& matrix)
     sendChangeMessage();
 }
 
+bool AudioRouterNode::trySetToggles (const ToggleGrid& newToggles) noexcept
+{
+    const ScopedTryLock sl (getLock());
+    if (! sl.isLocked())
+        return false;
+
+    jassert (nextToggles.sameSizeAs (newToggles));
+    nextToggles = newToggles;
+    togglesChanged = true;
+    return true;
+}
+
 MatrixState AudioRouterNode::getMatrixState() const
 {
     return state;
@@ -115,27 +127,18 @@ MatrixState AudioRouterNode::getMatrixState() const
 void AudioRouterNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
 {
     jassert (midi.getNumBuffers() == 1);
-    const auto& midiBuffer = *midi.getReadBuffer (0);
-
-    MidiBuffer::Iterator iter (midiBuffer);
-    ignoreUnused (iter);
-    MidiMessage msg; int midiFrame = 0;
-    
-    while (iter.getNextEvent (msg, midiFrame))
-    {
-        if (! msg.isProgramChange())
-            continue;
-        if (3 == msg.getProgramChangeNumber())
-            { DBG("program "); }
-    }
-
     const int numFrames = audio.getNumSamples();
     const int numChannels = audio.getNumChannels();
 
     tempAudio.setSize (numChannels, numFrames, false, false, true);
     tempAudio.clear (0, numFrames);
 
-    if (togglesChanged)
+    // the message thread only holds the lock to swap in new patches, if it
+    // has it now keep the current ones and pick up the change next block
+    const ScopedTryLock sl (lock);
+    const bool locked = sl.isLocked();
+
+    if (locked && togglesChanged)
     {
         fadeIn.reset();
         fadeIn.startFading();
@@ -145,12 +148,11 @@ void AudioRouterNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
         TRACE_AUDIO_ROUTER("fade start");
     }
 
-    if (fadeIn.isActive() || fadeOut.isActive())
+    if (locked && (fadeIn.isActive() || fadeOut.isActive()))
     {
         auto framesToProcess = numFrames;
         int frame = 0;
-        ScopedLock sl (lock);
-        
+
         float fadeInGain  = 0.0f;
         float fadeOutGain = 1.0f;
 
@@ -247,7 +249,6 @@ void AudioRouterNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
     }
     else
     {
-        ScopedLock sl (lock);
         for (int i = 0; i < numSources; ++i)
             for (int j = 0; j < numDestinations; ++j)
                 if (toggles.get (i, j))
@@ -42,6 +42,11 @@ public:
     void setState (const void*, int sizeInBytes) override;
 
     void setMatrixState (const MatrixState&);
+
+    /** Starts a crossfade to new patches without waiting for the lock.
+        Returns false if it is held, try again on the next block. The
+        matrix shown by the UI isn't changed. */
+    bool trySetToggles (const ToggleGrid& newToggles) noexcept;
     MatrixState getMatrixState() const;
     void setWithoutLocking (int src, int dst, bool set);
     CriticalSection& getLock() { return lock; }
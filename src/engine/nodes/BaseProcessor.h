@@ -41,6 +41,9 @@
 #define EL_INTERNAL_ID_MIDI_OUTPUT_DEVICE       "element.midiOutputDevice"
 #define EL_INTERNAL_ID_MIDI_MONITOR             "element.midiMonitor"
 #define EL_INTERNAL_ID_EQ_FILTER                "element.eqfilt"
+#define EL_INTERNAL_ID_LFO                      "element.lfo"
+#define EL_INTERNAL_ID_ENVELOPE_FOLLOWER        "element.envelopeFollower"
+#define EL_INTERNAL_ID_MIDI_TO_CONTROL          "element.midiToControl"
 
 #define EL_INTERNAL_UID_AUDIO_FILE_PLAYER        1000
 #define EL_INTERNAL_UID_AUDIO_MIXER              1001
@@ -60,6 +63,9 @@
 #define EL_INTERNAL_UID_MIDI_OUTPUT_DEVICE       1015
 #define EL_INTERNAL_UID_MIDI_MONITOR             1016
 #define EL_INTERNAL_UID_EQ_FILTER                1017
+#define EL_INTERNAL_UID_LFO                      1018
+#define EL_INTERNAL_UID_ENVELOPE_FOLLOWER        1019
+#define EL_INTERNAL_UID_MIDI_TO_CONTROL          1020
 
 namespace Element
 {
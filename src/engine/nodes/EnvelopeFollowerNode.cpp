@@ -0,0 +1,99 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/nodes/EnvelopeFollowerNode.h"
+
+namespace Element {
+
+EnvelopeFollowerNode::EnvelopeFollowerNode()
+    : GraphNode (0)
+{
+    jassert (metadata.hasType (Tags::node));
+    metadata.setProperty (Tags::format, "Element", nullptr);
+    metadata.setProperty (Tags::identifier, EL_INTERNAL_ID_ENVELOPE_FOLLOWER, nullptr);
+}
+
+EnvelopeFollowerNode::~EnvelopeFollowerNode() { }
+
+void EnvelopeFollowerNode::getPluginDescription (PluginDescription& desc) const
+{
+    desc.fileOrIdentifier   = EL_INTERNAL_ID_ENVELOPE_FOLLOWER;
+    desc.uid                = EL_INTERNAL_UID_ENVELOPE_FOLLOWER;
+    desc.name               = "Envelope Follower";
+    desc.descriptiveName    = "Turns the level of audio into a control signal";
+    desc.category           = "Modulation";
+    desc.numInputChannels   = 2;
+    desc.numOutputChannels  = 2;
+    desc.hasSharedContainer = false;
+    desc.isInstrument       = false;
+    desc.manufacturerName   = "Element";
+    desc.pluginFormatName   = "Element";
+    desc.version            = "1.0.0";
+}
+
+void EnvelopeFollowerNode::prepareToRender (double newSampleRate, int maxBufferSize)
+{
+    ignoreUnused (maxBufferSize);
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    envelope = 0.f;
+}
+
+void EnvelopeFollowerNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
+{
+    ignoreUnused (midi);
+    const int numSamples = audio.getNumSamples();
+    const float attackCoeff  = (float) std::exp (-1000.0 / (getAttack() * sampleRate));
+    const float releaseCoeff = (float) std::exp (-1000.0 / (getRelease() * sampleRate));
+    const float* const left  = audio.getReadPointer (0);
+    const float* const right = audio.getReadPointer (1);
+    float* const out = audio.getWritePointer (audio.getNumChannels() - 1);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float level = jmax (std::abs (left[i]), std::abs (right[i]));
+        const float coeff = level > envelope ? attackCoeff : releaseCoeff;
+        envelope = level + coeff * (envelope - level);
+        out[i] = jmin (1.f, envelope);
+    }
+
+    // keeps the follower from decaying into denormals on silence
+    if (envelope < 1.0e-6f)
+        envelope = 0.f;
+}
+
+void EnvelopeFollowerNode::getState (MemoryBlock& block)
+{
+    ValueTree tree ("envelopeFollower");
+    tree.setProperty ("attack", getAttack(), nullptr)
+        .setProperty ("release", getRelease(), nullptr);
+    MemoryOutputStream stream (block, false);
+    tree.writeToStream (stream);
+}
+
+void EnvelopeFollowerNode::setState (const void* data, int size)
+{
+    const auto tree = ValueTree::readFromData (data, (size_t) size);
+    if (! tree.isValid())
+        return;
+
+    setAttack ((float) tree.getProperty ("attack", 10.f));
+    setRelease ((float) tree.getProperty ("release", 200.f));
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "engine/GraphNode.h"
+#include "engine/MidiPipe.h"
+#include "engine/nodes/BaseProcessor.h"
+
+namespace Element {
+
+/** Follows the level of a stereo input and writes it to a control output.
+    Audio passes through untouched. */
+class EnvelopeFollowerNode : public GraphNode
+{
+public:
+    EnvelopeFollowerNode();
+    ~EnvelopeFollowerNode();
+
+    void getPluginDescription (PluginDescription& desc) const override;
+
+    void setAttack (float ms)           { attack.set (jlimit (0.1f, 1000.f, ms)); }
+    float getAttack() const             { return attack.get(); }
+    void setRelease (float ms)          { release.set (jlimit (1.f, 5000.f, ms)); }
+    float getRelease() const            { return release.get(); }
+
+    bool wantsMidiPipe() const override { return true; }
+    void prepareToRender (double sampleRate, int maxBufferSize) override;
+    void releaseResources() override { }
+    void render (AudioSampleBuffer& audio, MidiPipe& midi) override;
+
+    void getState (MemoryBlock& block) override;
+    void setState (const void* data, int size) override;
+
+private:
+    Atomic<float> attack { 10.f };
+    Atomic<float> release { 200.f };
+    double sampleRate = 44100.0;
+    float envelope = 0.f;
+    bool createdPorts = false;
+
+    void createPorts() override
+    {
+        if (createdPorts)
+            return;
+
+        ports.clearQuick();
+        ports.add (PortType::Audio, 0, 0, "audio_in_1", "Input 1", true);
+        ports.add (PortType::Audio, 1, 1, "audio_in_2", "Input 2", true);
+        ports.add (PortType::Audio, 2, 0, "audio_out_1", "Output 1", false);
+        ports.add (PortType::Audio, 3, 1, "audio_out_2", "Output 2", false);
+        ports.add (PortType::Control, 4, 0, "envelope_out", "Envelope", false);
+        createdPorts = true;
+    }
+};
+
+}
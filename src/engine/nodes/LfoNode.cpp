@@ -0,0 +1,105 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/nodes/LfoNode.h"
+
+namespace Element {
+
+LfoNode::LfoNode()
+    : GraphNode (0)
+{
+    jassert (metadata.hasType (Tags::node));
+    metadata.setProperty (Tags::format, "Element", nullptr);
+    metadata.setProperty (Tags::identifier, EL_INTERNAL_ID_LFO, nullptr);
+}
+
+LfoNode::~LfoNode() { }
+
+void LfoNode::getPluginDescription (PluginDescription& desc) const
+{
+    desc.fileOrIdentifier   = EL_INTERNAL_ID_LFO;
+    desc.uid                = EL_INTERNAL_UID_LFO;
+    desc.name               = "LFO";
+    desc.descriptiveName    = "Low frequency oscillator for modulation";
+    desc.category           = "Modulation";
+    desc.numInputChannels   = 0;
+    desc.numOutputChannels  = 0;
+    desc.hasSharedContainer = false;
+    desc.isInstrument       = false;
+    desc.manufacturerName   = "Element";
+    desc.pluginFormatName   = "Element";
+    desc.version            = "1.0.0";
+}
+
+void LfoNode::prepareToRender (double newSampleRate, int maxBufferSize)
+{
+    ignoreUnused (maxBufferSize);
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    phase = 0.0;
+}
+
+void LfoNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
+{
+    ignoreUnused (midi);
+    float* const out = audio.getWritePointer (audio.getNumChannels() - 1);
+    const double delta = (double) rate.get() / sampleRate;
+    const float scale = 0.5f * depth.get();
+    const int waveShape = shape.get();
+
+    for (int i = 0; i < audio.getNumSamples(); ++i)
+    {
+        const float p = (float) phase;
+        float wave;
+        switch (waveShape)
+        {
+            case Triangle:  wave = 4.f * std::abs (p - 0.5f) - 1.f; break;
+            case Saw:       wave = 2.f * p - 1.f; break;
+            case Square:    wave = p < 0.5f ? 1.f : -1.f; break;
+            default:        wave = std::sin (MathConstants<float>::twoPi * p); break;
+        }
+
+        out[i] = 0.5f + scale * wave;
+        phase += delta;
+        if (phase >= 1.0)
+            phase -= 1.0;
+    }
+}
+
+void LfoNode::getState (MemoryBlock& block)
+{
+    ValueTree tree ("lfo");
+    tree.setProperty ("rate", getRate(), nullptr)
+        .setProperty ("shape", getShape(), nullptr)
+        .setProperty ("depth", getDepth(), nullptr);
+    MemoryOutputStream stream (block, false);
+    tree.writeToStream (stream);
+}
+
+void LfoNode::setState (const void* data, int size)
+{
+    const auto tree = ValueTree::readFromData (data, (size_t) size);
+    if (! tree.isValid())
+        return;
+
+    setRate ((float) tree.getProperty ("rate", 1.f));
+    setShape ((int) tree.getProperty ("shape", (int) Sine));
+    setDepth ((float) tree.getProperty ("depth", 1.f));
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "engine/GraphNode.h"
+#include "engine/MidiPipe.h"
+#include "engine/nodes/BaseProcessor.h"
+
+namespace Element {
+
+/** A low frequency oscillator with a control output, for modulating the
+    parameters of other nodes. The output swings around 0.5 by depth. */
+class LfoNode : public GraphNode
+{
+public:
+    enum Shape
+    {
+        Sine = 0,
+        Triangle,
+        Saw,
+        Square,
+        numShapes
+    };
+
+    LfoNode();
+    ~LfoNode();
+
+    void getPluginDescription (PluginDescription& desc) const override;
+
+    void setRate (float hz)             { rate.set (jlimit (0.01f, 100.f, hz)); }
+    float getRate() const               { return rate.get(); }
+    void setShape (int newShape)        { shape.set (jlimit (0, numShapes - 1, newShape)); }
+    int getShape() const                { return shape.get(); }
+    void setDepth (float newDepth)      { depth.set (jlimit (0.f, 1.f, newDepth)); }
+    float getDepth() const              { return depth.get(); }
+
+    bool wantsMidiPipe() const override { return true; }
+    void prepareToRender (double sampleRate, int maxBufferSize) override;
+    void releaseResources() override { }
+    void render (AudioSampleBuffer& audio, MidiPipe& midi) override;
+
+    void getState (MemoryBlock& block) override;
+    void setState (const void* data, int size) override;
+
+private:
+    Atomic<float> rate { 1.f };
+    Atomic<float> depth { 1.f };
+    Atomic<int> shape { Sine };
+    double sampleRate = 44100.0;
+    double phase = 0.0;
+    bool createdPorts = false;
+
+    void createPorts() override
+    {
+        if (createdPorts)
+            return;
+
+        ports.clearQuick();
+        ports.add (PortType::Control, 0, 0, "lfo_out", "LFO", false);
+        createdPorts = true;
+    }
+};
+
+}
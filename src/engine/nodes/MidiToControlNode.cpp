@@ -0,0 +1,96 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/nodes/MidiToControlNode.h"
+
+namespace Element {
+
+MidiToControlNode::MidiToControlNode()
+    : MidiFilterNode (0)
+{
+    jassert (metadata.hasType (Tags::node));
+    metadata.setProperty (Tags::format, "Element", nullptr);
+    metadata.setProperty (Tags::identifier, EL_INTERNAL_ID_MIDI_TO_CONTROL, nullptr);
+}
+
+MidiToControlNode::~MidiToControlNode() { }
+
+void MidiToControlNode::getPluginDescription (PluginDescription& desc) const
+{
+    desc.fileOrIdentifier   = EL_INTERNAL_ID_MIDI_TO_CONTROL;
+    desc.uid                = EL_INTERNAL_UID_MIDI_TO_CONTROL;
+    desc.name               = "MIDI to Control";
+    desc.descriptiveName    = "Turns a MIDI controller into a control signal";
+    desc.category           = "Modulation";
+    desc.numInputChannels   = 0;
+    desc.numOutputChannels  = 0;
+    desc.hasSharedContainer = false;
+    desc.isInstrument       = false;
+    desc.manufacturerName   = "Element";
+    desc.pluginFormatName   = "Element";
+    desc.version            = "1.0.0";
+}
+
+void MidiToControlNode::render (AudioSampleBuffer& audio, MidiPipe& midi)
+{
+    const int numSamples = audio.getNumSamples();
+    float* const out = audio.getWritePointer (audio.getNumChannels() - 1);
+    const int cc = controller.get();
+    const int ch = channel.get();
+    int start = 0;
+
+    if (midi.getNumBuffers() > 0)
+    {
+        MidiBuffer::Iterator iter (*midi.getReadBuffer (0));
+        MidiMessage msg; int frame = 0;
+        while (iter.getNextEvent (msg, frame))
+        {
+            if (! msg.isControllerOfType (cc) || (ch > 0 && msg.getChannel() != ch))
+                continue;
+
+            frame = jlimit (start, numSamples, frame);
+            FloatVectorOperations::fill (out + start, value, frame - start);
+            value = (float) msg.getControllerValue() / 127.f;
+            start = frame;
+        }
+    }
+
+    FloatVectorOperations::fill (out + start, value, numSamples - start);
+}
+
+void MidiToControlNode::getState (MemoryBlock& block)
+{
+    ValueTree tree ("midiToControl");
+    tree.setProperty ("controller", getController(), nullptr)
+        .setProperty ("channel", getChannel(), nullptr);
+    MemoryOutputStream stream (block, false);
+    tree.writeToStream (stream);
+}
+
+void MidiToControlNode::setState (const void* data, int size)
+{
+    const auto tree = ValueTree::readFromData (data, (size_t) size);
+    if (! tree.isValid())
+        return;
+
+    setController ((int) tree.getProperty ("controller", 1));
+    setChannel ((int) tree.getProperty ("channel", 0));
+}
+
+}
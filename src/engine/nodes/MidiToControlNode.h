@@ -0,0 +1,72 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "engine/nodes/MidiFilterNode.h"
+#include "engine/MidiPipe.h"
+#include "engine/nodes/BaseProcessor.h"
+
+namespace Element {
+
+/** Turns a MIDI controller into a control signal. MIDI passes through and
+    the output holds the last value received. */
+class MidiToControlNode : public MidiFilterNode
+{
+public:
+    MidiToControlNode();
+    ~MidiToControlNode();
+
+    void getPluginDescription (PluginDescription& desc) const override;
+
+    /** Sets the controller number to follow */
+    void setController (int cc)         { controller.set (jlimit (0, 127, cc)); }
+    int getController() const           { return controller.get(); }
+
+    /** Sets the MIDI channel to listen on, zero for all */
+    void setChannel (int ch)            { channel.set (jlimit (0, 16, ch)); }
+    int getChannel() const              { return channel.get(); }
+
+    void prepareToRender (double sampleRate, int maxBufferSize) override { ignoreUnused (sampleRate, maxBufferSize); }
+    void releaseResources() override { }
+    void render (AudioSampleBuffer& audio, MidiPipe& midi) override;
+
+    void getState (MemoryBlock& block) override;
+    void setState (const void* data, int size) override;
+
+private:
+    Atomic<int> controller { 1 };
+    Atomic<int> channel { 0 };
+    float value = 0.f;
+    bool createdPorts = false;
+
+    void createPorts() override
+    {
+        if (createdPorts)
+            return;
+
+        ports.clearQuick();
+        ports.add (PortType::Midi, 0, 0, "midi_in", "MIDI In", true);
+        ports.add (PortType::Midi, 1, 0, "midi_out", "MIDI Out", false);
+        ports.add (PortType::Control, 2, 0, "control_out", "Control", false);
+        createdPorts = true;
+    }
+};
+
+}
@@ -65,6 +65,7 @@ public:
     inline void setPath (const Path& p, float reduceby = 2.f)
     {
         path = p;
+        sharedPath = getIcons().contains (&p) ? &p : nullptr;
         pathReduction = jmax (2.f, reduceby);
     }
 
@@ -82,6 +83,7 @@ private:
     String no  = "No";
     Image icon;
     Path path;
+    const Path* sharedPath = nullptr; // drawn from the icon cache when set
     int pathReduction = 2;
 };
 
@@ -203,6 +203,7 @@ public:
         int index = 30000;
         GraphNodePtr ptr = node.getGraphNode();
         menu.addItem (index++, "Mute input ports", ptr != nullptr, ptr && ptr->isMutingInputs());
+        menu.addItem (index++, "Sample accurate controls", ptr != nullptr, ptr && ptr->wantsSubBlockControls());
 
         addOversamplingSubmenu (menu);
 
@@ -218,10 +219,20 @@ public:
         if (ptr == nullptr || ptr->isAudioIONode() || ptr->isMidiIONode()) // not the right type of node
             return;
 
-        osMenu.addItem (index++, "1x", true, ptr->getOversamplingFactor() == 1);
+        const bool downsampled = ptr->getDownsamplingFactor() > 1;
+        osMenu.addItem (index++, "1x", true, ! downsampled && ptr->getOversamplingFactor() == 1);
         osMenu.addItem (index++, "2x", true, ptr->getOversamplingFactor() == 2);
         osMenu.addItem (index++, "4x", true, ptr->getOversamplingFactor() == 4);
         osMenu.addItem (index++, "8x", true, ptr->getOversamplingFactor() == 8);
+
+        if (ptr->isSubGraph())
+        {
+            // subgraphs can also run below the parent rate
+            index = 40100;
+            osMenu.addSeparator();
+            osMenu.addItem (++index, "1/2x", true, ptr->getDownsamplingFactor() == 2);
+            osMenu.addItem (++index, "1/4x", true, ptr->getDownsamplingFactor() == 4);
+        }
                                                       
         menuToAddTo.addSubMenu ("Oversample", osMenu);
     }
@@ -354,11 +365,16 @@ public:
                 case 0:
                     node.setMuteInput (! node.isMutingInputs());
                     break;
+                case 1:
+                    node.setSubBlockControls (! node.wantsSubBlockControls());
+                    break;
             }
         }
         else if (result >= 40000 && result < 50000)
         {
-            const int osFactor = (int) powf(2, float (result - 40000));
+            const bool downsample = result > 40100;
+            const int factor = downsample ? (int) powf (2, float (result - 40100))
+                                          : (int) powf (2, float (result - 40000));
             if (auto gNode = node.getGraphNode())
             {
                 auto* graph = gNode->getParentGraph();
@@ -366,7 +382,15 @@ public:
                 bool wasSuspended = graph->isSuspended();
                 graph->suspendProcessing (true);
                 graph->releaseResources();
-                gNode->setOversamplingFactor (osFactor);
+                if (downsample)
+                {
+                    gNode->setDownsamplingFactor (factor);
+                }
+                else
+                {
+                    gNode->setDownsamplingFactor (1);
+                    gNode->setOversamplingFactor (factor);
+                }
                 graph->prepareToPlay (gNode->getParentGraph()->getSampleRate(), gNode->getParentGraph()->getBlockSize());
                 graph->suspendProcessing (wasSuspended);
             }
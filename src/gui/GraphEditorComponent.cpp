@@ -295,11 +295,16 @@ public:
             muteButton.addListener (this);
         }
 
+        if (GraphNodePtr obj = node.getGraphNode())
+            faultChangedConnection = obj->faultChanged.connect (
+                std::bind (&FilterComponent::triggerAsyncUpdate, this));
+
         setSize (170, 60);
     }
 
     ~FilterComponent() noexcept
     {
+        faultChangedConnection.disconnect();
         nodeEnabled.removeListener (this);
         nodeName.removeListener (this);
         deleteAllPins();
@@ -317,6 +322,9 @@ public:
 
     void handleAsyncUpdate() override
     {
+        // while faulted the power button only clears the fault
+        if (GraphNodePtr obj = node.getGraphNode())
+            powerButton.setClickingTogglesState (! obj->isFaulted());
         repaint();
     }
 
@@ -344,6 +352,16 @@ public:
         }
         else if (b == &powerButton)
         {
+            if (obj->isFaulted())
+            {
+                // re-arms a node silenced by the signal guard and leaves bypass
+                // alone, undoing the toggle if the fault arrived mid click
+                if (powerButton.getClickingTogglesState())
+                    powerButton.setToggleState (! powerButton.getToggleState(), dontSendNotification);
+                obj->clearFault();
+                return;
+            }
+
             if (obj->isSuspended() != node.isBypassed())
                 obj->suspendProcessing (node.isBypassed());
         }
@@ -596,6 +614,16 @@ public:
             g.drawFittedText ("(placeholder)", pr, Justification::centred, 2);
         }
 
+        GraphNodePtr obj = node.getGraphNode();
+        const bool faulted = obj != nullptr && obj->isFaulted();
+        if (faulted)
+        {
+            g.setColour (Colors::toggleRed);
+            g.setFont (9.f);
+            auto pr = box; pr.removeFromTop (6);
+            g.drawFittedText ("(invalid output)", pr, Justification::centred, 2);
+        }
+
         g.setColour (Colours::black);
         g.setFont (font);
         
@@ -643,7 +671,7 @@ public:
         }
         
         bool selected = getGraphPanel()->selectedNodes.isSelected (node.getNodeId());
-        g.setColour (selected ? Colors::toggleBlue : Colours::grey);
+        g.setColour (faulted ? Colors::toggleRed : selected ? Colors::toggleBlue : Colours::grey);
         g.drawRoundedRectangle (box.toFloat(), cornerSize, 1.4);
     }
 
@@ -729,9 +757,6 @@ public:
         for (int i = 0; i < numPorts; ++i)
         {
             const Port port (node.getPort (i));
-            if (PortType::Control == port.getType())
-                continue;
-            
             if (port.isInput())
                 ++numIns;
             else
@@ -781,9 +806,6 @@ public:
             {
                 const Port port (node.getPort (i));
                 const PortType t (port.getType());
-                if (t == PortType::Control)
-                    continue;
-                
                 const bool isInput (port.isInput());
                 addAndMakeVisible (new PinComponent (graph, node, filterID, i, isInput, t, vertical));
             }
@@ -800,6 +822,7 @@ private:
 
     Value nodeEnabled;
     Value nodeName;
+    SignalConnection faultChangedConnection;
 
     int numInputs = 0, numOutputs = 0;
     int numIns = 0, numOuts = 0;
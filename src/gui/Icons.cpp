@@ -1421,4 +1421,82 @@ Icons::~Icons()
     __icons = nullptr;
 }
 
+//==============================================================================
+struct Icons::RasterCache
+{
+    enum { maxImages = 1024, maxSize = 512 };
+
+    HashMap<int64, Image> images;
+    float displayScale = 0.f;
+};
+
+bool Icons::drawCached (Graphics& g, const Path& path, Colour colour,
+                        const AffineTransform& transform) const
+{
+    if (! contains (&path))
+        return false;
+
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto bounds = path.getBounds().transformedBy (transform);
+    const int width  = roundToInt (std::ceil (bounds.getWidth() * scale));
+    const int height = roundToInt (std::ceil (bounds.getHeight() * scale));
+    if (width <= 0 || height <= 0 || width > RasterCache::maxSize || height > RasterCache::maxSize)
+        return false;
+
+    if (rasters == nullptr)
+        const_cast<Icons*> (this)->rasters.reset (new RasterCache());
+
+    // images are sized in physical pixels, so a display scale change
+    // leaves every entry unused
+    const float displayScale = (float) Desktop::getInstance().getDisplays().getMainDisplay().scale;
+    if (displayScale != rasters->displayScale || rasters->images.size() >= RasterCache::maxImages)
+    {
+        rasters->images.clear();
+        rasters->displayScale = displayScale;
+    }
+
+    const auto index = (uint64) ((reinterpret_cast<const char*> (&path) - reinterpret_cast<const char*> (this)) / (int) sizeof (Path));
+    const auto key = (int64) (index | ((uint64) width << 6) | ((uint64) height << 16) | ((uint64) colour.getARGB() << 32));
+
+    Image image (rasters->images [key]);
+    if (image.isNull())
+    {
+        image = Image (Image::ARGB, width, height, true);
+        Graphics ig (image);
+        ig.setColour (colour);
+        ig.fillPath (path, RectanglePlacement (RectanglePlacement::centred).getTransformToFit (
+            path.getBounds(), { 0.f, 0.f, (float) width, (float) height }));
+        rasters->images.set (key, image);
+    }
+
+    // land on whole physical pixels so the blit isn't resampled
+    const Rectangle<float> target (std::round (bounds.getX() * scale) / scale,
+                                   std::round (bounds.getY() * scale) / scale,
+                                   (float) width / scale, (float) height / scale);
+    Graphics::ScopedSaveState state (g);
+    g.setOpacity (1.f);
+    g.drawImage (image, target);
+    return true;
+}
+
+void Icon::draw (Graphics& g, const Rectangle<float>& area, bool isCrossedOut) const
+{
+    if (path == nullptr)
+        return;
+
+    const RectanglePlacement placement (RectanglePlacement::centred | RectanglePlacement::onlyReduceInSize);
+    const auto transform = placement.getTransformToFit (path->getBounds(), area);
+
+    g.setColour (colour);
+    if (! getIcons().drawCached (g, *path, colour, transform))
+        g.fillPath (*path, transform);
+
+    if (isCrossedOut)
+    {
+        g.setColour (Colours::red.withAlpha (0.8f));
+        g.drawLine ((float) area.getX(), area.getY() + area.getHeight() * 0.2f,
+                    (float) area.getRight(), area.getY() + area.getHeight() * 0.8f, 3.0f);
+    }
+}
+
 }
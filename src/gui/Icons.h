@@ -29,23 +29,9 @@ struct Icon
     Icon (const Path& p, const Colour& c)  : path (&p), colour (c) {}
     Icon (const Path* p, const Colour& c)  : path (p),  colour (c) {}
 
-    void draw (Graphics& g, const Rectangle<float>& area, bool isCrossedOut) const
-    {
-        if (path != nullptr)
-        {
-            g.setColour (colour);
-
-            const RectanglePlacement placement (RectanglePlacement::centred | RectanglePlacement::onlyReduceInSize);
-            g.fillPath (*path, placement.getTransformToFit (path->getBounds(), area));
-
-            if (isCrossedOut)
-            {
-                g.setColour (Colours::red.withAlpha (0.8f));
-                g.drawLine ((float) area.getX(), area.getY() + area.getHeight() * 0.2f,
-                            (float) area.getRight(), area.getY() + area.getHeight() * 0.8f, 3.0f);
-            }
-        }
-    }
+    /** Draws the icon centred in an area. Shared icons from getIcons() are
+        drawn from a cached image, other paths are filled directly. */
+    void draw (Graphics& g, const Rectangle<float>& area, bool isCrossedOut) const;
 
     Icon withContrastingColourTo (const Colour& background) const
     {
@@ -61,6 +47,20 @@ class Icons : public DeletedAtShutdown
 public:
     Icons();
     ~Icons();
+
+    /** Returns true if the path is one of these icons */
+    bool contains (const Path* path) const noexcept
+    {
+        return reinterpret_cast<const char*> (path) >= reinterpret_cast<const char*> (this)
+            && reinterpret_cast<const char*> (path) < reinterpret_cast<const char*> (this) + sizeof (Icons);
+    }
+
+    /** Fills one of these icons from an image rendered once per pixel size
+        and colour. Returns false if the path isn't one of these icons or is
+        too big to cache, in which case nothing is drawn. */
+    bool drawCached (Graphics& g, const Path& path, Colour colour,
+                     const AffineTransform& transform) const;
+
     Path folder, document, imageDoc,
          config, exporter, juceLogo,
          graph, jigsaw, info, warning,
@@ -79,6 +79,8 @@ public:
          fasRectangleLandscape;
 
 private:
+    struct RasterCache;
+    std::unique_ptr<RasterCache> rasters;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Icons)
 };
 
@@ -22,21 +22,12 @@
 
 namespace Element {
 
-typedef SelectedItemSet<NoteClipItem*>::ItemArray SelectedNotes;
+static const int numVelocityColours = 8;
 
-NoteSelection::NoteSelection() { }
-NoteSelection::~NoteSelection() { }
-
-void NoteSelection::itemSelected (NoteClipItem *item)
-{
-    item->setSelected (true);
-    item->repaint();
-}
-
-void NoteSelection::itemDeselected  (NoteClipItem *item)
+static Colour getVelocityColour (int bucket)
 {
-    item->setSelected (false);
-    item->repaint();
+    return Colours::lightsalmon.interpolatedWith (Colours::red,
+        (float) bucket / (float) (numVelocityColours - 1));
 }
 
 //=========================================================================
@@ -48,407 +39,677 @@ MidiEditorBody::MidiEditorBody (MidiKeyboardState& k)
     sequenceNode = sequence->node();
     sequenceNode.addListener (this);
 
-    setTrackWidth (80);
-    setTrackHeightsOffset (-getTracksTotalHeight() / 2, false);
-    resized();
-    repaint();
-
-    addAndMakeVisible (&lasso);
-    trackDeltaY = 0;
-
-    insertChannel = 1;
-    insertLength = 0.49f;
-    insertVelocity = 0.8f;
-
-    trackDrag = keyboardDrag = false;
+    midiChannels.setRange (1, 16, true);
+    showAllTracks();
+    setScrollY (0.5f * (float) rowKeys.size() * rowHeight);
+    setOpaque (true);
+    setWantsKeyboardFocus (false);
 }
 
 MidiEditorBody::~MidiEditorBody()
 {
+    cancelPendingUpdate();
     sequenceNode.removeListener (this);
-    notes.clear();
+    index.clear();
     sequence.clear();
 }
 
-
-void
-MidiEditorBody::addNote (int note, float start, float length, int channel)
+void MidiEditorBody::addNote (int note, double start, double length, int channel)
 {
     jassert (sequence.get() != nullptr);
     sequence->addNote (note, start, length, channel);
 }
 
+//=========================================================================
+double MidiEditorBody::xToTicks (int x, bool snap) const
+{
+    const double ticks = scrollTicks + (double) (x - keyboardWidth) / pixelsPerTick;
+    if (! snap)
+        return ticks;
+    const double grid = ticksPerBeat / 4.0;
+    return jmax (0.0, std::floor (ticks / grid) * grid);
+}
 
-void MidiEditorBody::addSequence (const MidiMessageSequence&)
+float MidiEditorBody::ticksToX (double ticks) const
 {
+    return (float) keyboardWidth + (float) ((ticks - scrollTicks) * pixelsPerTick);
 }
 
-void MidiEditorBody::clipClicked (TimelineClip* clip, const MouseEvent& clipEvent )
+int MidiEditorBody::keyAt (int y) const
 {
-    if (NoteClipItem* n = dynamic_cast<NoteClipItem*> (clip))
-    {
-        if (selected.getNumSelected() == 0)
-            selected.selectOnly (n);
-        else if (clipEvent.mods.isShiftDown())
-            selected.addToSelection (n);
+    const int row = (int) std::floor (((float) y + scrollY) / rowHeight);
+    return isPositiveAndBelow (row, rowKeys.size()) ? rowKeys.getUnchecked (row) : -1;
+}
 
-        if (triggerNotes())
-            keyboardState.noteOn (insertChannel, n->keyId(), insertVelocity);
-    }
+bool MidiEditorBody::isNoteVisible (const NoteIndex::Item& item) const
+{
+    return keyRows [item.key] >= 0 && midiChannels [item.channel];
 }
 
-void
-MidiEditorBody::clipDoubleClicked (TimelineClip* clip, const MouseEvent& /* clipEvent */)
+Rectangle<float> MidiEditorBody::getNoteBounds (const NoteIndex::Item& item, double deltaTicks,
+                                                double deltaEnd, int deltaKeys) const
 {
-    if (NoteClipItem* n = dynamic_cast<NoteClipItem*> (clip))
-        sequence->removeNote (n->note());
+    const int key = jlimit (0, 127, item.key + deltaKeys);
+    const int row = keyRows [key];
+    if (row < 0)
+        return {};
+
+    const float x1 = ticksToX (item.start + deltaTicks);
+    const float x2 = ticksToX (jmax (item.start + deltaTicks, item.end + deltaEnd));
+    return { x1, getRowY (row), jmax (1.f, x2 - x1), rowHeight };
 }
 
-void MidiEditorBody::clipMoved (TimelineClip* clip, const MouseEvent&, double deltaStart, double deltaEnd)
+int MidiEditorBody::getNoteAt (const Point<int>& pos) const
 {
-    if (clip->isSelected())
-    {
-        Range<double> time;
-        
-        const SelectedNotes& items (selected.getItemArray());
-        for (int i = 0; i < items.size(); ++i)
-        {
-            NoteClipItem* note = items.getUnchecked(i);
-            if (note == clip)
-                continue;
+    const int key = keyAt (pos.y);
+    if (key < 0 || pos.x < keyboardWidth)
+        return -1;
 
-            note->getTime (time);
-            time.setStart (time.getStart() + deltaStart);
-            time.setEnd (time.getEnd() + deltaEnd);
-            note->setTime (time);
+    const int id = index.hitTest (xToTicks (pos.x), key);
+    return id >= 0 && midiChannels [index.get(id).channel] ? id : -1;
+}
 
-            updateClip (note);
-        }
+void MidiEditorBody::setPixelsPerTick (double newPixelsPerTick)
+{
+    newPixelsPerTick = jlimit (0.0005, 2.0, newPixelsPerTick);
+    if (pixelsPerTick == newPixelsPerTick)
+        return;
+    pixelsPerTick = newPixelsPerTick;
+    repaint();
+}
+
+void MidiEditorBody::setScrollY (float newScrollY)
+{
+    const float maxScroll = jmax (0.f, (float) rowKeys.size() * rowHeight - (float) getHeight());
+    newScrollY = jlimit (0.f, maxScroll, newScrollY);
+    if (scrollY == newScrollY)
+        return;
+    scrollY = newScrollY;
+    repaint();
+}
+
+void MidiEditorBody::setVisibleKeys (const BigInteger& keys)
+{
+    rowKeys.clearQuick();
+    for (int key = 127; key >= 0; --key)
+    {
+        keyRows [key] = keys [key] ? rowKeys.size() : -1;
+        if (keys [key])
+            rowKeys.add (key);
     }
+
+    setScrollY (scrollY);
+    repaint();
 }
 
-void
-MidiEditorBody::clipChangedTrack (TimelineClip *clip, int trackDelta)
+void MidiEditorBody::showAllTracks()
+{
+    BigInteger keys;
+    keys.setRange (0, 128, true);
+    setVisibleKeys (keys);
+}
+
+void MidiEditorBody::hideEmptyKeys()
 {
+    BigInteger keys;
+    keys.setRange (0, 128, false);
+    sequence->getKeysWithEvents (keys);
+    setVisibleKeys (keys);
+}
 
-    if (triggerNotes()) {
-        if (NoteClipItem* note = dynamic_cast<NoteClipItem*> (clip))
-            keyboardState.noteOn (note->channel(), note->keyId(), insertVelocity);
+void MidiEditorBody::setVisibleChannel (int chan, bool updateInsertChannel)
+{
+    if (chan == 0)
+    {
+        midiChannels.setRange (1, 16, true);
+        repaint();
+        return;
     }
 
-    if (! clip->isSelected())
+    chan = jlimit (1, 16, chan);
+    midiChannels.clear();
+    midiChannels.setBit (chan, true);
+    insertChannel = updateInsertChannel ? chan : insertChannel;
+
+    // hidden notes can't stay selected
+    const auto selected = index.getSelectedIds();
+    for (const int id : selected)
+        if (! midiChannels [index.get(id).channel])
+            index.setSelected (id, false);
+
+    repaint();
+}
+
+void MidiEditorBody::setNoteSequence (const NoteSequence& s)
+{
+    if (sequenceNode == s.node())
         return;
 
-    const SelectedNotes& notes (selected.getItemArray());
-    for (int i = 0; i < notes.size(); ++i)
-    {
-        NoteClipItem* note = notes.getUnchecked (i);
-        if (note == clip) {
-             continue;
-        }
+    sequenceNode.removeListener (this);
+    sequence.setOwned (new NoteSequence (s));
+    sequenceNode = sequence->node();
+    sequenceNode.addListener (this);
 
-        note->adjustTrackIndex (trackDelta, false);
-        updateClip (note);
-    }
+    cancelPendingUpdate();
+    rebuildIndex();
+    repaint();
 }
 
+void MidiEditorBody::selectNotesOnKey (int key, bool deselectOthers)
+{
+    if (deselectOthers)
+        index.deselectAll();
 
-void
-MidiEditorBody::findLassoItemsInArea (Array <NoteClipItem*>& itemsFound, const Rectangle<int>& area)
+    Array<int> ids;
+    index.query ({ 0.0, std::numeric_limits<double>::max() }, key, key, ids);
+    for (const int id : ids)
+        if (index.get(id).channel == insertChannel)
+            index.setSelected (id, true);
+
+    repaint();
+}
+
+//=========================================================================
+void MidiEditorBody::paint (Graphics& g)
 {
-    for (int i = 0; i < notes.size(); ++i)
+    const auto body = getLocalBounds().withTrimmedLeft (keyboardWidth);
+    const int firstRow = jmax (0, (int) std::floor (scrollY / rowHeight));
+    const int lastRow  = jmin (rowKeys.size() - 1, (int) std::floor ((scrollY + (float) getHeight()) / rowHeight));
+
+    g.fillAll (Colour (0xff888888));
+
+    // lanes
+    for (int row = firstRow; row <= lastRow; ++row)
     {
-        NoteClipItem* note = notes.getUnchecked(i);
-        if (area.intersects (note->getBounds())) {
-            itemsFound.add (note);
-            selected.addToSelection (note);
-        } else {
-            selected.deselect (note);
-        }
+        g.setColour (MidiMessage::isMidiNoteBlack (rowKeys.getUnchecked (row))
+            ? Colour (0xff888888) : Colour (0xff999999));
+        g.fillRect ((float) body.getX(), getRowY (row), (float) body.getWidth(), rowHeight);
     }
-}
 
-NoteSelection& MidiEditorBody::getLassoSelection() { return selected; }
-int MidiEditorBody::getNumTracks() const { return 127; }
+    // beat lines, skipped when they'd be closer than a few pixels
+    const double beatWidth = ticksPerBeat * pixelsPerTick;
+    if (beatWidth >= 4.0)
+    {
+        g.setColour (Colours::black.withAlpha (0.2f));
+        const double endTicks = xToTicks (body.getRight());
+        for (double beat = std::ceil (scrollTicks / ticksPerBeat); beat * ticksPerBeat < endTicks; beat += 1.0)
+            g.drawVerticalLine (roundToInt (ticksToX (beat * ticksPerBeat)), 0.f, (float) getHeight());
+    }
 
-void
-MidiEditorBody::mouseDoubleClick (const MouseEvent &ev)
-{
-    if (ev.x > getTrackWidth())
     {
-        const int keyId = 127 - trackAt (ev);
-        const double ticks (xToTicks (ev.x, true));
+        Graphics::ScopedSaveState state (g);
+        g.reduceClipRegion (body);
+        paintNotes (g, body, firstRow, lastRow);
+    }
+
+    paintKeyboard (g, firstRow, lastRow);
 
-        addNote (keyId, ticks, (float)1920.f * 0.5f, insertChannel);
+    if (dragMode == dragLasso && ! lassoArea.isEmpty())
+    {
+        g.setColour (Colours::aqua.withAlpha (0.2f));
+        g.fillRect (lassoArea);
+        g.setColour (Colours::aqua);
+        g.drawRect (lassoArea, 1);
     }
 }
 
-void
-MidiEditorBody::mouseDrag (const MouseEvent &event)
+void MidiEditorBody::paintKeyboard (Graphics& g, int firstRow, int lastRow)
 {
-    lasso.dragLasso (event);
+    g.setColour (Colours::darkgrey);
+    g.fillRect (0, 0, keyboardWidth, getHeight());
 
-    if (trackDrag)
+    const int half = keyboardWidth / 2;
+    for (int row = firstRow; row <= lastRow; ++row)
     {
-        setTrackHeightsOffset ( -(trackDeltaY - event.y), true);
-        trackDeltaY = event.y;
-    }
+        const int key = rowKeys.getUnchecked (row);
+        const Rectangle<float> area (0.f, getRowY (row), (float) keyboardWidth, rowHeight);
 
-    if (keyboardDrag)
-    {
-        const int keyId = 127 - trackAt (event);
-        selectNotesOnKey (keyId, false);
+        g.setColour (MidiMessage::isMidiNoteBlack (key) ? Colours::black : Colours::white);
+        g.fillRect (area.withTrimmedLeft ((float) half).reduced (0.f, 0.5f));
 
-        if (dragTrack != trackAt (event))
+        if (key % 12 == 0)
         {
-            dragTrack = trackAt (event);
+            g.setFont (Font (10.0f));
+            g.setColour (Colours::black.withAlpha (0.78f));
+            g.drawText (String (key), area.withWidth ((float) half), Justification::left, true);
 
-            if (triggerNotes())
-                keyboardState.noteOn (insertChannel, 127 - dragTrack, insertVelocity);
+            g.setColour (Colours::black.withAlpha (0.5f));
+            g.drawHorizontalLine (roundToInt (area.getBottom()), 0.f, (float) keyboardWidth);
         }
     }
 }
 
-void MidiEditorBody::mouseUp (const MouseEvent& ev)
+void MidiEditorBody::paintNotes (Graphics& g, const Rectangle<int>& body, int firstRow, int lastRow)
 {
-    TimelineComponent::mouseUp (ev);
-    lasso.endLasso();
-    trackDrag = keyboardDrag = false;
-    trackDeltaY = 0;
-    keyboardState.allNotesOff (insertChannel);
-}
+    if (firstRow > lastRow)
+        return;
 
-void MidiEditorBody::mouseWheelMove (const MouseEvent &event, const MouseWheelDetails &wheel)
-{
-    if (this == getComponentAt (event.getPosition()))
-        setTrackHeightsOffset (wheel.deltaY * 100.0f, true);
-}
+    const bool dragging = dragMode == dragMove || dragMode == dragResize;
+    const double deltaStart = dragMode == dragMove ? dragTicks : 0.0;
+    const double deltaEnd   = dragTicks;
+    const int deltaKeys     = dragMode == dragMove ? dragKeys : 0;
 
-void MidiEditorBody::onNoteAdded (const Note& note)
-{
-    if (note.isValid())
+    const Range<double> ticks (xToTicks (body.getX()), xToTicks (body.getRight()) + 1.0);
+    const int highestKey = rowKeys.getUnchecked (firstRow);
+    const int lowestKey  = rowKeys.getUnchecked (lastRow);
+
+    RectangleList<float> outlines, selected;
+    RectangleList<float> fills [numVelocityColours];
+    Array<int> labels;
+
+    Array<int> ids;
+    index.query (ticks, lowestKey, highestKey, ids);
+
+    // ids come back per key in start order, so anything that ends before
+    // the last note drawn on the same key is hidden behind it
+    int lastKey = -1;
+    float coveredUntil = 0.f;
+
+    for (const int id : ids)
     {
-        NoteClipItem* c = findFreeClip<NoteClipItem>();
+        const auto& item = index.get (id);
+        if (! isNoteVisible (item) || (dragging && item.isSelected()))
+            continue;
 
-        if (c == nullptr)
-            c = new NoteClipItem (*this, note);
-        else {
-            c->setModel (note);
+        const auto r = getNoteBounds (item, 0.0, 0.0, 0);
+        if (item.key != lastKey)
+        {
+            lastKey = item.key;
+            coveredUntil = r.getX() - 1.f;
+        }
+        else if (r.getWidth() < 2.f && r.getRight() <= coveredUntil)
+        {
+            continue;
+        }
+
+        coveredUntil = jmax (coveredUntil, r.getRight());
+        outlines.addWithoutMerging (r);
+        const auto inner = r.getWidth() > 2.f ? r.reduced (1.f) : r;
+        if (item.isSelected())
+        {
+            selected.addWithoutMerging (inner);
+        }
+        else
+        {
+            const int bucket = jlimit (0, numVelocityColours - 1,
+                roundToInt (item.velocity * (float) (numVelocityColours - 1)));
+            fills[bucket].addWithoutMerging (inner);
         }
 
-        notes.add (c);
-        addTimelineClip (c, 127 - c->keyId());
+        if (r.getWidth() >= 20.f && rowHeight >= 10.f)
+            labels.add (id);
     }
-}
 
-void MidiEditorBody::onNoteRemoved (const Note& note)
-{
-    for (int i = 0; i < notes.size(); ++i)
+    if (dragging)
     {
-        NoteClipItem* const clip = notes.getUnchecked (i);
-        if (clip->note() == note)
+        // selected notes are drawn where they would land
+        ids.clearQuick();
+        const Range<double> origin (ticks.getStart() - jmax (deltaStart, deltaEnd, 0.0),
+                                    ticks.getEnd() - jmin (deltaStart, 0.0));
+        index.query (origin, lowestKey - deltaKeys, highestKey - deltaKeys, ids);
+        for (const int id : ids)
         {
-            notes.removeFirstMatchingValue (clip);
-            unloadNote (clip);
-            break;
+            const auto& item = index.get (id);
+            if (! item.isSelected() || ! midiChannels [item.channel])
+                continue;
+            const auto r = getNoteBounds (item, deltaStart, deltaEnd, deltaKeys);
+            if (r.isEmpty())
+                continue;
+            outlines.addWithoutMerging (r);
+            selected.addWithoutMerging (r.getWidth() > 2.f ? r.reduced (1.f) : r);
         }
     }
-}
 
-void MidiEditorBody::showAllTracks()
-{
-    BigInteger keys;
-    keys.setRange (0, 128, true);
-    setTrackVisibility (keys);
+    g.setColour (Colours::black);
+    g.fillRectList (outlines);
+    for (int i = 0; i < numVelocityColours; ++i)
+    {
+        if (fills[i].isEmpty())
+            continue;
+        g.setColour (getVelocityColour (i));
+        g.fillRectList (fills[i]);
+    }
+
+    g.setColour (Colours::aqua);
+    g.fillRectList (selected);
+
+    if (labels.size() <= 2000)
+    {
+        g.setFont (Font (jmin (12.f, rowHeight - 2.f)));
+        g.setColour (Colours::black);
+        for (const int id : labels)
+        {
+            const auto& item = index.get (id);
+            g.drawText (String (item.key), getNoteBounds (item, 0.0, 0.0, 0),
+                        Justification::centred, false);
+        }
+    }
 }
 
-void MidiEditorBody::hideEmptyKeys()
+void MidiEditorBody::resized()
 {
-    BigInteger keys;
-    keys.setRange (0, 128, false);
-    sequence->getKeysWithEvents (keys);
-    setTrackVisibility (keys);
+    setScrollY (scrollY);
 }
 
-void MidiEditorBody::setNoteSequence (const NoteSequence& s)
+//=========================================================================
+void MidiEditorBody::mouseDown (const MouseEvent& ev)
 {
-    if (sequenceNode == s.node())
-            return;
-
-    sequence.setOwned (new NoteSequence (s));
-    sequenceNode = sequence->node();
+    dragMode  = dragNone;
+    dragTicks = 0.0;
+    dragKeys  = 0;
+    dragLastY = ev.y;
 
-    selected.deselectAll();
-    foreachNote (std::bind (&MidiEditorBody::unloadNote, this, std::placeholders::_1));
-    notes.clear();
+    const int key = keyAt (ev.y);
 
-    for (int32 c = sequenceNode.getNumChildren(); --c >= 0;)
+    if (ev.x < keyboardWidth)
     {
-        Note note (sequenceNode.getChild (c));
-        onNoteAdded (note);
+        if (ev.x < keyboardWidth / 2)
+        {
+            dragMode = dragScroll;
+        }
+        else if (key >= 0)
+        {
+            dragMode = dragKeyboard;
+            dragKey = key;
+            selectNotesOnKey (key, ! ev.mods.isShiftDown());
+            if (triggerNotes())
+                keyboardState.noteOn (insertChannel, key, insertVelocity);
+        }
+        return;
     }
 
-    repaint();
-}
+    const int id = getNoteAt (ev.getPosition());
+    if (id >= 0)
+    {
+        if (ev.mods.isShiftDown())
+        {
+            index.setSelected (id, true);
+        }
+        else if (! index.isSelected (id))
+        {
+            index.deselectAll();
+            index.setSelected (id, true);
+        }
 
-void MidiEditorBody::paintTrackHeader (Graphics &g, int track, const Rectangle<int> &area)
-{
-    g.setColour (Colours::darkgrey);
-    g.fillRect (area);
+        const auto& item = index.get (id);
+        dragKey = item.key;
+        dragMode = (float) ev.x >= getNoteBounds (item, 0.0, 0.0, 0).getRight() - 5.f
+            ? dragResize : dragMove;
 
-    track = (127 - track);
+        if (triggerNotes())
+            keyboardState.noteOn (insertChannel, item.key, insertVelocity);
+        repaint();
+        return;
+    }
+
+    if (! ev.mods.isAnyModifierKeyDown())
+        index.deselectAll();
 
-    if (track < 0)
+    if (ev.mods.isPopupMenu())
+    {
+        PopupMenu menu;
+        menu.addSectionHeader (String ("MIDI Note ") + String (key));
+        menu.show();
+        repaint();
         return;
+    }
+
+    if (ev.mods.isCommandDown() && key >= 0)
+        addNote (key, xToTicks (ev.x, true), insertLength, insertChannel);
+
+    beginLasso (ev);
+    repaint();
+}
 
-    if (track % 12 == 0)
+void MidiEditorBody::mouseDrag (const MouseEvent& ev)
+{
+    switch (dragMode)
     {
-        g.setFont (Font (10.0f));
-        g.setColour (Colours::black.withAlpha (0.78f));
-        g.drawText (String (track), area, Justification::left, true);
+        case dragScroll:
+        {
+            setScrollY (scrollY - (float) (ev.y - dragLastY));
+            dragLastY = ev.y;
+        } break;
 
-        g.setColour (Colours::black.withAlpha (0.5f));
-        g.drawHorizontalLine (area.getBottom(), area.getX(), area.getRight());
-    }
+        case dragKeyboard:
+        {
+            const int key = keyAt (ev.y);
+            if (key >= 0 && key != dragKey)
+            {
+                dragKey = key;
+                selectNotesOnKey (key, false);
+                if (triggerNotes())
+                    keyboardState.noteOn (insertChannel, key, insertVelocity);
+            }
+        } break;
+
+        case dragMove:
+        case dragResize:
+        {
+            const double grid = ticksPerBeat / 4.0;
+            const double newTicks = std::round ((xToTicks (ev.x) - xToTicks (ev.getMouseDownX())) / grid) * grid;
+            int newKeys = 0;
+            if (dragMode == dragMove)
+            {
+                const int key = keyAt (ev.y);
+                const int downKey = keyAt (ev.getMouseDownY());
+                newKeys = key >= 0 && downKey >= 0 ? key - downKey : dragKeys;
+                if (newKeys != dragKeys && triggerNotes())
+                {
+                    keyboardState.allNotesOff (insertChannel);
+                    keyboardState.noteOn (insertChannel, jlimit (0, 127, dragKey + newKeys), insertVelocity);
+                }
+            }
+
+            if (newTicks != dragTicks || newKeys != dragKeys)
+            {
+                dragTicks = newTicks;
+                dragKeys  = newKeys;
+                repaint();
+            }
+        } break;
+
+        case dragLasso:
+            updateLasso (ev);
+            break;
 
-//    if (true) // Midi::noteIsWhiteKey (track))
-//        g.setColour (Colours::white);
-//    else
-//        g.setColour (Colours::black);
+        case dragNone:
+        default:
+            break;
+    }
+}
 
-    Rectangle<int> r (area);
-    g.fillRect (r.removeFromRight (area.getWidth() / 2));
+void MidiEditorBody::mouseUp (const MouseEvent&)
+{
+    if (dragMode == dragMove || dragMode == dragResize)
+        applyDrag();
+
+    dragMode = dragNone;
+    dragTicks = 0.0;
+    dragKeys = 0;
+    lassoArea = {};
+    lassoItems.clearQuick();
+    lassoBase.clearQuick();
+    keyboardState.allNotesOff (insertChannel);
+    repaint();
 }
 
-void MidiEditorBody::paintTrackLane (Graphics &g, int track, const Rectangle<int> &area)
+void MidiEditorBody::mouseDoubleClick (const MouseEvent& ev)
 {
-#if 1
-    track = (127 - track);
+    if (ev.x < keyboardWidth)
+        return;
 
-    g.resetToDefaultState();
-    
-    if (! MidiMessage::isMidiNoteBlack (track))
-        g.setColour (Colour (0xff999999));
-    else
-        g.setColour (Colour (0xff888888));
+    const int id = getNoteAt (ev.getPosition());
+    if (id >= 0)
+    {
+        const Note note (index.get(id).note);
+        sequence->removeNote (note);
+        return;
+    }
 
-    g.fillRect (area);
-#endif
+    const int key = keyAt (ev.y);
+    if (key >= 0)
+        addNote (key, xToTicks (ev.x, true), insertLength, insertChannel);
 }
 
-void MidiEditorBody::selectNotesOnKey (int key, bool deselectOthers)
+void MidiEditorBody::mouseWheelMove (const MouseEvent& ev, const MouseWheelDetails& wheel)
 {
-    for (int i = 0; i < notes.size(); ++i)
+    if (ev.mods.isCommandDown())
     {
-        NoteClipItem* const n = notes.getUnchecked (i);
-        if (n->keyId() == key && n->channel() == insertChannel)
-            selected.addToSelection (n);
-        else if (deselectOthers)
-            selected.deselect (n);
+        // zoom around the mouse
+        const double anchor = xToTicks (ev.x);
+        setPixelsPerTick (pixelsPerTick * (1.0 + (double) wheel.deltaY));
+        scrollTicks = jmax (0.0, anchor - (double) (ev.x - keyboardWidth) / pixelsPerTick);
+        repaint();
+    }
+    else if (ev.mods.isShiftDown() || wheel.deltaX != 0.f)
+    {
+        const float delta = wheel.deltaX != 0.f ? wheel.deltaX : wheel.deltaY;
+        scrollTicks = jmax (0.0, scrollTicks - (double) delta * 200.0 / pixelsPerTick);
+        repaint();
+    }
+    else
+    {
+        setScrollY (scrollY - wheel.deltaY * 100.0f);
     }
 }
 
-void MidiEditorBody::setVisibleChannel (int chan, bool updateInsertChannel)
+//=========================================================================
+void MidiEditorBody::beginLasso (const MouseEvent& ev)
 {
-    if (chan == 0)
+    dragMode = dragLasso;
+    lassoArea = {};
+    lassoItems.clearQuick();
+    lassoBase.clearQuick();
+    for (const int id : index.getSelectedIds())
+        lassoBase.add (id);
+    updateLasso (ev);
+}
+
+void MidiEditorBody::updateLasso (const MouseEvent& ev)
+{
+    lassoArea = Rectangle<int> (ev.getMouseDownPosition(), ev.getPosition());
+
+    Array<int> found;
+    const int highestKey = keyAt (lassoArea.getY());
+    const int lowestKey  = keyAt (lassoArea.getBottom());
+    index.query ({ xToTicks (lassoArea.getX()), xToTicks (lassoArea.getRight()) },
+                 lowestKey >= 0 ? lowestKey : 0, highestKey >= 0 ? highestKey : 127, found);
+
+    for (int i = found.size(); --i >= 0;)
     {
-        midiChannels.setRange (1, 16, true);
-        for (int i = 0; i < notes.size(); ++i)
-        {
-            NoteClipItem* const c = notes.getUnchecked (i);
-            c->setVisible (true);
-            updateClip (c);
-        }
-        return;
+        const auto& item = index.get (found.getUnchecked (i));
+        if (! isNoteVisible (item) || ! getNoteBounds (item, 0.0, 0.0, 0).intersects (lassoArea.toFloat()))
+            found.remove (i);
     }
 
-    midiChannels.setBit (clampNoMoreThan (chan, 1, 16), true);
-    insertChannel = updateInsertChannel ? chan : insertChannel;
+    found.sort();
 
-    for (int i = 0; i < notes.size(); ++i)
+    // only notes entering or leaving the lasso change state
+    int i = 0, j = 0;
+    while (i < lassoItems.size() || j < found.size())
     {
-        NoteClipItem* const c = notes.getUnchecked (i);
-        if (c->channel() == chan) {
-            c->setVisible (true);
-            updateClip (c);
+        if (j >= found.size() || (i < lassoItems.size() && lassoItems.getUnchecked (i) < found.getUnchecked (j)))
+        {
+            const int id = lassoItems.getUnchecked (i++);
+            if (! lassoBase.contains (id))
+                index.setSelected (id, false);
+        }
+        else if (i >= lassoItems.size() || found.getUnchecked (j) < lassoItems.getUnchecked (i))
+        {
+            index.setSelected (found.getUnchecked (j++), true);
         }
-        else {
-            c->setVisible (false);
+        else
+        {
+            ++i; ++j;
         }
     }
 
+    lassoItems.swapWith (found);
     repaint();
 }
 
-void MidiEditorBody::timelineBodyClicked (const MouseEvent& ev, int track)
+void MidiEditorBody::applyDrag()
 {
-    PopupMenu menu;
-
-    const int keyId = 127 - track;
+    if (dragTicks == 0.0 && dragKeys == 0)
+        return;
 
-    if (! ev.mods.isAnyModifierKeyDown())
+    const ScopedValueSetter<bool> edits (applyingEdits, true);
+    const Array<int> ids (index.getSelectedIds());
+    for (const int id : ids)
     {
-        selected.deselectAll();
-    }
+        Note note (index.get(id).note);
+        Note::EditDeltas deltas;
 
-    if (ev.mods.isPopupMenu()) {
-        menu.addSectionHeader (String ("MIDI Note ") + String(keyId));
-        menu.show();
-        return;
-    }
+        if (dragMode == dragMove)
+        {
+            note.move (deltas, jmax (0.0, note.tickStart() + dragTicks));
+            note.changeKeyId (deltas, jlimit (0, 127, note.keyId() + dragKeys));
+        }
+        else
+        {
+            note.resize (deltas, jmax (ticksPerBeat / 16.0, note.beatLength() + dragTicks));
+        }
 
-    if (ev.mods.isCommandDown()) {
-        addNote (keyId, xToTicks (ev.x, true), insertLength, insertChannel);
+        note.applyEdits (deltas);
+        index.refresh (id);
     }
-
-    lasso.beginLasso (ev, this);
 }
 
-void MidiEditorBody::timelineTrackHeadersClicked (const MouseEvent &ev, int track)
+//=========================================================================
+void MidiEditorBody::rebuildIndex()
 {
-    const int keyId = 127 - track;
+    Array<ValueTree> selectedNotes;
+    for (const int id : index.getSelectedIds())
+        selectedNotes.add (index.get(id).note.node());
 
-    if (ev.x < getTrackWidth() / 2) {
-        trackDrag = true;
-        trackDeltaY = ev.y;
-    } else {
-        dragTrack = 0;
-        keyboardDrag = true;
-        selectNotesOnKey (keyId, ! ev.mods.isShiftDown());
-        if (triggerNotes())
-            keyboardState.noteOn (insertChannel, keyId, (float) insertVelocity);
+    index.clear();
+    for (int i = 0; i < sequenceNode.getNumChildren(); ++i)
+    {
+        const auto child = sequenceNode.getChild (i);
+        if (child.hasType (Slugs::note))
+            index.add (Note (child));
     }
-}
 
-void MidiEditorBody::refreshComponentForTrack (const int track) { }
+    for (const auto& node : selectedNotes)
+        if (node.isAChildOf (sequenceNode))
+            index.setSelected (index.find (Note (node)), true);
+}
 
-void MidiEditorBody::unloadNote (NoteClipItem* clip)
+void MidiEditorBody::handleAsyncUpdate()
 {
-    selected.deselect (clip);
-    clip->reset();
-    recycleClip (clip);
+    rebuildIndex();
+    repaint();
 }
 
-
 void MidiEditorBody::valueTreeChildAdded (ValueTree& parent, ValueTree& child)
 {
-    if (parent == sequence->node() && child.hasType (Slugs::note)) {
-        Note note (child);
-        onNoteAdded (note);
+    if (parent == sequenceNode && child.hasType (Slugs::note))
+    {
+        index.add (Note (child));
+        repaint();
     }
 }
 
 void MidiEditorBody::valueTreeChildRemoved (ValueTree& parent, ValueTree& child, int)
 {
-    if (parent == sequence->node() && child.hasType (Slugs::note)) {
-        Note note (child);
-        onNoteRemoved (note);
+    if (parent == sequenceNode && child.hasType (Slugs::note))
+    {
+        const int id = index.find (Note (child));
+        if (id >= 0)
+            index.remove (id);
+        else
+            triggerAsyncUpdate();
+        repaint();
     }
 }
 
-void MidiEditorBody::valueTreePropertyChanged (ValueTree& tree, const Identifier& property) {}
-void MidiEditorBody::valueTreeChildOrderChanged (ValueTree& parent, int, int) {}
-void MidiEditorBody::valueTreeParentChanged (ValueTree& child) {}
-
+void MidiEditorBody::valueTreePropertyChanged (ValueTree& tree, const Identifier&)
+{
+    // edits made here refresh the index directly, anything else (undo,
+    // scripts) is coalesced into a single rebuild
+    if (! applyingEdits && tree.hasType (Slugs::note) && tree.getParent() == sequenceNode)
+        triggerAsyncUpdate();
 }
 
+}
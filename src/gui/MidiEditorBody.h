@@ -20,29 +20,25 @@
 #ifndef ELEMENT_MIDI_EDITOR_BODY_H
 #define ELEMENT_MIDI_EDITOR_BODY_H
 
-#include "gui/NoteClipItem.h"
+#include "gui/NoteIndex.h"
 
 namespace Element {
 
 class NoteSequence;
-    
-class NoteSelection :  public SelectedItemSet<NoteClipItem*>
-{
-public:
 
-    NoteSelection();
-    virtual ~NoteSelection();
-    void itemSelected (NoteClipItem *item);
-    void itemDeselected (NoteClipItem *item);
-
-};
-
-class MidiEditorBody :  public TimelineComponent,
-                        public LassoSource<NoteClipItem*>,
-                        private ValueTree::Listener
+/** A piano roll drawn on a single canvas.
+
+    Notes are not components. They live in a NoteIndex and only the ones
+    inside the visible area are looked up and drawn, batched by colour.
+    Hit testing, lasso selection and keyboard selection all go through the
+    index, so the cost of an interaction depends on what is on screen
+    rather than on the size of the clip.
+ */
+class MidiEditorBody :  public Component,
+                        private ValueTree::Listener,
+                        private AsyncUpdater
 {
 public:
-
     MidiEditorBody (MidiKeyboardState& keyboard);
     ~MidiEditorBody();
 
@@ -68,36 +64,28 @@ public:
     bool channelIsVisible (int channel) const { return midiChannels [channel]; }
 
     //======================================================================
-    virtual void findLassoItemsInArea (Array <NoteClipItem*>& itemsFound, const Rectangle<int>& area);
-    NoteSelection& getLassoSelection();
+    /** Returns the notes and selection shown by this editor */
+    const NoteIndex& getNoteIndex() const { return index; }
 
-    //======================================================================
-    void mouseDoubleClick (const MouseEvent &event);
-    void mouseDrag (const MouseEvent &event);
-    void mouseUp (const MouseEvent& ev);
-    void mouseWheelMove (const MouseEvent &event, const MouseWheelDetails &wheel);
+    /** Set the horizontal zoom in pixels per tick */
+    void setPixelsPerTick (double pixelsPerTick);
+    double getPixelsPerTick() const { return pixelsPerTick; }
 
-protected:
+    /** Returns the width of the keyboard on the left */
+    int getTrackWidth() const { return keyboardWidth; }
 
-    template<class Handler>
-    inline void foreachNote (Handler handle)
-    {
-        for (int i = 0; i < notes.size(); ++i)
-            if (NoteClipItem* note = notes.getUnchecked(i))
-                handle (note);
-    }
+    //======================================================================
+    void paint (Graphics& g) override;
+    void resized() override;
+    void mouseDown (const MouseEvent& ev) override;
+    void mouseDoubleClick (const MouseEvent& ev) override;
+    void mouseDrag (const MouseEvent& ev) override;
+    void mouseUp (const MouseEvent& ev) override;
+    void mouseWheelMove (const MouseEvent& ev, const MouseWheelDetails& wheel) override;
 
+protected:
     /** Add a note to the editor. */
-    void addNote (int note, float beat, float length = 1.0f, int channel = 1);
-
-    /** Add a midi sequence to the editor */
-    void addSequence (const MidiMessageSequence& seq);
-
-    /** @internal */
-    void onNoteAdded (const Note& note);
-
-    /** @internal */
-    void onNoteRemoved (const Note& note);
+    void addNote (int note, double tick, double length = 960.0, int channel = 1);
 
     /** Select all of the notes for a given keyboard key
         @param key The note on the keyboard
@@ -105,52 +93,77 @@ protected:
     */
     void selectNotesOnKey (int key, bool deselectOthers);
 
-    /** Unload a note.  Frees the model and recycles the clip */
-    void unloadNote (NoteClipItem* clip);
-
-    //======================================================================
-    void clipClicked (TimelineClip* clip, const MouseEvent& clipEvent);
-    void clipDoubleClicked (TimelineClip* clip, const MouseEvent& /* clipEvent */);
-    void clipMoved (TimelineClip* clip, const MouseEvent&, double deltaStart, double deltaEnd);
-    void clipChangedTrack (TimelineClip *clip, int trackDelta);
-    int getNumTracks() const;
-    void timelineBodyClicked (const MouseEvent& ev, int track);
-    void timelineTrackHeadersClicked (const MouseEvent &ev, int track);
-    virtual void paintTrackHeader (Graphics &g, int track, const Rectangle<int> &area);
-    virtual void paintTrackLane (Graphics &g, int track, const Rectangle<int> &area);
-    virtual void refreshComponentForTrack (const int track);
+    double xToTicks (int x, bool snap = false) const;
+    float ticksToX (double ticks) const;
+    int keyAt (int y) const;
 
 private:
-
-    ValueTree sequenceNode;
+    enum DragMode
+    {
+        dragNone = 0,
+        dragScroll,
+        dragKeyboard,
+        dragMove,
+        dragResize,
+        dragLasso
+    };
 
     MidiKeyboardState& keyboardState;
-
-    LassoComponent<NoteClipItem*> lasso;
-    NoteSelection selected;
-
-    bool trackDrag;
-    bool keyboardDrag;
-    int trackDeltaY, dragTrack;
-
-    Array<NoteClipItem*> notes;
-
-    //Signal<void()> changedSignal;
     OptionalScopedPointer<NoteSequence> sequence;
+    ValueTree sequenceNode;
+    NoteIndex index;
 
-    ValueTree props;
     Value shouldTriggerNotes;
-
-    int insertChannel;
-    float insertLength, insertVelocity;
+    int insertChannel = 1;
+    double insertLength = 960.0;
+    float insertVelocity = 0.8f;
     BigInteger midiChannels;
 
+    const double ticksPerBeat = 1920.0;
+    const int keyboardWidth = 80;
+    double pixelsPerTick = 0.05;
+    double scrollTicks = 0.0;
+    float rowHeight = 12.f;
+    float scrollY = 0.f;
+    Array<int> rowKeys;
+    int keyRows [128];
+
+    DragMode dragMode = dragNone;
+    int dragKey = -1;
+    int dragLastY = 0;
+    double dragTicks = 0.0;
+    int dragKeys = 0;
+    bool applyingEdits = false;
+
+    Rectangle<int> lassoArea;
+    Array<int> lassoItems;
+    SortedSet<int> lassoBase;
+
+    bool isNoteVisible (const NoteIndex::Item& item) const;
+    Rectangle<float> getNoteBounds (const NoteIndex::Item& item, double deltaTicks,
+                                    double deltaEnd, int deltaKeys) const;
+    int getNoteAt (const Point<int>& pos) const;
+    void setVisibleKeys (const BigInteger& keys);
+    void setScrollY (float newScrollY);
+    float getRowY (int row) const { return (float) row * rowHeight - scrollY; }
+
+    void paintKeyboard (Graphics& g, int firstRow, int lastRow);
+    void paintNotes (Graphics& g, const Rectangle<int>& body, int firstRow, int lastRow);
+
+    void beginLasso (const MouseEvent& ev);
+    void updateLasso (const MouseEvent& ev);
+    void applyDrag();
+    void rebuildIndex();
+
     friend class ValueTree;
-    void valueTreeChildAdded (ValueTree& parent, ValueTree& child);
-    void valueTreeChildRemoved (ValueTree& parent, ValueTree& child, int);
-    virtual void valueTreePropertyChanged (ValueTree& tree, const Identifier& property);
-    virtual void valueTreeChildOrderChanged (ValueTree& parent, int, int);
-    virtual void valueTreeParentChanged (ValueTree& child);
+    void valueTreeChildAdded (ValueTree& parent, ValueTree& child) override;
+    void valueTreeChildRemoved (ValueTree& parent, ValueTree& child, int) override;
+    void valueTreePropertyChanged (ValueTree& tree, const Identifier& property) override;
+    void valueTreeChildOrderChanged (ValueTree& parent, int, int) override { }
+    void valueTreeParentChanged (ValueTree& child) override { }
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiEditorBody)
 };
 
 }
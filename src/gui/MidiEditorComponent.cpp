@@ -23,10 +23,7 @@ namespace Element {
 
 MidiEditorComponent::MidiEditorComponent (MidiKeyboardState& k)
     : MidiEditorBody (k)
-{
-    if (auto* const i = indicator())
-        i->setVisible (false);
-}
+{ }
 
 MidiEditorComponent::~MidiEditorComponent()
 { }
@@ -30,6 +30,7 @@
 #include "session/Node.h"
 #include "DataPath.h"
 #include "Globals.h"
+#include "session/PeakCache.h"
 
 namespace Element {
 
@@ -269,7 +270,15 @@ public:
             tree->restoreOpennessState (*state, true);
     }
 
-    virtual void selectionChanged() override { }
+    virtual void selectionChanged() override
+    {
+        // overviews are ready by the time the file is dropped on a player
+        const auto file (getSelectedFile());
+        if (file.existsAsFile())
+            if (auto* const globals = ViewHelpers::getGlobals (this))
+                globals->getPeakCache().prefetch (Array<File> ({ file }));
+    }
+
     virtual void fileClicked (const File& file, const MouseEvent& e) override
     {
         if (e.mods.isPopupMenu() && ! file.isDirectory())
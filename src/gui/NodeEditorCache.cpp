@@ -0,0 +1,232 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "engine/GraphNode.h"
+#include "gui/NodeEditorCache.h"
+
+namespace Element {
+
+// editors hold more than their pixels, don't count any as smaller than this
+static const int64 minEditorBytes = 1 << 20;
+// how long the user has to leave the mouse alone before prefetching
+static const uint32 idleMillis = 400;
+
+NodeEditorCache::NodeEditorCache()
+    : memoryBudget (int64 (96) << 20),
+      maxEditors (12)
+{
+    startTimer (100);
+}
+
+NodeEditorCache::~NodeEditorCache()
+{
+    stopTimer();
+    clear();
+}
+
+void NodeEditorCache::setMemoryBudget (int64 bytes)
+{
+    memoryBudget = jmax (int64 (0), bytes);
+    trim();
+}
+
+void NodeEditorCache::setMaxEditors (int newMax)
+{
+    maxEditors = jmax (0, newMax);
+    trim();
+}
+
+int NodeEditorCache::indexOf (const Node& node, Usage usage) const
+{
+    for (int i = entries.size(); --i >= 0;)
+    {
+        const auto* entry = entries.getUnchecked (i);
+        if (entry->usage == usage && entry->node == node)
+            return i;
+    }
+    return -1;
+}
+
+Component* NodeEditorCache::take (const Node& node, Usage usage)
+{
+    lastActivity = Time::getMillisecondCounter();
+
+    const int index = indexOf (node, usage);
+    if (index < 0)
+        return nullptr;
+
+    std::unique_ptr<Entry> entry (entries.removeAndReturn (index));
+    if (isStale (*entry))
+    {
+        deleteEditor (entry->editor.release());
+        return nullptr;
+    }
+
+    return entry->editor.release();
+}
+
+void NodeEditorCache::release (const Node& node, Usage usage, Component* editor)
+{
+    lastActivity = Time::getMillisecondCounter();
+    if (editor == nullptr)
+        return;
+
+    if (auto* parent = editor->getParentComponent())
+        parent->removeChildComponent (editor);
+    editor->setVisible (false);
+
+    std::unique_ptr<Entry> entry (new Entry());
+    entry->node     = node;
+    entry->object   = node.getGraphNode();
+    entry->usage    = usage;
+    entry->bytes    = estimateBytes (*editor);
+    entry->editor.reset (editor);
+
+    // only editors of live nodes are worth keeping, and only one per view
+    const int existing = indexOf (node, usage);
+    if (existing >= 0 || entry->object == nullptr || isStale (*entry)
+        || maxEditors <= 0 || entry->bytes > memoryBudget)
+    {
+        deleteEditor (entry->editor.release());
+        return;
+    }
+
+    entries.add (entry.release());
+    trim();
+}
+
+void NodeEditorCache::prefetch (const Array<Node>& nodes, Usage usage, Factory factory)
+{
+    prefetchNodes   = nodes;
+    prefetchUsage   = usage;
+    prefetchFactory = factory;
+}
+
+void NodeEditorCache::evict (const Node& node)
+{
+    prefetchNodes.removeAllInstancesOf (node);
+    for (int i = entries.size(); --i >= 0;)
+    {
+        if (entries.getUnchecked(i)->node == node)
+        {
+            std::unique_ptr<Entry> entry (entries.removeAndReturn (i));
+            deleteEditor (entry->editor.release());
+        }
+    }
+}
+
+void NodeEditorCache::clear()
+{
+    prefetchNodes.clearQuick();
+    prefetchFactory = nullptr;
+    while (entries.size() > 0)
+    {
+        std::unique_ptr<Entry> entry (entries.removeAndReturn (0));
+        deleteEditor (entry->editor.release());
+    }
+}
+
+int64 NodeEditorCache::getMemoryUsed() const
+{
+    int64 bytes = 0;
+    for (const auto* entry : entries)
+        bytes += entry->bytes;
+    return bytes;
+}
+
+void NodeEditorCache::trim()
+{
+    int64 used = getMemoryUsed();
+    while (entries.size() > 0 && (used > memoryBudget || entries.size() > maxEditors))
+    {
+        std::unique_ptr<Entry> entry (entries.removeAndReturn (0));
+        used -= entry->bytes;
+        deleteEditor (entry->editor.release());
+    }
+}
+
+bool NodeEditorCache::isIdle() const
+{
+    const auto now = Time::getMillisecondCounter();
+    if (now - lastActivity < idleMillis)
+        return false;
+
+    for (int i = 0; i < Desktop::getInstance().getNumMouseSources(); ++i)
+        if (auto* source = Desktop::getInstance().getMouseSource (i))
+            if (source->isDragging() || (Time::getCurrentTime() - source->getLastMouseDownTime()).inMilliseconds() < (int64) idleMillis)
+                return false;
+
+    return ModalComponentManager::getInstance()->getNumModalComponents() <= 0;
+}
+
+bool NodeEditorCache::isStale (const Entry& entry)
+{
+    // the model drops its object when the node is removed
+    return entry.object == nullptr || entry.node.getGraphNode() != entry.object
+        || entry.object->getParentGraph() == nullptr;
+}
+
+int64 NodeEditorCache::estimateBytes (Component& editor)
+{
+    // hidden editors mostly cost their backing images and whatever the
+    // plugin allocated to draw them, both scale with size
+    const double scale = Desktop::getInstance().getGlobalScaleFactor()
+        * Desktop::getInstance().getDisplays().getMainDisplay().scale;
+    const int64 pixels = (int64) editor.getWidth() * (int64) editor.getHeight();
+    return jmax (minEditorBytes, (int64) ((double) pixels * 4.0 * scale * scale));
+}
+
+void NodeEditorCache::deleteEditor (Component* editor)
+{
+    if (auto* const ed = dynamic_cast<AudioProcessorEditor*> (editor))
+        ed->processor.editorBeingDeleted (ed);
+    delete editor;
+}
+
+void NodeEditorCache::timerCallback()
+{
+    for (int i = entries.size(); --i >= 0;)
+    {
+        if (isStale (*entries.getUnchecked (i)))
+        {
+            std::unique_ptr<Entry> entry (entries.removeAndReturn (i));
+            deleteEditor (entry->editor.release());
+        }
+    }
+
+    if (prefetchNodes.isEmpty() || prefetchFactory == nullptr || ! isIdle())
+        return;
+
+    const Node node (prefetchNodes.removeAndReturn (0));
+    GraphNodePtr object = node.getGraphNode();
+    if (object == nullptr || object->getParentGraph() == nullptr || indexOf (node, prefetchUsage) >= 0)
+        return;
+
+    if (auto* const proc = object->getAudioProcessor())
+        if (prefetchUsage == windowEditor && proc->getActiveEditor() != nullptr)
+            return;
+
+    if (auto* const editor = prefetchFactory (node))
+        release (node, prefetchUsage, editor);
+
+    // creating the editor isn't user activity
+    lastActivity = 0;
+}
+
+}
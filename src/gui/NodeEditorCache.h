@@ -0,0 +1,112 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "ElementApp.h"
+#include "session/Node.h"
+
+namespace Element {
+
+/** Keeps editors of recently viewed nodes alive while they are hidden.
+
+    Views hand their editor back with release() instead of deleting it, and
+    ask for it again with take() the next time the node is shown. Hidden
+    editors are detached from any window so they don't paint. The least
+    recently used are deleted once the cache goes over its memory budget.
+
+    prefetch() creates editors for nodes likely to be shown next. Creation
+    happens on the message thread, one editor per timer tick, and only after
+    the user has been idle for a moment so it doesn't get in their way.
+ */
+class NodeEditorCache : private Timer
+{
+public:
+    /** Where an editor is shown. Embedded and windowed editors of the same
+        node are kept apart because they aren't created the same way. */
+    enum Usage
+    {
+        embeddedEditor = 0,
+        windowEditor
+    };
+
+    using Factory = std::function<Component*(const Node&)>;
+
+    NodeEditorCache();
+    ~NodeEditorCache();
+
+    /** Sets the approximate memory hidden editors may use, in bytes */
+    void setMemoryBudget (int64 bytes);
+    int64 getMemoryBudget() const { return memoryBudget; }
+
+    /** Sets the most editors kept regardless of memory */
+    void setMaxEditors (int maxEditors);
+
+    /** Removes a hidden editor from the cache and returns it, or nullptr
+        if there isn't one. The caller takes ownership. */
+    Component* take (const Node& node, Usage usage);
+
+    /** Hands over an editor that is no longer shown. It is kept hidden for
+        reuse, or deleted right away if it can't be cached. */
+    void release (const Node& node, Usage usage, Component* editor);
+
+    /** Replaces the nodes to create editors for when idle */
+    void prefetch (const Array<Node>& nodes, Usage usage, Factory factory);
+
+    /** Deletes hidden editors for a node */
+    void evict (const Node& node);
+
+    /** Deletes all hidden editors */
+    void clear();
+
+    int getNumEditors() const { return entries.size(); }
+    int64 getMemoryUsed() const;
+
+private:
+    struct Entry
+    {
+        Node node;
+        GraphNodePtr object;
+        Usage usage;
+        std::unique_ptr<Component> editor;
+        int64 bytes = 0;
+    };
+
+    OwnedArray<Entry> entries; // least recently used first
+    int64 memoryBudget;
+    int maxEditors;
+
+    Array<Node> prefetchNodes;
+    Usage prefetchUsage = embeddedEditor;
+    Factory prefetchFactory;
+    uint32 lastActivity = 0;
+
+    int indexOf (const Node& node, Usage usage) const;
+    void trim();
+    bool isIdle() const;
+    static bool isStale (const Entry& entry);
+    static int64 estimateBytes (Component& editor);
+    static void deleteEditor (Component* editor);
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NodeEditorCache)
+};
+
+}
@@ -0,0 +1,240 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "gui/NoteIndex.h"
+
+namespace Element {
+
+NoteIndex::NoteIndex()
+{
+    clear();
+}
+
+NoteIndex::~NoteIndex() { }
+
+void NoteIndex::clear()
+{
+    items.clearQuick();
+    freeIds.clearQuick();
+    selection.clearQuick();
+    for (int i = 0; i < 128; ++i)
+    {
+        keys[i].clearQuick();
+        maxLength[i] = 0.0;
+    }
+    numLive = 0;
+}
+
+int NoteIndex::add (const Note& note)
+{
+    if (! note.isValid() || ! isPositiveAndBelow (note.keyId(), 128))
+        return -1;
+
+    int id;
+    if (freeIds.size() > 0)
+    {
+        id = freeIds.getLast();
+        freeIds.removeLast();
+    }
+    else
+    {
+        id = items.size();
+        items.add (Item());
+    }
+
+    auto& item = items.getReference (id);
+    item = Item();
+    item.note = note;
+    item.live = true;
+    ++numLive;
+
+    refresh (id);
+    return id;
+}
+
+void NoteIndex::remove (int id)
+{
+    if (! contains (id))
+        return;
+
+    setSelected (id, false);
+    removeFromKey (id);
+
+    auto& item = items.getReference (id);
+    item.live = false;
+    item.note = Note::make (ValueTree());
+    freeIds.add (id);
+    --numLive;
+}
+
+void NoteIndex::refresh (int id)
+{
+    if (! contains (id))
+        return;
+
+    auto& item = items.getReference (id);
+    if (item.key >= 0)
+        removeFromKey (id);
+
+    item.start      = item.note.tickStart();
+    item.end        = jmax (item.start, item.note.tickEnd());
+    item.key        = jlimit (0, 127, item.note.keyId());
+    item.channel    = item.note.channel();
+    item.velocity   = item.note.velocity();
+    insertIntoKey (id);
+}
+
+int NoteIndex::find (const Note& note) const
+{
+    if (! note.isValid() || ! isPositiveAndBelow (note.keyId(), 128))
+        return -1;
+
+    const auto& bucket = keys [note.keyId()];
+    const double start = note.tickStart();
+    for (int i = lowerBound (bucket, start); i < bucket.size(); ++i)
+    {
+        const int id = bucket.getUnchecked (i);
+        const auto& item = items.getReference (id);
+        if (item.start > start)
+            break;
+        if (item.note == note)
+            return id;
+    }
+
+    return -1;
+}
+
+void NoteIndex::query (Range<double> ticks, int lowestKey, int highestKey, Array<int>& ids) const
+{
+    lowestKey  = jlimit (0, 127, lowestKey);
+    highestKey = jlimit (0, 127, highestKey);
+
+    for (int key = lowestKey; key <= highestKey; ++key)
+    {
+        const auto& bucket = keys [key];
+        if (bucket.isEmpty())
+            continue;
+
+        // nothing starting before this can still be sounding in range
+        const double earliest = ticks.getStart() - maxLength [key];
+        for (int i = lowerBound (bucket, earliest); i < bucket.size(); ++i)
+        {
+            const int id = bucket.getUnchecked (i);
+            const auto& item = items.getReference (id);
+            if (item.start >= ticks.getEnd())
+                break;
+            if (item.end > ticks.getStart() || item.start == ticks.getStart())
+                ids.add (id);
+        }
+    }
+}
+
+int NoteIndex::hitTest (double tick, int key) const
+{
+    if (! isPositiveAndBelow (key, 128))
+        return -1;
+
+    const auto& bucket = keys [key];
+    int found = -1;
+    for (int i = lowerBound (bucket, tick - maxLength [key]); i < bucket.size(); ++i)
+    {
+        const int id = bucket.getUnchecked (i);
+        const auto& item = items.getReference (id);
+        if (item.start > tick)
+            break;
+        if (tick < item.end)
+            found = id;
+    }
+
+    return found;
+}
+
+void NoteIndex::setSelected (int id, bool shouldBeSelected)
+{
+    if (! contains (id))
+        return;
+
+    auto& item = items.getReference (id);
+    if (item.isSelected() == shouldBeSelected)
+        return;
+
+    if (shouldBeSelected)
+    {
+        item.selectedPos = selection.size();
+        selection.add (id);
+        return;
+    }
+
+    // swap with the last selected so removal is constant time
+    const int last = selection.getLast();
+    selection.set (item.selectedPos, last);
+    items.getReference(last).selectedPos = item.selectedPos;
+    selection.removeLast();
+    item.selectedPos = -1;
+}
+
+void NoteIndex::deselectAll()
+{
+    for (const int id : selection)
+        items.getReference(id).selectedPos = -1;
+    selection.clearQuick();
+}
+
+int NoteIndex::lowerBound (const Array<int>& bucket, double start) const
+{
+    int first = 0, last = bucket.size();
+    while (first < last)
+    {
+        const int mid = (first + last) / 2;
+        if (items.getReference(bucket.getUnchecked (mid)).start < start)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return first;
+}
+
+void NoteIndex::insertIntoKey (int id)
+{
+    const auto& item = items.getReference (id);
+    auto& bucket = keys [item.key];
+    int pos = lowerBound (bucket, item.start);
+    while (pos < bucket.size() && items.getReference(bucket.getUnchecked (pos)).start == item.start)
+        ++pos;
+    bucket.insert (pos, id);
+    maxLength [item.key] = jmax (maxLength [item.key], item.end - item.start);
+}
+
+void NoteIndex::removeFromKey (int id)
+{
+    const auto& item = items.getReference (id);
+    auto& bucket = keys [item.key];
+    for (int i = lowerBound (bucket, item.start); i < bucket.size(); ++i)
+    {
+        if (bucket.getUnchecked (i) == id)
+        {
+            bucket.remove (i);
+            return;
+        }
+    }
+
+    jassertfalse; // index out of sync with the item
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "session/Note.h"
+
+namespace Element {
+
+/** A spatial index of notes for the piano roll.
+
+    Notes are bucketed by key and kept sorted by start time inside each
+    bucket, so finding the notes in a rectangle of time and keys is a binary
+    search per key rather than a walk over the whole clip. The index also
+    owns the selection, which is a flag per note plus a list of selected ids
+    so selecting and deselecting never scans unselected notes.
+
+    Ids are stable until the note is removed or the index is rebuilt.
+ */
+class NoteIndex
+{
+public:
+    struct Item
+    {
+        Note note           { Note::make (ValueTree()) };
+        double start        = 0.0;
+        double end          = 0.0;
+        int key             = -1;
+        int channel         = 1;
+        float velocity      = 0.f;
+        bool live           = false;
+        int selectedPos     = -1;
+
+        bool isSelected() const noexcept { return selectedPos >= 0; }
+    };
+
+    NoteIndex();
+    ~NoteIndex();
+
+    /** Removes all notes and clears the selection */
+    void clear();
+
+    /** Returns the number of notes in the index */
+    int size() const noexcept { return numLive; }
+
+    /** Adds a note and returns its id */
+    int add (const Note& note);
+
+    /** Removes a note by id */
+    void remove (int id);
+
+    /** Re-reads a note's properties after its model has been edited */
+    void refresh (int id);
+
+    /** Returns the id of a note by looking it up with its current key and
+        start time, or -1 if it isn't indexed there */
+    int find (const Note& note) const;
+
+    /** Returns an item by id. The id must be valid. */
+    const Item& get (int id) const { return items.getReference (id); }
+
+    /** Returns true if the id refers to a note in the index */
+    bool contains (int id) const noexcept
+    {
+        return isPositiveAndBelow (id, items.size()) && items.getReference(id).live;
+    }
+
+    /** Collects the ids of notes overlapping a time range on the keys
+        lowestKey to highestKey inclusive. Ids are added in key order. */
+    void query (Range<double> ticks, int lowestKey, int highestKey, Array<int>& ids) const;
+
+    /** Returns the id of the last started note under a point, or -1 */
+    int hitTest (double tick, int key) const;
+
+    //==========================================================================
+    /** Selects or deselects a note */
+    void setSelected (int id, bool selected);
+
+    /** Returns true if a note is selected */
+    bool isSelected (int id) const { return contains (id) && get(id).isSelected(); }
+
+    /** Deselects everything */
+    void deselectAll();
+
+    /** Returns the number of selected notes */
+    int getNumSelected() const noexcept { return selection.size(); }
+
+    /** Returns the selected ids in selection order */
+    const Array<int>& getSelectedIds() const noexcept { return selection; }
+
+private:
+    Array<Item> items;
+    Array<int> freeIds;
+    Array<int> keys [128];
+    double maxLength [128];
+    Array<int> selection;
+    int numLive = 0;
+
+    void insertIntoKey (int id);
+    void removeFromKey (int id);
+    int lowerBound (const Array<int>& bucket, double start) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NoteIndex)
+};
+
+}
@@ -20,6 +20,7 @@
 #include "gui/GuiCommon.h"
 #include "gui/PluginManagerComponent.h"
 #include "session/PluginManager.h"
+#include "session/PluginSearchIndex.h"
 #include "Globals.h"
 #include "Settings.h"
 
@@ -38,11 +39,38 @@ static bool isPluginVersion()
 class PluginListComponent::TableModel  : public TableListBoxModel
 {
 public:
-    TableModel (PluginListComponent& c, KnownPluginList& l)  : owner (c), list (l) {}
+    TableModel (PluginListComponent& c, KnownPluginList& l)
+        : owner (c), list (l), index (c.plugins.getSearchIndex()) {}
     
     int getNumRows() override
     {
-        return list.getNumTypes() + list.getBlacklistedFiles().size();
+        return rows.size() + getNumBlacklisted();
+    }
+
+    /** Re-runs the current search and sort. Rows refer to search index
+        entries, so this is the only place the index is synced */
+    void refresh()
+    {
+        owner.plugins.getSearchIndex().search (owner.searchText, rows);
+        blacklisted = list.getBlacklistedFiles();
+
+        if (! isPositiveAndBelow (sortColumn - 1, (int) manufacturerCol))
+            return;
+
+        ColumnSorter sorter (index, sortColumn, sortForwards);
+        rows.sort (sorter, true);
+    }
+
+    const PluginDescription* getDescription (int row) const
+    {
+        return isPositiveAndBelow (row, rows.size())
+            ? index.getDescription (rows.getUnchecked (row))
+            : nullptr;
+    }
+
+    String getBlacklistedFile (int row) const
+    {
+        return row >= rows.size() ? blacklisted [row - rows.size()] : String();
     }
     
     void paintRowBackground (Graphics& g, int rowNumber, int width, int height, bool rowIsSelected) override
@@ -71,19 +99,18 @@ public:
                     int width, int height, bool rowIsSelected) override
     {
         String text;
-        bool isBlacklisted = row >= list.getNumTypes();
+        bool isBlacklisted = row >= rows.size();
         
         if (isBlacklisted)
         {
             if (columnId == nameCol)
-                text = list.getBlacklistedFiles() [row - list.getNumTypes()];
+                text = getBlacklistedFile (row);
             else if (columnId == descCol)
                 text = TRANS("Deactivated after failing to initialise correctly");
         }
-        else if (isPositiveAndBelow (row, list.getNumTypes()))
+        else if (const auto* type = getDescription (row))
         {
-            const auto types = list.getTypes();
-            const auto& desc = types.getReference (row);
+            const auto& desc = *type;
             switch (columnId)
             {
                 case nameCol:         text = desc.name; break;
@@ -141,18 +168,10 @@ public:
     
     void sortOrderChanged (int newSortColumnId, bool isForwards) override
     {
-        switch (newSortColumnId)
-        {
-            case nameCol:         list.sort (KnownPluginList::sortAlphabetically, isForwards); break;
-            case typeCol:         list.sort (KnownPluginList::sortByFormat, isForwards); break;
-            case categoryCol:     list.sort (KnownPluginList::sortByCategory, isForwards); break;
-            case manufacturerCol: list.sort (KnownPluginList::sortByManufacturer, isForwards); break;
-            
-            case ioCol:
-            case descCol:         break;
-                
-            default: jassertfalse; break;
-        }
+        // sorting only reorders rows, the known list itself is left alone
+        sortColumn   = newSortColumnId;
+        sortForwards = isForwards;
+        refresh();
     }
     
     static String getPluginDescription (const PluginDescription& desc)
@@ -170,6 +189,49 @@ public:
     
     PluginListComponent& owner;
     KnownPluginList& list;
+    const PluginSearchIndex& index;
+    Array<int> rows;
+    StringArray blacklisted;
+    int sortColumn = nameCol;
+    bool sortForwards = true;
+
+    int getNumBlacklisted() const
+    {
+        return owner.searchText.isEmpty() ? blacklisted.size() : 0;
+    }
+
+    struct ColumnSorter
+    {
+        ColumnSorter (const PluginSearchIndex& i, int c, bool f)
+            : index (i), column (c), forwards (f) { }
+
+        static const String& getText (const PluginDescription& desc, int column)
+        {
+            switch (column)
+            {
+                case typeCol:         return desc.pluginFormatName;
+                case categoryCol:     return desc.category;
+                case manufacturerCol: return desc.manufacturerName;
+                default: break;
+            }
+
+            return desc.name;
+        }
+
+        int compareElements (int a, int b) const
+        {
+            const auto& da = *index.getDescription (a);
+            const auto& db = *index.getDescription (b);
+            int result = getText (da, column).compareNatural (getText (db, column));
+            if (result == 0 && column != nameCol)
+                result = da.name.compareNatural (db.name);
+            return forwards ? result : -result;
+        }
+
+        const PluginSearchIndex& index;
+        const int column;
+        const bool forwards;
+    };
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TableModel)
 };
@@ -214,6 +276,10 @@ PluginListComponent::PluginListComponent (PluginManager& p, PropertiesFile* prop
     addAndMakeVisible (scanButton);
     scanButton.setButtonText (isPluginVersion() ? "Reload" : "Scan");
     scanButton.addListener (this);
+
+    addAndMakeVisible (searchBox);
+    searchBox.setTextToShowWhenEmpty (TRANS("Search..."), LookAndFeel_KV1::textColor.darker());
+    searchBox.addListener (this);
     
     setSize (400, 600);
     list.addChangeListener (this);
@@ -230,6 +296,7 @@ PluginListComponent::PluginListComponent (PluginManager& p, PropertiesFile* prop
 
 PluginListComponent::~PluginListComponent()
 {
+    searchBox.removeListener (this);
     list.removeChangeListener (this);
 }
 
@@ -263,6 +330,8 @@ void PluginListComponent::resized()
     r2.removeFromRight (2);
     closeButton.changeWidthToFitText (r2.getHeight());
     closeButton.setBounds (r2.removeFromRight (closeButton.getWidth()));
+    r2.removeFromRight (4);
+    searchBox.setBounds (r2.removeFromRight (jmin (220, jmax (0, r2.getRight() - optionsButton.getRight() - 4))));
     r.removeFromTop (3);
     r.removeFromBottom (3);
     table.setBounds (r);
@@ -278,6 +347,22 @@ void PluginListComponent::changeListenerCallback (ChangeBroadcaster* cb)
     }
 }
 
+void PluginListComponent::textEditorTextChanged (TextEditor&)
+{
+    searchText = searchBox.getText().trim();
+    if (auto* model = dynamic_cast<TableModel*> (tableModel.get()))
+        model->refresh();
+    table.deselectAllRows();
+    updateList();
+}
+
+const PluginDescription* PluginListComponent::getTypeForRow (int row) const
+{
+    if (auto* model = dynamic_cast<TableModel*> (tableModel.get()))
+        return model->getDescription (row);
+    return list.getType (row);
+}
+
 void PluginListComponent::updateList()
 {
     table.updateContent();
@@ -306,10 +391,8 @@ void PluginListComponent::setTableModel (TableListBoxModel* model)
 
 bool PluginListComponent::canShowSelectedFolder() const
 {
-    const auto types = list.getTypes();
-    if (isPositiveAndBelow (table.getSelectedRow(), types.size()))
-        return File::createFileWithoutCheckingPath (
-            types.getReference(table.getSelectedRow()).fileOrIdentifier).exists();
+    if (const auto* type = getTypeForRow (table.getSelectedRow()))
+        return File::createFileWithoutCheckingPath (type->fileOrIdentifier).exists();
     
     return false;
 }
@@ -319,9 +402,8 @@ void PluginListComponent::showSelectedFolder()
     if (! canShowSelectedFolder())
         return;
     
-    const auto types = list.getTypes();
-    const auto type = types [(table.getSelectedRow())];
-    File(type.fileOrIdentifier).getParentDirectory().startAsProcess();
+    if (const auto* type = getTypeForRow (table.getSelectedRow()))
+        File (type->fileOrIdentifier).getParentDirectory().startAsProcess();
 }
 
 void PluginListComponent::removeMissingPlugins()
@@ -334,18 +416,18 @@ void PluginListComponent::removeMissingPlugins()
 
 void PluginListComponent::removePluginItem (int index)
 {
-    const auto types = list.getTypes();
-    if (! isPositiveAndBelow (index, types.size()))
+    const auto* type = getTypeForRow (index);
+    if (type == nullptr)
     {
-        list.removeFromBlacklist (list.getBlacklistedFiles() [index - types.size()]);
+        if (auto* model = dynamic_cast<TableModel*> (tableModel.get()))
+            list.removeFromBlacklist (model->getBlacklistedFile (index));
         return;
     }
     
-    const auto& type = types.getReference (index);
-    if (type.pluginFormatName == "Element")
+    if (type->pluginFormatName == "Element")
         return;
     
-    list.removeType (type);
+    list.removeType (*type);
 }
 
 void PluginListComponent::optionsMenuStaticCallback (int result, PluginListComponent* pluginList)
@@ -490,7 +572,6 @@ void PluginListComponent::setLastSearchPath (PropertiesFile& properties, AudioPl
 {
     properties.setValue (Settings::lastPluginScanPathPrefix + format.getName(),
                          newPath.toString());
-	properties.saveIfNeeded();
 }
 
 // MARK: Scanner
@@ -678,10 +759,7 @@ private:
 		pathChooserWindow.setVisible (false);
         
 		if (propertiesToUse != nullptr)
-		{
 			setLastSearchPath (*propertiesToUse, formatToScan, pathList.getPath());
-			propertiesToUse->saveIfNeeded();
-		}
 
 		progressWindow.addButton(TRANS("Cancel"), 0, KeyPress(KeyPress::escapeKey));
 		progressWindow.addProgressBarComponent(progress);
@@ -32,7 +32,8 @@ class PluginManager;
 class PluginListComponent : public Component,
                             public FileDragAndDropTarget,
                             private ChangeListener,
-                            private Button::Listener
+                            private Button::Listener,
+                            private TextEditor::Listener
 {
 public:
     //==============================================================================
@@ -95,6 +96,8 @@ private:
     File deadMansPedalFile;
     TableListBox table;
     TextButton optionsButton, closeButton, scanButton;
+    TextEditor searchBox;
+    String searchText;
     PropertiesFile* propertiesToUse;
     String dialogTitle, dialogText;
     bool allowAsync;
@@ -118,12 +121,14 @@ private:
     bool canShowSelectedFolder() const;
     void removeMissingPlugins();
     void removePluginItem (int index);
+    const PluginDescription* getTypeForRow (int row) const;
     
     void resized() override;
     bool isInterestedInFileDrag (const StringArray&) override;
     void filesDropped (const StringArray&, int, int) override;
     void buttonClicked (Button*) override;
     void changeListenerCallback (ChangeBroadcaster*) override;
+    void textEditorTextChanged (TextEditor&) override;
     
     void scanWithBackgroundScanner();
     
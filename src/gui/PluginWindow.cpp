@@ -189,6 +189,15 @@ public:
     
     Toolbar* getToolbar() const { return toolbar.get(); }
 
+    Component* releaseEditor()
+    {
+        if (editor == nullptr)
+            return nullptr;
+        editor->removeComponentListener (this);
+        removeChildComponent (editor.get());
+        return editor.release();
+    }
+
     void stabilizeComponents()
     {
         if (auto* pw = findParentComponentOfClass<PluginWindow>())
@@ -290,6 +299,13 @@ PluginWindow::~PluginWindow()
     setLookAndFeel (nullptr);
 }
 
+Component* PluginWindow::releaseEditor()
+{
+    if (auto* pwc = dynamic_cast<PluginWindowContent*> (getContentComponent()))
+        return pwc->releaseEditor();
+    return nullptr;
+}
+
 ContentComponent* PluginWindow::getElementContentComponent() const
 {
     return gui.getContentComponent();
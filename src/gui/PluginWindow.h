@@ -45,6 +45,9 @@ public:
     
     Toolbar* getToolbar() const;
     void updateGraphNode (GraphNode* newNode, Component* newEditor);
+
+    /** Detaches the editor so it outlives the window. The caller owns it. */
+    Component* releaseEditor();
     Node getNode() const { return node; }
     void restoreAlwaysOnTopState();
     void moved() override;
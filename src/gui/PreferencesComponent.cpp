@@ -326,6 +326,30 @@ namespace Element {
             hidePluginWindows.setToggleState (settings.hidePluginWindowsWhenFocusLost(), dontSendNotification);
             hidePluginWindows.getToggleStateValue().addListener (this);
 
+            addAndMakeVisible (signalGuardLabel);
+            signalGuardLabel.setText ("Silence nodes producing NaN or Inf", dontSendNotification);
+            signalGuardLabel.setFont (Font (12.0, Font::bold));
+            addAndMakeVisible (signalGuard);
+            signalGuard.setClickingTogglesState (true);
+            signalGuard.setToggleState (settings.useSignalGuard(), dontSendNotification);
+            signalGuard.getToggleStateValue().addListener (this);
+
+            addAndMakeVisible (sleepIdleNodesLabel);
+            sleepIdleNodesLabel.setText ("Sleep effects while their inputs are silent", dontSendNotification);
+            sleepIdleNodesLabel.setFont (Font (12.0, Font::bold));
+            addAndMakeVisible (sleepIdleNodes);
+            sleepIdleNodes.setClickingTogglesState (true);
+            sleepIdleNodes.setToggleState (settings.sleepIdleNodes(), dontSendNotification);
+            sleepIdleNodes.getToggleStateValue().addListener (this);
+
+            addAndMakeVisible (localityOrderingLabel);
+            localityOrderingLabel.setText ("Order nodes for cache locality", dontSendNotification);
+            localityOrderingLabel.setFont (Font (12.0, Font::bold));
+            addAndMakeVisible (localityOrdering);
+            localityOrdering.setClickingTogglesState (true);
+            localityOrdering.setToggleState (settings.localityOrdering(), dontSendNotification);
+            localityOrdering.getToggleStateValue().addListener (this);
+
             addAndMakeVisible (openLastSessionLabel);
            #ifdef EL_PRO
             openLastSessionLabel.setText ("Open last used Session", dontSendNotification);
@@ -424,6 +448,9 @@ namespace Element {
             layoutSetting (r, showPluginWindowsLabel, showPluginWindows);
             layoutSetting (r, pluginWindowsOnTopLabel, pluginWindowsOnTop);
             layoutSetting (r, hidePluginWindowsLabel, hidePluginWindows);
+            layoutSetting (r, signalGuardLabel, signalGuard);
+            layoutSetting (r, sleepIdleNodesLabel, sleepIdleNodes);
+            layoutSetting (r, localityOrderingLabel, localityOrdering);
             layoutSetting (r, openLastSessionLabel, openLastSession);
             layoutSetting (r, askToSaveSessionLabel, askToSaveSession);
             
@@ -485,6 +512,21 @@ namespace Element {
             {
                 settings.setHidePluginWindowsWhenFocusLost (hidePluginWindows.getToggleState());
             }
+            else if (value.refersToSameSourceAs (signalGuard.getToggleStateValue()))
+            {
+                settings.setUseSignalGuard (signalGuard.getToggleState());
+                engine->applySettings (settings);
+            }
+            else if (value.refersToSameSourceAs (sleepIdleNodes.getToggleStateValue()))
+            {
+                settings.setSleepIdleNodes (sleepIdleNodes.getToggleState());
+                engine->applySettings (settings);
+            }
+            else if (value.refersToSameSourceAs (localityOrdering.getToggleStateValue()))
+            {
+                settings.setLocalityOrdering (localityOrdering.getToggleState());
+                engine->applySettings (settings);
+            }
 
             settings.saveIfNeeded();
             gui.stabilizeViews();
@@ -513,6 +555,15 @@ namespace Element {
         Label hidePluginWindowsLabel;
         SettingButton hidePluginWindows;
 
+        Label signalGuardLabel;
+        SettingButton signalGuard;
+
+        Label sleepIdleNodesLabel;
+        SettingButton sleepIdleNodes;
+
+        Label localityOrderingLabel;
+        SettingButton localityOrdering;
+
         Label openLastSessionLabel;
         SettingButton openLastSession;
 
@@ -530,29 +581,120 @@ namespace Element {
 
     // MARK: Audio Settings
 
-    class AudioSettingsComponent : public SettingsPage
+    class AudioSettingsComponent : public SettingsPage,
+                                   public ComboBox::Listener,
+                                   public ChangeListener,
+                                   public Timer
     {
     public:
-        AudioSettingsComponent (DeviceManager& d)
-            : devs (d, 1, DeviceManager::maxAudioChannels,
+        AudioSettingsComponent (Globals& g)
+            : devs (g.getDeviceManager(), 1, DeviceManager::maxAudioChannels,
                        1, DeviceManager::maxAudioChannels, 
                        false, false, false, false),
-              devices (d)
+              devices (g.getDeviceManager()),
+              settings (g.getSettings())
         {
             addAndMakeVisible (devs);
             devs.setItemHeight (22);
+
+            addAndMakeVisible (backupLabel);
+            backupLabel.setFont (Font (12.0, Font::bold));
+            backupLabel.setText ("Backup Output", dontSendNotification);
+            addAndMakeVisible (backupDevice);
+            backupDevice.addListener (this);
+            addAndMakeVisible (backupStatus);
+            backupStatus.setFont (Font (12.0));
+
             setSize (300, 400);
+            devices.addChangeListener (this);
+            updateBackupDevices();
+            startTimer (1 * 1000);
         }
 
         ~AudioSettingsComponent()
         {
+            devices.removeChangeListener (this);
+            backupDevice.removeListener (this);
+        }
+
+        void resized() override
+        {
+            const int settingHeight = 22;
+            auto r (getLocalBounds());
+            backupStatus.setBounds (r.removeFromBottom (settingHeight));
+            auto r2 = r.removeFromBottom (settingHeight);
+            backupLabel.setBounds (r2.removeFromLeft (getWidth() / 2));
+            backupDevice.setBounds (r2);
+            r.removeFromBottom (6);
+            devs.setBounds (r);
+        }
+
+        void comboBoxChanged (ComboBox*) override
+        {
+            const auto name = backupDevice.getSelectedId() > 1 ? backupDevice.getText() : String();
+            const auto error = devices.setBackupAudioDevice (name);
+            if (error.isNotEmpty())
+                AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Backup Output", error);
+            settings.setBackupAudioDevice (devices.getBackupAudioDeviceName());
+            settings.saveIfNeeded();
+            updateBackupDevices();
         }
 
-        void resized() override { devs.setBounds (getLocalBounds()); }
+        void changeListenerCallback (ChangeBroadcaster*) override
+        {
+            updateBackupDevices();
+        }
+
+        void timerCallback() override
+        {
+            const auto status = devices.getBackupStatus();
+            String text;
+            if (status.failedOver)
+                text << (status.primaryError ? "Failed over to backup, restart the main device"
+                                             : "Failed over to backup");
+            else if (status.backupRunning && ! status.backupCompatible)
+                text << "The backup's sample rate is too far from the main device's";
+            else if (status.backupRunning)
+                text << "Drift: " << String (status.driftPPM, 1) << " ppm  Underruns: " << status.underruns
+                     << "  Buffered: " << status.latencySamples;
+            backupStatus.setText (text, dontSendNotification);
+            backupStatus.setColour (Label::textColourId, status.failedOver || status.underruns > 0 || ! status.backupCompatible
+                ? Colours::orange : LookAndFeel::textColor);
+        }
 
     private:
         Element::AudioDeviceSelectorComponent devs;
         DeviceManager& devices;
+        Settings& settings;
+        Label backupLabel;
+        ComboBox backupDevice;
+        Label backupStatus;
+
+        void updateBackupDevices()
+        {
+            backupDevice.clear (dontSendNotification);
+            backupDevice.addItem ("None", 1);
+
+            AudioDeviceManager::AudioDeviceSetup setup;
+            devices.getAudioDeviceSetup (setup);
+            const auto current = devices.getBackupAudioDeviceName();
+            
+            if (auto* type = devices.getCurrentDeviceTypeObject())
+            {
+                int itemId = 2;
+                for (const auto& name : type->getDeviceNames (false))
+                {
+                    backupDevice.addItem (name, itemId);
+                    backupDevice.setItemEnabled (itemId, name != setup.outputDeviceName);
+                    if (name == current)
+                        backupDevice.setSelectedId (itemId, dontSendNotification);
+                    ++itemId;
+                }
+            }
+
+            if (current.isEmpty())
+                backupDevice.setSelectedId (1, dontSendNotification);
+        }
     };
 
     // MARK: MIDI Settings
@@ -930,7 +1072,7 @@ Component* PreferencesComponent::createPageForName (const String& name)
     if (name == EL_GENERAL_SETTINGS_NAME) {
         return new GeneralSettingsPage (world, gui);
     } else if (name == EL_AUDIO_SETTINGS_NAME) {
-        return new AudioSettingsComponent (world.getDeviceManager());
+        return new AudioSettingsComponent (world);
     } else if (name == EL_PLUGINS_PREFERENCE_NAME) {
         return new PluginSettingsComponent (world);
     } else if (name == EL_MIDI_SETTINGS_NAME) {
@@ -40,17 +40,10 @@ public:
     SessionNodeTreeItem (const Node& n)
         : node (n)
     {
-        ValueTree child (n.getValueTree());
-        ValueTree parent (child.getParent());
-        
-        if (parent.isValid())
-        {
-            uniqueName = String (parent.indexOf (child));
-        }
-        else
-        {
+        // the uuid stays put when siblings are added or removed around it
+        uniqueName = node.getUuidString();
+        if (uniqueName.isEmpty())
             uniqueName = String ((int64) node.getNodeId());
-        }
     }
     
     String getUniqueName() const override { return uniqueName; }
@@ -58,11 +51,17 @@ public:
     void itemOpennessChanged (const bool isOpen) override
     {
         if (isOpen)
+        {
             refreshSubItems();
+        }
         else
+        {
             clearSubItems();
+            populated = false;
+        }
     }
 
+    /** Items for child nodes are only created while this item is open */
     void addSubItems() override
     {
         const auto nodes (node.getNodesValueTree());
@@ -72,6 +71,42 @@ public:
             if (! c.isIONode())
                 addSubItem (new SessionNodeTreeItem (c));
         }
+
+        populated = true;
+    }
+
+    /** Returns the item for a direct child node, if it has been created */
+    SessionNodeTreeItem* findSubItemFor (const ValueTree& child) const
+    {
+        for (int i = 0; i < getNumSubItems(); ++i)
+            if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (getSubItem (i)))
+                if (item->node.getValueTree() == child)
+                    return item;
+        return nullptr;
+    }
+
+    void nodeAdded (const ValueTree& child)
+    {
+        const Node newNode (child, false);
+        if (! populated || newNode.isIONode() || findSubItemFor (child) != nullptr)
+            return;
+
+        // items skip IO nodes, so count what comes before it in the model
+        const auto nodes (node.getNodesValueTree());
+        int index = 0;
+        for (int i = 0; i < nodes.getNumChildren() && nodes.getChild (i) != child; ++i)
+            if (! Node (nodes.getChild (i), false).isIONode())
+                ++index;
+
+        addSubItem (new SessionNodeTreeItem (newNode), index);
+    }
+
+    void nodeRemoved (const ValueTree& child)
+    {
+        for (int i = getNumSubItems(); --i >= 0;)
+            if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (getSubItem (i)))
+                if (item->node.getValueTree() == child)
+                    { removeSubItem (i); break; }
     }
 
     void itemClicked (const MouseEvent& ev) override
@@ -330,6 +365,7 @@ public:
     String uniqueName;
     Node node;
     NodePopupMenu menu;
+    bool populated = false;
 };
 
 class SessionPluginTreeItem : public SessionNodeTreeItem
@@ -456,9 +492,16 @@ public:
         if (auto session = panel.getSession())
         {
             for (int i = 0; i < session->getNumGraphs(); ++i)
-                addSubItem (new SessionRootGraphTreeItem (session->getGraph (i)));
+                addGraph (session->getGraph (i), -1);
         }
+    }
 
+    /** Root graphs start open, nested graphs wait until they're expanded */
+    void addGraph (const Node& graph, int index)
+    {
+        auto* const item = new SessionRootGraphTreeItem (graph);
+        addSubItem (item, index);
+        item->setOpen (true);
     }
 
     virtual bool mightContainSubItems() override { return true; }
@@ -515,7 +558,7 @@ SessionTreePanel::SessionTreePanel()
 {
     tree.setRootItemVisible (false);
     tree.setInterceptsMouseClicks (true, true);
-    tree.setDefaultOpenness (true);
+    tree.setDefaultOpenness (false);
     tree.setMultiSelectEnabled (true);
     setRoot (new SessionRootTreeItem (*this));
     data.addListener (this);
@@ -562,25 +605,40 @@ SessionPtr SessionTreePanel::getSession() const
     return session;
 }
 
-static TreeViewItem* findItemForNodeRecursive (TreeViewItem* item, const Node& node)
+TreeViewItem* SessionTreePanel::findItemForNode (const ValueTree& nodeData, const bool reveal) const
 {
-    if (auto* const sitem = dynamic_cast<SessionNodeTreeItem*> (item))
-        if (sitem->node == node)
-            return sitem;
-    for (int i = 0; i < item->getNumSubItems(); ++i)
+    if (rootItem == nullptr || ! nodeData.hasType (Tags::node))
+        return nullptr;
+
+    // follow the node's parents down from the root graph instead of
+    // searching every item, which also avoids creating the ones not needed
+    Array<ValueTree> path;
+    for (ValueTree data = nodeData; data.hasType (Tags::node); data = data.getParent().getParent())
+        path.insert (0, data);
+
+    TreeViewItem* item = rootItem.get();
+    for (int i = 0; i < path.size(); ++i)
     {
-        if (auto* const found = findItemForNodeRecursive (item->getSubItem (i), node))
-            return found;
+        SessionNodeTreeItem* found = nullptr;
+        for (int j = 0; j < item->getNumSubItems() && found == nullptr; ++j)
+            if (auto* const sitem = dynamic_cast<SessionNodeTreeItem*> (item->getSubItem (j)))
+                if (sitem->node.getValueTree() == path.getReference (i))
+                    found = sitem;
+
+        if (found == nullptr)
+            return nullptr;
+
+        item = found;
+        if (reveal && i < path.size() - 1 && ! item->isOpen())
+            item->setOpen (true);
     }
 
-    return nullptr;
+    return item;
 }
 
 TreeViewItem* SessionTreePanel::findItemForNode (const Node& node) const
 {
-    if (rootItem != nullptr)
-        return findItemForNodeRecursive (rootItem.get(), node);
-    return nullptr;
+    return findItemForNode (node.getValueTree(), true);
 }
 
 void SessionTreePanel::onNodeSelected()
@@ -653,19 +711,62 @@ static void refreshSubItems (TreeItemBase* item)
 
 void SessionTreePanel::valueTreeChildAdded (ValueTree& parent, ValueTree& child)
 {
-    if (couldBeSessionObjects (parent, child))
+    if (! couldBeSessionObjects (parent, child))
+        return;
+
+    if (parent.hasType (Tags::graphs))
+    {
+        if (auto* const root = dynamic_cast<SessionRootTreeItem*> (rootItem.get()))
+            root->addGraph (Node (child, false), parent.indexOf (child));
+    }
+    else if (parent.hasType (Tags::nodes))
+    {
+        if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (findItemForNode (parent.getParent(), false)))
+            item->nodeAdded (child);
+    }
+    else
+    {
         refreshSubItems (rootItem.get());
+    }
 }
 
 void SessionTreePanel::valueTreeChildRemoved (ValueTree& parent, ValueTree& child, int indexRemovedAt)
 {
-    if (couldBeSessionObjects (parent, child))
+    ignoreUnused (indexRemovedAt);
+    if (rootItem == nullptr || ! couldBeSessionObjects (parent, child))
+        return;
+
+    if (parent.hasType (Tags::graphs))
+    {
+        for (int i = rootItem->getNumSubItems(); --i >= 0;)
+            if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (rootItem->getSubItem (i)))
+                if (item->node.getValueTree() == child)
+                    { rootItem->removeSubItem (i); break; }
+    }
+    else if (parent.hasType (Tags::nodes))
+    {
+        if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (findItemForNode (parent.getParent(), false)))
+            item->nodeRemoved (child);
+    }
+    else
+    {
         refreshSubItems (rootItem.get());
+    }
 }
 
 void SessionTreePanel::valueTreeChildOrderChanged (ValueTree& parent, int oldIndex, int newIndex)
 {
-    refreshSubItems (rootItem.get());
+    ignoreUnused (oldIndex, newIndex);
+    if (parent.hasType (Tags::nodes))
+    {
+        if (auto* const item = dynamic_cast<SessionNodeTreeItem*> (findItemForNode (parent.getParent(), false)))
+            if (item->isOpen())
+                item->refreshSubItems();
+    }
+    else if (parent.hasType (Tags::graphs))
+    {
+        refreshSubItems (rootItem.get());
+    }
 }
 
 void SessionTreePanel::valueTreeParentChanged (ValueTree& tree)
@@ -54,6 +54,7 @@ private:
     void selectActiveRootGraph();
     
     TreeViewItem* findItemForNode (const Node& node) const;
+    TreeViewItem* findItemForNode (const ValueTree& nodeData, bool reveal) const;
 
     void onNodeSelected();
 
@@ -19,6 +19,7 @@
 
 #include "controllers/GuiController.h"
 #include "gui/MainWindow.h"
+#include "gui/NodeEditorCache.h"
 #include "gui/WindowManager.h"
 
 namespace Element {
@@ -45,6 +46,8 @@ void WindowManager::deletePluginWindow (const int index, const bool windowVisibl
         window->node.setProperty (Tags::windowVisible, windowVisible);
         window->removeKeyListener (gui.commander().getKeyMappings());
         window->removeKeyListener (gui.getKeyListener());
+        gui.getEditorCache().release (window->node, NodeEditorCache::windowEditor,
+                                      window->releaseEditor());
         activePluginWindows.remove (index);
     }
 }
@@ -57,5 +60,10 @@ PluginWindow* WindowManager::createPluginWindowFor (const Node& n, Component* e)
     return window;
 }
 
+Component* WindowManager::takeCachedEditor (const Node& n)
+{
+    return gui.getEditorCache().take (n, NodeEditorCache::windowEditor);
+}
+
 }
 
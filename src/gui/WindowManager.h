@@ -172,6 +172,9 @@ public:
 
     inline PluginWindow* createPluginWindowFor (const Node& node)
     {
+        if (auto* const cached = takeCachedEditor (node))
+            return createPluginWindowFor (node, cached);
+
         if (node.getIdentifier().toString() == EL_INTERNAL_ID_MIDI_PROGRAM_MAP)
         {
             auto* const pgced = new MidiProgramMapEditor (node);
@@ -213,6 +216,7 @@ private:
     void deletePluginWindow (PluginWindow* window, const bool windowVisible);
     void deletePluginWindow (const int index, const bool windowVisible);
     PluginWindow* createPluginWindowFor (const Node& n, Component* e);
+    Component* takeCachedEditor (const Node& n);
 };
 
 }
@@ -40,23 +40,15 @@ static AudioProcessor* getAudioProcessor (const Node& node)
 
 }
 
-class ParameterListener   : private AudioProcessorParameter::Listener,
-                            private AudioProcessorListener,
-                            private Timer
+/** Base for the controls in a parameter row. Controls don't listen to their
+    parameter, the editor tells them when the value has changed. */
+class ParameterControl   : public Component
 {
 public:
-    ParameterListener (AudioProcessor& proc, AudioProcessorParameter& param)
-        : processor (proc), parameter (param)
-    {
-        parameter.addListener (this);
-        startTimer (100);
-    }
+    ParameterControl (AudioProcessorParameter& param)
+        : parameter (param) { }
 
-    ~ParameterListener() override
-    {
-        stopTimer();
-        parameter.removeListener (this);
-    }
+    ~ParameterControl() override { }
 
     AudioProcessorParameter& getParameter() noexcept
     {
@@ -66,50 +58,102 @@ public:
     virtual void handleNewParameterValue() = 0;
 
 private:
-    //==============================================================================
-    void parameterValueChanged (int, float) override
+    AudioProcessorParameter& parameter;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterControl)
+};
+
+/** Collects parameter changes from any thread and hands them to the message
+    thread from a single timer.
+
+    The processor listener only sets a bit per parameter, so notifying is
+    lock-free and allocation free on the audio thread. However many changes
+    arrive between ticks, each parameter is dispatched at most once.
+ */
+class ParameterChangeHub   : private AudioProcessorListener,
+                             private Timer
+{
+public:
+    ParameterChangeHub (AudioProcessor& proc)
+        : processor (proc),
+          numParameters (proc.getParameters().size()),
+          numWords ((numParameters + 31) / 32),
+          dirty (new std::atomic<uint32> [(size_t) jmax (1, numWords)])
     {
-        parameterValueHasChanged = 1;
+        for (int i = 0; i < jmax (1, numWords); ++i)
+            dirty[i].store (0, std::memory_order_relaxed);
+        processor.addListener (this);
+        startTimerHz (60);
+    }
+
+    ~ParameterChangeHub() override
+    {
+        stopTimer();
+        processor.removeListener (this);
     }
 
-    void parameterGestureChanged (int, bool) override {}
+    /** Called on the message thread with the index of a changed parameter */
+    std::function<void(int)> onParameterChanged;
+
+    void markDirty (int index) noexcept
+    {
+        if (! isPositiveAndBelow (index, numParameters))
+            return;
+        dirty[index >> 5].fetch_or (1u << (index & 31), std::memory_order_release);
+        pending.store (true, std::memory_order_release);
+    }
+
+    void markAllDirty() noexcept
+    {
+        allDirty.store (true, std::memory_order_release);
+        pending.store (true, std::memory_order_release);
+    }
+
+private:
+    AudioProcessor& processor;
+    const int numParameters;
+    const int numWords;
+    std::unique_ptr<std::atomic<uint32>[]> dirty;
+    std::atomic<bool> pending { false };
+    std::atomic<bool> allDirty { false };
 
-    //==============================================================================
     void audioProcessorParameterChanged (AudioProcessor*, int index, float) override
     {
-        if (index == parameter.getParameterIndex())
-            parameterValueHasChanged = 1;
+        markDirty (index);
     }
 
-    void audioProcessorChanged (AudioProcessor*) override {}
+    void audioProcessorChanged (AudioProcessor*) override
+    {
+        // program changes and the like can touch every parameter
+        markAllDirty();
+    }
 
-    //==============================================================================
     void timerCallback() override
     {
-        if (parameterValueHasChanged.compareAndSetBool (0, 1))
-        {
-            handleNewParameterValue();
-            startTimerHz (50);
-        }
-        else
+        if (! pending.exchange (false, std::memory_order_acquire))
+            return;
+
+        const bool all = allDirty.exchange (false, std::memory_order_acquire);
+        for (int word = 0; word < numWords; ++word)
         {
-            startTimer (jmin (250, getTimerInterval() + 10));
+            uint32 bits = dirty[word].exchange (0, std::memory_order_acquire);
+            if (all)
+                bits = 0xffffffff;
+
+            for (int index = word * 32; bits != 0 && index < numParameters; ++index, bits >>= 1)
+                if ((bits & 1u) != 0 && onParameterChanged)
+                    onParameterChanged (index);
         }
     }
 
-    AudioProcessor& processor;
-    AudioProcessorParameter& parameter;
-    Atomic<int> parameterValueHasChanged { 0 };
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterListener)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterChangeHub)
 };
 
-class BooleanParameterComponent final   : public Component,
-                                          private ParameterListener
+class BooleanParameterComponent final   : public ParameterControl
 {
 public:
-    BooleanParameterComponent (AudioProcessor& proc, AudioProcessorParameter& param)
-        : ParameterListener (proc, param)
+    BooleanParameterComponent (AudioProcessorParameter& param)
+        : ParameterControl (param)
     {
         // Set the initial value.
         handleNewParameterValue();
@@ -157,12 +201,11 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BooleanParameterComponent)
 };
 
-class SwitchParameterComponent final   : public Component,
-                                         private ParameterListener
+class SwitchParameterComponent final   : public ParameterControl
 {
 public:
-    SwitchParameterComponent (AudioProcessor& proc, AudioProcessorParameter& param)
-        : ParameterListener (proc, param)
+    SwitchParameterComponent (AudioProcessorParameter& param)
+        : ParameterControl (param)
     {
         auto* leftButton  = buttons.add (new TextButton());
         auto* rightButton = buttons.add (new TextButton());
@@ -262,12 +305,11 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SwitchParameterComponent)
 };
 
-class ChoiceParameterComponent final   : public Component,
-                                         private ParameterListener
+class ChoiceParameterComponent final   : public ParameterControl
 {
 public:
-    ChoiceParameterComponent (AudioProcessor& proc, AudioProcessorParameter& param)
-        : ParameterListener (proc, param),
+    ChoiceParameterComponent (AudioProcessorParameter& param)
+        : ParameterControl (param),
           parameterValues (getParameter().getAllValueStrings())
     {
         box.addItemList (parameterValues, 1);
@@ -324,12 +366,11 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChoiceParameterComponent)
 };
 
-class SliderParameterComponent final   : public Component,
-                                         private ParameterListener
+class SliderParameterComponent final   : public ParameterControl
 {
 public:
-    SliderParameterComponent (AudioProcessor& proc, AudioProcessorParameter& param)
-        : ParameterListener (proc, param)
+    SliderParameterComponent (AudioProcessorParameter& param)
+        : ParameterControl (param)
     {
         if (getParameter().getNumSteps() != AudioProcessor::getDefaultNumParameterSteps())
             slider.setRange (0.0, 1.0, 1.0 / (getParameter().getNumSteps() - 1.0));
@@ -421,7 +462,7 @@ private:
 class ParameterDisplayComponent   : public Component
 {
 public:
-    ParameterDisplayComponent (AudioProcessor& processor, AudioProcessorParameter& param)
+    ParameterDisplayComponent (AudioProcessorParameter& param)
         : parameter (param)
     {
         parameterName.setFont (Font (12.f));
@@ -438,24 +479,24 @@ public:
             // marking a parameter as boolean. If you want consistency across
             // all  formats then it might be best to use a
             // SwitchParameterComponent instead.
-            parameterComp.reset (new BooleanParameterComponent (processor, param));
+            parameterComp.reset (new BooleanParameterComponent (param));
         }
         else if (param.getNumSteps() == 2)
         {
             // Most hosts display any parameter with just two steps as a switch.
-            parameterComp.reset (new SwitchParameterComponent (processor, param));
+            parameterComp.reset (new SwitchParameterComponent (param));
         }
         else if (! param.getAllValueStrings().isEmpty())
         {
             // If we have a list of strings to represent the different states a
             // parameter can be in then we should present a dropdown allowing a
             // user to pick one of them.
-            parameterComp.reset (new ChoiceParameterComponent (processor, param));
+            parameterComp.reset (new ChoiceParameterComponent (param));
         }
         else
         {
             // Everything else can be represented as a slider.
-            parameterComp.reset (new SliderParameterComponent (processor, param));
+            parameterComp.reset (new SliderParameterComponent (param));
         }
 
         addAndMakeVisible (parameterComp.get());
@@ -474,60 +515,92 @@ public:
         parameterComp->setBounds (area);
     }
 
+    AudioProcessorParameter& getParameter() const noexcept { return parameter; }
+
+    void handleNewParameterValue()
+    {
+        parameterComp->handleNewParameterValue();
+    }
+
 private:
     AudioProcessorParameter& parameter;
     Label parameterName, parameterLabel;
-    std::unique_ptr<Component> parameterComp;
+    std::unique_ptr<ParameterControl> parameterComp;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterDisplayComponent)
 };
 
-class ParametersPanel   : public Component
+struct GenericNodeEditor::Pimpl : public ListBoxModel
 {
-public:
-    ParametersPanel (AudioProcessor& processor, const Array<AudioProcessorParameter*>& parameters)
+    Pimpl (GenericNodeEditor& parent)
+        : owner (parent),
+          processor (*parent.getAudioProcessor()),
+          hub (processor)
     {
-        for (auto* param : parameters)
-            if (param->isAutomatable())
-                addAndMakeVisible (paramComponents.add (new ParameterDisplayComponent (processor, *param)));
+        const auto& params = processor.getParameters();
+        rowForParameter.insertMultiple (0, -1, params.size());
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto* param = params.getUnchecked (i);
+            if (! param->isAutomatable())
+                continue;
+            rowForParameter.set (i, parameters.size());
+            parameters.add (param);
+        }
 
-        if (auto* comp = paramComponents [0])
-            setSize (comp->getWidth(), comp->getHeight() * paramComponents.size());
-        else
-            setSize (400, 100);
+        hub.onParameterChanged = [this](int index) { parameterChanged (index); };
+
+        owner.setOpaque (true);
+        list.setModel (this);
+        list.setRowHeight (rowHeight);
+        list.setColour (ListBox::backgroundColourId, Colours::transparentBlack);
+        owner.addAndMakeVisible (list);
     }
 
-    void paint (Graphics& g) override { }
+    ~Pimpl()
+    {
+        hub.onParameterChanged = nullptr;
+        list.setModel (nullptr);
+    }
 
-    void resized() override
+    int getNumRows() override { return parameters.size(); }
+    void paintListBoxItem (int, Graphics&, int, int, bool) override { }
+
+    Component* refreshComponentForRow (int row, bool, Component* existing) override
     {
-        auto area = getLocalBounds();
+        // only rows on screen have a component, so a large plugin costs as
+        // much as the few rows that fit in the editor
+        auto* const param = parameters [row];
+        auto* const comp = dynamic_cast<ParameterDisplayComponent*> (existing);
+        if (param != nullptr && comp != nullptr && &comp->getParameter() == param)
+            return comp;
 
-        for (auto* comp : paramComponents)
-            comp->setBounds (area.removeFromTop (comp->getHeight()));
+        delete existing;
+        return param != nullptr ? new ParameterDisplayComponent (*param) : nullptr;
     }
 
-private:
-    OwnedArray<ParameterDisplayComponent> paramComponents;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParametersPanel)
-};
+    void parameterChanged (int index)
+    {
+        const int row = rowForParameter [index];
+        if (row < 0)
+            return;
+        if (auto* comp = dynamic_cast<ParameterDisplayComponent*> (list.getComponentForRowNumber (row)))
+            comp->handleNewParameterValue();
+    }
 
-struct GenericNodeEditor::Pimpl
-{
-    Pimpl (GenericNodeEditor& parent)
-        : owner (parent)
+    int getContentHeight() const
     {
-        auto* p = parent.getAudioProcessor();
-        jassert (p != nullptr);
-        owner.setOpaque (true);
-        view.setViewedComponent (new ParametersPanel (*p, p->getParameters()));
-        owner.addAndMakeVisible (view);
-        view.setScrollBarsShown (true, false);
+        return parameters.isEmpty() ? 100 : parameters.size() * rowHeight;
     }
 
     GenericNodeEditor& owner;
-    Viewport view;
+    AudioProcessor& processor;
+    const int rowHeight = 34;
+    Array<AudioProcessorParameter*> parameters;
+    Array<int> rowForParameter;
+    ParameterChangeHub hub;
+    ListBox list;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pimpl)
 };
 
@@ -535,8 +608,8 @@ GenericNodeEditor::GenericNodeEditor (const Node& node)
     : NodeEditorComponent (node), pimpl (new Pimpl (*this))
 {
     jassert (GenericEditorHelpers::isAudioProcessorNode (node));  // only nodes with real parameters are supported
-    setSize (pimpl->view.getViewedComponent()->getWidth() + pimpl->view.getVerticalScrollBar().getWidth(),
-             jmin (pimpl->view.getViewedComponent()->getHeight(), 400));
+    setSize (400 + pimpl->list.getViewport()->getScrollBarThickness(),
+             jmin (pimpl->getContentHeight(), 400));
 }
 
 GenericNodeEditor::~GenericNodeEditor() { }
@@ -553,9 +626,7 @@ void GenericNodeEditor::paint (Graphics& g)
 
 void GenericNodeEditor::resized()
 {
-    if (auto* const comp = pimpl->view.getViewedComponent())
-        comp->setSize (jmax (150, getWidth()), comp->getHeight());
-    pimpl->view.setBounds (getLocalBounds());
+    pimpl->list.setBounds (getLocalBounds());
 }
 
 }
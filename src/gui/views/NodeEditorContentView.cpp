@@ -33,6 +33,7 @@
 #include "gui/ViewHelpers.h"
 #include "gui/LookAndFeel.h"
 #include "gui/ContextMenus.h"
+#include "gui/NodeEditorCache.h"
 
 #include "session/DeviceManager.h"
 #include "Globals.h"
@@ -158,6 +159,7 @@ NodeEditorContentView::NodeEditorContentView()
 
 NodeEditorContentView::~NodeEditorContentView()
 {
+    clearEditor();
     watcher.reset();
     menuButton.onClick = nullptr;
     nodesCombo.removeListener (this);
@@ -338,6 +340,7 @@ void NodeEditorContentView::setNode (const Node& newNode)
         nodeObjectValue.addListener (this);
 
         resized();
+        prefetchNeighbors();
     }
 
     nodesCombo.selectNode (node, dontSendNotification);
@@ -359,6 +362,17 @@ void NodeEditorContentView::clearEditor()
 {
     if (editor == nullptr)
         return;
+
+    if (editorIsCacheable)
+    {
+        editorIsCacheable = false;
+        if (auto* cache = getEditorCache())
+        {
+            cache->release (node, NodeEditorCache::embeddedEditor, editor.release());
+            return;
+        }
+    }
+
     GraphNodePtr object = node.getGraphNode();
     auto* const proc = (object != nullptr) ? object->getAudioProcessor() : nullptr;
     if (auto* aped = dynamic_cast<AudioProcessorEditor*> (editor.get()))
@@ -371,9 +385,49 @@ void NodeEditorContentView::clearEditor()
     editor.reset (nullptr);
 }
 
+NodeEditorCache* NodeEditorContentView::getEditorCache()
+{
+    if (auto* cc = ViewHelpers::findContentComponent (this))
+        if (auto* gui = cc->getAppController().findChild<GuiController>())
+            return &gui->getEditorCache();
+    return nullptr;
+}
+
+void NodeEditorContentView::prefetchNeighbors()
+{
+    auto* const cache = getEditorCache();
+    if (cache == nullptr || ! node.isValid())
+        return;
+
+    // operators step through the node list, so the next and previous
+    // nodes are the ones most likely to be shown next
+    Array<Node> nodes;
+    const int index = graph.getNodesValueTree().indexOf (node.getValueTree());
+    for (const int neighbor : { index + 1, index - 1 })
+    {
+        const Node next (graph.getNode (neighbor));
+        if (next.isValid() && ! next.isIONode() && next.getGraphNode() != nullptr)
+            nodes.add (next);
+    }
+
+    cache->prefetch (nodes, NodeEditorCache::embeddedEditor, createPluginEditor);
+}
+
+Component* NodeEditorContentView::createPluginEditor (const Node& node)
+{
+    GraphNodePtr object = node.getGraphNode();
+    auto* const proc = (object != nullptr) ? object->getAudioProcessor() : nullptr;
+    if (proc == nullptr)
+        return nullptr;
+    if (node.getFormat() == "Element" && proc->hasEditor())
+        return proc->createEditor();
+    return new GenericNodeEditor (node);
+}
+
 Component* NodeEditorContentView::createEmbededEditor()
 {
     auto* const world = ViewHelpers::getGlobals (this);
+    editorIsCacheable = false;
     
     if (node.isAudioInputNode())
     {
@@ -440,9 +494,11 @@ Component* NodeEditorContentView::createEmbededEditor()
     auto* const proc = (object != nullptr) ? object->getAudioProcessor() : nullptr;
     if (proc != nullptr)
     {
-        if (node.getFormat() == "Element" && proc->hasEditor())
-            return proc->createEditor();
-        return new GenericNodeEditor (node);
+        editorIsCacheable = true;
+        if (auto* cache = getEditorCache())
+            if (auto* cached = cache->take (node, NodeEditorCache::embeddedEditor))
+                return cached;
+        return createPluginEditor (node);
     }
     else if (node.getIdentifier() == EL_INTERNAL_ID_MIDI_PROGRAM_MAP)
     {
@@ -25,6 +25,8 @@
 
 namespace Element {
 
+class NodeEditorCache;
+
 class NodeEditorContentView : public ContentView,
                               public ComboBox::Listener,
                               public Value::Listener
@@ -60,8 +62,12 @@ private:
     NodeListComboBox nodesCombo;
     IconButton menuButton;
     bool sticky = false;
+    bool editorIsCacheable = false;
     void clearEditor();
     Component* createEmbededEditor();
+    NodeEditorCache* getEditorCache();
+    void prefetchNeighbors();
+    static Component* createPluginEditor (const Node&);
     
     static void nodeMenuCallback (int, NodeEditorContentView*);
     void onGraphChanged();
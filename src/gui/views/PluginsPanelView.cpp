@@ -18,6 +18,7 @@
 */
 
 #include "session/PluginManager.h"
+#include "session/PluginSearchIndex.h"
 #include "gui/GuiCommon.h"
 #include "gui/views/PluginsPanelView.h"
 
@@ -89,12 +90,10 @@ public:
     {
         if (isNowOpen)
         {
-            const auto text = panel.getSearchText();
             for (auto* folder : tree.subFolders)
                 addSubItem (new PluginFolderTreeViewItem (panel, *folder));
             for (const auto& plugin : tree.plugins)
-                if (text.isEmpty() || plugin.name.containsIgnoreCase (text))
-                    addSubItem (new PluginTreeViewItem (plugin));
+                addSubItem (new PluginTreeViewItem (plugin));
         }
         else
         {
@@ -134,6 +133,75 @@ public:
     std::unique_ptr<KnownPluginList::PluginTree> data;
 };
 
+/** Lists search results from the plugin index. Only visible rows are
+    painted, so large result sets cost nothing to display */
+class PluginsPanelView::ResultsModel : public ListBoxModel
+{
+public:
+    ResultsModel (PluginManager& p) : plugins (p), index (p.getSearchIndex()) { }
+
+    void search (const String& text)
+    {
+        // only sync here so entries stay stable between searches
+        plugins.getSearchIndex().search (text, matches);
+    }
+
+    int getNumRows() override { return matches.size(); }
+
+    void paintListBoxItem (int row, Graphics& g, int width, int height, bool selected) override
+    {
+        const auto* desc = getDescription (row);
+        if (desc == nullptr)
+            return;
+
+        if (selected)
+            g.fillAll (Element::LookAndFeel::textColor.withAlpha (0.12f));
+
+        g.setColour (Element::LookAndFeel::textColor.darker (0.22f));
+        const int leftSide = (width * 4) / 5;
+        g.drawText (desc->name, 6, 0, leftSide - 6, height, Justification::centredLeft);
+
+        String extra = PluginTreeViewItem::shortFormatName (desc->pluginFormatName);
+        if (extra.isNotEmpty())
+        {
+            g.setColour (Element::LookAndFeel::textColor.withAlpha (0.8f));
+            extra = String("(") + extra + String(")");
+            g.setFont (Font (12.f));
+            g.drawText (extra, leftSide, 0, width - leftSide - 3, height, Justification::centredRight);
+        }
+    }
+
+    var getDragSourceDescription (const SparseSet<int>& rows) override
+    {
+        var result;
+        if (const auto* desc = getDescription (rows [0]))
+        {
+            result.append ("plugin");
+            result.append (desc->createIdentifierString());
+        }
+        return result;
+    }
+
+    String getTooltipForRow (int row) override
+    {
+        if (const auto* desc = getDescription (row))
+            return desc->manufacturerName;
+        return String();
+    }
+
+private:
+    PluginManager& plugins;
+    const PluginSearchIndex& index;
+    Array<int> matches;
+
+    const PluginDescription* getDescription (int row) const
+    {
+        return isPositiveAndBelow (row, matches.size())
+            ? index.getDescription (matches.getUnchecked (row))
+            : nullptr;
+    }
+};
+
 PluginsPanelView::PluginsPanelView (PluginManager& p)
     : plugins(p)
 {
@@ -146,6 +214,13 @@ PluginsPanelView::PluginsPanelView (PluginManager& p)
     tree.setOpenCloseButtonsVisible (true);
     tree.setIndentSize (10);
     tree.setRootItem (new PluginsPanelTreeRootItem (*this, plugins));
+
+    resultsModel.reset (new ResultsModel (plugins));
+    addChildComponent (results);
+    results.setModel (resultsModel.get());
+    results.setRowHeight (20);
+    results.setColour (ListBox::backgroundColourId, Colours::transparentBlack);
+
     plugins.getKnownPlugins().addChangeListener (this);
 }
 
@@ -154,6 +229,7 @@ PluginsPanelView::~PluginsPanelView()
     plugins.getKnownPlugins().removeChangeListener (this);
     tree.getRootItem()->clearSubItems();
     tree.deleteRootItem();
+    results.setModel (nullptr);
 }
 
 void PluginsPanelView::resized()
@@ -162,40 +238,43 @@ void PluginsPanelView::resized()
     search.setBounds (r.removeFromTop (22));
     r.removeFromTop (2);
     tree.setBounds (r);
+    results.setBounds (r);
 }
 
 void PluginsPanelView::paint (Graphics& g) { }
 
 void PluginsPanelView::textEditorTextChanged (TextEditor&)
 {
-    startTimer (200);
+    updateResults();
 }
 
-void PluginsPanelView::updateTreeView()
+void PluginsPanelView::updateResults()
 {
-    tree.deleteRootItem();
-    tree.setRootItem (new PluginsPanelTreeRootItem (*this, plugins));
-    auto* root = tree.getRootItem();
-    for (int i = 0; i < root->getNumSubItems();  ++i)
-        root->getSubItem(i)->setOpenness (TreeViewItem::opennessOpen);
-}
+    const auto text = getSearchText().trim();
+    const bool searching = text.isNotEmpty();
 
-void PluginsPanelView::timerCallback()
-{
-    updateTreeView();
-    stopTimer();
+    if (searching)
+    {
+        resultsModel->search (text);
+        results.updateContent();
+        results.deselectAllRows();
+        results.scrollToEnsureRowIsOnscreen (0);
+    }
+
+    results.setVisible (searching);
+    tree.setVisible (! searching);
 }
 
 void PluginsPanelView::textEditorReturnKeyPressed (TextEditor& e)
 {
-    stopTimer();
-    updateTreeView();
+    updateResults();
 }
 
 void PluginsPanelView::changeListenerCallback (ChangeBroadcaster* src)
 {
     tree.deleteRootItem();
     tree.setRootItem (new PluginsPanelTreeRootItem (*this, plugins));
+    updateResults();
 }
 
 }
@@ -28,8 +28,7 @@ class PluginManager;
 
 class PluginsPanelView : public ContentView,
                             public ChangeListener,
-                            public TextEditor::Listener,
-                            public Timer
+                            public TextEditor::Listener
 {
 public:
     PluginsPanelView (PluginManager& pm);
@@ -45,13 +44,16 @@ public:
     void textEditorTextChanged (TextEditor&) override;
     void textEditorReturnKeyPressed (TextEditor&) override;
     void changeListenerCallback (ChangeBroadcaster*) override;
-    void timerCallback() override;
+
 private:
     PluginManager& plugins;
     TreeView tree;
     TextEditor search;
+    class ResultsModel;
+    std::unique_ptr<ResultsModel> resultsModel;
+    ListBox results;
 
-    void updateTreeView();
+    void updateResults();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginsPanelView);
 };
@@ -0,0 +1,106 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "gui/widgets/PeakOverview.h"
+#include "gui/LookAndFeel.h"
+
+namespace Element {
+
+PeakOverview::PeakOverview()
+{
+    setColour (backgroundColourId, LookAndFeel::widgetBackgroundColor.darker());
+    setColour (waveformColourId, Colors::toggleBlue);
+    setColour (positionColourId, Colours::white);
+}
+
+PeakOverview::~PeakOverview()
+{
+    readyConnection.disconnect();
+}
+
+void PeakOverview::setPeakCache (PeakCache* newCache)
+{
+    if (cache == newCache)
+        return;
+
+    readyConnection.disconnect();
+    cache = newCache;
+    if (cache != nullptr)
+        readyConnection = cache->peaksReady.connect (
+            std::bind (&PeakOverview::peaksReady, this, std::placeholders::_1));
+    refresh();
+}
+
+void PeakOverview::setFile (const File& newFile)
+{
+    if (file == newFile)
+        return;
+    file = newFile;
+    visibleStart = 0;
+    visibleEnd = -1;
+    refresh();
+}
+
+void PeakOverview::setVisibleRange (int64 startSample, int64 endSample)
+{
+    visibleStart = jmax ((int64) 0, startSample);
+    visibleEnd = endSample;
+    repaint();
+}
+
+void PeakOverview::setPosition (double newPosition)
+{
+    if (position == newPosition)
+        return;
+    position = newPosition;
+    repaint();
+}
+
+void PeakOverview::refresh()
+{
+    peaks = (cache != nullptr && file.existsAsFile()) ? cache->getPeaks (file) : nullptr;
+    repaint();
+}
+
+void PeakOverview::peaksReady (const File& ready)
+{
+    if (ready == file && peaks == nullptr)
+        refresh();
+}
+
+void PeakOverview::paint (Graphics& g)
+{
+    g.fillAll (findColour (backgroundColourId));
+
+    if (peaks != nullptr)
+    {
+        const int64 end = visibleEnd > visibleStart ? visibleEnd : peaks->getLengthInSamples();
+        g.setColour (findColour (waveformColourId));
+        peaks->drawChannels (g, getLocalBounds(), visibleStart, end);
+    }
+
+    if (position >= 0.0)
+    {
+        g.setColour (findColour (positionColourId));
+        g.drawVerticalLine (roundToInt (position * (double) (getWidth() - 1)), 0.f, (float) getHeight());
+    }
+}
+
+}
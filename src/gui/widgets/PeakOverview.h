@@ -0,0 +1,69 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#pragma once
+
+#include "session/PeakCache.h"
+
+namespace Element {
+
+/** Shows the waveform overview of an audio file from a PeakCache */
+class PeakOverview : public Component
+{
+public:
+    enum ColourIds
+    {
+        backgroundColourId = 0x90002000,
+        waveformColourId,
+        positionColourId
+    };
+
+    PeakOverview();
+    virtual ~PeakOverview();
+
+    /** Sets the cache to read peaks from */
+    void setPeakCache (PeakCache* cache);
+    PeakCache* getPeakCache() const noexcept { return cache; }
+
+    /** Sets the file to show, the whole file is visible afterwards */
+    void setFile (const File& file);
+    const File& getFile() const noexcept { return file; }
+
+    /** Sets the range of samples to show */
+    void setVisibleRange (int64 startSample, int64 endSample);
+
+    /** Sets the playhead, between 0 and 1. Negative hides it */
+    void setPosition (double position);
+
+    void paint (Graphics&) override;
+
+private:
+    PeakCache* cache = nullptr;
+    SignalConnection readyConnection;
+    PeakCache::Peaks::Ptr peaks;
+    File file;
+    int64 visibleStart = 0, visibleEnd = -1;
+    double position = -1.0;
+
+    void refresh();
+    void peaksReady (const File&);
+};
+
+}
@@ -30,6 +30,8 @@ public:
     ~Private() { }
 
     EnginePtr activeEngine;
+    RedundantAudioOutput redundant;
+    std::unique_ptr<AudioIODevice> backupDevice;
    #if KV_JACK_AUDIO
     kv::JackClient jackClient { "Element", 2, "main_in_", 2, "main_out_" };
    #endif
@@ -42,6 +44,7 @@ DeviceManager::DeviceManager()
 
 DeviceManager::~DeviceManager()
 {
+    closeBackupAudioDevice();
     closeAudioDevice();
     attach (nullptr);
 }
@@ -53,14 +56,19 @@ void DeviceManager::attach (EnginePtr engine)
 
     EnginePtr old = impl->activeEngine;
 
+    // the engine is rendered through the redundant output so a backup
+    // device can mirror it, the primary callback is re-added to deliver
+    // start and stop to the new engine
     if (old != nullptr)
     {
-        removeAudioCallback (&old->getAudioIODeviceCallback());
+        removeAudioCallback (&impl->redundant.getPrimaryCallback());
     }
 
+    impl->redundant.setEngineCallback (engine != nullptr ? &engine->getAudioIODeviceCallback() : nullptr);
+
     if (engine)
     {
-        addAudioCallback (&engine->getAudioIODeviceCallback());
+        addAudioCallback (&impl->redundant.getPrimaryCallback());
     }
     else
     {
@@ -70,6 +78,59 @@ void DeviceManager::attach (EnginePtr engine)
     impl->activeEngine = engine;
 }
 
+String DeviceManager::setBackupAudioDevice (const String& deviceName)
+{
+    closeBackupAudioDevice();
+    if (deviceName.isEmpty())
+        return String();
+
+    auto* const type = getCurrentDeviceTypeObject();
+    if (type == nullptr)
+        return TRANS("No audio device type is selected");
+
+    AudioDeviceSetup setup;
+    getAudioDeviceSetup (setup);
+    if (deviceName == setup.outputDeviceName)
+        return TRANS("The backup device must be different from the main output");
+
+    std::unique_ptr<AudioIODevice> device (type->createDevice (deviceName, String()));
+    if (device == nullptr)
+        return TRANS("Could not create backup device: ") + deviceName;
+
+    BigInteger outputs (setup.outputChannels);
+    if (outputs.isZero())
+        outputs.setRange (0, 2, true);
+    const double sampleRate = setup.sampleRate > 0.0 ? setup.sampleRate : 44100.0;
+    const String error = device->open (BigInteger(), outputs, sampleRate, setup.bufferSize);
+    if (error.isNotEmpty())
+        return error;
+
+    device->start (&impl->redundant.getBackupCallback());
+    impl->backupDevice = std::move (device);
+    sendChangeMessage();
+    return String();
+}
+
+String DeviceManager::getBackupAudioDeviceName() const
+{
+    return impl->backupDevice != nullptr ? impl->backupDevice->getName() : String();
+}
+
+void DeviceManager::closeBackupAudioDevice()
+{
+    if (impl->backupDevice == nullptr)
+        return;
+    impl->backupDevice->stop();
+    impl->backupDevice->close();
+    impl->backupDevice.reset();
+    sendChangeMessage();
+}
+
+RedundantAudioOutput::Status DeviceManager::getBackupStatus() const
+{
+    return impl->redundant.getStatus();
+}
+
 static void addIfNotNull (OwnedArray <AudioIODeviceType>& list, AudioIODeviceType* const device)
 {
     if (device != nullptr)
@@ -21,6 +21,7 @@
 
 #include "ElementApp.h"
 #include "engine/Engine.h"
+#include "engine/RedundantAudioOutput.h"
 
 namespace Element {
 
@@ -37,6 +38,24 @@ public:
     void selectAudioDriver (const String& name);
     void attach (EnginePtr engine);
 
+    /** Opens a second output device that mirrors the main output and takes
+        over rendering if the main device stops calling back. It is opened
+        with the same type, rate, block size and output channels as the
+        current device. Pass an empty name to close it.
+
+        @returns an error message or an empty string on success
+     */
+    String setBackupAudioDevice (const String& deviceName);
+
+    /** Returns the name of the backup device or empty if there isn't one */
+    String getBackupAudioDeviceName() const;
+
+    /** Closes the backup device if open */
+    void closeBackupAudioDevice();
+
+    /** Returns drift, underrun and failover information for the backup */
+    RedundantAudioOutput::Status getBackupStatus() const;
+
    #if KV_JACK_AUDIO
     kv::JackClient& getJackClient();
    #endif
@@ -679,11 +679,14 @@ void Node::restorePluginState()
 
         obj->setMuted ((bool) getProperty (Tags::mute, obj->isMuted()));
         obj->setMuteInput ((bool) getProperty ("muteInput", obj->isMutingInputs()));
+        obj->setSubBlockControls ((bool) getProperty ("subBlockControls", obj->wantsSubBlockControls()));
 
         if (hasProperty (Tags::transpose))
             obj->setTransposeOffset (getProperty (Tags::transpose));
         
         obj->setOversamplingFactor (jmax (1, (int) getProperty (Tags::oversamplingFactor, 1)));
+        obj->setDownsamplingFactor (jmax (1, (int) getProperty (Tags::downsamplingFactor, 1)));
+        obj->setAutomation (NodeAutomation::compile (getAutomationValueTree()));
     }
 
     // this was originally here to help reduce memory usage
@@ -698,6 +701,13 @@ void Node::restorePluginState()
 }
 
 void Node::savePluginState()
+{
+    savePluginState ([](ValueTree& data, const Identifier& property, MemoryBlock& state) {
+        data.setProperty (property, state.toBase64Encoding(), nullptr);
+    });
+}
+
+void Node::savePluginState (const StateWriter& writer)
 {
     if (! isValid())
         return;
@@ -712,7 +722,7 @@ void Node::savePluginState()
             proc->getStateInformation (state);
             if (state.getSize() > 0)
             {
-                objectData.setProperty (Tags::state, state.toBase64Encoding(), nullptr);
+                writer (objectData, Tags::state, state);
             }
             else
             {
@@ -725,7 +735,7 @@ void Node::savePluginState()
             proc->getCurrentProgramStateInformation (state);
             if (state.getSize() > 0)
             {
-                objectData.setProperty (Tags::programState, state.toBase64Encoding(), 0);
+                writer (objectData, Tags::programState, state);
             }
 
             setProperty (Tags::bypass, proc->isSuspended());
@@ -735,7 +745,7 @@ void Node::savePluginState()
         {
             obj->getState (state);
             if (state.getSize() > 0)
-                objectData.setProperty (Tags::state, state.toBase64Encoding(), nullptr);
+                writer (objectData, Tags::state, state);
         }
 
         setProperty (Tags::midiProgram, obj->getMidiProgram());
@@ -743,13 +753,15 @@ void Node::savePluginState()
         setProperty (Tags::midiProgramsEnabled, obj->areMidiProgramsEnabled());
         setProperty (Tags::mute, obj->isMuted());
         setProperty ("muteInput", obj->isMutingInputs());
+        setProperty ("subBlockControls", obj->wantsSubBlockControls());
         String mps; obj->getMidiProgramsState (mps);
         setProperty (Tags::midiProgramsState, mps);
         setProperty (Tags::oversamplingFactor, obj->getOversamplingFactor());
+        setProperty (Tags::downsamplingFactor, obj->getDownsamplingFactor());
     }
 
     for (int i = 0; i < getNumNodes(); ++i)
-        getNode(i).savePluginState();
+        getNode(i).savePluginState (writer);
 }
 
 void Node::setMuted (bool shouldBeMuted)
@@ -760,6 +772,44 @@ void Node::setMuted (bool shouldBeMuted)
         obj->setMuted (isMuted());
 }
 
+void Node::addAutomationPoint (int parameter, double beat, float value)
+{
+    jassert (parameter >= 0);
+    auto automation = objectData.getOrCreateChildWithName (Tags::automation, nullptr);
+    auto lane = automation.getChildWithProperty (Tags::parameter, parameter);
+    if (! lane.isValid())
+    {
+        lane = ValueTree (Tags::lane);
+        lane.setProperty (Tags::parameter, parameter, nullptr);
+        automation.addChild (lane, -1, nullptr);
+    }
+
+    ValueTree point (Tags::point);
+    point.setProperty (Tags::beat, jmax (0.0, beat), nullptr)
+         .setProperty (Tags::value, jlimit (0.f, 1.f, value), nullptr);
+    lane.addChild (point, -1, nullptr);
+    updateAutomation();
+}
+
+void Node::clearAutomation (int parameter)
+{
+    auto automation = getAutomationValueTree();
+    if (! automation.isValid())
+        return;
+
+    if (parameter < 0)
+        automation.removeAllChildren (nullptr);
+    else
+        automation.removeChild (automation.getChildWithProperty (Tags::parameter, parameter), nullptr);
+    updateAutomation();
+}
+
+void Node::updateAutomation()
+{
+    if (GraphNodePtr obj = getGraphNode())
+        obj->setAutomation (NodeAutomation::compile (getAutomationValueTree()));
+}
+
 void Node::setMuteInput (bool shouldMuteInputs)
 {
     if (shouldMuteInputs != isMutingInputs())
@@ -768,6 +818,14 @@ void Node::setMuteInput (bool shouldMuteInputs)
         obj->setMuteInput (isMutingInputs());
 }
 
+void Node::setSubBlockControls (bool subBlocks)
+{
+    if (subBlocks != wantsSubBlockControls())
+        setProperty ("subBlockControls", subBlocks);
+    if (auto* obj = getGraphNode())
+        obj->setSubBlockControls (wantsSubBlockControls());
+}
+
 void Node::setCurrentProgram (const int index)
 {
     if (auto* obj = getGraphNode())
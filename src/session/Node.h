@@ -189,6 +189,8 @@ public:
     bool isMutingInputs() const { return (bool) getProperty ("muteInput", false); }
     void setMuted (bool);
     void setMuteInput (bool);
+    bool wantsSubBlockControls() const { return (bool) getProperty ("subBlockControls", false); }
+    void setSubBlockControls (bool);
 
     /** returns the number of connections on this node */
     int getNumConnections() const;
@@ -377,6 +379,14 @@ public:
     
     /** Saves the node state from GraphNode to state property */
     void savePluginState();
+
+    /** Receives the raw state blocks savePluginState() captures, along with
+        the node data and property they belong to */
+    using StateWriter = std::function<void (ValueTree& data, const Identifier& property, MemoryBlock& state)>;
+
+    /** Saves the node state like savePluginState() but hands the state blocks
+        to a writer instead of encoding them on the calling thread */
+    void savePluginState (const StateWriter& writer);
     
     /** Reads state property and applies to GraphNode */
     void restorePluginState();
@@ -409,6 +419,20 @@ public:
     ValueTree getParentArcsNode() const;
     ValueTree getPortsValueTree() const { return objectData.getChildWithName (Tags::ports); }
     ValueTree getUIValueTree()    const { return objectData.getChildWithName (Tags::ui); }
+    ValueTree getAutomationValueTree() const { return objectData.getChildWithName (Tags::automation); }
+    ValueTree getScenesValueTree() const { return objectData.getChildWithName (Tags::scenes); }
+
+    /** Adds a breakpoint to a parameter's automation lane. The value is
+        normalized and the beat is a transport position in quarter notes. */
+    void addAutomationPoint (int parameter, double beat, float value);
+
+    /** Removes a parameter's automation lane, or all lanes if parameter
+        is negative */
+    void clearAutomation (int parameter = -1);
+
+    /** Compiles the automation lanes and hands them to the GraphNode */
+    void updateAutomation();
+
     const bool operator==(const Node& o) const { return this->objectData == o.objectData; }
     const bool operator!=(const Node& o) const { return this->objectData != o.objectData; }
 
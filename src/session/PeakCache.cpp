@@ -0,0 +1,427 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "session/PeakCache.h"
+
+namespace Element {
+
+const int PeakCache::magic                  = (int) ByteOrder::littleEndianInt ("ELPK");
+const int PeakCache::version                = 1;
+const char* const PeakCache::fileExtension  = ".peaks";
+
+static String getKey (const File& audioFile)
+{
+    String id (audioFile.getFullPathName());
+    id << "|" << audioFile.getSize() << "|" << audioFile.getLastModificationTime().toMilliseconds();
+    return String::toHexString (id.hashCode64());
+}
+
+static int8 toPeak (float value, bool roundUp) noexcept
+{
+    if (! std::isfinite (value))
+        return 0;
+    const float scaled = value * 127.f;
+    return (int8) jlimit (-127, 127, (int) (roundUp ? std::ceil (scaled) : std::floor (scaled)));
+}
+
+//=============================================================================
+PeakCache::Peaks::Ptr PeakCache::Peaks::open (const File& cacheFile)
+{
+    std::unique_ptr<MemoryMappedFile> map (new MemoryMappedFile (cacheFile, MemoryMappedFile::readOnly));
+    if (map->getData() == nullptr)
+        return nullptr;
+
+    MemoryInputStream in (map->getData(), map->getSize(), false);
+    if (in.readInt() != magic || in.readInt() != version)
+        return nullptr;
+
+    Ptr peaks (new Peaks());
+    peaks->numChannels      = in.readInt();
+    const int numLevels     = in.readInt();
+    peaks->sampleRate       = in.readDouble();
+    peaks->lengthInSamples  = in.readInt64();
+    const int spp           = in.readInt();
+    const int factor        = in.readInt();
+
+    if (spp != samplesPerPeak || factor != levelFactor || ! isPositiveAndNotGreaterThan (peaks->numChannels, (int) maxChannels)
+            || peaks->numChannels == 0 || ! isPositiveAndBelow (numLevels, 64) || numLevels == 0)
+        return nullptr;
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        Level level;
+        level.offset    = in.readInt64();
+        level.numPeaks  = in.readInt64();
+        const int64 end = level.offset + level.numPeaks * peaks->numChannels * 2;
+        if (in.isExhausted() || level.offset < 0 || level.numPeaks <= 0 || end > (int64) map->getSize())
+            return nullptr;
+        peaks->levels.add (level);
+    }
+
+    peaks->map.reset (map.release());
+    return peaks;
+}
+
+int64 PeakCache::Peaks::getNumPeaks (int level) const noexcept
+{
+    return isPositiveAndBelow (level, levels.size()) ? levels.getReference(level).numPeaks : 0;
+}
+
+int64 PeakCache::Peaks::getSamplesPerPeak (int level) const noexcept
+{
+    int64 spp = samplesPerPeak;
+    for (int i = 0; i < level; ++i)
+        spp *= levelFactor;
+    return spp;
+}
+
+const int8* PeakCache::Peaks::getPeak (int level, int64 index) const noexcept
+{
+    const auto* const data = static_cast<const int8*> (map->getData());
+    return data + levels.getReference(level).offset + index * numChannels * 2;
+}
+
+void PeakCache::Peaks::getMinMax (int channel, int64 startSample, int64 endSample,
+                                  float* mins, float* maxs, int numPixels) const noexcept
+{
+    if (numPixels <= 0)
+        return;
+
+    if (! isPositiveAndBelow (channel, numChannels) || endSample <= startSample)
+    {
+        FloatVectorOperations::clear (mins, numPixels);
+        FloatVectorOperations::clear (maxs, numPixels);
+        return;
+    }
+
+    const double perPixel = (double) (endSample - startSample) / (double) numPixels;
+    int level = 0;
+    while (level + 1 < levels.size() && (double) getSamplesPerPeak (level + 1) <= perPixel)
+        ++level;
+
+    const int64 spp = getSamplesPerPeak (level);
+    const int64 numPeaks = levels.getReference(level).numPeaks;
+
+    for (int x = 0; x < numPixels; ++x)
+    {
+        const int64 start = startSample + (int64) (x * perPixel);
+        const int64 end   = startSample + (int64) ((x + 1) * perPixel);
+        const int64 first = jmax ((int64) 0, start / spp);
+        const int64 last  = jmin (numPeaks, jmax (first + 1, (end + spp - 1) / spp));
+
+        int low = 127, high = -127;
+        for (int64 i = first; i < last; ++i)
+        {
+            const int8* const peak = getPeak (level, i) + channel * 2;
+            low  = jmin (low, (int) peak[0]);
+            high = jmax (high, (int) peak[1]);
+        }
+
+        if (low > high)
+            low = high = 0;
+        mins[x] = (float) low / 127.f;
+        maxs[x] = (float) high / 127.f;
+    }
+}
+
+void PeakCache::Peaks::drawChannels (Graphics& g, const Rectangle<int>& area,
+                                     int64 startSample, int64 endSample, float verticalZoom) const
+{
+    const int width = area.getWidth();
+    if (width <= 0 || area.getHeight() <= 0)
+        return;
+
+    HeapBlock<float> mins ((size_t) width), maxs ((size_t) width);
+    const float laneHeight = (float) area.getHeight() / (float) numChannels;
+    const float halfHeight = laneHeight * 0.5f * verticalZoom;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        getMinMax (channel, startSample, endSample, mins, maxs, width);
+        const float centre = (float) area.getY() + laneHeight * ((float) channel + 0.5f);
+        for (int x = 0; x < width; ++x)
+        {
+            const float top    = centre - jlimit (-1.f, 1.f, maxs[x]) * halfHeight;
+            const float bottom = centre - jlimit (-1.f, 1.f, mins[x]) * halfHeight;
+            g.drawVerticalLine (area.getX() + x, top, jmax (bottom, top + 1.f));
+        }
+    }
+}
+
+//=============================================================================
+class PeakCache::ScanJob : public ThreadPoolJob
+{
+public:
+    ScanJob (PeakCache& c, const File& f, const String& k)
+        : ThreadPoolJob ("PeakCache::ScanJob"), cache (c), file (f), key (k) { }
+
+    JobStatus runJob() override
+    {
+        bool ok = false;
+        if (std::unique_ptr<AudioFormatReader> reader { cache.formats.createReaderFor (file) })
+        {
+            const auto result = build (*reader, cache.directory.getChildFile (key + fileExtension),
+                                       [this]() { return shouldExit(); });
+            ok = result.wasOk();
+            if (result.failed() && ! shouldExit())
+                DBG("[EL] peak cache: " << file.getFileName() << ": " << result.getErrorMessage());
+        }
+
+        if (! shouldExit())
+            cache.scanned (file, key, ok);
+        return jobHasFinished;
+    }
+
+private:
+    PeakCache& cache;
+    const File file;
+    const String key;
+};
+
+PeakCache::PeakCache (const File& dir)
+    : directory (dir),
+      pool (jlimit (1, 4, SystemStats::getNumCpus() / 2))
+{
+    formats.registerBasicFormats();
+}
+
+PeakCache::~PeakCache()
+{
+    pool.removeAllJobs (true, 10000);
+    cancelPendingUpdate();
+}
+
+File PeakCache::getCacheFileFor (const File& audioFile) const
+{
+    return directory.getChildFile (getKey (audioFile) + fileExtension);
+}
+
+PeakCache::Peaks::Ptr PeakCache::getPeaks (const File& audioFile)
+{
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+    if (! audioFile.existsAsFile())
+        return nullptr;
+
+    const auto key = getKey (audioFile);
+    if (auto peaks = findOpen (key))
+        return peaks;
+
+    const auto cacheFile = directory.getChildFile (key + fileExtension);
+    if (cacheFile.existsAsFile())
+    {
+        if (auto peaks = Peaks::open (cacheFile))
+        {
+            open.set (key, peaks);
+            recent.add (key);
+            while (recent.size() > maxOpenFiles)
+            {
+                open.remove (recent[0]);
+                recent.remove (0);
+            }
+            return peaks;
+        }
+
+        // left by a crash or an older version
+        cacheFile.deleteFile();
+    }
+
+    queue (audioFile, key);
+    return nullptr;
+}
+
+void PeakCache::prefetch (const Array<File>& audioFiles)
+{
+    for (const auto& file : audioFiles)
+    {
+        if (! file.existsAsFile())
+            continue;
+        const auto key = getKey (file);
+        if (! open.contains (key) && ! directory.getChildFile (key + fileExtension).existsAsFile())
+            queue (file, key);
+    }
+}
+
+int PeakCache::getNumPending() const
+{
+    const ScopedLock sl (lock);
+    return queued.size();
+}
+
+PeakCache::Peaks::Ptr PeakCache::findOpen (const String& key)
+{
+    if (! open.contains (key))
+        return nullptr;
+
+    recent.removeString (key);
+    recent.add (key);
+    return open[key];
+}
+
+bool PeakCache::queue (const File& audioFile, const String& key)
+{
+    if (formats.findFormatForFileExtension (audioFile.getFileExtension()) == nullptr)
+        return false;
+
+    {
+        const ScopedLock sl (lock);
+        if (queued.contains (key) || failed.contains (key))
+            return false;
+        queued.add (key);
+    }
+
+    pool.addJob (new ScanJob (*this, audioFile, key), true);
+    return true;
+}
+
+void PeakCache::scanned (const File& audioFile, const String& key, bool ok)
+{
+    {
+        const ScopedLock sl (lock);
+        queued.removeString (key);
+        if (ok)
+            finished.add (audioFile);
+        else
+            failed.add (key);
+    }
+
+    if (ok)
+        triggerAsyncUpdate();
+}
+
+void PeakCache::handleAsyncUpdate()
+{
+    Array<File> ready;
+    {
+        const ScopedLock sl (lock);
+        ready.swapWith (finished);
+    }
+
+    for (const auto& file : ready)
+        peaksReady (file);
+}
+
+//=============================================================================
+Result PeakCache::build (AudioFormatReader& reader, const File& cacheFile, std::function<bool()> shouldExit)
+{
+    const int numChannels = jmin ((int) reader.numChannels, (int) maxChannels);
+    const int64 length = reader.lengthInSamples;
+    if (numChannels <= 0 || length <= 0 || reader.sampleRate <= 0.0)
+        return Result::fail ("File has no audio");
+
+    Array<int64> counts;
+    for (int64 count = (length + samplesPerPeak - 1) / samplesPerPeak;; count = (count + levelFactor - 1) / levelFactor)
+    {
+        counts.add (count);
+        if (count <= minPeaksPerLevel)
+            break;
+    }
+
+    const int64 peakBytes = (int64) numChannels * 2;
+    int64 totalPeaks = 0;
+    for (const auto count : counts)
+        totalPeaks += count;
+
+    HeapBlock<int8> data ((size_t) (totalPeaks * peakBytes));
+    Array<int8*> levels;
+    for (int64 i = 0, offset = 0; i < counts.size(); offset += counts[(int) i] * peakBytes, ++i)
+        levels.add (data + offset);
+
+    // the one pass over the audio, everything else is built from the finest level
+    AudioSampleBuffer buffer (numChannels, samplesPerPeak * 64);
+    int64 peak = 0;
+    for (int64 position = 0; position < length; position += buffer.getNumSamples())
+    {
+        if (shouldExit != nullptr && shouldExit())
+            return Result::fail ("Cancelled");
+
+        const int numSamples = (int) jmin ((int64) buffer.getNumSamples(), length - position);
+        if (! reader.read (&buffer, 0, numSamples, position, true, true))
+            return Result::fail ("Could not read the file");
+
+        for (int offset = 0; offset < numSamples; offset += samplesPerPeak, ++peak)
+        {
+            const int count = jmin ((int) samplesPerPeak, numSamples - offset);
+            int8* const out = levels.getUnchecked (0) + peak * peakBytes;
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = FloatVectorOperations::findMinAndMax (buffer.getReadPointer (channel, offset), count);
+                out[channel * 2]     = toPeak (range.getStart(), false);
+                out[channel * 2 + 1] = toPeak (range.getEnd(), true);
+            }
+        }
+    }
+
+    for (int level = 1; level < counts.size(); ++level)
+    {
+        const int64 below = counts[level - 1];
+        const int8* const src = levels.getUnchecked (level - 1);
+        int8* const dst = levels.getUnchecked (level);
+        for (int64 i = 0; i < counts[level]; ++i)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                int low = 127, high = -127;
+                for (int64 j = i * levelFactor; j < jmin (below, (i + 1) * levelFactor); ++j)
+                {
+                    low  = jmin (low,  (int) src[j * peakBytes + channel * 2]);
+                    high = jmax (high, (int) src[j * peakBytes + channel * 2 + 1]);
+                }
+                dst[i * peakBytes + channel * 2]     = (int8) low;
+                dst[i * peakBytes + channel * 2 + 1] = (int8) high;
+            }
+        }
+    }
+
+    if (! cacheFile.getParentDirectory().createDirectory())
+        return Result::fail ("Could not create " + cacheFile.getParentDirectory().getFullPathName());
+
+    // written aside and moved in place so a map never sees a partial file
+    TemporaryFile temp (cacheFile);
+    {
+        FileOutputStream out (temp.getFile());
+        if (out.failedToOpen())
+            return Result::fail ("Could not write " + temp.getFile().getFullPathName());
+
+        const int64 headerSize = 4 * 4 + 8 + 8 + 4 * 2 + counts.size() * 16;
+        out.writeInt (magic);
+        out.writeInt (version);
+        out.writeInt (numChannels);
+        out.writeInt (counts.size());
+        out.writeDouble (reader.sampleRate);
+        out.writeInt64 (length);
+        out.writeInt (samplesPerPeak);
+        out.writeInt (levelFactor);
+        for (int64 i = 0, offset = headerSize; i < counts.size(); offset += counts[(int) i] * peakBytes, ++i)
+        {
+            out.writeInt64 (offset);
+            out.writeInt64 (counts[(int) i]);
+        }
+
+        out.write (data, (size_t) (totalPeaks * peakBytes));
+        out.flush();
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    return temp.overwriteTargetFileWithTemporary()
+        ? Result::ok() : Result::fail ("Could not move " + cacheFile.getFileName() + " in place");
+}
+
+}
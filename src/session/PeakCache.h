@@ -0,0 +1,145 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#pragma once
+
+#include "ElementApp.h"
+#include "Signals.h"
+
+namespace Element {
+
+/** Waveform overviews of audio files, kept on disk between runs.
+
+    Each file gets a pyramid of min/max peaks. The finest level has a peak
+    every samplesPerPeak samples and each level above it combines levelFactor
+    peaks of the one below. Cache files are named by a hash of the audio
+    file's path, size and modification time, so an edited file is simply
+    scanned again.
+
+    Files are decoded once on a pool thread, all levels are built from that
+    single pass. Finished caches are memory mapped and shared, so any view at
+    any zoom reads peaks without touching the audio again.
+ */
+class PeakCache : private AsyncUpdater
+{
+public:
+    enum
+    {
+        samplesPerPeak      = 256,
+        levelFactor         = 4,
+        minPeaksPerLevel    = 16,
+        maxChannels         = 16,
+        maxOpenFiles        = 512
+    };
+
+    static const int magic;
+    static const int version;
+    static const char* const fileExtension;
+
+    /** A memory mapped peak file */
+    class Peaks : public ReferenceCountedObject
+    {
+    public:
+        using Ptr = ReferenceCountedObjectPtr<Peaks>;
+
+        /** Maps a cache file, returns nullptr if it isn't valid */
+        static Ptr open (const File& cacheFile);
+
+        int getNumChannels() const noexcept         { return numChannels; }
+        double getSampleRate() const noexcept       { return sampleRate; }
+        int64 getLengthInSamples() const noexcept   { return lengthInSamples; }
+        int getNumLevels() const noexcept           { return levels.size(); }
+        int64 getNumPeaks (int level) const noexcept;
+        int64 getSamplesPerPeak (int level) const noexcept;
+
+        /** Fills mins and maxs with one value each per pixel covering a range of
+            samples. Values are between -1 and 1 and read from the coarsest level
+            that still has a peak per pixel. */
+        void getMinMax (int channel, int64 startSample, int64 endSample,
+                        float* mins, float* maxs, int numPixels) const noexcept;
+
+        /** Draws each channel in its own lane of an area */
+        void drawChannels (Graphics& g, const Rectangle<int>& area,
+                           int64 startSample, int64 endSample, float verticalZoom = 1.f) const;
+
+    private:
+        Peaks() = default;
+        struct Level { int64 offset; int64 numPeaks; };
+        std::unique_ptr<MemoryMappedFile> map;
+        int numChannels = 0;
+        double sampleRate = 0.0;
+        int64 lengthInSamples = 0;
+        Array<Level> levels;
+
+        const int8* getPeak (int level, int64 index) const noexcept;
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Peaks)
+    };
+
+    explicit PeakCache (const File& directory);
+    ~PeakCache();
+
+    /** Returns the directory cache files are written to */
+    const File& getDirectory() const noexcept { return directory; }
+
+    /** Returns the overview of a file if it has been built. Otherwise the
+        file is queued, nullptr is returned and peaksReady is emitted once it
+        is done. Message thread. */
+    Peaks::Ptr getPeaks (const File& audioFile);
+
+    /** Queues files to be scanned ahead of being shown. Files already cached
+        are skipped without being opened. */
+    void prefetch (const Array<File>& audioFiles);
+
+    /** Returns the number of files waiting to be scanned */
+    int getNumPending() const;
+
+    /** Returns the cache file used for an audio file as it is now */
+    File getCacheFileFor (const File& audioFile) const;
+
+    /** Decodes an audio file and writes its cache file. Called on the pool's
+        threads, public for offline tools. */
+    static Result build (AudioFormatReader& reader, const File& cacheFile,
+                         std::function<bool()> shouldExit = nullptr);
+
+    /** Emitted on the message thread when a queued file has been scanned */
+    Signal<void(const File&)> peaksReady;
+
+private:
+    class ScanJob;
+    File directory;
+    AudioFormatManager formats;
+    ThreadPool pool;
+
+    HashMap<String, Peaks::Ptr> open;
+    StringArray recent;
+
+    CriticalSection lock;
+    StringArray queued, failed;
+    Array<File> finished;
+
+    Peaks::Ptr findOpen (const String& key);
+    bool queue (const File& audioFile, const String& key);
+    void scanned (const File& audioFile, const String& key, bool ok);
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakCache)
+};
+
+}
@@ -18,12 +18,16 @@
 */
 
 #include "session/PluginManager.h"
+#include "session/PluginSearchIndex.h"
 #include "session/Node.h"
 #include "engine/nodes/BaseProcessor.h"
 #include "engine/nodes/AudioRouterNode.h"
 #include "engine/nodes/MidiChannelSplitterNode.h"
 #include "engine/nodes/MidiProgramMapNode.h"
+#include "engine/nodes/EnvelopeFollowerNode.h"
+#include "engine/nodes/LfoNode.h"
 #include "engine/nodes/MidiMonitorNode.h"
+#include "engine/nodes/MidiToControlNode.h"
 #include "DataPath.h"
 #include "Settings.h"
 
@@ -41,6 +45,7 @@
 namespace Element {
 
 static const char* pluginListKey() { return Settings::pluginListKey; }
+static const char* pluginUsageKey() { return Settings::pluginUsageKey; }
 /* noop. prevent OS error dialogs from child process */ 
 static void pluginScannerSlaveCrashHandler (void*) { }
 
@@ -534,16 +539,39 @@ private:
 
 // MARK: Plugin Manager
     
-class PluginManager::Private : public PluginScanner::Listener
+class PluginManager::Private : public PluginScanner::Listener,
+                               public ChangeListener
 {
 public:
 	Private (PluginManager& o)
         : owner(o)
 	{
 		deadAudioPlugins = DataPath::applicationDataDir().getChildFile(EL_DEAD_AUDIO_PLUGINS_FILENAME);
+        allPlugins.addChangeListener (this);
 	}
 
-	~Private() {  }
+	~Private()
+    {
+        allPlugins.removeChangeListener (this);
+    }
+
+    PluginSearchIndex& getSearchIndex()
+    {
+        // change messages are async, so the count catches additions and
+        // removals made before this listener has been called
+        if (searchIndexDirty || searchIndex.size() != allPlugins.getNumTypes())
+        {
+            searchIndex.sync (allPlugins);
+            searchIndexDirty = false;
+        }
+
+        return searchIndex;
+    }
+
+    void changeListenerCallback (ChangeBroadcaster*) override
+    {
+        searchIndexDirty = true;
+    }
 
 	/** returns true if anything changed in the plugin list */
 	bool updateBlacklistedAudioPlugins()
@@ -578,6 +606,8 @@ private:
 	KnownPluginList allPlugins;
 	File deadAudioPlugins;
     UnverifiedPlugins unverified;
+    PluginSearchIndex searchIndex;
+    bool searchIndexDirty = true;
 	double sampleRate = 44100.0;
 	int    blockSize = 512;
 	ScopedPointer<PluginScanner> scanner;
@@ -707,8 +737,11 @@ bool PluginManager::isScanningAudioPlugins()
 
 AudioPluginInstance* PluginManager::createAudioPlugin (const PluginDescription& desc, String& errorMsg)
 {
-    return getAudioPluginFormats().createPluginInstance (
+    auto* instance = getAudioPluginFormats().createPluginInstance (
         desc, priv->sampleRate, priv->blockSize, errorMsg).release();
+    if (instance != nullptr)
+        priv->searchIndex.recordUsage (desc.createIdentifierString());
+    return instance;
 }
 
 Processor* PluginManager::createPlugin (const PluginDescription &desc, String &errorMsg)
@@ -727,25 +760,45 @@ GraphNode* PluginManager::createGraphNode (const PluginDescription& desc, String
         return nullptr;
     }
 
+    GraphNode* node = nullptr;
+
    #if defined (EL_PRO) || defined (EL_SOLO)
     if (desc.fileOrIdentifier == EL_INTERNAL_ID_MIDI_CHANNEL_SPLITTER)
     {
-        return new MidiChannelSplitterNode();
+        node = new MidiChannelSplitterNode();
     }
     else if (desc.fileOrIdentifier == EL_INTERNAL_ID_MIDI_PROGRAM_MAP)
     {
-        return new MidiProgramMapNode();
+        node = new MidiProgramMapNode();
     }
     else if (desc.fileOrIdentifier == EL_INTERNAL_ID_MIDI_MONITOR)
     {
-        return new MidiMonitorNode();
+        node = new MidiMonitorNode();
     }
     else if (desc.fileOrIdentifier == EL_INTERNAL_ID_AUDIO_ROUTER)
     {
-        return new AudioRouterNode();
+        node = new AudioRouterNode();
+    }
+    else if (desc.fileOrIdentifier == EL_INTERNAL_ID_LFO)
+    {
+        node = new LfoNode();
+    }
+    else if (desc.fileOrIdentifier == EL_INTERNAL_ID_ENVELOPE_FOLLOWER)
+    {
+        node = new EnvelopeFollowerNode();
+    }
+    else if (desc.fileOrIdentifier == EL_INTERNAL_ID_MIDI_TO_CONTROL)
+    {
+        node = new MidiToControlNode();
     }
    #endif
 
+    if (node != nullptr)
+    {
+        priv->searchIndex.recordUsage (desc.createIdentifierString());
+        return node;
+    }
+
     errorMsg = desc.name;
     errorMsg << " not found.";
     return nullptr;
@@ -771,22 +824,25 @@ AudioPluginFormat* PluginManager::getAudioPluginFormat (const String& name) cons
 
 KnownPluginList& PluginManager::getKnownPlugins() { return priv->allPlugins; }
 const KnownPluginList& PluginManager::getKnownPlugins() const { return priv->allPlugins; }
+PluginSearchIndex& PluginManager::getSearchIndex() { return priv->getSearchIndex(); }
 const File& PluginManager::getDeadAudioPluginsFile() const { return priv->deadAudioPlugins; }
 
-void PluginManager::saveUserPlugins (ApplicationProperties& settings)
+void PluginManager::saveUserPlugins (Settings& settings)
 {
     setPropertiesFile (settings.getUserSettings());
     if (auto elm = priv->allPlugins.createXml())
-    {
         props->setValue (pluginListKey(), elm.get());
-        props->saveIfNeeded();
-    }
+    if (auto usage = priv->searchIndex.getUsageState().createXml())
+        props->setValue (pluginUsageKey(), usage.get());
+    settings.saveIfNeeded();
 }
 
-void PluginManager::restoreUserPlugins (ApplicationProperties& settings)
+void PluginManager::restoreUserPlugins (Settings& settings)
 {
     setPropertiesFile (settings.getUserSettings());
     if (props == nullptr) return;
+    if (auto usage = props->getXmlValue (pluginUsageKey()))
+        priv->searchIndex.setUsageState (ValueTree::fromXml (*usage));
     if (auto xml = props->getXmlValue (pluginListKey()))
 		restoreUserPlugins (*xml);
     settings.saveIfNeeded();
@@ -797,14 +853,13 @@ void PluginManager::restoreUserPlugins (const XmlElement& xml)
 	priv->allPlugins.recreateFromXml (xml);
     scanInternalPlugins();
     priv->updateBlacklistedAudioPlugins();
+    priv->searchIndexDirty = true;
     if (props == nullptr)
         return;
 
+    // Settings writes the change behind
     if (auto e = priv->allPlugins.createXml())
-    {
         props->setValue (pluginListKey(), e.get());
-        props->saveIfNeeded();
-    }
 }
 
 void PluginManager::setPlayConfig (double sampleRate, int blockSize)
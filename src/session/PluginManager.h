@@ -28,7 +28,9 @@ namespace Element {
 class GraphNode;
 class Node;
 class PluginScannerMaster;
+class PluginSearchIndex;
 class PluginScanner;
+class Settings;
 
 class PluginManager : public ChangeBroadcaster
 {
@@ -49,6 +51,10 @@ public:
     KnownPluginList& getKnownPlugins();
     const KnownPluginList& getKnownPlugins() const;
 
+    /** Returns the search index for the known plugins, updated to reflect
+        any changes made to the list since it was last accessed */
+    PluginSearchIndex& getSearchIndex();
+
     /** Scan/Add a description to the known plugins */
     void addToKnownPlugins (const PluginDescription& desc);
 
@@ -92,11 +98,11 @@ public:
     void scanInternalPlugins();
     
     /** Save the known plugins to user settings */
-    void saveUserPlugins (ApplicationProperties&);
+    void saveUserPlugins (Settings&);
     
     /** Restore user plugins. Will also scan internal plugins so they don't get removed
         by accident */
-    void restoreUserPlugins (ApplicationProperties&);
+    void restoreUserPlugins (Settings&);
 
     /** Restore user plugins. Will also scan internal plugins so they don't get removed
         by accident */
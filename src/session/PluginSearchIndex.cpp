@@ -0,0 +1,378 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "session/PluginSearchIndex.h"
+
+namespace Element {
+
+static void tokenize (const String& text, StringArray& tokens)
+{
+    auto p = text.getCharPointer();
+    String token;
+
+    while (! p.isEmpty())
+    {
+        const juce_wchar c = p.getAndAdvance();
+        if (CharacterFunctions::isLetterOrDigit (c))
+        {
+            token << c;
+        }
+        else if (token.isNotEmpty())
+        {
+            tokens.add (token);
+            token.clear();
+        }
+    }
+
+    if (token.isNotEmpty())
+        tokens.add (token);
+}
+
+static void intersect (Array<int>& a, const Array<int>& b)
+{
+    // both arrays are sorted ascending
+    int w = 0, i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        const int x = a.getUnchecked (i), y = b.getUnchecked (j);
+        if (x < y)          { ++i; }
+        else if (y < x)     { ++j; }
+        else                { a.setUnchecked (w++, x); ++i; ++j; }
+    }
+
+    a.removeRange (w, a.size() - w);
+}
+
+PluginSearchIndex::PluginSearchIndex() { }
+PluginSearchIndex::~PluginSearchIndex() { }
+
+uint64 PluginSearchIndex::makeTrigram (juce_wchar a, juce_wchar b, juce_wchar c) noexcept
+{
+    const uint64 mask = 0x1fffff;
+    return ((static_cast<uint64> (a) & mask) << 42)
+         | ((static_cast<uint64> (b) & mask) << 21)
+         |  (static_cast<uint64> (c) & mask);
+}
+
+void PluginSearchIndex::clear()
+{
+    entries.clearQuick (true);
+    identifiers.clear();
+    words.clearQuick();
+    trigrams.clear();
+    numRemoved = 0;
+}
+
+void PluginSearchIndex::sync (const KnownPluginList& list)
+{
+    const auto types = list.getTypes();
+    HashMap<String, int> present;
+    bool changed = false;
+
+    for (const auto& type : types)
+    {
+        const auto identifier = type.createIdentifierString();
+        present.set (identifier, 1);
+        if (! identifiers.contains (identifier))
+        {
+            add (type);
+            changed = true;
+        }
+        else if (entries.getUnchecked (identifiers [identifier])->hash != hashDescription (type))
+        {
+            // a rescan can change everything but what the identifier is made of
+            remove (identifiers [identifier]);
+            add (type);
+            changed = true;
+        }
+    }
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        auto* const entry = entries.getUnchecked (i);
+        if (! entry->removed && ! present.contains (entry->identifier))
+        {
+            remove (i);
+            changed = true;
+        }
+    }
+
+    if (! changed)
+        return;
+
+    // tombstones are only compacted once they outnumber live entries
+    if (numRemoved > size())
+        rebuild();
+    else
+        words.sort (WordSorter());
+}
+
+int64 PluginSearchIndex::hashDescription (const PluginDescription& desc)
+{
+    return StringArray ({ desc.name, desc.descriptiveName, desc.manufacturerName,
+                          desc.category, desc.pluginFormatName, desc.version,
+                          desc.fileOrIdentifier, String (desc.uid),
+                          String ((int) desc.isInstrument), String ((int) desc.hasSharedContainer),
+                          String (desc.numInputChannels), String (desc.numOutputChannels),
+                          String (desc.lastFileModTime.toMilliseconds()) })
+        .joinIntoString ("\n").hashCode64();
+}
+
+void PluginSearchIndex::add (const PluginDescription& desc)
+{
+    const int index = entries.size();
+    auto* const entry = entries.add (new Entry());
+    entry->description  = desc;
+    entry->identifier   = desc.createIdentifierString();
+    entry->name         = desc.name.toLowerCase();
+    entry->haystack     = StringArray ({ desc.name, desc.manufacturerName, desc.category,
+                                         desc.pluginFormatName }).joinIntoString (" ").toLowerCase();
+    entry->hash         = hashDescription (desc);
+    entry->usage        = usage.contains (entry->identifier) ? usage [entry->identifier] : 0;
+    identifiers.set (entry->identifier, index);
+
+    StringArray tokens;
+    tokenize (entry->haystack, tokens);
+    tokens.removeDuplicates (false);
+
+    for (const auto& token : tokens)
+    {
+        words.add ({ token, index });
+
+        auto p = token.getCharPointer();
+        for (int i = 2; i < token.length(); ++i)
+        {
+            auto& postings = trigrams [makeTrigram (p[i - 2], p[i - 1], p[i])];
+            // entries are only appended, so postings stay sorted
+            if (postings.isEmpty() || postings.getLast() != index)
+                postings.add (index);
+        }
+    }
+}
+
+void PluginSearchIndex::remove (int index)
+{
+    auto* const entry = entries.getUnchecked (index);
+    entry->removed = true;
+    identifiers.remove (entry->identifier);
+    ++numRemoved;
+}
+
+void PluginSearchIndex::rebuild()
+{
+    Array<PluginDescription> live;
+    for (const auto* entry : entries)
+        if (! entry->removed)
+            live.add (entry->description);
+
+    clear();
+    for (const auto& desc : live)
+        add (desc);
+    words.sort (WordSorter());
+}
+
+const PluginDescription* PluginSearchIndex::getDescription (int index) const
+{
+    if (auto* const entry = entries [index])
+        return entry->removed ? nullptr : &entry->description;
+    return nullptr;
+}
+
+void PluginSearchIndex::matchPrefix (const String& token, Array<int>& matches) const
+{
+    int start = 0, end = words.size();
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
+        if (words.getReference (mid).text.compare (token) < 0)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    for (int i = start; i < words.size(); ++i)
+    {
+        const auto& word = words.getReference (i);
+        if (! word.text.startsWith (token))
+            break;
+        matches.add (word.entry);
+    }
+
+    matches.sort();
+    for (int i = matches.size(); --i > 0;)
+        if (matches.getUnchecked (i) == matches.getUnchecked (i - 1))
+            matches.remove (i);
+}
+
+void PluginSearchIndex::matchTrigrams (const String& token, Array<int>& matches) const
+{
+    auto p = token.getCharPointer();
+    bool first = true;
+
+    for (int i = 2; i < token.length(); ++i)
+    {
+        const auto iter = trigrams.find (makeTrigram (p[i - 2], p[i - 1], p[i]));
+        if (iter == trigrams.end())
+        {
+            matches.clearQuick();
+            return;
+        }
+
+        if (first)
+            matches.addArray (iter->second);
+        else
+            intersect (matches, iter->second);
+
+        first = false;
+        if (matches.isEmpty())
+            return;
+    }
+
+    // trigrams can match out of order, confirm the substring
+    for (int i = matches.size(); --i >= 0;)
+        if (! entries.getUnchecked (matches.getUnchecked (i))->haystack.contains (token))
+            matches.remove (i);
+}
+
+int PluginSearchIndex::getMatchQuality (const Entry& entry, const String& query) const
+{
+    if (entry.name.startsWith (query))
+        return 0;
+    if (entry.name.contains (query))
+        return 1;
+    return 2;
+}
+
+void PluginSearchIndex::search (const String& text, Array<int>& results) const
+{
+    results.clearQuick();
+    const auto query = text.trim().toLowerCase();
+    StringArray tokens;
+    tokenize (query, tokens);
+
+    if (tokens.isEmpty())
+    {
+        for (int i = 0; i < entries.size(); ++i)
+            if (! entries.getUnchecked(i)->removed)
+                results.add (i);
+    }
+    else
+    {
+        Array<int> matches;
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            matches.clearQuick();
+            const auto& token = tokens.getReference (i);
+            if (token.length() < 3)
+                matchPrefix (token, matches);
+            else
+                matchTrigrams (token, matches);
+
+            if (i == 0)
+                results.swapWith (matches);
+            else
+                intersect (results, matches);
+
+            if (results.isEmpty())
+                return;
+        }
+
+        for (int i = results.size(); --i >= 0;)
+            if (entries.getUnchecked (results.getUnchecked (i))->removed)
+                results.remove (i);
+    }
+
+    struct Ranking
+    {
+        Ranking (const PluginSearchIndex& i, const String& q)
+            : index (i), query (q) { }
+
+        int compareElements (int a, int b) const
+        {
+            const auto& ea = *index.entries.getUnchecked (a);
+            const auto& eb = *index.entries.getUnchecked (b);
+
+            if (query.isNotEmpty())
+            {
+                const int qa = index.getMatchQuality (ea, query);
+                const int qb = index.getMatchQuality (eb, query);
+                if (qa != qb)
+                    return qa - qb;
+            }
+
+            if (ea.usage != eb.usage)
+                return eb.usage - ea.usage;
+
+            const int result = ea.name.compare (eb.name);
+            return result != 0 ? result : a - b;
+        }
+
+        const PluginSearchIndex& index;
+        const String& query;
+    };
+
+    Ranking ranking (*this, query);
+    results.sort (ranking);
+}
+
+void PluginSearchIndex::recordUsage (const String& identifier)
+{
+    if (identifier.isEmpty())
+        return;
+
+    const int count = getUsageCount (identifier) + 1;
+    usage.set (identifier, count);
+    if (identifiers.contains (identifier))
+        entries.getUnchecked (identifiers [identifier])->usage = count;
+}
+
+int PluginSearchIndex::getUsageCount (const String& identifier) const
+{
+    return usage.contains (identifier) ? usage [identifier] : 0;
+}
+
+ValueTree PluginSearchIndex::getUsageState() const
+{
+    ValueTree state ("pluginUsage");
+    for (HashMap<String, int>::Iterator iter (usage); iter.next();)
+    {
+        ValueTree plugin ("plugin");
+        plugin.setProperty ("identifier", iter.getKey(), nullptr)
+              .setProperty ("count", iter.getValue(), nullptr);
+        state.appendChild (plugin, nullptr);
+    }
+    return state;
+}
+
+void PluginSearchIndex::setUsageState (const ValueTree& state)
+{
+    usage.clear();
+    for (int i = 0; i < state.getNumChildren(); ++i)
+    {
+        const auto plugin = state.getChild (i);
+        const String identifier = plugin.getProperty ("identifier").toString();
+        if (identifier.isNotEmpty())
+            usage.set (identifier, (int) plugin.getProperty ("count", 0));
+    }
+
+    for (auto* entry : entries)
+        entry->usage = getUsageCount (entry->identifier);
+}
+
+}
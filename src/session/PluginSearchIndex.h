@@ -0,0 +1,120 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#pragma once
+
+#include "ElementApp.h"
+#include <unordered_map>
+
+namespace Element {
+
+/** An in-memory search index over a KnownPluginList.
+
+    Names, manufacturers, categories and format names are indexed by word
+    prefix (for short queries) and by trigram (for everything else). The index
+    is kept in step with the known list incrementally by sync(), which only
+    touches descriptions that were added, removed or changed since the last
+    call.
+
+    Results are ranked by match quality, then by how often a plugin has been
+    instantiated, then by name.
+ */
+class PluginSearchIndex
+{
+public:
+    PluginSearchIndex();
+    ~PluginSearchIndex();
+
+    /** Brings the index in line with the list. Only added and removed types
+        are processed, and types whose description changed on a rescan. */
+    void sync (const KnownPluginList& list);
+
+    /** Removes everything from the index, usage counts are kept */
+    void clear();
+
+    /** Returns the number of searchable descriptions */
+    int size() const { return entries.size() - numRemoved; }
+
+    /** Returns the description for an entry returned by search() */
+    const PluginDescription* getDescription (int entry) const;
+
+    /** Fills results with matching entries, best first. An empty query
+        returns every plugin. */
+    void search (const String& query, Array<int>& results) const;
+
+    /** Call when a plugin is instantiated so it ranks higher in results */
+    void recordUsage (const String& identifierString);
+
+    /** Returns the number of times a plugin has been used */
+    int getUsageCount (const String& identifierString) const;
+
+    /** Usage counts for saving to settings */
+    ValueTree getUsageState() const;
+
+    /** Restore usage counts from settings */
+    void setUsageState (const ValueTree& state);
+
+private:
+    struct Entry
+    {
+        PluginDescription description;
+        String identifier;
+        String name;
+        String haystack;
+        int64 hash = 0;
+        int usage = 0;
+        bool removed = false;
+    };
+
+    struct Word
+    {
+        String text;
+        int entry;
+    };
+
+    struct WordSorter
+    {
+        static int compareElements (const Word& a, const Word& b)
+        {
+            const int result = a.text.compare (b.text);
+            return result != 0 ? result : a.entry - b.entry;
+        }
+    };
+
+    OwnedArray<Entry> entries;
+    HashMap<String, int> identifiers;
+    HashMap<String, int> usage;
+    Array<Word> words;
+    std::unordered_map<uint64, Array<int>> trigrams;
+    int numRemoved = 0;
+
+    static int64 hashDescription (const PluginDescription& desc);
+    void add (const PluginDescription& desc);
+    void remove (int entry);
+    void rebuild();
+    void matchPrefix (const String& token, Array<int>& matches) const;
+    void matchTrigrams (const String& token, Array<int>& matches) const;
+    int getMatchQuality (const Entry& entry, const String& query) const;
+
+    static uint64 makeTrigram (juce_wchar a, juce_wchar b, juce_wchar c) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginSearchIndex)
+};
+
+}
@@ -28,18 +28,10 @@
 
 namespace Element {
 
-    static Node findNodeRecursive (const Node& start, const Uuid& uuid)
+    static String getIndexKey (const var& uuid)
     {
-        if (! uuid.isNull() && uuid == start.getUuid())
-            return start;
-
-        for (int i = start.getNumNodes(); --i >= 0;)
-        {
-            const auto node = findNodeRecursive (start.getNode(i), uuid);
-            if (node.isValid()) return node;
-        }
-
-        return Node();
+        const Uuid id (uuid.toString());
+        return id.isNull() ? String() : id.toString();
     }
 
     class Session::Private
@@ -50,9 +42,67 @@ namespace Element {
         { }
 
         ~Private() { }
+
+        void invalidate()
+        {
+            nodesDirty = mapsDirty = true;
+        }
+
+        ValueTree findNode (const String& key)
+        {
+            if (nodesDirty)
+            {
+                nodes.clear();
+                // same order the old recursive search used, so the first
+                // match still wins when uuids collide
+                for (int i = session.getNumGraphs(); --i >= 0;)
+                    indexNodes (session.getGraphValueTree (i));
+                nodesDirty = false;
+            }
+
+            return key.isNotEmpty() && nodes.contains (key) ? nodes[key] : ValueTree();
+        }
+
+        Array<ValueTree> findMaps (const String& key)
+        {
+            if (mapsDirty)
+            {
+                maps.clear();
+                const auto data = session.getControllerMapsValueTree();
+                for (int i = 0; i < data.getNumChildren(); ++i)
+                {
+                    const auto map = data.getChild (i);
+                    const auto node = getIndexKey (map.getProperty (Tags::node));
+                    if (node.isEmpty())
+                        continue;
+                    auto list = maps[node];
+                    list.add (map);
+                    maps.set (node, list);
+                }
+                mapsDirty = false;
+            }
+
+            return maps[key];
+        }
+
     private:
         friend class Session;
         Session&                     session;
+        HashMap<String, ValueTree>   nodes;
+        HashMap<String, Array<ValueTree>> maps;
+        bool nodesDirty = true;
+        bool mapsDirty = true;
+
+        void indexNodes (const ValueTree& node)
+        {
+            const auto key = getIndexKey (node.getProperty (Tags::uuid));
+            if (key.isNotEmpty() && ! nodes.contains (key))
+                nodes.set (key, node);
+
+            const auto children = node.getChildWithName (Tags::nodes);
+            for (int i = children.getNumChildren(); --i >= 0;)
+                indexNodes (children.getChild (i));
+        }
     };
 
     Session::Session()
@@ -103,6 +153,8 @@ namespace Element {
     void Session::clear()
     {
         setMissingProperties (true);
+        if (priv != nullptr)
+            priv->invalidate();
     }
 
     bool Session::loadData (const ValueTree &data)
@@ -113,6 +165,7 @@ namespace Element {
         objectData = data;
         setMissingProperties();
         objectData.addListener (this);
+        priv->invalidate();
         return true;
     }
 
@@ -149,15 +202,18 @@ namespace Element {
 
     Node Session::findNodeById (const Uuid& uuid)
     {
-        Node node;
-
-        for (int i = getNumGraphs(); --i >= 0;)
-        {
-            node = findNodeRecursive (getGraph (i), uuid);
-            if (node.isValid()) break;
-        }
+        if (uuid.isNull())
+            return Node();
+        const auto data = priv->findNode (uuid.toString());
+        return data.isValid() ? Node (data, false) : Node();
+    }
 
-        return node;
+    Array<ControllerMap> Session::findControllerMaps (const Node& node)
+    {
+        Array<ControllerMap> result;
+        for (const auto& map : priv->findMaps (getIndexKey (node.getUuidString())))
+            result.add (ControllerMap (map));
+        return result;
     }
 
     ControllerDevice Session::findControllerDeviceById (const Uuid& uuid)
@@ -182,6 +238,11 @@ namespace Element {
     
     void Session::valueTreePropertyChanged (ValueTree& tree, const Identifier& property)
     {
+        if (property == Tags::uuid)
+            priv->nodesDirty = true;
+        if (tree.hasType (Tags::map))
+            priv->mapsDirty = true;
+
         if (property == Tags::object ||
             (tree.hasType(Tags::node) && property == Tags::state))
         {
@@ -197,6 +258,8 @@ namespace Element {
 
     void Session::valueTreeChildAdded (ValueTree& parent, ValueTree& child)
     {
+        indexChanged (parent, child);
+
         // controller device added
         if (parent.getParent() == objectData && 
             parent.hasType (Tags::controllers) && 
@@ -221,6 +284,8 @@ namespace Element {
 
     void Session::valueTreeChildRemoved (ValueTree& parent, ValueTree& child, int)
     {
+        indexChanged (parent, child);
+
         // controller device removed
         if (parent.getParent() == objectData && 
             parent.hasType (Tags::controllers) && 
@@ -245,7 +310,15 @@ namespace Element {
 
     void Session::valueTreeChildOrderChanged (ValueTree& parent, int, int) {  }
     void Session::valueTreeParentChanged (ValueTree& tree) { }
-    void Session::valueTreeRedirected (ValueTree& tree) { }
+    void Session::valueTreeRedirected (ValueTree& tree) { priv->invalidate(); }
+
+    void Session::indexChanged (const ValueTree& parent, const ValueTree& child)
+    {
+        if (child.hasType (Tags::node) || child.hasType (Tags::nodes) || child.hasType (Tags::graphs))
+            priv->nodesDirty = true;
+        if (parent.hasType (Tags::maps) || child.hasType (Tags::maps))
+            priv->mapsDirty = true;
+    }
     
     void Session::saveGraphState()
     {
@@ -107,6 +107,10 @@ namespace Element {
         Node findNodeById (const Uuid&);
         ControllerDevice findControllerDeviceById (const Uuid&);
 
+        /** Returns the controller maps targeting a node. Lookups by uuid are
+            indexed and the indexes rebuilt lazily after the session changes. */
+        Array<ControllerMap> findControllerMaps (const Node& node);
+
         void cleanOrphanControllerMaps();
 
         typedef std::function<void(const ValueTree& tree)> ValueTreeFunction;
@@ -145,6 +149,7 @@ namespace Element {
         class Private;
         ScopedPointer<Private> priv;
         void setMissingProperties (bool resetExisting = false);
+        void indexChanged (const ValueTree& parent, const ValueTree& child);
         
         inline ValueTree getGraphsValueTree()                   const { return objectData.getChildWithName (Tags::graphs); }
         inline ValueTree getGraphValueTree (const int index)    const { return getGraphsValueTree().getChild(index); }
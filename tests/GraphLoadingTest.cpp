@@ -0,0 +1,88 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+#include "controllers/GraphManager.h"
+
+namespace Element {
+
+class GraphLoadingTest : public UnitTestBase
+{
+public:
+    GraphLoadingTest() : UnitTestBase ("Graph Loading", "controllers", "graphLoading") { }
+    virtual ~GraphLoadingTest() { }
+
+    void initialise() override
+    {
+        initializeWorld();
+    }
+
+    void shutdown() override
+    {
+        shutdownWorld();
+    }
+
+    void runTest() override
+    {
+        GraphProcessor graph;
+        graph.prepareToPlay (44100.0, 512);
+        GraphManager controller (graph, getWorld().getPluginManager());
+        const Node model (Node::createDefaultGraph ("Loading"));
+        const int numNodes = model.getNumNodes();
+
+        beginTest ("one node at a time");
+        controller.beginLoading (model);
+        expect (! controller.isLoaded());
+        int steps = 1;
+        while (controller.loadNextNode())
+            ++steps;
+        expectEquals (steps, numNodes);
+        expectEquals (controller.getNumNodesLoaded(), numNodes);
+        expectEquals (graph.getNumNodes(), numNodes);
+        controller.finishLoading();
+        expect (controller.isLoaded());
+        expectEquals (model.getArcsValueTree().getNumChildren(), graph.getNumConnections());
+
+        beginTest ("finish early");
+        controller.beginLoading (model);
+        controller.loadNextNode();
+        controller.finishLoading();
+        expect (controller.isLoaded());
+        expectEquals (graph.getNumNodes(), numNodes);
+
+        beginTest ("state writer");
+        runDispatchLoop (20);
+        Node saved (model.getValueTree().createCopy(), false);
+        saved.savePluginState();
+        Node written (model.getValueTree().createCopy(), false);
+        written.savePluginState ([](ValueTree& data, const Identifier& property, MemoryBlock& state)
+        {
+            data.setProperty (property, state.toBase64Encoding(), nullptr);
+        });
+        expect (saved.getValueTree().isEquivalentTo (written.getValueTree()));
+
+        controller.clear();
+        graph.releaseResources();
+    }
+};
+
+static GraphLoadingTest sGraphLoadingTest;
+
+}
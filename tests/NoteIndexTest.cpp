@@ -0,0 +1,133 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "gui/NoteIndex.h"
+
+namespace Element {
+
+class NoteIndexTest : public UnitTestBase
+{
+public:
+    NoteIndexTest() : UnitTestBase ("Note Index", "gui", "noteIndex") { }
+    virtual ~NoteIndexTest() { }
+
+    void runTest() override
+    {
+        testQuery();
+        testHitTest();
+        testRefresh();
+        testSelection();
+    }
+
+private:
+    void testQuery()
+    {
+        beginTest ("query");
+        NoteIndex index;
+        for (int i = 0; i < 100; ++i)
+            index.add (Note::make (60, i * 100.0, 50.0));
+        index.add (Note::make (60, 0.0, 5000.0));
+        index.add (Note::make (64, 250.0, 10.0));
+        expect (index.size() == 102);
+
+        Array<int> ids;
+        index.query ({ 1000.0, 1200.0 }, 60, 60, ids);
+        // two notes start in range plus the long note from the start
+        expectEquals (ids.size(), 3);
+
+        ids.clearQuick();
+        index.query ({ 200.0, 300.0 }, 0, 127, ids);
+        expectEquals (ids.size(), 3);
+
+        ids.clearQuick();
+        index.query ({ 6000.0, 7000.0 }, 61, 63, ids);
+        expect (ids.isEmpty());
+    }
+
+    void testHitTest()
+    {
+        beginTest ("hit test");
+        NoteIndex index;
+        const int a = index.add (Note::make (60, 0.0, 100.0));
+        const int b = index.add (Note::make (60, 50.0, 100.0));
+        expect (index.hitTest (10.0, 60) == a);
+        expect (index.hitTest (75.0, 60) == b);
+        expect (index.hitTest (120.0, 60) == b);
+        expect (index.hitTest (200.0, 60) < 0);
+        expect (index.hitTest (10.0, 61) < 0);
+    }
+
+    void testRefresh()
+    {
+        beginTest ("refresh and remove");
+        NoteIndex index;
+        Note note (Note::make (60, 0.0, 100.0));
+        const int id = index.add (note);
+        expect (index.find (note) == id);
+
+        Note::EditDeltas deltas;
+        note.move (deltas, 400.0);
+        note.changeKeyId (deltas, 72);
+        note.applyEdits (deltas);
+        index.refresh (id);
+
+        expect (index.hitTest (10.0, 60) < 0);
+        expect (index.hitTest (450.0, 72) == id);
+        expect (index.find (note) == id);
+
+        index.remove (id);
+        expect (index.size() == 0);
+        expect (index.hitTest (450.0, 72) < 0);
+        expect (! index.contains (id));
+    }
+
+    void testSelection()
+    {
+        beginTest ("selection");
+        NoteIndex index;
+        Array<int> ids;
+        for (int i = 0; i < 10; ++i)
+            ids.add (index.add (Note::make (40 + i, i * 10.0, 10.0)));
+
+        for (const int id : ids)
+            index.setSelected (id, true);
+        expectEquals (index.getNumSelected(), 10);
+
+        index.setSelected (ids[3], false);
+        index.setSelected (ids[0], false);
+        index.setSelected (ids[0], false);
+        expectEquals (index.getNumSelected(), 8);
+        expect (! index.isSelected (ids[3]));
+        expect (index.isSelected (ids[9]));
+
+        index.remove (ids[9]);
+        expectEquals (index.getNumSelected(), 7);
+        for (const int id : index.getSelectedIds())
+            expect (index.isSelected (id));
+
+        index.deselectAll();
+        expectEquals (index.getNumSelected(), 0);
+        expect (! index.isSelected (ids[5]));
+    }
+};
+
+static NoteIndexTest sNoteIndexTest;
+
+}
@@ -0,0 +1,166 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+#include "session/PeakCache.h"
+
+namespace Element {
+
+class PeakCacheTest : public UnitTestBase
+{
+public:
+    PeakCacheTest() : UnitTestBase ("Peak Cache", "session", "peakCache") { }
+    virtual ~PeakCacheTest() { }
+
+    void initialise() override
+    {
+        directory = File::getSpecialLocation (File::tempDirectory)
+            .getNonexistentChildFile ("PeakCacheTest", String());
+        directory.createDirectory();
+        audioFile = directory.getChildFile ("ramp.wav");
+        writeRamp (audioFile, 100000);
+    }
+
+    void shutdown() override
+    {
+        directory.deleteRecursively();
+    }
+
+    void runTest() override
+    {
+        testBuild();
+        testCache();
+    }
+
+private:
+    File directory, audioFile;
+
+    // left channel ramps from -1 to 1, right channel is silent
+    static void writeRamp (const File& file, int numSamples)
+    {
+        AudioSampleBuffer buffer (2, numSamples);
+        buffer.clear();
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (0, i, -1.f + 2.f * (float) i / (float) (numSamples - 1));
+
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (
+            new FileOutputStream (file), 44100.0, 2, 24, {}, 0));
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    void testBuild()
+    {
+        beginTest ("build");
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader (wav.createReaderFor (new FileInputStream (audioFile), true));
+        expect (reader != nullptr);
+        if (reader == nullptr)
+            return;
+
+        const auto cacheFile = directory.getChildFile ("ramp.peaks");
+        expect (PeakCache::build (*reader, cacheFile).wasOk());
+        auto peaks = PeakCache::Peaks::open (cacheFile);
+        expect (peaks != nullptr);
+        if (peaks == nullptr)
+            return;
+
+        expectEquals (peaks->getNumChannels(), 2);
+        expectEquals (peaks->getLengthInSamples(), (int64) 100000);
+        expectEquals (peaks->getNumPeaks (0), (int64) ((100000 + 255) / 256));
+        expect (peaks->getNumLevels() > 1);
+        expect (peaks->getNumPeaks (peaks->getNumLevels() - 1) <= (int64) PeakCache::minPeaksPerLevel);
+
+        beginTest ("min/max");
+        float mins[4], maxs[4];
+        peaks->getMinMax (0, 0, 100000, mins, maxs, 4);
+        expectWithinAbsoluteError (mins[0], -1.f, 0.02f);
+        expectWithinAbsoluteError (maxs[1], 0.f, 0.02f);
+        expectWithinAbsoluteError (maxs[3], 1.f, 0.02f);
+        for (int i = 0; i < 4; ++i)
+            expect (mins[i] <= maxs[i]);
+
+        // zoomed in reads the finest level
+        peaks->getMinMax (0, 50000, 50512, mins, maxs, 2);
+        expectWithinAbsoluteError (mins[0], 0.f, 0.02f);
+        expectWithinAbsoluteError (maxs[1], 0.f, 0.02f);
+
+        peaks->getMinMax (1, 0, 100000, mins, maxs, 4);
+        for (int i = 0; i < 4; ++i)
+            expect (mins[i] == 0.f && maxs[i] == 0.f);
+
+        beginTest ("invalid files");
+        const auto bad = directory.getChildFile ("bad.peaks");
+        bad.replaceWithText ("not peaks");
+        expect (PeakCache::Peaks::open (bad) == nullptr);
+    }
+
+    void testCache()
+    {
+        beginTest ("cache");
+        PeakCache cache (directory.getChildFile ("cache"));
+        int numReady = 0;
+        cache.peaksReady.connect ([&numReady](const File&) { ++numReady; });
+
+        expect (cache.getPeaks (audioFile) == nullptr);
+        expect (waitFor ([&]() { return numReady > 0; }));
+        expectEquals (cache.getNumPending(), 0);
+        expect (cache.getCacheFileFor (audioFile).existsAsFile());
+        auto peaks = cache.getPeaks (audioFile);
+        expect (peaks != nullptr);
+        expect (cache.getPeaks (audioFile) == peaks);
+
+        beginTest ("reuse");
+        {
+            // a new cache maps the file left by the last one
+            PeakCache second (cache.getDirectory());
+            second.prefetch (Array<File> ({ audioFile }));
+            expectEquals (second.getNumPending(), 0);
+            expect (second.getPeaks (audioFile) != nullptr);
+        }
+
+        beginTest ("changed file");
+        const auto oldCacheFile = cache.getCacheFileFor (audioFile);
+        writeRamp (audioFile, 5000);
+        audioFile.setLastModificationTime (Time::getCurrentTime() + RelativeTime::seconds (5.0));
+        expect (cache.getCacheFileFor (audioFile) != oldCacheFile);
+        numReady = 0;
+        expect (cache.getPeaks (audioFile) == nullptr);
+        expect (waitFor ([&]() { return numReady > 0; }));
+        peaks = cache.getPeaks (audioFile);
+        expect (peaks != nullptr && peaks->getLengthInSamples() == 5000);
+    }
+
+    bool waitFor (std::function<bool()> condition)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            if (condition())
+                return true;
+            runDispatchLoop (20);
+        }
+        return condition();
+    }
+};
+
+static PeakCacheTest sPeakCacheTest;
+
+}
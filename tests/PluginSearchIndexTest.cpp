@@ -0,0 +1,164 @@
+/*
+    This file is part of Element
+    Copyright (C) 2018-2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Tests.h"
+#include "Tests.h"
+#include "session/PluginSearchIndex.h"
+
+namespace Element {
+
+class PluginSearchIndexTest : public UnitTestBase
+{
+public:
+    PluginSearchIndexTest() : UnitTestBase ("Plugin Search Index", "plugins", "searchIndex") { }
+    virtual ~PluginSearchIndexTest() { }
+
+    void runTest() override
+    {
+        testSearch();
+        testIncrementalSync();
+        testUsageRanking();
+    }
+
+private:
+    static PluginDescription makeType (const String& name, const String& manufacturer,
+                                       const String& category, const String& format = "VST3")
+    {
+        PluginDescription desc;
+        desc.name               = name;
+        desc.descriptiveName    = name;
+        desc.manufacturerName   = manufacturer;
+        desc.category           = category;
+        desc.pluginFormatName   = format;
+        desc.fileOrIdentifier   = String ("/plugins/") + name;
+        desc.uid                = name.hashCode();
+        return desc;
+    }
+
+    static void fill (KnownPluginList& list)
+    {
+        list.addType (makeType ("Reverb Room", "Acme", "Effect"));
+        list.addType (makeType ("Plate Reverb", "Kushview", "Effect"));
+        list.addType (makeType ("Synth One", "Acme", "Synth"));
+        list.addType (makeType ("Compressor", "Dynamics Co", "Effect", "AudioUnit"));
+    }
+
+    StringArray names (const PluginSearchIndex& index, const Array<int>& results)
+    {
+        StringArray result;
+        for (const int entry : results)
+            if (auto* desc = index.getDescription (entry))
+                result.add (desc->name);
+        return result;
+    }
+
+    void testSearch()
+    {
+        beginTest ("search");
+        KnownPluginList list;
+        fill (list);
+        PluginSearchIndex index;
+        index.sync (list);
+        expect (index.size() == 4);
+
+        Array<int> results;
+        index.search ("reverb", results);
+        expect (names (index, results) == StringArray ({ "Reverb Room", "Plate Reverb" }));
+
+        index.search ("re", results);
+        expect (names (index, results).contains ("Plate Reverb"));
+        expect (! names (index, results).contains ("Compressor"));
+
+        index.search ("acme synth", results);
+        expect (names (index, results) == StringArray ({ "Synth One" }));
+
+        index.search ("verb", results);
+        expect (results.size() == 2);
+
+        index.search ("audiounit", results);
+        expect (names (index, results) == StringArray ({ "Compressor" }));
+
+        index.search ("nothing", results);
+        expect (results.isEmpty());
+
+        index.search (String(), results);
+        expect (names (index, results) == StringArray ({ "Compressor", "Plate Reverb", "Reverb Room", "Synth One" }));
+    }
+
+    void testIncrementalSync()
+    {
+        beginTest ("incremental sync");
+        KnownPluginList list;
+        fill (list);
+        PluginSearchIndex index;
+        index.sync (list);
+
+        Array<int> results;
+        list.removeType (makeType ("Plate Reverb", "Kushview", "Effect"));
+        index.sync (list);
+        expect (index.size() == 3);
+        index.search ("reverb", results);
+        expect (names (index, results) == StringArray ({ "Reverb Room" }));
+
+        list.addType (makeType ("Spring Reverb", "Kushview", "Effect"));
+        index.sync (list);
+        index.search ("reverb", results);
+        expect (names (index, results) == StringArray ({ "Reverb Room", "Spring Reverb" }));
+
+        // rescanned with a new vendor, the identifier stays the same
+        list.addType (makeType ("Reverb Room", "Newco", "Effect"));
+        index.sync (list);
+        expect (index.size() == 3);
+        index.search ("newco", results);
+        expect (names (index, results) == StringArray ({ "Reverb Room" }));
+        index.search ("acme", results);
+        expect (names (index, results) == StringArray ({ "Synth One" }));
+
+        list.clear();
+        index.sync (list);
+        expect (index.size() == 0);
+        index.search ("reverb", results);
+        expect (results.isEmpty());
+    }
+
+    void testUsageRanking()
+    {
+        beginTest ("usage ranking");
+        KnownPluginList list;
+        fill (list);
+        PluginSearchIndex index;
+        index.sync (list);
+
+        const auto plate = makeType ("Plate Reverb", "Kushview", "Effect").createIdentifierString();
+        index.recordUsage (plate);
+        index.recordUsage (plate);
+        expect (index.getUsageCount (plate) == 2);
+
+        Array<int> results;
+        index.search ("effect", results);
+        expect (names (index, results)[0] == "Plate Reverb");
+
+        PluginSearchIndex restored;
+        restored.setUsageState (index.getUsageState());
+        expect (restored.getUsageCount (plate) == 2);
+    }
+};
+
+static PluginSearchIndexTest sPluginSearchIndexTest;
+
+}
@@ -0,0 +1,103 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+
+namespace Element {
+
+class SessionIndexTest : public UnitTestBase
+{
+public:
+    SessionIndexTest() : UnitTestBase ("Session Index", "session", "sessionIndex") { }
+    virtual ~SessionIndexTest() { }
+
+    void initialise() override
+    {
+        globals.reset (new Globals());
+    }
+
+    void shutdown() override
+    {
+        globals.reset (nullptr);
+    }
+
+    void runTest() override
+    {
+        auto session = globals->getSession();
+        session->clear();
+
+        auto graph = Node::createGraph ("Graph");
+        const Node child (Tags::plugin);
+        const Node nested (Tags::plugin);
+        auto subgraph = Node::createGraph ("Sub");
+        subgraph.getNodesValueTree().addChild (nested.getValueTree(), -1, nullptr);
+        graph.getNodesValueTree().addChild (child.getValueTree(), -1, nullptr);
+        graph.getNodesValueTree().addChild (subgraph.getValueTree(), -1, nullptr);
+        session->addGraph (graph, true);
+
+        beginTest ("nodes");
+        expect (session->findNodeById (graph.getUuid()) == graph);
+        expect (session->findNodeById (nested.getUuid()) == nested);
+        expect (! session->findNodeById (Uuid()).isValid());
+
+        // indexes follow edits made after a lookup
+        const Node added (Tags::plugin);
+        subgraph.getNodesValueTree().addChild (added.getValueTree(), -1, nullptr);
+        expect (session->findNodeById (added.getUuid()) == added);
+        graph.getNodesValueTree().removeChild (subgraph.getValueTree(), nullptr);
+        expect (! session->findNodeById (nested.getUuid()).isValid());
+        expect (session->findNodeById (child.getUuid()) == child);
+
+        beginTest ("maps");
+        auto maps = session->getValueTree().getChildWithName (Tags::maps);
+        for (int i = 0; i < 64; ++i)
+        {
+            ValueTree map (Tags::map);
+            map.setProperty (Tags::node, (i % 2 == 0 ? child : graph).getUuidString(), nullptr)
+               .setProperty (Tags::parameter, i, nullptr);
+            maps.addChild (map, -1, nullptr);
+        }
+
+        expectEquals (session->findControllerMaps (child).size(), 32);
+        expectEquals (session->findControllerMaps (graph).size(), 32);
+        expectEquals (session->findControllerMaps (child).getFirst().getParameterIndex(), 0);
+        expect (session->findControllerMaps (added).isEmpty());
+
+        maps.getChild(0).setProperty (Tags::node, added.getUuidString(), nullptr);
+        expectEquals (session->findControllerMaps (child).size(), 31);
+        expectEquals (session->findControllerMaps (added).size(), 1);
+
+        beginTest ("orphans");
+        // no devices in this session, every map is an orphan
+        session->cleanOrphanControllerMaps();
+        expectEquals (session->getNumControllerMaps(), 0);
+        expect (session->findControllerMaps (child).isEmpty());
+
+        session->clear();
+        expect (! session->findNodeById (child.getUuid()).isValid());
+    }
+
+private:
+    std::unique_ptr<Globals> globals;
+};
+
+static SessionIndexTest sSessionIndexTest;
+
+}
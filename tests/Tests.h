@@ -90,6 +90,33 @@ protected:
         world.reset (nullptr);
     }
 
+    /** Sets up Globals with only Element's plugin format, for tests that run
+        graphs by hand. Call from initialise() and shutdownPlugins() from shutdown() */
+    void initializePlugins (double sampleRate = 44100.0, int blockSize = 512)
+    {
+        if (plugins) return;
+        plugins.reset (new Globals());
+        plugins->getPluginManager().addDefaultFormats();
+        plugins->getPluginManager().addFormat (new ElementAudioPluginFormat (*plugins));
+        plugins->getPluginManager().setPlayConfig (sampleRate, blockSize);
+    }
+
+    void shutdownPlugins()
+    {
+        plugins.reset (nullptr);
+    }
+
+    /** Creates one of Element's plugins, or nullptr if it couldn't be */
+    AudioProcessor* createPluginProcessor (const String& identifier = "element.volume.stereo")
+    {
+        initializePlugins();
+        PluginDescription desc;
+        desc.pluginFormatName = "Element";
+        desc.fileOrIdentifier = identifier;
+        String msg;
+        return plugins->getPluginManager().createAudioPlugin (desc, msg);
+    }
+
     const File getDataDir() const
     {
         const auto thedir = File::getSpecialLocation (File::invokedExecutableFile)
@@ -111,6 +138,7 @@ private:
     const String slug;
     std::unique_ptr<Globals> world;
     std::unique_ptr<AppController> app;
+    std::unique_ptr<Globals> plugins;
 };
 
 }
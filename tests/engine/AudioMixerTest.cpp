@@ -0,0 +1,161 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+#include "engine/nodes/AudioMixerProcessor.h"
+
+namespace Element {
+
+class AudioMixerTest : public UnitTestBase
+{
+public:
+    AudioMixerTest() : UnitTestBase ("Audio Mixer", "engine", "audioMixer") { }
+    virtual ~AudioMixerTest() { }
+
+    void runTest() override
+    {
+        testRouting();
+        testState();
+        testScale();
+    }
+
+private:
+    enum { blockSize = 256 };
+
+    /** Feeds a constant into track 0 for two blocks, returns the output of the last */
+    static void render (AudioMixerProcessor& mixer, AudioSampleBuffer& audio, float value = 0.5f)
+    {
+        MidiBuffer midi;
+        for (int i = 0; i < 2; ++i)
+        {
+            audio.clear();
+            for (int c = 0; c < 2; ++c)
+                FloatVectorOperations::fill (audio.getWritePointer (c), value, audio.getNumSamples());
+            mixer.processBlock (audio, midi);
+        }
+    }
+
+    void testRouting()
+    {
+        beginTest ("sum");
+        AudioMixerProcessor mixer (4, 44100.0, blockSize);
+        mixer.prepareToPlay (44100.0, blockSize);
+        AudioSampleBuffer audio (mixer.getTotalNumInputChannels(), blockSize);
+        render (mixer, audio);
+        expectWithinAbsoluteError (audio.getSample (0, blockSize - 1), 0.5f, 1.0e-4f);
+        expectWithinAbsoluteError (audio.getSample (1, blockSize - 1), 0.5f, 1.0e-4f);
+        expectWithinAbsoluteError (mixer.getMonitor(0)->getLevel (0), 0.5f, 1.0e-3f);
+
+        beginTest ("pan");
+        mixer.setTrackPan (0, 1.f);
+        render (mixer, audio);
+        expectWithinAbsoluteError (audio.getSample (0, blockSize - 1), 0.f, 1.0e-4f);
+        expectWithinAbsoluteError (audio.getSample (1, blockSize - 1), 0.5f, 1.0e-4f);
+        mixer.setTrackPan (0, 0.f);
+
+        beginTest ("groups");
+        const int group = mixer.addGroup();
+        expectEquals (group, 0);
+        mixer.setTrackGroup (0, group);
+        mixer.getGroupMonitor(group)->requestGain (0.5f);
+        render (mixer, audio);
+        expectWithinAbsoluteError (audio.getSample (0, blockSize - 1), 0.25f, 1.0e-4f);
+        expectWithinAbsoluteError (mixer.getGroupMonitor(group)->getLevel (0), 0.25f, 1.0e-3f);
+
+        beginTest ("vca");
+        const int vca = mixer.addVca();
+        mixer.setTrackVca (0, vca);
+        mixer.getVcaMonitor(vca)->requestGain (0.5f);
+        render (mixer, audio);
+        expectWithinAbsoluteError (audio.getSample (0, blockSize - 1), 0.125f, 1.0e-4f);
+        expectWithinAbsoluteError (mixer.getMonitor(0)->getLevel (0), 0.25f, 1.0e-3f);
+
+        mixer.getVcaMonitor(vca)->requestMute (true);
+        render (mixer, audio);
+        expectEquals (audio.getSample (0, blockSize - 1), 0.f);
+        expect (mixer.getVcaMonitor(vca)->isMuted());
+
+        beginTest ("ramps");
+        mixer.getVcaMonitor(vca)->requestMute (false);
+        MidiBuffer midi;
+        audio.clear();
+        for (int c = 0; c < 2; ++c)
+            FloatVectorOperations::fill (audio.getWritePointer (c), 0.5f, blockSize);
+        mixer.processBlock (audio, midi);
+        expect (audio.getSample (0, 0) < 0.01f);
+        expect (audio.getSample (0, blockSize - 1) > 0.1f);
+        mixer.releaseResources();
+    }
+
+    void testState()
+    {
+        beginTest ("state");
+        AudioMixerProcessor mixer (4);
+        mixer.setTrackGroup (2, mixer.addGroup());
+        mixer.setTrackVca (3, mixer.addVca());
+        mixer.setTrackPan (1, -0.5f);
+        mixer.setTrackGain (1, 0.25f);
+        mixer.setTrackMuted (2, true);
+
+        MemoryBlock state;
+        mixer.getStateInformation (state);
+        AudioMixerProcessor restored (4);
+        restored.setStateInformation (state.getData(), (int) state.getSize());
+        expectEquals (restored.getNumTracks(), 4);
+        expectEquals (restored.getNumGroups(), 1);
+        expectEquals (restored.getNumVcas(), 1);
+        expectEquals (restored.getTrackGroup (2), 0);
+        expectEquals (restored.getTrackVca (3), 0);
+        expectEquals (restored.getTrackPan (1), -0.5f);
+        expectEquals (restored.getTrackGain (1), 0.25f);
+        expect (restored.isTrackMuted (2));
+        expect (! restored.isTrackMuted (1));
+    }
+
+    void testScale()
+    {
+        beginTest ("scale");
+        AudioMixerProcessor mixer (AudioMixerProcessor::maxTracks, 44100.0, blockSize);
+        expectEquals (mixer.getNumTracks(), (int) AudioMixerProcessor::maxTracks);
+        for (int i = 0; i < AudioMixerProcessor::maxGroups; ++i)
+            expectEquals (mixer.addGroup(), i);
+        expectEquals (mixer.addGroup(), -1);
+        for (int i = 0; i < mixer.getNumTracks(); ++i)
+            mixer.setTrackGroup (i, i % AudioMixerProcessor::maxGroups);
+
+        mixer.prepareToPlay (44100.0, blockSize);
+        AudioSampleBuffer audio (mixer.getTotalNumInputChannels(), blockSize);
+        MidiBuffer midi;
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int c = 0; c < audio.getNumChannels(); ++c)
+                FloatVectorOperations::fill (audio.getWritePointer (c), 0.01f, blockSize);
+            mixer.processBlock (audio, midi);
+        }
+
+        expectWithinAbsoluteError (audio.getSample (0, blockSize - 1),
+                                   0.01f * (float) AudioMixerProcessor::maxTracks, 1.0e-3f);
+        mixer.releaseResources();
+    }
+};
+
+static AudioMixerTest sAudioMixerTest;
+
+}
@@ -0,0 +1,137 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/Automation.h"
+
+namespace Element {
+
+class AutomationTest : public UnitTestBase
+{
+public:
+    AutomationTest() : UnitTestBase ("Automation", "engine", "automation") { }
+    virtual ~AutomationTest() { }
+
+    void runTest() override
+    {
+        testCompile();
+        testInterpolation();
+        testModel();
+    }
+
+private:
+    static ValueTree createLane (int parameter, std::initializer_list<std::pair<double, float>> points)
+    {
+        ValueTree lane (Tags::lane);
+        lane.setProperty (Tags::parameter, parameter, nullptr);
+        for (const auto& p : points)
+        {
+            ValueTree point (Tags::point);
+            point.setProperty (Tags::beat, p.first, nullptr)
+                 .setProperty (Tags::value, p.second, nullptr);
+            lane.addChild (point, -1, nullptr);
+        }
+        return lane;
+    }
+
+    void testCompile()
+    {
+        beginTest ("compile");
+        ValueTree automation (Tags::automation);
+        expect (NodeAutomation::compile (automation) == nullptr);
+
+        automation.addChild (createLane (2, {}), -1, nullptr);
+        expect (NodeAutomation::compile (automation) == nullptr);
+
+        automation.addChild (createLane (0, { { 4.0, 1.f }, { 0.0, 0.f } }), -1, nullptr);
+        automation.addChild (createLane (1, { { 0.0, 2.f } }), -1, nullptr);
+        auto compiled = NodeAutomation::compile (automation);
+        expect (compiled != nullptr);
+        if (compiled == nullptr)
+            return;
+
+        expectEquals (compiled->getNumLanes(), 2);
+        const auto& lane = compiled->getLane (0);
+        expectEquals (lane.parameter, 0);
+        expectEquals (lane.numPoints, 2);
+        expectEquals (lane.beats[0], 0.0);
+        expectEquals (lane.beats[1], 4.0);
+        expectEquals (compiled->getLane(1).getValue (0.0), 1.f);
+    }
+
+    void testInterpolation()
+    {
+        beginTest ("interpolation");
+        ValueTree automation (Tags::automation);
+        automation.addChild (createLane (0, { { 1.0, 0.f }, { 3.0, 1.f }, { 5.0, 1.f }, { 6.0, 0.5f } }), -1, nullptr);
+        auto compiled = NodeAutomation::compile (automation);
+        const auto& lane = compiled->getLane (0);
+
+        expectEquals (lane.getValue (0.0), 0.f);
+        expectWithinAbsoluteError (lane.getValue (2.0), 0.5f, 1.0e-6f);
+        expectEquals (lane.getValue (4.0), 1.f);
+        expectWithinAbsoluteError (lane.getValue (5.5), 0.75f, 1.0e-6f);
+        expectEquals (lane.getValue (10.0), 0.5f);
+
+        beginTest ("seeking");
+        // the cursor has to recover when playback loops or jumps
+        expectWithinAbsoluteError (lane.getValue (1.5), 0.25f, 1.0e-6f);
+        expectWithinAbsoluteError (lane.getValue (5.5), 0.75f, 1.0e-6f);
+        for (double beat = 0.0; beat < 7.0; beat += 0.125)
+        {
+            const float expected = beat < 1.0 ? 0.f
+                : beat < 3.0 ? (float) (beat - 1.0) * 0.5f
+                : beat < 5.0 ? 1.f
+                : beat < 6.0 ? 1.f - (float) (beat - 5.0) * 0.5f
+                : 0.5f;
+            expectWithinAbsoluteError (lane.getValue (beat), expected, 1.0e-6f);
+        }
+
+        beginTest ("movement");
+        expect (lane.isFlat (0.0, 0.5));
+        expect (! lane.isFlat (0.5, 1.5));
+        expect (! lane.isFlat (2.0, 2.1));
+        expect (lane.isFlat (3.5, 4.5));
+        expect (lane.isFlat (7.0, 100.0));
+        expect (compiled->movesWithin (4.5, 5.5));
+    }
+
+    void testModel()
+    {
+        beginTest ("model");
+        Node node (Tags::plugin);
+        node.addAutomationPoint (3, 2.0, 0.5f);
+        node.addAutomationPoint (3, 0.0, 1.f);
+        node.addAutomationPoint (4, 0.0, 0.25f);
+        expectEquals (node.getAutomationValueTree().getNumChildren(), 2);
+
+        auto compiled = NodeAutomation::compile (node.getAutomationValueTree());
+        expectEquals (compiled->getNumLanes(), 2);
+        expectWithinAbsoluteError (compiled->getLane(0).getValue (1.0), 0.75f, 1.0e-6f);
+
+        node.clearAutomation (3);
+        expectEquals (node.getAutomationValueTree().getNumChildren(), 1);
+        node.clearAutomation();
+        expect (NodeAutomation::compile (node.getAutomationValueTree()) == nullptr);
+    }
+};
+
+static AutomationTest sAutomationTest;
+
+}
@@ -0,0 +1,142 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+
+namespace Element {
+
+class ConnectedInputsTest : public UnitTestBase
+{
+public:
+    ConnectedInputsTest() : UnitTestBase ("Connected Inputs", "engine", "connectedInputs") { }
+    virtual ~ConnectedInputsTest() { }
+
+    void runTest() override
+    {
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 512);
+        graph.prepareToPlay (44100.0, 512);
+
+        auto* const tap = new TapProcessor();
+        GraphNodePtr node = graph.addNode (tap);
+        GraphNodePtr input = graph.addNode (new GraphProcessor::AudioGraphIOProcessor (
+            GraphProcessor::AudioGraphIOProcessor::audioInputNode));
+        GraphNodePtr output = graph.addNode (new GraphProcessor::AudioGraphIOProcessor (
+            GraphProcessor::AudioGraphIOProcessor::audioOutputNode));
+
+        // input 1 is left unconnected. Input 2 is past the node's only output,
+        // so it reads the right input's buffer in place while the graph output
+        // reads it after the node has run.
+        auto connect = [&](GraphNodePtr src, int srcChan, GraphNodePtr dst, int dstChan) {
+            expect (graph.addConnection (src->nodeId, src->getNthPort (PortType::Audio, srcChan, false, false),
+                                         dst->nodeId, dst->getNthPort (PortType::Audio, dstChan, true, false)));
+        };
+
+        connect (input, 0, node, 0);
+        connect (input, 1, node, 2);
+        connect (input, 1, output, 1);
+        connect (node, 0, output, 0);
+        runDispatchLoop (20);
+
+        AudioSampleBuffer audio (2, 512);
+        MidiBuffer midi;
+        auto process = [&]() {
+            // the second block is past the gain ramps
+            for (int block = 0; block < 2; ++block)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    FloatVectorOperations::fill (audio.getWritePointer (ch), 0.5f, 512);
+                graph.processBlock (audio, midi);
+            }
+        };
+
+        beginTest ("output gain");
+        node->setGain (0.5f);
+        process();
+        expectWithinAbsoluteError (audio.getMagnitude (0, 0, 512), 0.25f, 0.001f);
+        expectWithinAbsoluteError (audio.getMagnitude (1, 0, 512), 0.5f, 0.001f);
+        expectEquals (tap->levels[1], 0.f);
+
+        beginTest ("input gain");
+        node->setGain (1.f);
+        node->setInputGain (0.5f);
+        process();
+        expectWithinAbsoluteError (tap->levels[0], 0.25f, 0.001f);
+        expectEquals (tap->levels[1], 0.f);
+        expectWithinAbsoluteError (node->getInputRMS (0), 0.25f, 0.001f);
+        expectEquals (node->getInputRMS (1), 0.f);
+        expectWithinAbsoluteError (audio.getMagnitude (0, 0, 512), 0.25f, 0.001f);
+
+        node = nullptr;
+        input = nullptr;
+        output = nullptr;
+        graph.releaseResources();
+        graph.clear();
+    }
+
+private:
+    /** Three inputs and one output. Passes the first input through and
+        remembers the level of each input it was given. */
+    class TapProcessor : public AudioPluginInstance
+    {
+    public:
+        TapProcessor()
+            : AudioPluginInstance (BusesProperties()
+                .withInput  ("Main", AudioChannelSet::discreteChannels (3))
+                .withOutput ("Main", AudioChannelSet::mono())) { }
+
+        float levels [3] = { 0.f, 0.f, 0.f };
+
+        const String getName() const override { return "Tap"; }
+        void fillInPluginDescription (PluginDescription& desc) const override
+        {
+            desc.name = getName();
+            desc.fileOrIdentifier = "test.tap";
+            desc.pluginFormatName = "Test";
+            desc.numInputChannels = 3;
+            desc.numOutputChannels = 1;
+        }
+
+        void prepareToPlay (double, int) override { }
+        void releaseResources() override { }
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer&) override
+        {
+            for (int ch = 0; ch < 3; ++ch)
+                levels[ch] = buffer.getMagnitude (ch, 0, buffer.getNumSamples());
+        }
+
+        double getTailLengthSeconds() const override { return 0.0; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram (int) override { }
+        const String getProgramName (int) override { return String(); }
+        void changeProgramName (int, const String&) override { }
+        void getStateInformation (MemoryBlock&) override { }
+        void setStateInformation (const void*, int) override { }
+    };
+};
+
+static ConnectedInputsTest sConnectedInputsTest;
+
+}
@@ -0,0 +1,115 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/nodes/LfoNode.h"
+
+namespace Element {
+
+class ControlPortsTest : public UnitTestBase
+{
+public:
+    ControlPortsTest() : UnitTestBase ("Control Ports", "engine", "controlPorts") { }
+    virtual ~ControlPortsTest() { }
+
+    void initialise() override
+    {
+        initializePlugins();
+    }
+
+    void shutdown() override
+    {
+        shutdownPlugins();
+    }
+
+    void runTest() override
+    {
+        beginTest ("ports");
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 512);
+        graph.prepareToPlay (44100.0, 512);
+
+        auto* const lfo = new LfoNode();
+        GraphNodePtr source = graph.addNode (lfo);
+        expectEquals ((int) source->getNumPorts (PortType::Control, false), 1);
+        expectEquals ((int) source->getNumPorts(), 1);
+
+        auto* const plugin = createPluginProcessor();
+        expect (plugin != nullptr);
+        if (plugin == nullptr)
+            return;
+        GraphNodePtr dest = graph.addNode (plugin);
+        runDispatchLoop (20);
+
+        auto* const param = plugin->getParameters().getFirst();
+        expect (param != nullptr);
+        if (param == nullptr)
+            return;
+
+        beginTest ("modulation");
+        lfo->setDepth (0.f);
+        param->setValueNotifyingHost (1.f);
+        const uint32 controlPort = dest->getNthPort (PortType::Control, 0, true, false);
+        expect (graph.addConnection (source->nodeId, 0, dest->nodeId, controlPort));
+        runDispatchLoop (20);
+
+        AudioSampleBuffer audio (2, 512);
+        MidiBuffer midi;
+        audio.clear();
+        graph.processBlock (audio, midi);
+        expectWithinAbsoluteError (param->getValue(), 0.5f, 0.001f);
+
+        // a square at full depth starts high
+        lfo->setDepth (1.f);
+        lfo->setShape (LfoNode::Square);
+        lfo->setRate (0.1f);
+        graph.processBlock (audio, midi);
+        expectWithinAbsoluteError (param->getValue(), 1.f, 0.001f);
+
+        beginTest ("per block");
+        // the square falls part way through this block, the value at its
+        // start is kept for the whole block
+        lfo->setRate (60.f);
+        graph.processBlock (audio, midi);
+        expectWithinAbsoluteError (param->getValue(), 1.f, 0.001f);
+
+        beginTest ("sub-blocks");
+        // this block starts low and rises, the last sub-block sees it high
+        dest->setSubBlockControls (true);
+        graph.processBlock (audio, midi);
+        expectWithinAbsoluteError (param->getValue(), 1.f, 0.001f);
+        dest->setSubBlockControls (false);
+
+        beginTest ("disconnected");
+        expect (graph.removeConnection (source->nodeId, 0, dest->nodeId, controlPort));
+        runDispatchLoop (20);
+        param->setValueNotifyingHost (0.25f);
+        graph.processBlock (audio, midi);
+        expectWithinAbsoluteError (param->getValue(), 0.25f, 0.001f);
+
+        source = nullptr;
+        dest = nullptr;
+        graph.releaseResources();
+        graph.clear();
+    }
+};
+
+static ControlPortsTest sControlPortsTest;
+
+}
@@ -0,0 +1,93 @@
+/*
+    This file is part of Element
+    Copyright (C) 2018-2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Tests.h"
+#include "engine/Downsampler.h"
+
+namespace Element {
+
+class DownsamplerTest : public UnitTestBase
+{
+public:
+    DownsamplerTest() : UnitTestBase ("Downsampler", "engine", "downsampler") { }
+    virtual ~DownsamplerTest() { }
+
+    void runTest() override
+    {
+        testRoundTrip (2);
+        testRoundTrip (4);
+    }
+
+private:
+    void testRoundTrip (int factor)
+    {
+        beginTest (String ("round trip, factor ") + String (factor));
+
+        const int maxBlock = 512;
+        Downsampler ds;
+        ds.prepare (2, factor, maxBlock);
+        expect (ds.getMaxInnerSamples() >= maxBlock / factor + 1);
+
+        // a low tone passes both filters, so what comes out should be the
+        // input delayed by the reported latency
+        const int total = 44100;
+        const double freq = 220.0 / 44100.0;
+        AudioSampleBuffer in (2, total), out (2, total);
+        for (int i = 0; i < total; ++i)
+            for (int ch = 0; ch < 2; ++ch)
+                in.setSample (ch, i, 0.5f * (float) std::sin (MathConstants<double>::twoPi * freq * i));
+
+        // block sizes that aren't multiples of the factor
+        const int sizes[] = { 37, 512, 1, 255, 100, 3, 511 };
+        AudioSampleBuffer block (2, maxBlock);
+        int pos = 0, n = 0;
+        while (pos < total)
+        {
+            const int numSamples = jmin (sizes[n++ % numElementsInArray (sizes)], total - pos);
+            for (int ch = 0; ch < 2; ++ch)
+                block.copyFrom (ch, 0, in, ch, pos, numSamples);
+
+            const int numInner = ds.decimate (block, numSamples);
+            expect (numInner <= ds.getMaxInnerSamples());
+            ds.interpolate (block, numSamples, numInner);
+
+            for (int ch = 0; ch < 2; ++ch)
+                out.copyFrom (ch, pos, block, ch, 0, numSamples);
+            pos += numSamples;
+        }
+
+        const int latency = ds.getLatencySamples();
+        float maxError = 0.f;
+        for (int i = latency + 4 * maxBlock; i < total; ++i)
+            for (int ch = 0; ch < 2; ++ch)
+                maxError = jmax (maxError, std::abs (out.getSample (ch, i) - in.getSample (ch, i - latency)));
+        expectLessThan (maxError, 0.01f);
+
+        // the FIFO is primed again
+        ds.reset();
+        block.clear();
+        const int numInner = ds.decimate (block, 1);
+        expectEquals (numInner, 0);
+        ds.interpolate (block, 1, numInner);
+        expectEquals (block.getSample (0, 0), 0.f);
+    }
+};
+
+static DownsamplerTest sDownsamplerTest;
+
+}
@@ -85,6 +85,40 @@ public:
             graph.clear();
         }
 
+        {
+            GraphProcessor graph;
+            graph.setPlayConfigDetails (0, 2, 44100.0, 512);
+            graph.prepareToPlay (44100.0, 512);
+
+            beginTest ("oversampled chain");
+            GraphNodePtr node1 = graph.addNode (createPluginProcessor());
+            GraphNodePtr node2 = graph.addNode (createPluginProcessor());
+            GraphNodePtr output = graph.addNode (new Element::GraphProcessor::AudioGraphIOProcessor (
+                GraphProcessor::AudioGraphIOProcessor::audioOutputNode));
+            node1->connectAudioTo (node2);
+            node2->connectAudioTo (output);
+            for (int i = 0; i < 3; ++i)
+                runDispatchLoop (15);
+
+            graph.releaseResources();
+            node1->setOversamplingFactor (2);
+            node2->setOversamplingFactor (2);
+            graph.prepareToPlay (44100.0, 512);
+
+            // both nodes share one scope, so the filters are only counted once
+            dsp::Oversampling<float> oversampling (2, 1, dsp::Oversampling<float>::filterHalfBandPolyphaseIIR);
+            expectEquals (graph.getLatencySamples(), roundFloatToInt (oversampling.getLatencyInSamples()));
+
+            AudioSampleBuffer audio (2, 512);
+            audio.clear();
+            MidiBuffer midi;
+            graph.processBlock (audio, midi);
+
+            node1 = nullptr; node2 = nullptr; output = nullptr;
+            graph.releaseResources();
+            graph.clear();
+        }
+
         {
             GraphProcessor graph;
             graph.setPlayConfigDetails (0, 2, 44100.0, 512);
@@ -0,0 +1,130 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+
+namespace Element {
+
+class NodeOrderTest : public UnitTestBase
+{
+public:
+    NodeOrderTest() : UnitTestBase ("Node Ordering", "engine", "nodeOrder") { }
+    virtual ~NodeOrderTest() { }
+
+    void initialise() override
+    {
+        initializePlugins();
+    }
+
+    void shutdown() override
+    {
+        GraphProcessor::setLocalityOrderingEnabled (true);
+        shutdownPlugins();
+    }
+
+    void runTest() override
+    {
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 512);
+        graph.prepareToPlay (44100.0, 512);
+
+        // two chains added interleaved: a1 b1 a2 b2 a3 b3
+        ReferenceCountedArray<GraphNode> a, b;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto* const pa = createPluginProcessor();
+            auto* const pb = createPluginProcessor();
+            expect (pa != nullptr && pb != nullptr);
+            if (pa != nullptr) a.add (graph.addNode (pa));
+            if (pb != nullptr) b.add (graph.addNode (pb));
+            if (pa == nullptr || pb == nullptr)
+                return;
+        }
+
+        for (int i = 1; i < 3; ++i)
+        {
+            connect (graph, a[i - 1], a[i]);
+            connect (graph, b[i - 1], b[i]);
+        }
+        runDispatchLoop (20);
+
+        beginTest ("dependency order");
+        GraphProcessor::setLocalityOrderingEnabled (false);
+        ReferenceCountedArray<GraphNode> ordered;
+        graph.getOrderedNodes (ordered);
+        expectEquals (ordered.size(), 6);
+        expect (ordered[0] == a[0] && ordered[1] == b[0] && ordered[2] == a[1]);
+
+        beginTest ("locality order");
+        GraphProcessor::setLocalityOrderingEnabled (true);
+        ordered.clearQuick();
+        graph.getOrderedNodes (ordered);
+        expectEquals (ordered.size(), 6);
+        for (int i = 0; i < 3; ++i)
+        {
+            expect (ordered[i] == a[i]);
+            expect (ordered[i + 3] == b[i]);
+        }
+
+        beginTest ("joined chains");
+        // a mixer fed by both chains still runs after them
+        auto* const pm = createPluginProcessor();
+        expect (pm != nullptr);
+        if (pm == nullptr)
+            return;
+        GraphNodePtr mixer = graph.addNode (pm);
+        connect (graph, a[2], mixer);
+        connect (graph, b[2], mixer);
+        ordered.clearQuick();
+        graph.getOrderedNodes (ordered);
+        expectEquals (ordered.size(), 7);
+        expect (ordered.getLast() == mixer);
+        for (int i = 1; i < 3; ++i)
+        {
+            expect (ordered.indexOf (a[i - 1]) < ordered.indexOf (a[i]));
+            expect (ordered.indexOf (b[i - 1]) < ordered.indexOf (b[i]));
+        }
+        runDispatchLoop (20);
+
+        AudioSampleBuffer audio (2, 512);
+        MidiBuffer midi;
+        audio.clear();
+        graph.processBlock (audio, midi);
+
+        mixer = nullptr;
+        ordered.clear();
+        a.clear();
+        b.clear();
+        graph.releaseResources();
+        graph.clear();
+    }
+
+private:
+    void connect (GraphProcessor& graph, GraphNode* source, GraphNode* dest)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            expect (graph.addConnection (source->nodeId, source->getNthPort (PortType::Audio, ch, false, false),
+                                         dest->nodeId, dest->getNthPort (PortType::Audio, ch, true, false)));
+    }
+};
+
+static NodeOrderTest sNodeOrderTest;
+
+}
@@ -0,0 +1,94 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+
+namespace Element {
+
+class NodeSleepTest : public UnitTestBase
+{
+public:
+    NodeSleepTest() : UnitTestBase ("Node Sleeping", "engine", "nodeSleep") { }
+    virtual ~NodeSleepTest() { }
+
+    void initialise() override
+    {
+        initializePlugins();
+    }
+
+    void shutdown() override
+    {
+        GraphNode::setSleepingEnabled (true);
+        shutdownPlugins();
+    }
+
+    void runTest() override
+    {
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 512);
+        graph.prepareToPlay (44100.0, 512);
+
+        auto* const plugin = createPluginProcessor();
+        expect (plugin != nullptr);
+        if (plugin == nullptr)
+            return;
+        GraphNodePtr node = graph.addNode (plugin);
+        GraphNodePtr input = graph.addNode (new GraphProcessor::AudioGraphIOProcessor (
+            GraphProcessor::AudioGraphIOProcessor::audioInputNode));
+        for (int ch = 0; ch < 2; ++ch)
+            expect (graph.addConnection (input->nodeId, input->getNthPort (PortType::Audio, ch, false, false),
+                                         node->nodeId, node->getNthPort (PortType::Audio, ch, true, false)));
+        runDispatchLoop (20);
+
+        AudioSampleBuffer audio (2, 512);
+        MidiBuffer midi;
+        audio.clear();
+
+        beginTest ("sleeps on silence");
+        GraphNode::setSleepingEnabled (true);
+        graph.processBlock (audio, midi);
+        expect (! node->isSleeping());
+        graph.processBlock (audio, midi);
+        expect (node->isSleeping());
+
+        beginTest ("wakes on signal");
+        for (int ch = 0; ch < 2; ++ch)
+            FloatVectorOperations::fill (audio.getWritePointer (ch), 0.5f, 512);
+        graph.processBlock (audio, midi);
+        expect (! node->isSleeping());
+
+        beginTest ("disabled");
+        audio.clear();
+        graph.processBlock (audio, midi);
+        graph.processBlock (audio, midi);
+        expect (node->isSleeping());
+        GraphNode::setSleepingEnabled (false);
+        graph.processBlock (audio, midi);
+        expect (! node->isSleeping());
+
+        node = nullptr;
+        input = nullptr;
+        graph.releaseResources();
+        graph.clear();
+    }
+};
+
+static NodeSleepTest sNodeSleepTest;
+
+}
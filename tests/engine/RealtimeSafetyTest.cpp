@@ -0,0 +1,296 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/MidiPipe.h"
+#include "engine/RealtimeSafety.h"
+
+namespace Element {
+
+class RealtimeSafetyTest : public UnitTestBase
+{
+public:
+    RealtimeSafetyTest() : UnitTestBase ("Realtime Safety", "engine", "realtimeSafety") { }
+    virtual ~RealtimeSafetyTest() { }
+
+    void initialise() override
+    {
+        globals.reset (new Globals());
+        globals->getPluginManager().addDefaultFormats();
+        globals->getPluginManager().addFormat (new ElementAudioPluginFormat (*globals));
+        globals->getPluginManager().setPlayConfig (44100.0, blockSize);
+    }
+
+    void shutdown() override
+    {
+        RealtimeSafety::setEnabled (false);
+        RealtimeSafety::clearViolations();
+        globals.reset (nullptr);
+    }
+
+    void runTest() override
+    {
+        if (! RealtimeSafety::isAvailable())
+        {
+            beginTest ("detector");
+            logMessage ("realtime checks not built in, skipping");
+            return;
+        }
+
+        RealtimeSafety::setEnabled (true);
+        testDetector();
+        testBuiltinNodes();
+    }
+
+private:
+    enum { blockSize = 512, numBlocks = 8 };
+    std::unique_ptr<Globals> globals;
+
+    void testDetector()
+    {
+        beginTest ("detector");
+        static void* volatile sink = nullptr;
+
+        RealtimeSafety::clearViolations();
+        sink = std::malloc (64);
+        std::free (sink);
+        expectEquals (RealtimeSafety::getNumViolations(), 0);
+
+        bool wasRealtime = false;
+        {
+            const RealtimeSafety::ScopedRealtime realtime;
+            wasRealtime = RealtimeSafety::isRealtimeThread();
+            sink = std::malloc (64);
+            std::free (sink);
+        }
+        expect (wasRealtime);
+        expect (! RealtimeSafety::isRealtimeThread());
+        expectEquals (RealtimeSafety::getNumViolations(), 2);
+
+        auto violations = RealtimeSafety::getViolations();
+        expectEquals (violations.size(), 2);
+        expectEquals (violations.getReference(0).function, String ("malloc"));
+        expectEquals (violations.getReference(1).function, String ("free"));
+
+        RealtimeSafety::clearViolations();
+        CriticalSection lock;
+        {
+            const RealtimeSafety::ScopedRealtime realtime;
+            const ScopedLock sl (lock);
+        }
+        expect (RealtimeSafety::getNumViolations() > 0);
+
+        RealtimeSafety::clearViolations();
+        {
+            const RealtimeSafety::ScopedRealtime realtime;
+            const RealtimeSafety::ScopedNonRealtime nonRealtime;
+            sink = std::malloc (64);
+            std::free (sink);
+        }
+        expectEquals (RealtimeSafety::getNumViolations(), 0);
+    }
+
+    void testBuiltinNodes()
+    {
+        auto& plugins = globals->getPluginManager();
+        ElementAudioPluginFormat format (*globals);
+
+        for (const auto& identifier : format.searchPathsForPlugins (FileSearchPath(), false, false))
+        {
+            OwnedArray<PluginDescription> types;
+            format.findAllTypesForFile (types, identifier);
+            for (const auto* type : types)
+            {
+                beginTest (type->fileOrIdentifier);
+                String error;
+                GraphNode* node = plugins.createGraphNode (*type, error);
+                AudioProcessor* processor = node == nullptr ? plugins.createAudioPlugin (*type, error) : nullptr;
+                if (node == nullptr && processor == nullptr)
+                {
+                    logMessage (type->fileOrIdentifier + ": " + error);
+                    continue;
+                }
+
+                checkRender (type->fileOrIdentifier, node, processor);
+            }
+        }
+    }
+
+    void checkRender (const String& identifier, GraphNode* newNode, AudioProcessor* newProcessor)
+    {
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+        graph.prepareToPlay (44100.0, blockSize);
+
+        GraphNodePtr node = newNode != nullptr ? graph.addNode (newNode)
+                                               : graph.addNode (newProcessor);
+        for (int i = 0; i < 3; ++i)
+            runDispatchLoop (15);
+
+        if (node == nullptr)
+        {
+            expect (false, identifier + " could not be added");
+            return;
+        }
+
+        const int numChannels = jmax (2, node->getNumAudioInputs(), node->getNumAudioOutputs());
+        const int numMidi = jmax (1, node->getNumPorts (PortType::Midi, true),
+                                     node->getNumPorts (PortType::Midi, false));
+        AudioSampleBuffer audio (numChannels, blockSize);
+        OwnedArray<MidiBuffer> midi;
+        Array<int> midiChannels;
+        for (int i = 0; i < numMidi; ++i)
+        {
+            midi.add (new MidiBuffer())->ensureSize (4096);
+            midiChannels.add (i);
+        }
+
+        // the first block may set things up lazily
+        renderBlock (*node, audio, midi, midiChannels);
+        RealtimeSafety::clearViolations();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (auto* buffer : midi)
+            {
+                buffer->clear();
+                buffer->addEvent (MidiMessage::noteOn (1, 60 + block, 0.8f), 0);
+                buffer->addEvent (MidiMessage::programChange (1, block), 10);
+                buffer->addEvent (MidiMessage::noteOff (1, 60 + block), blockSize / 2);
+            }
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int s = 0; s < blockSize; ++s)
+                    audio.setSample (c, s, std::sin ((float) s * 0.05f) * 0.5f);
+
+            const RealtimeSafety::ScopedRealtime realtime;
+            renderBlock (*node, audio, midi, midiChannels);
+        }
+
+        checkViolations (identifier);
+        checkGraphRender (identifier, graph, node);
+
+        node = nullptr;
+        graph.releaseResources();
+        graph.clear();
+    }
+
+    /** Renders the node wired between the graph's IO nodes, so what the graph
+        does around each node (MIDI filters, gain, metering) is checked too */
+    void checkGraphRender (const String& identifier, GraphProcessor& graph, GraphNodePtr node)
+    {
+        typedef GraphProcessor::AudioGraphIOProcessor IOProcessor;
+        GraphNodePtr audioIn  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+        GraphNodePtr audioOut = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+        GraphNodePtr midiIn   = graph.addNode (new IOProcessor (IOProcessor::midiInputNode));
+
+        for (int ch = 0; ch < jmin (2, node->getNumAudioInputs()); ++ch)
+            graph.addConnection (audioIn->nodeId, audioIn->getNthPort (PortType::Audio, ch, false, false),
+                                 node->nodeId, node->getNthPort (PortType::Audio, ch, true, false));
+        for (int ch = 0; ch < jmin (2, node->getNumAudioOutputs()); ++ch)
+            graph.addConnection (node->nodeId, node->getNthPort (PortType::Audio, ch, false, false),
+                                 audioOut->nodeId, audioOut->getNthPort (PortType::Audio, ch, true, false));
+        if (node->getNumPorts (PortType::Midi, true) > 0)
+            graph.addConnection (midiIn->nodeId, midiIn->getNthPort (PortType::Midi, 0, false, false),
+                                 node->nodeId, node->getNthPort (PortType::Midi, 0, true, false));
+        for (int i = 0; i < 3; ++i)
+            runDispatchLoop (15);
+
+        AudioSampleBuffer audio (2, blockSize);
+        MidiBuffer midi;
+        midi.ensureSize (4096);
+
+        // the first block after a rebuild may set things up lazily
+        graph.processBlock (audio, midi);
+        RealtimeSafety::clearViolations();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            midi.clear();
+            midi.addEvent (MidiMessage::noteOn (1, 60 + block, 0.8f), 0);
+            midi.addEvent (MidiMessage::noteOff (1, 60 + block), blockSize / 2);
+            for (int c = 0; c < 2; ++c)
+                for (int s = 0; s < blockSize; ++s)
+                    audio.setSample (c, s, std::sin ((float) s * 0.05f) * 0.5f);
+
+            const RealtimeSafety::ScopedRealtime realtime;
+            graph.processBlock (audio, midi);
+        }
+
+        checkViolations (identifier + " in a graph");
+    }
+
+    void checkViolations (const String& identifier)
+    {
+        const auto violations = RealtimeSafety::getViolations();
+        if (isKnownOffender (identifier.upToFirstOccurrenceOf (" ", false, false)))
+        {
+            if (! violations.isEmpty())
+                logMessage (identifier + ": " + String (violations.size()) + " known violation(s), first: "
+                    + violations.getReference(0).toString());
+        }
+        else
+        {
+            for (const auto& violation : violations)
+                logMessage (violation.toString());
+            expect (violations.isEmpty(), identifier + " is not realtime safe");
+        }
+
+        RealtimeSafety::clearViolations();
+    }
+
+    static void renderBlock (GraphNode& node, AudioSampleBuffer& audio,
+                             OwnedArray<MidiBuffer>& midi, const Array<int>& midiChannels)
+    {
+        if (node.wantsMidiPipe())
+        {
+            MidiPipe pipe (midi, midiChannels);
+            node.render (audio, pipe);
+        }
+        else if (auto* processor = node.getAudioProcessor())
+        {
+            processor->processBlock (audio, *midi.getUnchecked (0));
+        }
+    }
+
+    /** Nodes that lock while rendering by design. Their violations are logged
+        rather than failed. Only add a node here with the reason it can't be
+        fixed in the node itself. */
+    static bool isKnownOffender (const String& identifier)
+    {
+        static const StringArray offenders {
+            // juce::AudioTransportSource takes its callback lock every block
+            EL_INTERNAL_ID_AUDIO_FILE_PLAYER,
+            EL_INTERNAL_ID_MEDIA_PLAYER,
+            // the map is rewritten under the callback lock by parameter
+            // listeners, rendering with a stale map would strand note offs
+            EL_INTERNAL_ID_MIDI_CHANNEL_MAP,
+            // juce::MidiMessageCollector locks and grows its queue
+            EL_INTERNAL_ID_MIDI_MONITOR,
+            // same as the channel map, and the editor is told through an AsyncUpdater
+            EL_INTERNAL_ID_MIDI_PROGRAM_MAP
+        };
+
+        return offenders.contains (identifier);
+    }
+};
+
+static RealtimeSafetyTest sRealtimeSafetyTest;
+
+}
@@ -0,0 +1,215 @@
+/*
+    This file is part of Element
+    Copyright (C) 2018-2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Tests.h"
+#include "engine/RedundantAudioOutput.h"
+
+namespace Element {
+
+class RedundantAudioOutputTest : public UnitTestBase
+{
+public:
+    RedundantAudioOutputTest() : UnitTestBase ("Redundant Audio Output", "engine", "redundantOutput") { }
+    virtual ~RedundantAudioOutputTest() { }
+
+    void runTest() override
+    {
+        testPrimaryStopped();
+        testRateChange();
+        testIncompatibleRate();
+    }
+
+private:
+    /** A device that is never opened, the callbacks are driven by hand */
+    class FakeDevice : public AudioIODevice
+    {
+    public:
+        FakeDevice (double rate, int block)
+            : AudioIODevice ("Fake", "Fake"), sampleRate (rate), blockSize (block) { }
+
+        StringArray getOutputChannelNames() override            { return { "1", "2" }; }
+        StringArray getInputChannelNames() override             { return {}; }
+        Array<double> getAvailableSampleRates() override        { return { sampleRate }; }
+        Array<int> getAvailableBufferSizes() override           { return { blockSize }; }
+        int getDefaultBufferSize() override                     { return blockSize; }
+        String open (const BigInteger&, const BigInteger&, double, int) override { return {}; }
+        void close() override { }
+        bool isOpen() override                                  { return true; }
+        void start (AudioIODeviceCallback*) override { }
+        void stop() override { }
+        bool isPlaying() override                               { return true; }
+        String getLastError() override                          { return {}; }
+        int getCurrentBufferSizeSamples() override              { return blockSize; }
+        double getCurrentSampleRate() override                  { return sampleRate; }
+        int getCurrentBitDepth() override                       { return 32; }
+        BigInteger getActiveOutputChannels() const override     { BigInteger chans; chans.setRange (0, 2, true); return chans; }
+        BigInteger getActiveInputChannels() const override      { return {}; }
+        int getOutputLatencyInSamples() override                { return 0; }
+        int getInputLatencyInSamples() override                 { return 0; }
+
+        double sampleRate;
+        int blockSize;
+    };
+
+    /** Outputs a constant and remembers how it was driven */
+    struct Engine : public AudioIODeviceCallback
+    {
+        void audioDeviceAboutToStart (AudioIODevice* device) override
+        {
+            sampleRate = device->getCurrentSampleRate();
+            ++numStarts;
+        }
+
+        void audioDeviceStopped() override { ++numStops; }
+
+        void audioDeviceIOCallback (const float**, int, float** outputs, int numOutputs, int numSamples) override
+        {
+            largestBlock = jmax (largestBlock, numSamples);
+            for (int c = 0; c < numOutputs; ++c)
+                FloatVectorOperations::fill (outputs[c], 0.5f, numSamples);
+        }
+
+        double sampleRate = 0.0;
+        int numStarts = 0;
+        int numStops = 0;
+        int largestBlock = 0;
+    };
+
+    static float process (AudioIODeviceCallback& callback, FakeDevice& device)
+    {
+        AudioSampleBuffer buffer (2, device.blockSize);
+        buffer.clear();
+        callback.audioDeviceIOCallback (nullptr, 0, buffer.getArrayOfWritePointers(), 2, device.blockSize);
+        return buffer.getMagnitude (0, device.blockSize);
+    }
+
+    void testPrimaryStopped()
+    {
+        beginTest ("primary stopped");
+        FakeDevice main (48000.0, 256), spare (44100.0, 441);
+        Engine engine;
+        RedundantAudioOutput output;
+        output.setEngineCallback (&engine);
+        auto& primary = output.getPrimaryCallback();
+        auto& backup  = output.getBackupCallback();
+
+        primary.audioDeviceAboutToStart (&main);
+        backup.audioDeviceAboutToStart (&spare);
+        for (int i = 0; i < 32; ++i)
+        {
+            expectEquals (process (primary, main), 0.5f);
+            process (backup, spare);
+        }
+
+        // unplugging the primary keeps the engine running on the backup
+        const int underruns = output.getStatus().underruns;
+        primary.audioDeviceStopped();
+        expectEquals (engine.numStops, 0);
+        expect (output.isFailedOver());
+
+        engine.largestBlock = 0;
+        float peak = 0.f;
+        for (int i = 0; i < 64; ++i)
+            peak = process (backup, spare);
+        expectWithinAbsoluteError (peak, 0.5f, 0.001f);
+
+        // at the primary's block size, not the backup's
+        expectEquals (engine.largestBlock, main.blockSize);
+        expectEquals (output.getStatus().underruns, underruns);
+
+        backup.audioDeviceStopped();
+        expectEquals (engine.numStops, 1);
+        output.setEngineCallback (nullptr);
+    }
+
+    void testRateChange()
+    {
+        beginTest ("primary rate change");
+        FakeDevice main (44100.0, 128), spare (44100.0, 128);
+        Engine engine;
+        RedundantAudioOutput output;
+        output.setEngineCallback (&engine);
+        auto& primary = output.getPrimaryCallback();
+        auto& backup  = output.getBackupCallback();
+
+        primary.audioDeviceAboutToStart (&main);
+        backup.audioDeviceAboutToStart (&spare);
+        for (int i = 0; i < 16; ++i)
+        {
+            process (primary, main);
+            process (backup, spare);
+        }
+
+        // the backup is sized again for the restarted primary
+        primary.audioDeviceStopped();
+        main.sampleRate = 96000.0;
+        main.blockSize = 1024;
+        primary.audioDeviceAboutToStart (&main);
+        expectEquals (engine.sampleRate, 96000.0);
+        expect (! output.isFailedOver());
+        for (int i = 0; i < 16; ++i)
+        {
+            process (primary, main);
+            process (backup, spare);
+        }
+
+        primary.audioDeviceStopped();
+        expect (output.isFailedOver());
+        engine.largestBlock = 0;
+        float peak = 0.f;
+        for (int i = 0; i < 64; ++i)
+            peak = process (backup, spare);
+        expectWithinAbsoluteError (peak, 0.5f, 0.001f);
+        expectEquals (engine.largestBlock, main.blockSize);
+
+        backup.audioDeviceStopped();
+        output.setEngineCallback (nullptr);
+    }
+
+    void testIncompatibleRate()
+    {
+        beginTest ("incompatible rate");
+        FakeDevice main (96000.0, 256), spare (8000.0, 256);
+        Engine engine;
+        RedundantAudioOutput output;
+        output.setEngineCallback (&engine);
+        auto& primary = output.getPrimaryCallback();
+        auto& backup  = output.getBackupCallback();
+
+        primary.audioDeviceAboutToStart (&main);
+        backup.audioDeviceAboutToStart (&spare);
+        expect (! output.getStatus().backupCompatible);
+        for (int i = 0; i < 8; ++i)
+        {
+            process (primary, main);
+            expectEquals (process (backup, spare), 0.f);
+        }
+
+        // nothing can take over, so the engine stops with the primary
+        primary.audioDeviceStopped();
+        expect (! output.isFailedOver());
+        expectEquals (engine.numStops, 1);
+
+        backup.audioDeviceStopped();
+        output.setEngineCallback (nullptr);
+    }
+};
+
+static RedundantAudioOutputTest sRedundantAudioOutputTest;
+
+}
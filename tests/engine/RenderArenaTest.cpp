@@ -0,0 +1,68 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/RenderArena.h"
+
+namespace Element {
+
+class RenderArenaTest : public UnitTestBase
+{
+public:
+    RenderArenaTest() : UnitTestBase ("Render Arena", "engine", "renderArena") { }
+    virtual ~RenderArenaTest() { }
+
+    void runTest() override
+    {
+        beginTest ("measure");
+        RenderArena arena;
+        expect (! arena.isCommitted());
+        expect (layout (arena) == nullptr);
+        const size_t measured = arena.getUsedBytes();
+        expect (measured >= sizeof (float) * 1003);
+        expectEquals ((int) (measured % RenderArena::alignment), 0);
+
+        beginTest ("commit");
+        expect (arena.commit());
+        expect (arena.isCommitted());
+        expectEquals ((int) arena.getUsedBytes(), 0);
+
+        float* const data = layout (arena);
+        expect (data != nullptr);
+        expect (arena.getUsedBytes() == measured);
+        expectEquals ((int) ((pointer_sized_int) data % RenderArena::alignment), 0);
+
+        bool zeroed = true;
+        for (int i = 0; i < 1000; ++i)
+            zeroed = zeroed && data[i] == 0.f;
+        expect (zeroed);
+    }
+
+private:
+    static float* layout (RenderArena& arena)
+    {
+        auto* const first = arena.allocate<float> (1000);
+        arena.allocate<float> (3);
+        return first;
+    }
+};
+
+static RenderArenaTest sRenderArenaTest;
+
+}
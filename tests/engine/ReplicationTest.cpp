@@ -0,0 +1,350 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#include "Tests.h"
+#include "engine/SessionReplication.h"
+
+namespace Element {
+
+class ReplicationTest : public UnitTestBase
+{
+public:
+    ReplicationTest() : UnitTestBase ("Replication", "engine", "replication") { }
+    virtual ~ReplicationTest() { }
+
+    void runTest() override
+    {
+        testStateDiffs();
+        testPaths();
+        testLocalhost();
+        testLeaderTimeout (false);
+        testLeaderTimeout (true);
+        testFencedLeader();
+    }
+
+private:
+    /** Sends one snapshot when a follower connects, then nothing, like a
+        leader whose audio has stopped. Fences are counted and, if asked to,
+        acknowledged */
+    class StalledLeader : public InterprocessConnectionServer
+    {
+    public:
+        StalledLeader (const ValueTree& s, bool ack) : session (s), acknowledgesFences (ack) { }
+        ~StalledLeader() { stop(); connections.clear(); }
+
+        Atomic<int> numFences { 0 };
+
+        InterprocessConnection* createConnectionObject() override
+        {
+            return connections.add (new Connection (*this));
+        }
+
+    private:
+        struct Connection : public InterprocessConnection
+        {
+            Connection (StalledLeader& l) : InterprocessConnection (false, Replication::magic), leader (l) { }
+            ~Connection() { disconnect(); }
+
+            void connectionMade() override
+            {
+                MemoryOutputStream tree;
+                leader.session.writeToStream (tree);
+
+                MemoryOutputStream out;
+                out.writeByte (0);
+                out.writeCompressedInt (1);
+                out.writeByte ((char) Replication::snapshotRecord);
+                out.writeCompressedInt (Replication::version);
+                out.writeCompressedInt ((int) tree.getDataSize());
+                out.write (tree.getData(), tree.getDataSize());
+                sendMessage (out.getMemoryBlock());
+            }
+
+            void connectionLost() override { }
+
+            void messageReceived (const MemoryBlock& message) override
+            {
+                if (Replication::getSignal (message) != Replication::fenceRecord)
+                    return;
+                ++leader.numFences;
+                if (leader.acknowledgesFences)
+                    sendMessage (Replication::encodeSignal (Replication::fenceAckRecord));
+            }
+
+            StalledLeader& leader;
+        };
+
+        ValueTree session;
+        const bool acknowledgesFences;
+        OwnedArray<Connection> connections;
+    };
+
+    /** A bare connection to a leader that records the signals it gets */
+    struct Probe : public InterprocessConnection
+    {
+        Probe() : InterprocessConnection (false, Replication::magic) { }
+        ~Probe() { disconnect(); }
+
+        void connectionMade() override { }
+        void connectionLost() override { }
+        void messageReceived (const MemoryBlock& message) override
+        {
+            const int signal = Replication::getSignal (message);
+            if (signal == Replication::heartbeatRecord)
+                ++numHeartbeats;
+            else if (signal == Replication::fenceAckRecord)
+                acknowledged.set (1);
+        }
+
+        Atomic<int> numHeartbeats { 0 };
+        Atomic<int> acknowledged { 0 };
+    };
+
+    void testStateDiffs()
+    {
+        beginTest ("state diffs");
+        Random random (1234);
+        MemoryBlock before (1000);
+        for (size_t i = 0; i < before.getSize(); ++i)
+            before[i] = (char) random.nextInt (256);
+
+        MemoryBlock after (before);
+        after[10]  = (char) (after[10] + 1);
+        after[700] = (char) (after[700] + 1);
+
+        {
+            MemoryOutputStream out;
+            expect (! Replication::writeStateDiff (before, before, out));
+            expectEquals ((int) out.getDataSize(), 0);
+        }
+
+        MemoryOutputStream out;
+        expect (Replication::writeStateDiff (before, after, out));
+        expect (out.getDataSize() < (size_t) Replication::stateChunkSize * 3);
+
+        MemoryInputStream in (out.getData(), out.getDataSize(), false);
+        MemoryBlock patched (before);
+        expect (Replication::applyStateDiff (patched, in));
+        expect (patched == after);
+
+        beginTest ("state size changes");
+        MemoryBlock shorter (after.getData(), 300);
+        MemoryOutputStream shrink;
+        expect (Replication::writeStateDiff (after, shorter, shrink));
+        MemoryInputStream shrinkIn (shrink.getData(), shrink.getDataSize(), false);
+        expect (Replication::applyStateDiff (patched, shrinkIn));
+        expect (patched == shorter);
+
+        // from nothing is the whole state
+        MemoryOutputStream full;
+        expect (Replication::writeStateDiff (MemoryBlock(), after, full));
+        MemoryInputStream fullIn (full.getData(), full.getDataSize(), false);
+        MemoryBlock fromNothing;
+        expect (Replication::applyStateDiff (fromNothing, fullIn));
+        expect (fromNothing == after);
+    }
+
+    void testPaths()
+    {
+        beginTest ("paths");
+        ValueTree root ("root");
+        ValueTree a ("a"), b ("b"), c ("c");
+        root.addChild (a, -1, nullptr);
+        root.addChild (b, -1, nullptr);
+        b.addChild (c, -1, nullptr);
+
+        Array<int> path;
+        expect (Replication::getPath (root, c, path));
+        expect (path == Array<int> ({ 1, 0 }));
+        expect (Replication::findTree (root, path) == c);
+        expect (Replication::getPath (root, root, path));
+        expect (path.isEmpty());
+        expect (! Replication::getPath (root, ValueTree ("other"), path));
+        expect (! Replication::findTree (root, Array<int> ({ 3 })).isValid());
+    }
+
+    void testLocalhost()
+    {
+        beginTest ("snapshot");
+        ValueTree session (Tags::session);
+        session.setProperty (Tags::tempo, 120.0, nullptr);
+        ValueTree graphs (Tags::graphs);
+        session.addChild (graphs, -1, nullptr);
+        auto graph = Node::createGraph ("Graph").getValueTree();
+        graphs.addChild (graph, -1, nullptr);
+
+        ReplicationLeader leader;
+        leader.setStateInterval (0);
+        int port = 47651;
+        while (port < 47700 && leader.start (port, session).failed())
+            ++port;
+        expect (leader.isRunning());
+        if (! leader.isRunning())
+            return;
+
+        ReplicationFollower follower;
+        expect (follower.connect ("127.0.0.1", port).wasOk());
+        expect (waitFor ([&]() { return follower.isFollowing(); }));
+        expectEquals (leader.getNumFollowers(), 1);
+        expect (session.isEquivalentTo (follower.getSession()));
+
+        beginTest ("edits");
+        const int received = follower.getNumBatchesReceived();
+        graph.setProperty (Tags::name, "One", nullptr);
+        graph.setProperty (Tags::name, "Two", nullptr);
+        ValueTree node (Tags::node);
+        node.setProperty (Tags::uuid, Uuid().toString(), nullptr);
+        graph.getChildWithName (Tags::nodes).addChild (node, -1, nullptr);
+        node.setProperty (Tags::name, "Node", nullptr);
+        graphs.setProperty (Tags::active, 0, nullptr);
+        leader.flush();
+        expect (waitFor ([&]() { return follower.getNumBatchesReceived() > received; }));
+        expectEquals (follower.getNumBatchesReceived(), received + 1);
+        expect (session.isEquivalentTo (follower.getSession()));
+
+        graph.getChildWithName (Tags::nodes).removeChild (node, nullptr);
+        graph.removeProperty (Tags::name, nullptr);
+        leader.flush();
+        expect (waitFor ([&]() { return session.isEquivalentTo (follower.getSession()); }));
+
+        beginTest ("transport");
+        leader.sendTempo (140.0);
+        leader.sendMeter (3, 2);
+        leader.sendSeek (44100);
+        leader.sendPlayState (true);
+        leader.flush();
+        expect (waitFor ([&]() { return follower.getTransportState().playing; }));
+        const auto& transport = follower.getTransportState();
+        expectEquals (transport.tempo, 140.0);
+        expectEquals (transport.beatsPerBar, 3);
+        expectEquals (transport.frame, (int64) 44100);
+
+        beginTest ("heartbeats");
+        follower.setLeaderTimeout (200);
+        runDispatchLoop (600);
+        expect (! follower.hasTakenOver());
+        expect (follower.isFollowing());
+
+        beginTest ("takeover");
+        int numTakeovers = 0;
+        follower.takeover.connect ([&numTakeovers]() { ++numTakeovers; });
+        expect (! follower.hasTakenOver());
+        leader.stop();
+        expect (waitFor ([&]() { return follower.hasTakenOver(); }));
+        expectEquals (numTakeovers, 1);
+        expect (! follower.isFollowing());
+    }
+
+    void testLeaderTimeout (bool acknowledges)
+    {
+        beginTest (acknowledges ? "fence acknowledged" : "leader timeout");
+        ValueTree session (Tags::session);
+        session.addChild (ValueTree (Tags::graphs), -1, nullptr);
+
+        StalledLeader leader (session, acknowledges);
+        int port = 47701;
+        while (port < 47750 && ! leader.beginWaitingForSocket (port, "127.0.0.1"))
+            ++port;
+        expect (port < 47750);
+        if (port >= 47750)
+            return;
+
+        ReplicationFollower follower;
+        follower.setLeaderTimeout (300);
+        int numTakeovers = 0;
+        follower.takeover.connect ([&numTakeovers]() { ++numTakeovers; });
+        expect (follower.connect ("127.0.0.1", port).wasOk());
+        expect (waitFor ([&]() { return follower.isFollowing(); }));
+
+        // the connection stays open, only the watchdog can notice. One
+        // quiet window only fences the leader, an acknowledged fence goes
+        // live right away and an unanswered one after a second window
+        Thread::sleep (200);
+        expect (! follower.hasTakenOver());
+        Thread::sleep (300);
+        expectEquals (leader.numFences.get(), 1);
+        expect (follower.hasTakenOver() == acknowledges);
+
+        // it does so without the message thread, takeover is emitted once it runs
+        Thread::sleep (acknowledges ? 0 : 400);
+        expect (follower.hasTakenOver());
+        expectEquals (numTakeovers, 0);
+        expect (waitFor ([&]() { return numTakeovers > 0; }));
+        expectEquals (numTakeovers, 1);
+        expect (! follower.isFollowing());
+
+        runDispatchLoop (100);
+        expectEquals (numTakeovers, 1);
+    }
+
+    void testFencedLeader()
+    {
+        beginTest ("fenced leader");
+        ValueTree session (Tags::session);
+        session.addChild (ValueTree (Tags::graphs), -1, nullptr);
+
+        ReplicationLeader leader;
+        leader.setStateInterval (0);
+        int numFenced = 0;
+        leader.fenced.connect ([&numFenced]() { ++numFenced; });
+        int port = 47751;
+        while (port < 47800 && leader.start (port, session).failed())
+            ++port;
+        expect (leader.isRunning());
+        if (! leader.isRunning())
+            return;
+
+        Probe probe;
+        expect (probe.connectToSocket ("127.0.0.1", port, 3000));
+        expect (waitFor ([&]() { return leader.getNumFollowers() == 1; }));
+
+        // heartbeats don't need the message thread
+        const int heartbeats = probe.numHeartbeats.get();
+        Thread::sleep (200);
+        expect (probe.numHeartbeats.get() > heartbeats);
+
+        expect (probe.sendMessage (Replication::encodeSignal (Replication::fenceRecord)));
+        Thread::sleep (200);
+        expect (leader.isFenced());
+        expectEquals (probe.acknowledged.get(), 1);
+        expectEquals (numFenced, 0);
+        expect (waitFor ([&]() { return numFenced > 0; }));
+
+        // a fenced leader has stopped being heard, it doesn't claim otherwise
+        const int fencedHeartbeats = probe.numHeartbeats.get();
+        Thread::sleep (200);
+        expectEquals (probe.numHeartbeats.get(), fencedHeartbeats);
+    }
+
+    bool waitFor (std::function<bool()> condition)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            if (condition())
+                return true;
+            runDispatchLoop (20);
+        }
+        return condition();
+    }
+};
+
+static ReplicationTest sReplicationTest;
+
+}
@@ -0,0 +1,163 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/SceneRecall.h"
+
+namespace Element {
+
+class SceneRecallTest : public UnitTestBase
+{
+public:
+    SceneRecallTest() : UnitTestBase ("Scene Recall", "engine", "sceneRecall") { }
+    virtual ~SceneRecallTest() { }
+
+    void initialise() override
+    {
+        initializePlugins();
+    }
+
+    void shutdown() override
+    {
+        shutdownPlugins();
+    }
+
+    void runTest() override
+    {
+        GraphProcessor root;
+        root.prepareToPlay (44100.0, 512);
+        GraphNodePtr graphNode = root.addNode (new SubGraphProcessor());
+        auto* const graph = dynamic_cast<GraphProcessor*> (graphNode->getAudioProcessor());
+        auto* const plugin = createPluginProcessor();
+        expect (graph != nullptr && plugin != nullptr);
+        if (graph == nullptr || plugin == nullptr)
+            return;
+
+        GraphNodePtr node = graph->addNode (plugin);
+        runDispatchLoop (20);
+
+        Node graphModel (Tags::graph);
+        graphModel.getValueTree().setProperty (Tags::object, graphNode.get(), nullptr);
+        Node nodeModel (Tags::plugin);
+        nodeModel.getValueTree().setProperty (Tags::object, node.get(), nullptr);
+        graphModel.getNodesValueTree().addChild (nodeModel.getValueTree(), -1, nullptr);
+
+        auto* const param = plugin->getParameters().getFirst();
+        expect (param != nullptr);
+        if (param == nullptr)
+            return;
+
+        beginTest ("capture");
+        param->setValueNotifyingHost (0.25f);
+        const float captured = param->getValue();
+        auto data = CompiledScene::capture (graphModel, "A");
+        expectEquals (data.getNumChildren(), 1);
+        expect (data.getChild(0).hasProperty (Tags::parameters));
+
+        beginTest ("recall");
+        SceneRecall recall;
+        param->setValueNotifyingHost (0.75f);
+        const float changed = param->getValue();
+        node->setMuted (true);
+        auto scene = CompiledScene::compile (graphModel, data);
+        expect (scene != nullptr);
+        expectEquals (scene->getNumNodes(), 1);
+        expectEquals (scene->getNumParameters(), plugin->getParameters().size());
+
+        expect (recall.recall (scene));
+        expectEquals (param->getValue(), changed);
+        recall.process (512, 44100.0);
+        expectWithinAbsoluteError (param->getValue(), captured, 0.01f);
+        expect (! node->isMuted());
+        expect (scene->isSettled());
+
+        // handed back to the message thread on the next block
+        recall.process (512, 44100.0);
+        runDispatchLoop (60);
+        expect (recall.getAppliedScene() == scene);
+        expect (! (bool) nodeModel.getProperty (Tags::mute, true));
+
+        beginTest ("glide");
+        data.setProperty (Tags::glide, 1024.0 / 44100.0, nullptr);
+        param->setValueNotifyingHost (0.75f);
+        scene = CompiledScene::compile (graphModel, data);
+        ParameterListener listener;
+        param->addListener (&listener);
+        expect (recall.recall (scene));
+        recall.process (512, 44100.0);
+        expectWithinAbsoluteError (param->getValue(), 0.5f * (changed + captured), 0.01f);
+        expect (! scene->isSettled());
+        recall.process (512, 44100.0);
+        expectWithinAbsoluteError (param->getValue(), captured, 0.01f);
+        expect (scene->isSettled());
+
+        beginTest ("listeners told on the message thread");
+        expectEquals (listener.numChanges, 0);
+        runDispatchLoop (60);
+        expect (listener.numChanges > 0);
+        expect (listener.onMessageThread);
+        expectWithinAbsoluteError (listener.lastValue, captured, 0.01f);
+        param->removeListener (&listener);
+
+        beginTest ("superseded recall");
+        // a scene that turns the node on, dropped for one that leaves it alone
+        node->setEnabled (false);
+        nodeModel.getValueTree().setProperty (Tags::enabled, false, nullptr);
+        data.removeProperty (Tags::glide, nullptr);
+        data.getChild(0).setProperty (Tags::enabled, true, nullptr);
+        auto dropped = CompiledScene::compile (graphModel, data);
+        auto newer = CompiledScene::compile (graphModel, ValueTree (Tags::scene));
+        expect (recall.recall (dropped));
+        expect (node->isEnabled() && node->isMuted());
+        expect (recall.recall (newer));
+        recall.process (512, 44100.0);
+        recall.process (512, 44100.0);
+        runDispatchLoop (60);
+        expect (recall.getAppliedScene() == newer);
+        expect (! node->isEnabled());
+        expect (! node->isMuted());
+
+        recall.clear();
+        node = nullptr;
+        graphNode = nullptr;
+        root.releaseResources();
+        root.clear();
+    }
+
+private:
+    struct ParameterListener : public AudioProcessorParameter::Listener
+    {
+        int numChanges = 0;
+        float lastValue = -1.f;
+        bool onMessageThread = true;
+
+        void parameterValueChanged (int, float value) override
+        {
+            ++numChanges;
+            lastValue = value;
+            onMessageThread = onMessageThread && MessageManager::getInstance()->isThisTheMessageThread();
+        }
+
+        void parameterGestureChanged (int, bool) override { }
+    };
+};
+
+static SceneRecallTest sSceneRecallTest;
+
+}
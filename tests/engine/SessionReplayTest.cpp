@@ -0,0 +1,227 @@
+/*
+    This file is part of Element
+    Copyright (C) 2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Tests.h"
+#include "engine/SessionCapture.h"
+#include "engine/SessionReplay.h"
+
+namespace Element {
+
+/** Captures a synthetic session and checks it replays the same way twice.
+
+    Set EL_REPLAY_CAPTURE to a directory written with EL_CAPTURE_DIR to
+    replay a real session as well. The first replay's report is saved next to
+    the capture as a baseline, later replays are compared against it.
+ */
+class SessionReplayTest : public UnitTestBase
+{
+public:
+    SessionReplayTest() : UnitTestBase ("Session Replay", "engine", "sessionReplay") { }
+    virtual ~SessionReplayTest() { }
+
+    void initialise() override
+    {
+        globals.reset (new Globals());
+        engine = new AudioEngine (*globals);
+        auto& plugins = globals->getPluginManager();
+        plugins.addDefaultFormats();
+        plugins.addFormat (new ElementAudioPluginFormat (*globals));
+        plugins.addFormat (new InternalFormat (*engine, globals->getMidiEngine()));
+        plugins.setPlayConfig (44100.0, 512);
+    }
+
+    void shutdown() override
+    {
+        engine = nullptr;
+        globals.reset (nullptr);
+    }
+
+    void runTest() override
+    {
+        testCaptureAndReplay();
+        replayFromEnvironment();
+    }
+
+private:
+    std::unique_ptr<Globals> globals;
+    AudioEnginePtr engine;
+
+    enum { numBlocks = 200 };
+
+    static ValueTree createGraphs()
+    {
+        Node graph (Node::createDefaultGraph ("Capture"));
+        ValueTree arcs = graph.getArcsValueTree();
+        for (int port = 0; port < 2; ++port)
+        {
+            ValueTree arc (Tags::arc);
+            arc.setProperty (Tags::sourceNode, 1, nullptr)
+               .setProperty (Tags::sourcePort, port, nullptr)
+               .setProperty (Tags::destNode, 2, nullptr)
+               .setProperty (Tags::destPort, port, nullptr);
+            arcs.addChild (arc, -1, nullptr);
+        }
+
+        ValueTree graphs (Tags::graphs);
+        graphs.setProperty (Tags::active, 0, nullptr);
+        graphs.addChild (graph.getValueTree(), -1, nullptr);
+        return graphs;
+    }
+
+    void testCaptureAndReplay()
+    {
+        beginTest ("capture");
+        const auto dir = File::getSpecialLocation (File::tempDirectory)
+            .getNonexistentChildFile ("ElementCapture", String());
+        ValueTree graphs (createGraphs());
+
+        SessionCapture capture;
+        const auto started = capture.start (dir, 44100.0, 2, graphs);
+        expect (started.wasOk(), started.getErrorMessage());
+        if (started.failed())
+            return;
+
+        AudioSampleBuffer input (2, 256);
+        MidiBuffer midi;
+        int64 frame = 0;
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            // odd sizes on purpose, some devices do this
+            const int numSamples = (i % 3 == 0) ? 256 : 200;
+            input.setSize (2, numSamples, false, false, true);
+            for (int c = 0; c < 2; ++c)
+                for (int s = 0; s < numSamples; ++s)
+                    input.setSample (c, s, 0.5f * std::sin ((float) (frame + s) * 0.01f * (float) (c + 1)));
+            frame += numSamples;
+
+            midi.clear();
+            if (i % 10 == 0)
+                midi.addEvent (MidiMessage::noteOn (1, 60, 0.8f), 5);
+            if (i == 75)
+            {
+                // longer than a record, goes through the sysex fifo
+                uint8 dump [300];
+                for (int b = 0; b < (int) sizeof (dump); ++b)
+                    dump[b] = (uint8) (b & 0x7f);
+                midi.addEvent (MidiMessage::createSysExMessage (dump, (int) sizeof (dump)), 10);
+            }
+
+            capture.captureBlock (input, midi);
+
+            if (i == 50)
+            {
+                capture.capturePlayState (true);
+                capture.captureTempo (140.0);
+            }
+            else if (i == 100)
+            {
+                graphs.getChild(0).setProperty (Tags::name, "Edited", nullptr);
+                runDispatchLoop (20);
+            }
+            else if (i == 150)
+            {
+                capture.captureSeek (0);
+            }
+        }
+
+        capture.stop();
+        expectEquals (capture.getNumDropped(), 0);
+        expect (capture.getNumFramesCaptured() == frame);
+        expect (dir.getChildFile (SessionCapture::inputFileName).existsAsFile());
+
+        beginTest ("replay");
+        SessionReplay replay;
+        const auto opened = replay.open (dir);
+        expect (opened.wasOk(), opened.getErrorMessage());
+        expectEquals (replay.getNumInputs(), 2);
+        expectEquals (replay.getSampleRate(), 44100.0);
+
+        SessionReplay::Options options;
+        options.hashSeconds = 0.25;
+        SessionReplay::Report first, second;
+        expect (replay.run (*engine, first, options).wasOk());
+        expectEquals (first.numBlocks, (int) numBlocks);
+        expect (first.numFrames == frame);
+        expectEquals (first.numMidiEvents, numBlocks / 10 + 1);
+        expectEquals (first.numTransportEvents, 3);
+        expectEquals (first.numGraphEdits, 2);
+        expectEquals (first.callbackTimes.size(), (int) numBlocks);
+        expect (first.sectionHashes.size() > 1);
+
+        beginTest ("replay is deterministic");
+        expect (replay.run (*engine, second, options).wasOk());
+        expectEquals (first.findFirstDifference (second), -1);
+        expect (first.outputHash == second.outputHash);
+
+        beginTest ("report round trip");
+        const auto loaded = SessionReplay::Report::fromValueTree (first.toValueTree());
+        expectEquals (loaded.findFirstDifference (first), -1);
+        expectEquals (loaded.numBlocks, first.numBlocks);
+        expectEquals (loaded.callbackTimes.size(), first.callbackTimes.size());
+
+        dir.deleteRecursively();
+    }
+
+    void replayFromEnvironment()
+    {
+        const auto path = SystemStats::getEnvironmentVariable ("EL_REPLAY_CAPTURE", String());
+        if (! File::isAbsolutePath (path))
+            return;
+
+        const File dir (path);
+        beginTest ("replay " + dir.getFileName());
+
+        SessionReplay replay;
+        auto result = replay.open (dir);
+        expect (result.wasOk(), result.getErrorMessage());
+        if (result.failed())
+            return;
+
+        SessionReplay::Report report;
+        result = replay.run (*engine, report);
+        expect (result.wasOk(), result.getErrorMessage());
+        logMessage (report.toString());
+
+        const auto baselineFile = dir.getChildFile ("baseline.xml");
+        if (! baselineFile.existsAsFile())
+        {
+            std::unique_ptr<XmlElement> xml (report.toValueTree().createXml());
+            if (xml != nullptr)
+                xml->writeToFile (baselineFile, String());
+            logMessage ("saved baseline report");
+            return;
+        }
+
+        std::unique_ptr<XmlElement> xml (XmlDocument::parse (baselineFile));
+        const auto baseline = SessionReplay::Report::fromValueTree (
+            xml != nullptr ? ValueTree::fromXml (*xml) : ValueTree());
+        const int section = report.findFirstDifference (baseline);
+        expect (section < 0, "output differs from baseline in section " + String (section));
+
+        String timing;
+        timing << "baseline callback us: mean " << String (baseline.getMeanCallbackTime(), 1)
+               << ", p99 " << String (baseline.getCallbackPercentile (99.0), 1)
+               << ", over budget " << baseline.numOverBudget;
+        logMessage (timing);
+    }
+};
+
+static SessionReplayTest sSessionReplayTest;
+
+}
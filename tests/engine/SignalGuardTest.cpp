@@ -0,0 +1,206 @@
+/*
+    This file is part of Element
+    Copyright (C) 2018-2019  Kushview, LLC.  All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Tests.h"
+#include "engine/SignalGuard.h"
+
+namespace Element {
+
+class SignalGuardTest : public UnitTestBase
+{
+public:
+    SignalGuardTest() : UnitTestBase ("Signal Guard", "engine", "signalGuard") { }
+    virtual ~SignalGuardTest() { }
+
+    void runTest() override
+    {
+        testMetering();
+        testNonFinite();
+        testDenormals();
+        testGraphFault();
+    }
+
+private:
+    /** Passes audio through, or writes NaN when asked to */
+    class NaNProcessor : public AudioPluginInstance
+    {
+    public:
+        NaNProcessor()
+            : AudioPluginInstance (BusesProperties()
+                .withInput  ("Main", AudioChannelSet::stereo())
+                .withOutput ("Main", AudioChannelSet::stereo())) { }
+
+        Atomic<int> emitNaN { 0 };
+
+        const String getName() const override { return "NaN"; }
+        void fillInPluginDescription (PluginDescription& desc) const override
+        {
+            desc.name = getName();
+            desc.fileOrIdentifier = "test.nan";
+            desc.pluginFormatName = "Test";
+            desc.numInputChannels = desc.numOutputChannels = 2;
+        }
+
+        void prepareToPlay (double, int) override { }
+        void releaseResources() override { }
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer&) override
+        {
+            if (emitNaN.get() == 1)
+                buffer.setSample (0, buffer.getNumSamples() / 2, std::numeric_limits<float>::quiet_NaN());
+        }
+
+        double getTailLengthSeconds() const override { return 0.0; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram (int) override { }
+        const String getProgramName (int) override { return String(); }
+        void changeProgramName (int, const String&) override { }
+        void getStateInformation (MemoryBlock&) override { }
+        void setStateInformation (const void*, int) override { }
+    };
+
+    void testMetering()
+    {
+        beginTest ("rms matches AudioBuffer");
+        AudioSampleBuffer buffer (1, 67);
+        Random rng (1234);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, rng.nextFloat() * 2.f - 1.f);
+        const float expected = buffer.getRMSLevel (0, 0, buffer.getNumSamples());
+        const auto result = SignalGuard::scan (buffer.getWritePointer (0), buffer.getNumSamples());
+        expect (! result.nonFinite);
+        expect (result.denormals == 0);
+        expectWithinAbsoluteError (result.rms, expected, 0.0001f);
+    }
+
+    void testNonFinite()
+    {
+        beginTest ("nan and inf");
+        AudioSampleBuffer buffer (1, 64);
+        buffer.clear();
+        buffer.setSample (0, 13, std::numeric_limits<float>::quiet_NaN());
+        expect (SignalGuard::scan (buffer.getWritePointer (0), 64).nonFinite);
+        buffer.clear();
+        buffer.setSample (0, 63, std::numeric_limits<float>::infinity());
+        expect (SignalGuard::scan (buffer.getWritePointer (0), 64).nonFinite);
+        buffer.clear();
+        expect (! SignalGuard::scan (buffer.getWritePointer (0), 64).nonFinite);
+    }
+
+    void testDenormals()
+    {
+        beginTest ("denormals flushed");
+        AudioSampleBuffer buffer (1, 64);
+        buffer.clear();
+        const float tiny = std::numeric_limits<float>::denorm_min();
+        for (int i = 0; i < 40; ++i)
+            buffer.setSample (0, i, tiny);
+        const auto result = SignalGuard::scan (buffer.getWritePointer (0), 64);
+        expect (result.denormals == 40);
+        expect (SignalGuard::isDenormalStorm (result.denormals, 64));
+        expect (! SignalGuard::isDenormalStorm (4, 64));
+        for (int i = 0; i < 64; ++i)
+            expect (buffer.getSample (0, i) == 0.f);
+
+        beginTest ("large finite values");
+        buffer.clear();
+        buffer.setSample (0, 7, 1e20f);
+        buffer.setSample (0, 8, -std::numeric_limits<float>::max());
+        const auto loud = SignalGuard::scan (buffer.getWritePointer (0), 64);
+        expect (! loud.nonFinite);
+        expect (loud.rms > 1e20f);
+    }
+
+    void testGraphFault()
+    {
+        beginTest ("graph silences and clears a faulted node");
+        const bool wasEnabled = GraphNode::isSignalGuardEnabled();
+        GraphNode::setSignalGuardEnabled (true);
+
+        GraphProcessor graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 512);
+        graph.prepareToPlay (44100.0, 512);
+
+        auto* const processor = new NaNProcessor();
+        GraphNodePtr node = graph.addNode (processor);
+        GraphNodePtr input = graph.addNode (new GraphProcessor::AudioGraphIOProcessor (
+            GraphProcessor::AudioGraphIOProcessor::audioInputNode));
+        GraphNodePtr output = graph.addNode (new GraphProcessor::AudioGraphIOProcessor (
+            GraphProcessor::AudioGraphIOProcessor::audioOutputNode));
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            expect (graph.addConnection (input->nodeId, input->getNthPort (PortType::Audio, ch, false, false),
+                                         node->nodeId, node->getNthPort (PortType::Audio, ch, true, false)));
+            expect (graph.addConnection (node->nodeId, node->getNthPort (PortType::Audio, ch, false, false),
+                                         output->nodeId, output->getNthPort (PortType::Audio, ch, true, false)));
+        }
+        runDispatchLoop (20);
+
+        int numFaultChanges = 0;
+        node->faultChanged.connect ([&numFaultChanges](GraphNode*) { ++numFaultChanges; });
+
+        AudioSampleBuffer audio (2, 512);
+        MidiBuffer midi;
+        auto render = [&]() {
+            for (int ch = 0; ch < 2; ++ch)
+                FloatVectorOperations::fill (audio.getWritePointer (ch), 0.5f, 512);
+            graph.processBlock (audio, midi);
+        };
+
+        render();
+        expect (! node->isFaulted());
+        expect (audio.getMagnitude (0, 0, 512) > 0.f);
+
+        processor->emitNaN.set (1);
+        render();
+        expect (node->isFaulted());
+        expectEquals (audio.getMagnitude (0, 0, 512), 0.f);
+        expectEquals (audio.getMagnitude (1, 0, 512), 0.f);
+
+        // stays silent until cleared, even once the NaN stops
+        processor->emitNaN.set (0);
+        render();
+        expect (node->isFaulted());
+        expectEquals (audio.getMagnitude (0, 0, 512), 0.f);
+        runDispatchLoop (20);
+        expectEquals (numFaultChanges, 1);
+
+        node->clearFault();
+        expect (! node->isFaulted());
+        expectEquals (numFaultChanges, 2);
+        render();
+        expect (audio.getMagnitude (0, 0, 512) > 0.f);
+        render();
+        expectWithinAbsoluteError (audio.getSample (0, 511), 0.5f, 0.001f);
+
+        node = nullptr;
+        input = nullptr;
+        output = nullptr;
+        graph.releaseResources();
+        graph.clear();
+        GraphNode::setSignalGuardEnabled (wasEnabled);
+    }
+};
+
+static SignalGuardTest sSignalGuardTest;
+
+}